@@ -32,6 +32,13 @@ void IdleCmd::Reflect(ut::meta::Snapshot& snapshot)
 	snapshot << milliseconds_to_wait;
 }
 
+// Idle command is sent very often and has only one plain member,
+// so its reflection tree can be cached.
+bool IdleCmd::HasFixedReflection() const
+{
+	return true;
+}
+
 // Executes command if received by client.
 //    @param connection - connection owning the command.
 //    @return - error if failed.
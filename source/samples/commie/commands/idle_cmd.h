@@ -25,6 +25,10 @@ public:
 	// Serialization
 	void Reflect(ut::meta::Snapshot& snapshot);
 
+	// Idle command is sent very often and has only one plain member,
+	// so its reflection tree can be cached.
+	bool HasFixedReflection() const;
+
 	// Executes command if received by client.
 	//    @param connection - connection owning the command.
 	//    @return - error if failed.
@@ -2,6 +2,7 @@
 //---------------------------------|  U  T  |---------------------------------//
 //----------------------------------------------------------------------------//
 #include "serialization_test.h"
+#include "file_test.h"
 //----------------------------------------------------------------------------//
 // simple polymorphic types
 UT_REGISTER_TYPE(TestBase, TestBase, "test_base")
@@ -28,6 +29,13 @@ SerializationTestUnit::SerializationTestUnit() : TestUnit("SERIALIZATION")
 {
 	tasks.Add(ut::MakeUnique<ParameterTraitsTask>());
 	tasks.Add(ut::MakeUnique<SerializationVariantsTask>());
+	tasks.Add(ut::MakeUnique<BulkArrayTask>());
+	tasks.Add(ut::MakeUnique<CorruptedStringTask>());
+	tasks.Add(ut::MakeUnique<SchemaTask>());
+	tasks.Add(ut::MakeUnique<TypeDictionaryTask>());
+	tasks.Add(ut::MakeUnique<ParallelSerializationTask>());
+	tasks.Add(ut::MakeUnique<LazyLoadingTask>());
+	tasks.Add(ut::MakeUnique<DeltaSerializationTask>());
 }
 
 //----------------------------------------------------------------------------//
@@ -441,6 +449,11 @@ SerializationVariantsTask::SerializationVariantsTask() : TestTask("Serialization
 	// minimal
 	serialization_info = ut::meta::Info::CreateMinimal();
 	info_variants.Insert("minimal", serialization_info);
+
+	// legacy strings (loader must detect the format by header)
+	serialization_info = ut::meta::Info::CreateComplete();
+	serialization_info.EnableLengthPrefixedStrings(false);
+	info_variants.Insert("null-terminated strings", serialization_info);
 }
 
 void SerializationVariantsTask::Execute()
@@ -577,6 +590,25 @@ bool SerializationVariantsTask::TestVariant(const ut::meta::Info& in_info,
 	}
 	binary_stream.MoveCursor(0); // move stream cursor back
 
+	// binary serialization to the stream without positioning
+	// must produce exactly the same data
+	SequentialStream sequential_stream;
+	save_error = snapshot.Save(sequential_stream);
+	if (save_error)
+	{
+		report += ut::String("Failed to save binary object to the sequential stream.") + ut::CRet();
+		report += save_error->GetDesc();
+		failed_test_counter.Increment();
+		return false;
+	}
+	else if (!CompareStreams(binary_stream, sequential_stream))
+	{
+		report += ut::String("FAIL: Sequential stream doesn't match the binary one.") + ut::CRet();
+		failed_test_counter.Increment();
+		return false;
+	}
+	sequential_stream.Rewind();
+
 	// xml serialization
 	ut::BinaryStream xml_stream;
 	ut::XmlDoc save_xml;
@@ -609,6 +641,22 @@ bool SerializationVariantsTask::TestVariant(const ut::meta::Info& in_info,
 	}
 	json_stream.MoveCursor(0);
 
+	// binary document serialization
+	ut::BinaryStream binary_doc_stream;
+	ut::BinaryDoc save_binary_doc;
+	try
+	{
+		binary_doc_stream << (save_binary_doc << snapshot);
+	}
+	catch (const ut::Error& error)
+	{
+		report += "Saving binary document: failed. ";
+		report += error.GetDesc() + ut::CRet();
+		failed_test_counter.Increment();
+		return false;
+	}
+	binary_doc_stream.MoveCursor(0);
+
 	// load another object from the stream, it must be
 	// the same as the original one
 	SerializationTest binary_object(is_mutable, in_info.HasLinkageInformation());
@@ -622,6 +670,17 @@ bool SerializationVariantsTask::TestVariant(const ut::meta::Info& in_info,
 		return false;
 	}
 
+	SerializationTest sequential_object(is_mutable, in_info.HasLinkageInformation());
+	ut::meta::Snapshot sequential_snapshot = ut::meta::Snapshot::Capture(sequential_object, "test_object");
+	load_error = sequential_snapshot.Load(sequential_stream);
+	if (load_error)
+	{
+		report += ut::String("Failed to load binary object from the sequential stream:") + ut::CRet();
+		report += load_error->GetDesc() + ut::CRet();
+		failed_test_counter.Increment();
+		return false;
+	}
+
 	SerializationTest xml_object(is_mutable, in_info.HasLinkageInformation());
 	ut::meta::Snapshot xml_snapshot = ut::meta::Snapshot::Capture(xml_object, "test_object");
 	ut::XmlDoc load_xml;
@@ -652,6 +711,21 @@ bool SerializationVariantsTask::TestVariant(const ut::meta::Info& in_info,
 		return false;
 	}
 
+	SerializationTest binary_doc_object(is_mutable, in_info.HasLinkageInformation());
+	ut::BinaryDoc load_binary_doc;
+	ut::meta::Snapshot binary_doc_snapshot = ut::meta::Snapshot::Capture(binary_doc_object, "test_object");
+	try
+	{
+		binary_doc_stream >> load_binary_doc >> binary_doc_snapshot;
+	}
+	catch (const ut::Error& error)
+	{
+		report += "Loading binary document: failed. ";
+		report += error.GetDesc() + ut::CRet();
+		failed_test_counter.Increment();
+		return false;
+	}
+
 	// validate binary object immutability after save/load action
 	bool check_ok = true;
 	if (!CheckSerializedObject(binary_object, is_mutable, in_info.HasLinkageInformation()))
@@ -661,6 +735,14 @@ bool SerializationVariantsTask::TestVariant(const ut::meta::Info& in_info,
 		check_ok = false;
 	}
 
+	// validate sequentially loaded object
+	if (!CheckSerializedObject(sequential_object, is_mutable, in_info.HasLinkageInformation()))
+	{
+		report += ut::String("FAIL: Objects don't match after sequential stream serialization/deserialization.") + ut::CRet();
+		failed_test_counter.Increment();
+		check_ok = false;
+	}
+
 	// validate xml object immutability after save/load action
 	if (!CheckSerializedObject(xml_object, is_mutable, in_info.HasLinkageInformation()))
 	{
@@ -677,19 +759,1185 @@ bool SerializationVariantsTask::TestVariant(const ut::meta::Info& in_info,
 		check_ok = false;
 	}
 
+	// validate binary document object immutability after save/load action
+	if (!CheckSerializedObject(binary_doc_object, is_mutable, in_info.HasLinkageInformation()))
+	{
+		report += ut::String("FAIL: Objects don't match after binary document serialization/deserialization. ") + ut::CRet();
+		failed_test_counter.Increment();
+		check_ok = false;
+	}
+
 	// success
 	return check_ok;
 }
 
 //----------------------------------------------------------------------------//
-SerializationSubClass::SerializationSubClass() : u16val(0), str("void")
+// number of elements in the bulk array
+static const size_t skBulkArraySize = 1024 * 1024;
+
+// Fills bulk array with test values.
+void FillBulkArray(BulkArrayHolder<float>& holder)
+{
+	holder.arr.Resize(skBulkArraySize);
+	for (size_t i = 0; i < skBulkArraySize; i++)
+	{
+		holder.arr[i] = static_cast<float>(i % 1000) * 0.5f - 100.0f;
+	}
+	holder.tail = 17;
+}
+
+// Checks that loaded bulk array matches the original one.
+bool CheckBulkArray(const BulkArrayHolder<float>& holder, size_t count)
+{
+	if (holder.arr.Count() != count || holder.tail != 17)
+	{
+		return false;
+	}
+
+	for (size_t i = 0; i < count; i++)
+	{
+		if (holder.arr[i] != static_cast<float>(i % 1000) * 0.5f - 100.0f)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// BulkArrayHolder<float> with 8 elements saved by the older version of
+// the library with ut::meta::Info::CreateComplete(), every element of
+// the array has a separate child node
+static const ut::byte skLegacyBulkArchive[] =
+{
+	0x01, 0x00, 0x00, 0x00, 0x6F, 0x00, 0x00, 0x00, 0x62, 0x75, 0x6C, 0x6B, 0x00, 0x72, 0x65, 0x66,
+	0x6C, 0x65, 0x63, 0x74, 0x69, 0x76, 0x65, 0x00, 0xE3, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00,
+	0x61, 0x72, 0x72, 0x00, 0x61, 0x72, 0x72, 0x61, 0x79, 0x00, 0xBA, 0x00, 0x00, 0x00, 0x66, 0x6C,
+	0x6F, 0x61, 0x74, 0x00, 0x08, 0x00, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00, 0x70, 0x30, 0x00, 0x66,
+	0x6C, 0x6F, 0x61, 0x74, 0x00, 0x0C, 0x00, 0x00, 0x00, 0x00, 0x00, 0xC8, 0xC2, 0x00, 0x00, 0x00,
+	0x00, 0x70, 0x31, 0x00, 0x66, 0x6C, 0x6F, 0x61, 0x74, 0x00, 0x0C, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0xC7, 0xC2, 0x00, 0x00, 0x00, 0x00, 0x70, 0x32, 0x00, 0x66, 0x6C, 0x6F, 0x61, 0x74, 0x00, 0x0C,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0xC6, 0xC2, 0x00, 0x00, 0x00, 0x00, 0x70, 0x33, 0x00, 0x66, 0x6C,
+	0x6F, 0x61, 0x74, 0x00, 0x0C, 0x00, 0x00, 0x00, 0x00, 0x00, 0xC5, 0xC2, 0x00, 0x00, 0x00, 0x00,
+	0x70, 0x34, 0x00, 0x66, 0x6C, 0x6F, 0x61, 0x74, 0x00, 0x0C, 0x00, 0x00, 0x00, 0x00, 0x00, 0xC4,
+	0xC2, 0x00, 0x00, 0x00, 0x00, 0x70, 0x35, 0x00, 0x66, 0x6C, 0x6F, 0x61, 0x74, 0x00, 0x0C, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0xC3, 0xC2, 0x00, 0x00, 0x00, 0x00, 0x70, 0x36, 0x00, 0x66, 0x6C, 0x6F,
+	0x61, 0x74, 0x00, 0x0C, 0x00, 0x00, 0x00, 0x00, 0x00, 0xC2, 0xC2, 0x00, 0x00, 0x00, 0x00, 0x70,
+	0x37, 0x00, 0x66, 0x6C, 0x6F, 0x61, 0x74, 0x00, 0x0C, 0x00, 0x00, 0x00, 0x00, 0x00, 0xC1, 0xC2,
+	0x00, 0x00, 0x00, 0x00, 0x74, 0x61, 0x69, 0x6C, 0x00, 0x69, 0x6E, 0x74, 0x33, 0x32, 0x00, 0x0C,
+	0x00, 0x00, 0x00, 0x11, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+};
+
+BulkArrayTask::BulkArrayTask() : TestTask("Bulk arrays")
 { }
 
-void SerializationSubClass::Reflect(ut::meta::Snapshot& snapshot)
+void BulkArrayTask::Execute()
 {
-	snapshot << u16val;
-	snapshot << iarr;
-	snapshot << str;
+	ut::meta::Info info = ut::meta::Info::CreateComplete();
+	TestBinary(info, "binary");
+
+	info.SetEndianness(ut::endianness::Order::big);
+	TestBinary(info, "binary, big endian");
+
+	info = ut::meta::Info::CreateMinimal();
+	TestBinary(info, "binary, minimal");
+
+	info = ut::meta::Info::CreateComplete();
+	TestText(info, "text");
+
+	info.EnableValueEncapsulation(false);
+	TestText(info, "text, no encapsulation");
+
+	TestLegacyText();
+	TestLegacyBinary();
+}
+
+bool BulkArrayTask::TestBinary(const ut::meta::Info& info, const ut::String& name)
+{
+	report += name + ": ";
+
+	BulkArrayHolder<float> original;
+	FillBulkArray(original);
+
+	ut::time::Counter counter;
+	counter.Start();
+
+	// bulk array must have no child nodes
+	ut::meta::Snapshot snapshot = ut::meta::Snapshot::Capture(original, "bulk", info);
+	ut::Optional<ut::meta::Snapshot&> arr_node = snapshot.FindChildByName("arr");
+	if (!arr_node || arr_node->CountChildren() != 0)
+	{
+		report += "failed: bulk array has child nodes.\n";
+		failed_test_counter.Increment();
+		return false;
+	}
+
+	ut::BinaryStream stream;
+	ut::Optional<ut::Error> save_error = snapshot.Save(stream);
+	if (save_error)
+	{
+		report += ut::String("failed to save: ") + save_error->GetDesc() + "\n";
+		failed_test_counter.Increment();
+		return false;
+	}
+	const double save_time = counter.GetTime();
+
+	counter.Start();
+	stream.MoveCursor(0);
+	BulkArrayHolder<float> loaded;
+	ut::meta::Snapshot load_snapshot = ut::meta::Snapshot::Capture(loaded, "bulk");
+	ut::Optional<ut::Error> load_error = load_snapshot.Load(stream);
+	if (load_error)
+	{
+		report += ut::String("failed to load: ") + load_error->GetDesc() + "\n";
+		failed_test_counter.Increment();
+		return false;
+	}
+	const double load_time = counter.GetTime();
+
+	if (!CheckBulkArray(loaded, skBulkArraySize))
+	{
+		report += "failed: arrays don't match.\n";
+		failed_test_counter.Increment();
+		return false;
+	}
+
+	// serialized data must be close to the raw size of the array
+	const size_t raw_size = skBulkArraySize * sizeof(float);
+	const size_t stream_size = stream.GetBuffer().GetSize();
+	report += ut::String("saved ") + ut::Print(stream_size) + " bytes (raw " + ut::Print(raw_size) + ") in " +
+	          ut::Print(save_time) + "ms, loaded in " + ut::Print(load_time) + "ms.\n";
+	if (stream_size > raw_size + 512)
+	{
+		report += "failed: serialized array is too big.\n";
+		failed_test_counter.Increment();
+		return false;
+	}
+
+	return true;
+}
+
+bool BulkArrayTask::TestText(const ut::meta::Info& info, const ut::String& name)
+{
+	report += name + ": ";
+
+	BulkArrayHolder<float> original;
+	FillBulkArray(original);
+
+	ut::time::Counter counter;
+	counter.Start();
+	ut::meta::Snapshot snapshot = ut::meta::Snapshot::Capture(original, "bulk", info);
+	ut::BinaryStream stream;
+	ut::JsonDoc save_json;
+	try
+	{
+		stream << (save_json << snapshot);
+	}
+	catch (const ut::Error& error)
+	{
+		report += ut::String("failed to save: ") + error.GetDesc() + "\n";
+		failed_test_counter.Increment();
+		return false;
+	}
+	const double save_time = counter.GetTime();
+
+	counter.Start();
+	stream.MoveCursor(0);
+	BulkArrayHolder<float> loaded;
+	ut::meta::Snapshot load_snapshot = ut::meta::Snapshot::Capture(loaded, "bulk");
+	ut::JsonDoc load_json;
+	try
+	{
+		stream >> load_json >> load_snapshot;
+	}
+	catch (const ut::Error& error)
+	{
+		report += ut::String("failed to load: ") + error.GetDesc() + "\n";
+		failed_test_counter.Increment();
+		return false;
+	}
+	const double load_time = counter.GetTime();
+
+	if (!CheckBulkArray(loaded, skBulkArraySize))
+	{
+		report += "failed: arrays don't match.\n";
+		failed_test_counter.Increment();
+		return false;
+	}
+
+	report += ut::String("saved ") + ut::Print(stream.GetBuffer().GetSize()) + " bytes in " +
+	          ut::Print(save_time) + "ms, loaded in " + ut::Print(load_time) + "ms.\n";
+	return true;
+}
+
+bool BulkArrayTask::TestLegacyText()
+{
+	report += "element-wise text: ";
+
+	// 'long double' arrays are still serialized element by element,
+	// without type information such text data is a valid input for
+	// the array of floats
+	const size_t count = 64;
+	BulkArrayHolder<long double> legacy;
+	for (size_t i = 0; i < count; i++)
+	{
+		legacy.arr.Add(static_cast<long double>(i % 1000) * 0.5 - 100.0);
+	}
+	legacy.tail = 17;
+
+	ut::meta::Info info = ut::meta::Info::CreateComplete();
+	info.EnableTypeInformation(false);
+	ut::meta::Snapshot snapshot = ut::meta::Snapshot::Capture(legacy, "bulk", info);
+	ut::Tree<ut::text::Node> text_tree;
+	ut::Optional<ut::Error> save_error = snapshot.Save(text_tree);
+	if (save_error)
+	{
+		report += ut::String("failed to save: ") + save_error->GetDesc() + "\n";
+		failed_test_counter.Increment();
+		return false;
+	}
+
+	BulkArrayHolder<float> loaded;
+	ut::meta::Snapshot load_snapshot = ut::meta::Snapshot::Capture(loaded, "bulk");
+	ut::Optional<ut::Error> load_error = load_snapshot.Load(text_tree);
+	if (load_error)
+	{
+		report += ut::String("failed to load: ") + load_error->GetDesc() + "\n";
+		failed_test_counter.Increment();
+		return false;
+	}
+
+	if (!CheckBulkArray(loaded, count))
+	{
+		report += "failed: arrays don't match.\n";
+		failed_test_counter.Increment();
+		return false;
+	}
+
+	report += "success";
+	return true;
+}
+
+bool BulkArrayTask::TestLegacyBinary()
+{
+	report += "\nelement-wise binary: ";
+
+	ut::BinaryStream stream;
+	ut::Optional<ut::Error> write_error = stream.Write(skLegacyBulkArchive, 1, sizeof(skLegacyBulkArchive));
+	if (write_error)
+	{
+		report += ut::String("failed to write archive: ") + write_error->GetDesc() + "\n";
+		failed_test_counter.Increment();
+		return false;
+	}
+	stream.MoveCursor(0);
+
+	BulkArrayHolder<float> loaded;
+	ut::meta::Snapshot load_snapshot = ut::meta::Snapshot::Capture(loaded, "bulk");
+	ut::Optional<ut::Error> load_error = load_snapshot.Load(stream);
+	if (load_error)
+	{
+		report += ut::String("failed to load: ") + load_error->GetDesc() + "\n";
+		failed_test_counter.Increment();
+		return false;
+	}
+
+	if (!CheckBulkArray(loaded, 8))
+	{
+		report += "failed: arrays don't match.\n";
+		failed_test_counter.Increment();
+		return false;
+	}
+
+	// the same snapshot must be saved in the current layout
+	ut::Optional<ut::meta::Snapshot&> arr_node = load_snapshot.FindChildByName("arr");
+	if (!arr_node || arr_node->CountChildren() != 0)
+	{
+		report += "failed: loaded bulk array has child nodes.\n";
+		failed_test_counter.Increment();
+		return false;
+	}
+
+	ut::BinaryStream resave_stream;
+	ut::Optional<ut::Error> save_error = load_snapshot.Save(resave_stream);
+	if (save_error)
+	{
+		report += ut::String("failed to save loaded snapshot: ") + save_error->GetDesc() + "\n";
+		failed_test_counter.Increment();
+		return false;
+	}
+
+	resave_stream.MoveCursor(0);
+	BulkArrayHolder<float> reloaded;
+	load_error = ut::meta::Snapshot::Capture(reloaded, "bulk").Load(resave_stream);
+	if (load_error)
+	{
+		report += ut::String("failed to load saved snapshot: ") + load_error->GetDesc() + "\n";
+		failed_test_counter.Increment();
+		return false;
+	}
+
+	if (!CheckBulkArray(reloaded, 8))
+	{
+		report += "failed: arrays don't match after saving loaded snapshot.\n";
+		failed_test_counter.Increment();
+		return false;
+	}
+
+	report += "success";
+	return true;
+}
+//----------------------------------------------------------------------------//
+ut::Result<ut::stream::Cursor, ut::Error> SequentialStream::GetCursor() const
+{
+	return ut::MakeError(ut::error::not_supported);
+}
+
+ut::Optional<ut::Error> SequentialStream::MoveCursor(ut::stream::Cursor,
+                                                     ut::stream::Position)
+{
+	return ut::Error(ut::error::not_supported);
+}
+
+ut::Result<size_t, ut::Error> SequentialStream::GetSize()
+{
+	return ut::MakeError(ut::error::not_supported);
+}
+
+void SequentialStream::Rewind()
+{
+	cursor = 0;
+}
+
+//----------------------------------------------------------------------------//
+bool CompareStreams(const ut::BinaryStream& left, const ut::BinaryStream& right)
+{
+	const ut::Array<ut::byte>& left_buffer = left.GetBuffer();
+	const ut::Array<ut::byte>& right_buffer = right.GetBuffer();
+	if (left_buffer.GetSize() != right_buffer.GetSize())
+	{
+		return false;
+	}
+
+	for (size_t i = 0; i < left_buffer.GetSize(); i++)
+	{
+		if (left_buffer[i] != right_buffer[i])
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+//----------------------------------------------------------------------------//
+CorruptedStringTask::CorruptedStringTask() : TestTask("Corrupted string length")
+{ }
+
+void CorruptedStringTask::Execute()
+{
+	ut::String original("abc");
+	ut::BinaryStream stream;
+	ut::Optional<ut::Error> save_error = ut::meta::Snapshot::Capture(original, "str", ut::meta::Info::CreatePure()).Save(stream);
+	if (save_error)
+	{
+		report += ut::String("failed to save: ") + save_error->GetDesc();
+		failed_test_counter.Increment();
+		return;
+	}
+
+	// find the length prefix, it's followed by the characters
+	ut::Array<ut::byte> data = stream.GetBuffer();
+	const size_t length_size = sizeof(ut::uint32);
+	size_t length_offset = 0;
+	bool found = false;
+	for (; !found && length_offset + length_size + 3 <= data.GetSize(); length_offset++)
+	{
+		const ut::byte* characters = data.GetAddress() + length_offset + length_size;
+		found = characters[0] == 'a' && characters[1] == 'b' && characters[2] == 'c';
+	}
+
+	if (!found)
+	{
+		report += "failed: string isn't found in the archive.";
+		failed_test_counter.Increment();
+		return;
+	}
+
+	// length larger than the whole archive must be rejected before allocation
+	length_offset--;
+	for (size_t i = 0; i < length_size; i++)
+	{
+		data[length_offset + i] = 0x7F;
+	}
+	stream.SetBuffer(ut::Move(data));
+	stream.MoveCursor(0);
+
+	ut::String loaded;
+	ut::Optional<ut::Error> load_error = ut::meta::Snapshot::Capture(loaded, "str", ut::meta::Info::CreatePure()).Load(stream);
+	if (!load_error || load_error->GetCode() != ut::error::out_of_bounds)
+	{
+		report += "failed: corrupted length was accepted.";
+		failed_test_counter.Increment();
+		return;
+	}
+
+	report += "success";
+}
+
+//----------------------------------------------------------------------------//
+SchemaTask::SchemaTask() : TestTask("Schema")
+{ }
+
+void SchemaTask::Execute()
+{
+	TestStatic();
+	TestPointer();
+	TestPerformance();
+}
+
+bool SchemaTask::TestStatic()
+{
+	report += "static type: ";
+
+	ut::meta::Schema& schema = ut::meta::Schema::Get<SerializationSubClass>();
+	for (ut::int32 i = 0; i < 3; i++)
+	{
+		// every iteration uses another object
+		SerializationSubClass original;
+		original.u16val = static_cast<ut::uint16>(100 + i);
+		original.str = ut::String("object ") + ut::Print(i);
+		for (ut::int32 j = 0; j <= i; j++)
+		{
+			original.iarr.Add(j * 10);
+		}
+
+		ut::BinaryStream schema_stream;
+		{
+			ut::Result<ut::meta::Schema::Lease, ut::Error> lease = schema.Acquire(original, "sub");
+			if (!lease)
+			{
+				report += ut::String("failed to acquire: ") + lease.GetAlt().GetDesc() + "\n";
+				failed_test_counter.Increment();
+				return false;
+			}
+
+			ut::Optional<ut::Error> save_error = lease.Get()->Save(schema_stream);
+			if (save_error)
+			{
+				report += ut::String("failed to save: ") + save_error->GetDesc() + "\n";
+				failed_test_counter.Increment();
+				return false;
+			}
+		}
+
+		// cached snapshot must produce exactly the same data
+		ut::BinaryStream capture_stream;
+		ut::meta::Snapshot::Capture(original, "sub").Save(capture_stream);
+		if (!CompareStreams(schema_stream, capture_stream))
+		{
+			report += "failed: data doesn't match the captured snapshot.\n";
+			failed_test_counter.Increment();
+			return false;
+		}
+
+		schema_stream.MoveCursor(0);
+		SerializationSubClass loaded;
+		{
+			ut::Result<ut::meta::Schema::Lease, ut::Error> lease = schema.Acquire(loaded, "sub");
+			ut::Optional<ut::Error> load_error = lease ? lease.Get()->Load(schema_stream) :
+			                                             ut::Optional<ut::Error>(lease.GetAlt());
+			if (load_error)
+			{
+				report += ut::String("failed to load: ") + load_error->GetDesc() + "\n";
+				failed_test_counter.Increment();
+				return false;
+			}
+		}
+
+		if (loaded.u16val != original.u16val ||
+		    loaded.str != original.str ||
+		    loaded.iarr.Count() != original.iarr.Count() ||
+		    loaded.iarr.GetLast() != original.iarr.GetLast())
+		{
+			report += "failed: loaded object doesn't match the original.\n";
+			failed_test_counter.Increment();
+			return false;
+		}
+	}
+
+	if (!schema.IsCacheable())
+	{
+		report += "failed: schema is not cacheable.\n";
+		failed_test_counter.Increment();
+		return false;
+	}
+
+	report += "success.\n";
+	return true;
+}
+
+bool SchemaTask::TestPointer()
+{
+	report += "pointer: ";
+
+	for (ut::int32 i = 0; i < 3; i++)
+	{
+		ut::UniquePtr<TestBase> original = ut::MakeUnique<PolymorphicA>(i, 10 + i);
+		original->fval = static_cast<float>(i) + 0.5f;
+
+		ut::meta::Schema& schema = ut::meta::Schema::Get<TestBase>(original->Identify());
+		ut::BinaryStream schema_stream;
+		{
+			ut::Result<ut::meta::Schema::Lease, ut::Error> lease = schema.Acquire(original, "ptr");
+			if (!lease)
+			{
+				report += ut::String("failed to acquire: ") + lease.GetAlt().GetDesc() + "\n";
+				failed_test_counter.Increment();
+				return false;
+			}
+
+			ut::Optional<ut::Error> save_error = lease.Get()->Save(schema_stream);
+			if (save_error)
+			{
+				report += ut::String("failed to save: ") + save_error->GetDesc() + "\n";
+				failed_test_counter.Increment();
+				return false;
+			}
+		}
+
+		ut::BinaryStream capture_stream;
+		ut::meta::Snapshot::Capture(original, "ptr").Save(capture_stream);
+		if (!CompareStreams(schema_stream, capture_stream))
+		{
+			report += "failed: data doesn't match the captured snapshot.\n";
+			failed_test_counter.Increment();
+			return false;
+		}
+
+		// loaded pointer is reset, so the dynamic type is taken from the data
+		schema_stream.MoveCursor(0);
+		ut::UniquePtr<TestBase> loaded;
+		ut::Optional<ut::Error> load_error = ut::meta::Snapshot::Capture(loaded, "ptr").Load(schema_stream);
+		if (load_error)
+		{
+			report += ut::String("failed to load: ") + load_error->GetDesc() + "\n";
+			failed_test_counter.Increment();
+			return false;
+		}
+
+		const PolymorphicA* loaded_a = loaded ? dynamic_cast<const PolymorphicA*>(loaded.Get()) : nullptr;
+		if (loaded_a == nullptr ||
+		    loaded_a->ival != i ||
+		    loaded_a->uval != static_cast<ut::uint32>(10 + i) ||
+		    loaded_a->fval != original->fval)
+		{
+			report += "failed: loaded object doesn't match the original.\n";
+			failed_test_counter.Increment();
+			return false;
+		}
+	}
+
+	// schema of another dynamic type must not accept this object
+	ut::UniquePtr<TestBase> other = ut::MakeUnique<PolymorphicB>("b", 1);
+	ut::meta::Schema& schema_a = ut::meta::Schema::Get<TestBase>(ut::Identify<PolymorphicA>());
+	if (schema_a.Acquire(other))
+	{
+		report += "failed: schema accepted an object of another type.\n";
+		failed_test_counter.Increment();
+		return false;
+	}
+
+	report += "success.\n";
+	return true;
+}
+
+bool SchemaTask::TestPerformance()
+{
+	report += "performance: ";
+
+	const size_t iterations = 20000;
+	SerializationSubClass object;
+	object.str = "performance";
+	object.iarr.Add(1);
+
+	ut::BinaryStream stream;
+	ut::time::Counter counter;
+	counter.Start();
+	for (size_t i = 0; i < iterations; i++)
+	{
+		stream.MoveCursor(0);
+		ut::meta::Snapshot::Capture(object, "sub").Save(stream);
+	}
+	const double capture_time = counter.GetTime();
+
+	ut::meta::Schema& schema = ut::meta::Schema::Get<SerializationSubClass>();
+	counter.Start();
+	for (size_t i = 0; i < iterations; i++)
+	{
+		stream.MoveCursor(0);
+		ut::Result<ut::meta::Schema::Lease, ut::Error> lease = schema.Acquire(object, "sub");
+		if (!lease || lease.Get()->Save(stream))
+		{
+			report += "failed to save.\n";
+			failed_test_counter.Increment();
+			return false;
+		}
+	}
+	const double schema_time = counter.GetTime();
+
+	report += ut::Print(iterations) + " saves: capture " + ut::Print(capture_time) +
+	          "ms, schema " + ut::Print(schema_time) + "ms.";
+	return true;
+}
+
+//----------------------------------------------------------------------------//
+TypeDictionaryTask::TypeDictionaryTask() : TestTask("Type dictionary")
+{ }
+
+void TypeDictionaryTask::Execute()
+{
+	size_t dictionary_size = 0;
+	size_t names_size = 0;
+	if (!TestVariant(true, dictionary_size) || !TestVariant(false, names_size))
+	{
+		return;
+	}
+
+	// every object refers to the type by index instead of the name
+	if (dictionary_size >= names_size)
+	{
+		report += "failed: type dictionary doesn't reduce the size of the archive.\n";
+		failed_test_counter.Increment();
+	}
+}
+
+bool TypeDictionaryTask::TestVariant(bool dictionary, size_t& out_size)
+{
+	report += dictionary ? "dictionary: " : "names: ";
+
+	const size_t count = 3000;
+	ut::Array< ut::UniquePtr<TestBase> > original;
+	for (size_t i = 0; i < count; i++)
+	{
+		switch (i % 4)
+		{
+			case 0: original.Add(ut::MakeUnique<PolymorphicA>(static_cast<ut::int32>(i), 1)); break;
+			case 1: original.Add(ut::MakeUnique<PolymorphicB>("b", static_cast<ut::uint16>(i))); break;
+			case 2: original.Add(ut::MakeUnique<PolymorphicC>("c")); break;
+			default: original.Add(ut::UniquePtr<TestBase>());
+		}
+	}
+
+	ut::meta::Info info = ut::meta::Info::CreateComplete();
+	info.EnableTypeDictionary(dictionary);
+
+	ut::time::Counter counter;
+	counter.Start();
+	ut::BinaryStream stream;
+	ut::Optional<ut::Error> save_error = ut::meta::Snapshot::Capture(original, "arr", info).Save(stream);
+	if (save_error)
+	{
+		report += ut::String("failed to save: ") + save_error->GetDesc() + "\n";
+		failed_test_counter.Increment();
+		return false;
+	}
+	const double save_time = counter.GetTime();
+
+	counter.Start();
+	stream.MoveCursor(0);
+	ut::Array< ut::UniquePtr<TestBase> > loaded;
+	ut::Optional<ut::Error> load_error = ut::meta::Snapshot::Capture(loaded, "arr").Load(stream);
+	if (load_error)
+	{
+		report += ut::String("failed to load: ") + load_error->GetDesc() + "\n";
+		failed_test_counter.Increment();
+		return false;
+	}
+	const double load_time = counter.GetTime();
+
+	// check dynamic types and values
+	bool match = loaded.Count() == count;
+	for (size_t i = 0; match && i < count; i++)
+	{
+		if (!original[i] || !loaded[i])
+		{
+			match = !original[i] && !loaded[i];
+		}
+		else if (loaded[i]->Identify().GetHandle() != original[i]->Identify().GetHandle())
+		{
+			match = false;
+		}
+		else if (i % 4 == 0)
+		{
+			match = static_cast<PolymorphicA&>(loaded[i].GetRef()).ival == static_cast<ut::int32>(i);
+		}
+	}
+
+	if (!match)
+	{
+		report += "failed: loaded objects don't match the original.\n";
+		failed_test_counter.Increment();
+		return false;
+	}
+
+	out_size = stream.GetBuffer().GetSize();
+	report += ut::String("saved ") + ut::Print(out_size) + " bytes in " + ut::Print(save_time) +
+	          "ms, loaded in " + ut::Print(load_time) + "ms.\n";
+	return true;
+}
+
+//----------------------------------------------------------------------------//
+ParallelSerializationTask::ParallelSerializationTask() : TestTask("Parallel serialization")
+{ }
+
+void ParallelSerializationTask::Execute()
+{
+	// default flags, linkage forces sequential serialization
+	if (!TestVariant(ut::meta::Info::CreateComplete(), "default"))
+	{
+		return;
+	}
+
+	// subtrees are processed simultaneously only without linkage
+	ut::meta::Info info = ut::meta::Info::CreateComplete();
+	info.EnableLinkageInformation(false);
+	if (!TestVariant(info, "names"))
+	{
+		return;
+	}
+
+	info.SetEndianness(ut::endianness::Order::big);
+	if (!TestVariant(info, "big endian"))
+	{
+		return;
+	}
+
+	info.EnableBinaryNames(false);
+	if (!TestVariant(info, "no names"))
+	{
+		return;
+	}
+
+	info.EnableTypeDictionary(false);
+	TestVariant(info, "no dictionary");
+}
+
+bool ParallelSerializationTask::TestVariant(const ut::meta::Info& info, const ut::String& name)
+{
+	report += name + ": ";
+
+	// several large independent subtrees
+	const size_t subtree_count = 8;
+	const size_t element_count = 5000;
+	ut::Array< ut::Array<SerializationSubClass> > original(subtree_count);
+	for (size_t i = 0; i < subtree_count; i++)
+	{
+		original[i].Resize(element_count);
+		for (size_t j = 0; j < element_count; j++)
+		{
+			SerializationSubClass& element = original[i][j];
+			element.u16val = static_cast<ut::uint16>(i + j);
+			element.str = ut::Print(i * element_count + j);
+			element.iarr.Add(static_cast<ut::int32>(j));
+		}
+	}
+
+	// parallel output must be the same as the sequential one
+	ut::ThreadPool<void> pool;
+	ut::time::Counter counter;
+	counter.Start();
+	ut::BinaryStream sequential_stream;
+	ut::Optional<ut::Error> save_error = ut::meta::Snapshot::Capture(original, "arr", info).Save(sequential_stream);
+	const double sequential_save_time = counter.GetTime();
+
+	counter.Start();
+	ut::BinaryStream parallel_stream;
+	if (!save_error)
+	{
+		save_error = ut::meta::Snapshot::Capture(original, "arr", info).Save(parallel_stream, pool);
+	}
+	const double parallel_save_time = counter.GetTime();
+
+	if (save_error)
+	{
+		report += ut::String("failed to save: ") + save_error->GetDesc() + "\n";
+		failed_test_counter.Increment();
+		return false;
+	}
+
+	const ut::Array<ut::byte>& sequential_data = sequential_stream.GetBuffer();
+	const ut::Array<ut::byte>& parallel_data = parallel_stream.GetBuffer();
+	bool identical = sequential_data.GetSize() == parallel_data.GetSize();
+	for (size_t i = 0; identical && i < sequential_data.GetSize(); i++)
+	{
+		identical = sequential_data[i] == parallel_data[i];
+	}
+
+	if (!identical)
+	{
+		report += "failed: parallel output differs from the sequential one.\n";
+		failed_test_counter.Increment();
+		return false;
+	}
+
+	// load in parallel
+	counter.Start();
+	parallel_stream.MoveCursor(0);
+	ut::Array< ut::Array<SerializationSubClass> > loaded;
+	ut::Optional<ut::Error> load_error = ut::meta::Snapshot::Capture(loaded, "arr", info).Load(parallel_stream, pool);
+	const double parallel_load_time = counter.GetTime();
+	if (load_error)
+	{
+		report += ut::String("failed to load: ") + load_error->GetDesc() + "\n";
+		failed_test_counter.Increment();
+		return false;
+	}
+
+	bool match = loaded.Count() == subtree_count;
+	for (size_t i = 0; match && i < subtree_count; i++)
+	{
+		match = loaded[i].Count() == element_count;
+		for (size_t j = 0; match && j < element_count; j++)
+		{
+			const SerializationSubClass& element = loaded[i][j];
+			match = element.u16val == static_cast<ut::uint16>(i + j) &&
+			        element.str == ut::Print(i * element_count + j) &&
+			        element.iarr.Count() == 1 && element.iarr[0] == static_cast<ut::int32>(j);
+		}
+	}
+
+	if (!match)
+	{
+		report += "failed: loaded objects don't match the original.\n";
+		failed_test_counter.Increment();
+		return false;
+	}
+
+	report += ut::String("saved in ") + ut::Print(sequential_save_time) + "ms sequentially, " +
+	          ut::Print(parallel_save_time) + "ms in parallel, loaded in " +
+	          ut::Print(parallel_load_time) + "ms in parallel.\n";
+	return true;
+}
+
+//----------------------------------------------------------------------------//
+LazyLoadingTask::LazyLoadingTask() : TestTask("Lazy loading")
+{ }
+
+void LazyLoadingTask::Execute()
+{
+	ut::meta::Info info = ut::meta::Info::CreateComplete();
+	info.EnableLinkageInformation(false);
+
+	// save the archive to the file
+	const ut::String filename = g_test_dir + "lazy.bin";
+	const size_t record_count = 1000;
+	LazyArchive original;
+	original.header = 7;
+	original.records.Resize(record_count);
+	for (size_t i = 0; i < record_count; i++)
+	{
+		original.records[i].u16val = static_cast<ut::uint16>(i);
+		original.records[i].str = ut::Print(i);
+	}
+	for (ut::uint32 i = 0; i < 1024; i++)
+	{
+		original.blob.values[i] = i * 3;
+	}
+
+	ut::File file;
+	ut::Optional<ut::Error> save_error = file.Open(filename, ut::File::Access::write);
+	if (!save_error)
+	{
+		ut::BufferedOutputStream buffered_file(file);
+		save_error = ut::meta::Snapshot::Capture(original, "archive", info).Save(buffered_file);
+		if (!save_error)
+		{
+			save_error = buffered_file.Flush();
+		}
+	}
+	file.Close();
+
+	if (save_error)
+	{
+		report += ut::String("failed to save: ") + save_error->GetDesc() + "\n";
+		failed_test_counter.Increment();
+		return;
+	}
+
+	// only the root is loaded, leaves are waiting
+	LazyArchive loaded;
+	ut::MappedFile mapped_file;
+	ut::meta::Snapshot snapshot = ut::meta::Snapshot::Capture(loaded, "archive", info);
+	ut::Optional<ut::Error> load_error = mapped_file.Open(filename);
+	if (!load_error)
+	{
+		load_error = snapshot.LoadLazy(mapped_file);
+	}
+
+	if (load_error)
+	{
+		report += ut::String("failed to load: ") + load_error->GetDesc() + "\n";
+		failed_test_counter.Increment();
+		return;
+	}
+
+	if (loaded.header != 0 || loaded.records.Count() != 0)
+	{
+		report += "failed: leaves were loaded before the first access.\n";
+		failed_test_counter.Increment();
+		return;
+	}
+
+	// binary leaf is accessed right in the mapped memory
+	ut::Result<ut::meta::Controller::BinaryView, ut::Error> view = snapshot.MapBinary("blob");
+	if (!view)
+	{
+		report += ut::String("failed to map binary data: ") + view.GetAlt().GetDesc() + "\n";
+		failed_test_counter.Increment();
+		return;
+	}
+
+	const ut::uint32* mapped_values = static_cast<const ut::uint32*>(view.Get().data);
+	bool blob_match = view.Get().size == sizeof(LazyArchive::Blob) && loaded.blob.values[1] == 0;
+	for (ut::uint32 i = 0; blob_match && i < 1024; i++)
+	{
+		blob_match = mapped_values[i] == i * 3;
+	}
+
+	if (!blob_match)
+	{
+		report += "failed: mapped binary data doesn't match the original.\n";
+		failed_test_counter.Increment();
+		return;
+	}
+
+	// leaves are loaded on demand
+	ut::Optional<ut::meta::Snapshot&> records = snapshot.FindChildByName("records");
+	bool records_match = records && loaded.header == 0 && loaded.records.Count() == record_count;
+	for (size_t i = 0; records_match && i < record_count; i++)
+	{
+		records_match = loaded.records[i].u16val == static_cast<ut::uint16>(i) &&
+		                loaded.records[i].str == ut::Print(i);
+	}
+
+	if (!records_match)
+	{
+		report += "failed: lazily loaded records don't match the original.\n";
+		failed_test_counter.Increment();
+		return;
+	}
+
+	if (!snapshot.FindChildByName("header") || loaded.header != 7)
+	{
+		report += "failed: lazily loaded header doesn't match the original.\n";
+		failed_test_counter.Increment();
+		return;
+	}
+
+	mapped_file.Close();
+	ut::RemoveFile(filename);
+	report += "success.\n";
+}
+
+//----------------------------------------------------------------------------//
+DeltaSerializationTask::DeltaSerializationTask() : TestTask("Delta serialization")
+{ }
+
+void DeltaSerializationTask::Execute()
+{
+	const size_t record_count = 1000;
+	LazyArchive original;
+	original.header = 1;
+	original.records.Resize(record_count);
+	for (size_t i = 0; i < record_count; i++)
+	{
+		original.records[i].u16val = static_cast<ut::uint16>(i);
+		original.records[i].str = ut::Print(i);
+		original.records[i].iarr.Add(static_cast<ut::int32>(i));
+	}
+
+	ut::meta::Baseline baseline;
+	LazyArchive loaded;
+	ut::meta::Snapshot source = ut::meta::Snapshot::Capture(original, "archive");
+	ut::meta::Snapshot target = ut::meta::Snapshot::Capture(loaded, "archive");
+
+	// the first delta contains the whole tree
+	size_t full_size;
+	if (!SaveAndApply(source, baseline, target, original, loaded, "full", full_size))
+	{
+		return;
+	}
+
+	// only a few parameters changed
+	size_t delta_size;
+	original.header = 2;
+	original.records[record_count / 2].str = "changed";
+	original.blob.values[7] = 7;
+	if (!SaveAndApply(source, baseline, target, original, loaded, "small change", delta_size))
+	{
+		return;
+	}
+
+	if (delta_size * 10 > full_size)
+	{
+		report += "failed: delta is too big.\n";
+		failed_test_counter.Increment();
+		return;
+	}
+
+	// nothing changed
+	size_t empty_size;
+	if (!SaveAndApply(source, baseline, target, original, loaded, "no change", empty_size))
+	{
+		return;
+	}
+
+	// structure of the array changed, the tree must be captured again
+	original.records.Remove(0);
+	ut::meta::Snapshot recaptured = ut::meta::Snapshot::Capture(original, "archive");
+	size_t structure_size;
+	if (!SaveAndApply(recaptured, baseline, target, original, loaded, "structure change", structure_size))
+	{
+		return;
+	}
+
+	if (TestRemovedLeaf())
+	{
+		report += "\n";
+	}
+}
+
+bool DeltaSerializationTask::TestRemovedLeaf()
+{
+	report += "removed leaf: ";
+
+	ConditionalHolder original;
+	original.value = 3;
+	original.extra = 5;
+	ut::meta::Baseline baseline;
+	ut::BinaryStream full_stream;
+	ut::BinaryStream unchanged_stream;
+	ut::BinaryStream removed_stream;
+	ut::Optional<ut::Error> save_error = ut::meta::Snapshot::Capture(original, "holder").SaveDelta(full_stream, baseline);
+	if (!save_error)
+	{
+		save_error = ut::meta::Snapshot::Capture(original, "holder").SaveDelta(unchanged_stream, baseline);
+	}
+
+	// the body of the node and the remaining leaf stay the same
+	original.has_extra = false;
+	if (!save_error)
+	{
+		save_error = ut::meta::Snapshot::Capture(original, "holder").SaveDelta(removed_stream, baseline);
+	}
+
+	if (save_error)
+	{
+		report += ut::String("failed to save: ") + save_error->GetDesc() + "\n";
+		failed_test_counter.Increment();
+		return false;
+	}
+
+	if (removed_stream.GetBuffer().GetSize() <= unchanged_stream.GetBuffer().GetSize())
+	{
+		report += "failed: removed leaf wasn't detected.\n";
+		failed_test_counter.Increment();
+		return false;
+	}
+
+	// the whole node is in the delta
+	ConditionalHolder loaded;
+	loaded.has_extra = false;
+	removed_stream.MoveCursor(0);
+	ut::Optional<ut::Error> load_error = ut::meta::Snapshot::Capture(loaded, "holder").LoadDelta(removed_stream);
+	if (load_error || loaded.value != original.value)
+	{
+		report += "failed: node with the removed leaf wasn't loaded.\n";
+		failed_test_counter.Increment();
+		return false;
+	}
+
+	report += ut::Print(removed_stream.GetBuffer().GetSize()) + " bytes. ";
+	return true;
+}
+
+bool DeltaSerializationTask::SaveAndApply(ut::meta::Snapshot& source,
+                                          ut::meta::Baseline& baseline,
+                                          ut::meta::Snapshot& target,
+                                          const LazyArchive& original,
+                                          const LazyArchive& loaded,
+                                          const ut::String& name,
+                                          size_t& out_size)
+{
+	report += name + ": ";
+
+	ut::BinaryStream stream;
+	ut::Optional<ut::Error> error = source.SaveDelta(stream, baseline);
+	if (error)
+	{
+		report += ut::String("failed to save: ") + error->GetDesc() + "\n";
+		failed_test_counter.Increment();
+		return false;
+	}
+
+	out_size = stream.GetBuffer().GetSize();
+	stream.MoveCursor(0);
+	error = target.LoadDelta(stream);
+	if (error)
+	{
+		report += ut::String("failed to load: ") + error->GetDesc() + "\n";
+		failed_test_counter.Increment();
+		return false;
+	}
+
+	bool match = loaded.header == original.header &&
+	             loaded.records.Count() == original.records.Count();
+	for (size_t i = 0; match && i < 1024; i++)
+	{
+		match = loaded.blob.values[i] == original.blob.values[i];
+	}
+	for (size_t i = 0; match && i < original.records.Count(); i++)
+	{
+		match = loaded.records[i].u16val == original.records[i].u16val &&
+		        loaded.records[i].str == original.records[i].str &&
+		        loaded.records[i].iarr.Count() == 1 &&
+		        loaded.records[i].iarr[0] == original.records[i].iarr[0];
+	}
+
+	if (!match)
+	{
+		report += "failed: loaded object doesn't match the original.\n";
+		failed_test_counter.Increment();
+		return false;
+	}
+
+	report += ut::Print(out_size) + " bytes. ";
+	return true;
+}
+
+//----------------------------------------------------------------------------//
+SerializationSubClass::SerializationSubClass() : u16val(0), str("void")
+{ }
+
+void SerializationSubClass::Reflect(ut::meta::Snapshot& snapshot)
+{
+	snapshot << u16val;
+	snapshot << iarr;
+	snapshot << str;
+}
+
+//----------------------------------------------------------------------------//
+LazyArchive::LazyArchive() : header(0)
+{
+	ut::memory::Set(&blob, 0, sizeof(Blob));
+}
+
+void LazyArchive::Reflect(ut::meta::Snapshot& snapshot)
+{
+	snapshot.Add(header, "header");
+	snapshot.Add(records, "records");
+	snapshot.Add(ut::meta::BinaryParameter<Blob>(&blob, sizeof(ut::uint32)), "blob");
 }
 
 //----------------------------------------------------------------------------//
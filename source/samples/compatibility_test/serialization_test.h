@@ -38,6 +38,137 @@ private:
 	typedef ut::Pair<ut::String, ut::meta::Info> PairType;
 };
 
+//----------------------------------------------------------------------------//
+class BulkArrayTask : public TestTask
+{
+public:
+	BulkArrayTask();
+	void Execute();
+
+private:
+	bool TestBinary(const ut::meta::Info& info, const ut::String& name);
+	bool TestText(const ut::meta::Info& info, const ut::String& name);
+	bool TestLegacyText();
+	bool TestLegacyBinary();
+};
+
+//----------------------------------------------------------------------------//
+class CorruptedStringTask : public TestTask
+{
+public:
+	CorruptedStringTask();
+	void Execute();
+};
+
+//----------------------------------------------------------------------------//
+class SchemaTask : public TestTask
+{
+public:
+	SchemaTask();
+	void Execute();
+
+private:
+	bool TestStatic();
+	bool TestPointer();
+	bool TestPerformance();
+};
+
+//----------------------------------------------------------------------------//
+class TypeDictionaryTask : public TestTask
+{
+public:
+	TypeDictionaryTask();
+	void Execute();
+
+private:
+	bool TestVariant(bool dictionary, size_t& out_size);
+};
+
+//----------------------------------------------------------------------------//
+class ParallelSerializationTask : public TestTask
+{
+public:
+	ParallelSerializationTask();
+	void Execute();
+
+private:
+	bool TestVariant(const ut::meta::Info& info, const ut::String& name);
+};
+
+//----------------------------------------------------------------------------//
+class LazyLoadingTask : public TestTask
+{
+public:
+	LazyLoadingTask();
+	void Execute();
+};
+
+//----------------------------------------------------------------------------//
+class LazyArchive;
+
+class ConditionalHolder : public ut::meta::Reflective
+{
+public:
+	void Reflect(ut::meta::Snapshot& snapshot)
+	{
+		snapshot.Add(value, "value");
+		if (has_extra)
+		{
+			snapshot.Add(extra, "extra");
+		}
+	}
+
+	ut::uint32 value = 0;
+	ut::uint32 extra = 0;
+	bool has_extra = true;
+};
+
+class DeltaSerializationTask : public TestTask
+{
+public:
+	DeltaSerializationTask();
+	void Execute();
+
+private:
+	bool SaveAndApply(ut::meta::Snapshot& source,
+	                  ut::meta::Baseline& baseline,
+	                  ut::meta::Snapshot& target,
+	                  const LazyArchive& original,
+	                  const LazyArchive& loaded,
+	                  const ut::String& name,
+	                  size_t& out_size);
+	bool TestRemovedLeaf();
+};
+
+//----------------------------------------------------------------------------//
+template<typename T>
+class BulkArrayHolder : public ut::meta::Reflective
+{
+public:
+	void Reflect(ut::meta::Snapshot& snapshot)
+	{
+		snapshot.Add(arr, "arr");
+		snapshot.Add(tail, "tail");
+	}
+
+	ut::Array<T> arr;
+	ut::int32 tail = 0;
+};
+
+//----------------------------------------------------------------------------//
+// Memory stream that doesn't support positioning, like sockets or pipes.
+class SequentialStream : public ut::BinaryStream
+{
+public:
+	ut::Result<ut::stream::Cursor, ut::Error> GetCursor() const;
+	ut::Optional<ut::Error> MoveCursor(ut::stream::Cursor offset,
+	                                   ut::stream::Position origin = ut::stream::Position::start);
+	ut::Result<size_t, ut::Error> GetSize();
+
+	// Moves the cursor to the beginning of the stream.
+	void Rewind();
+};
+
 //----------------------------------------------------------------------------//
 class SerializationSubClass : public ut::meta::Reflective
 {
@@ -51,6 +182,24 @@ public:
 	ut::Array<ut::int32> iarr;
 };
 
+//----------------------------------------------------------------------------//
+class LazyArchive : public ut::meta::Reflective
+{
+public:
+	struct Blob
+	{
+		ut::uint32 values[1024];
+	};
+
+	LazyArchive();
+
+	void Reflect(ut::meta::Snapshot& snapshot);
+
+	ut::int32 header;
+	ut::Array<SerializationSubClass> records;
+	Blob blob;
+};
+
 //----------------------------------------------------------------------------//
 class TestBase : public ut::meta::Reflective, public ut::Polymorphic
 {
@@ -326,6 +475,9 @@ void ChangeSerializedObject(SerializationTest& object);
 // note that ChangeSerializedObject() must be called before saving an object
 bool CheckSerializedObject(const SerializationTest& object, bool alternate, bool linkage);
 
+// Checks if provided streams have the same content
+bool CompareStreams(const ut::BinaryStream& left, const ut::BinaryStream& right);
+
 //----------------------------------------------------------------------------//
 //----------------------------------------------------------------------------//
 //----------------------------------------------------------------------------//
\ No newline at end of file
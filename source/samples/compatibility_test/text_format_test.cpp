@@ -8,6 +8,11 @@ TextFormatUnit::TextFormatUnit() : TestUnit("TEXT FORMAT")
 {
 	tasks.Add(ut::MakeUnique<XmlTask>());
 	tasks.Add(ut::MakeUnique<JsonTask>());
+	tasks.Add(ut::MakeUnique<XmlReaderTask>());
+	tasks.Add(ut::MakeUnique<ChildIndexTask>());
+	tasks.Add(ut::MakeUnique<ParallelJsonTask>());
+	tasks.Add(ut::MakeUnique<BinaryDocTask>());
+	tasks.Add(ut::MakeUnique<JsonPathTask>());
 }
 
 //----------------------------------------------------------------------------//
@@ -128,7 +133,570 @@ void JsonTask::Execute()
 }
 
 //----------------------------------------------------------------------------//
+//----------------------------------------------------------------------------//
+// Compares two text trees, returns 'true' if they are equal.
+bool CompareTextNodes(const ut::Tree<ut::text::Node>& a, const ut::Tree<ut::text::Node>& b)
+{
+	if (a.data.GetType() != b.data.GetType() ||
+	    a.data.name != b.data.name ||
+	    a.data.is_attribute != b.data.is_attribute ||
+	    static_cast<bool>(a.data.value) != static_cast<bool>(b.data.value) ||
+	    a.CountChildren() != b.CountChildren())
+	{
+		return false;
+	}
+
+	if (a.data.value && a.data.value.Get() != b.data.value.Get())
+	{
+		return false;
+	}
+
+	for (size_t i = 0; i < a.CountChildren(); i++)
+	{
+		if (!CompareTextNodes(a[i], b[i]))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// Incremental xml reader
+XmlReaderTask::XmlReaderTask() : TestTask("XML Reader") {}
+
+void XmlReaderTask::Execute()
+{
+	// reference document
+	ut::XmlDoc doc;
+	ut::Optional<ut::Error> parse_error = doc.Parse(g_xml_file_contents);
+	if (parse_error)
+	{
+		report += "failed to parse reference xml document: \n";
+		report += parse_error->GetDesc();
+		failed_test_counter.Increment();
+		return;
+	}
+
+	// read the same document from the stream using tiny chunks and a small buffer,
+	// so that almost every token spans a chunk boundary
+	ut::String text(g_xml_file_contents);
+	ut::BinaryStream stream;
+	stream.Write(text.GetAddress(), 1, text.Length());
+	stream.MoveCursor(0);
+	ut::XmlReader stream_reader(stream, 7, 256);
+	ut::Array< ut::Tree<ut::text::Node> > stream_nodes;
+	ut::Optional<ut::Error> read_error = ReadTree(stream_reader, stream_nodes);
+	if (read_error)
+	{
+		report += "failed to read xml document from the stream: \n";
+		report += read_error->GetDesc();
+		failed_test_counter.Increment();
+		return;
+	}
+
+	// compare with the reference document
+	bool equal = stream_nodes.Count() == doc.nodes.Count();
+	for (size_t i = 0; equal && i < stream_nodes.Count(); i++)
+	{
+		equal = CompareTextNodes(stream_nodes[i], doc.nodes[i]);
+	}
+	if (!equal)
+	{
+		report += "streamed xml document differs from the reference document.";
+		failed_test_counter.Increment();
+		return;
+	}
+	report += "streamed xml matches the reference. ";
+
+	// stream of unknown size
+	UnsizedStream unsized_stream(text, false);
+	ut::XmlReader unsized_reader(unsized_stream, 64, 256);
+	ut::Array< ut::Tree<ut::text::Node> > unsized_nodes;
+	read_error = ReadTree(unsized_reader, unsized_nodes);
+	equal = !read_error && unsized_nodes.Count() == doc.nodes.Count();
+	for (size_t i = 0; equal && i < unsized_nodes.Count(); i++)
+	{
+		equal = CompareTextNodes(unsized_nodes[i], doc.nodes[i]);
+	}
+	if (!equal)
+	{
+		report += "xml document read from the stream of unknown size differs from the reference document.";
+		failed_test_counter.Increment();
+		return;
+	}
+
+	// read errors must not be taken for the end of the document
+	UnsizedStream broken_stream(text, true);
+	ut::XmlReader broken_reader(broken_stream, 64, 256);
+	ut::Array< ut::Tree<ut::text::Node> > broken_nodes;
+	read_error = ReadTree(broken_reader, broken_nodes);
+	if (!read_error || read_error->GetCode() != ut::error::fail)
+	{
+		report += "read error of the stream wasn't reported.";
+		failed_test_counter.Increment();
+		return;
+	}
+	report += "stream of unknown size is ok. ";
+
+	// push mode: feed 3 bytes at a time
+	const char* push_xml = "\xEF\xBB\xBF<root a=\"1 > 0\"><leaf/><!-- c --><v>x &amp; y</v></root>";
+	ut::XmlReader push_reader(64);
+	const size_t push_length = ut::String(push_xml).Length();
+	size_t fed = 0;
+	ut::uint32 events = 0;
+	ut::String path;
+	while (true)
+	{
+		ut::Result<ut::XmlReader::Event, ut::Error> result = push_reader.Next();
+		if (!result)
+		{
+			if (result.GetAlt().GetCode() != ut::error::empty)
+			{
+				report += "push mode failed: ";
+				report += result.GetAlt().GetDesc();
+				failed_test_counter.Increment();
+				return;
+			}
+
+			const size_t size = ut::Min<size_t>(3, push_length - fed);
+			push_reader.Feed(push_xml + fed, size);
+			fed += size;
+			if (fed == push_length)
+			{
+				push_reader.Finish();
+			}
+			continue;
+		}
+
+		const ut::XmlReader::Event& event = result.Get();
+		if (event.type == ut::XmlReader::Event::Type::end_document)
+		{
+			break;
+		}
+
+		if (event.type == ut::XmlReader::Event::Type::start_element)
+		{
+			path += ut::String("/") + event.node.data.name;
+		}
+		else if (event.type == ut::XmlReader::Event::Type::text)
+		{
+			path += ut::String("=") + event.node.data.value.Get();
+		}
+		events++;
+	}
+
+	if (events != 8 || path != "/root/leaf/v=x & y")
+	{
+		report += ut::String("push mode produced unexpected events: ") + path;
+		failed_test_counter.Increment();
+		return;
+	}
+
+	report += "push mode events are ok.";
+}
+
+//----------------------------------------------------------------------------//
+UnsizedStream::UnsizedStream(const ut::String& in_text,
+                             bool in_broken) : text(in_text)
+                                             , cursor(0)
+                                             , broken(in_broken)
+{}
+
+ut::Optional<ut::Error> UnsizedStream::Read(void* ptr, size_t size, size_t count)
+{
+	const size_t arr_size = size * count;
+	if (cursor + arr_size > text.Length())
+	{
+		return ut::Error(broken ? ut::error::fail : ut::error::out_of_bounds);
+	}
+
+	ut::memory::Copy(ptr, text.GetAddress() + cursor, arr_size);
+	cursor += arr_size;
+	return ut::Optional<ut::Error>();
+}
+
+//----------------------------------------------------------------------------//
+ChildIndexTask::ChildIndexTask() : TestTask("Child name index") {}
+
+void ChildIndexTask::Execute()
+{
+	// the last node duplicates the name of the first one
+	const size_t node_count = 64;
+	ut::Tree<ut::text::Node> root;
+	for (size_t i = 0; i <= node_count; i++)
+	{
+		ut::Tree<ut::text::Node> child;
+		child.data.name.Print("n%u", static_cast<ut::uint32>(i % node_count));
+		root.Add(ut::Move(child));
+	}
+
+	// indexed search must give the same result as the linear one
+	const ut::Tree<ut::text::Node>& const_root = root;
+	for (size_t i = 0; i < node_count; i++)
+	{
+		ut::String name;
+		name.Print("n%u", static_cast<ut::uint32>(i));
+		ut::Optional<const ut::Tree<ut::text::Node>&> indexed = ut::text::FindChild(const_root, name);
+		ut::Optional<ut::Tree<ut::text::Node>&> linear = ut::text::FindChild(root, name);
+		if (!indexed || !linear || &indexed.Get() != &linear.Get())
+		{
+			report += ut::String("indexed search failed for ") + name;
+			failed_test_counter.Increment();
+			return;
+		}
+	}
+
+	if (ut::text::FindChild(const_root, "missing"))
+	{
+		report += "indexed search found a missing node.";
+		failed_test_counter.Increment();
+		return;
+	}
+
+	// the index must notice new nodes and renamed ones
+	ut::Tree<ut::text::Node> extra_node;
+	extra_node.data.name = "extra";
+	root.Add(ut::Move(extra_node));
+	root[1].data.name = "renamed";
+	root.data.child_index.Reset();
+	if (!ut::text::FindChild(const_root, "extra") ||
+	    !ut::text::FindChild(const_root, "renamed") ||
+	    ut::text::FindChild(const_root, "n1"))
+	{
+		report += "index wasn't updated after the tree was changed.";
+		failed_test_counter.Increment();
+		return;
+	}
+
+	report += "success";
+}
+
+//----------------------------------------------------------------------------//
+ParallelJsonTask::ParallelJsonTask() : TestTask("Parallel JSON") {}
+
+void ParallelJsonTask::Execute()
+{
+	// large array of records, every record has a nested array
+	ut::String text("{ \"header\": \"records\", \"records\": [");
+	const ut::uint32 record_count = 1000;
+	for (ut::uint32 i = 0; i < record_count; i++)
+	{
+		ut::String record;
+		record.Print("%s\n{ \"id\": %u, \"name\": \"rec, [%u]\", \"tags\": [%u, \"x\\\"]\"] }",
+		             i == 0 ? "" : ",", i, i, i);
+		text += record;
+	}
+	text += "] }";
+
+	// parse sequentially and in parallel
+	ut::ThreadPool<void> pool(4);
+	ut::JsonDoc sequential_doc, parallel_doc;
+	ut::Optional<ut::Error> sequential_error = sequential_doc.Parse(text);
+	ut::Optional<ut::Error> parallel_error = parallel_doc.Parse(text, pool);
+	if (sequential_error || parallel_error)
+	{
+		report += "failed to parse the document.";
+		failed_test_counter.Increment();
+		return;
+	}
+
+	bool equal = sequential_doc.nodes.Count() == parallel_doc.nodes.Count();
+	for (size_t i = 0; equal && i < sequential_doc.nodes.Count(); i++)
+	{
+		equal = CompareTextNodes(sequential_doc.nodes[i], parallel_doc.nodes[i]);
+	}
+	if (!equal || parallel_doc.nodes[1].CountChildren() != record_count)
+	{
+		report += "parallel result differs from the sequential one.";
+		failed_test_counter.Increment();
+		return;
+	}
+
+	// broken element in the middle must produce the same error
+	ut::String broken(text);
+	const ut::Optional<size_t> broken_position = broken.Find("\"id\": 500");
+	if (!broken_position)
+	{
+		report += "test document is invalid.";
+		failed_test_counter.Increment();
+		return;
+	}
+	broken[broken_position.Get()] = '?';
+	sequential_error = sequential_doc.Parse(broken);
+	parallel_error = parallel_doc.Parse(broken, pool);
+	if (!sequential_error || !parallel_error ||
+	    sequential_error->GetDesc() != parallel_error->GetDesc())
+	{
+		report += "parallel parser reported a different error.";
+		failed_test_counter.Increment();
+		return;
+	}
+
+	report += "success";
+}
+
+//----------------------------------------------------------------------------//
+BinaryDocTask::BinaryDocTask() : TestTask("Binary document") {}
+
+void BinaryDocTask::Execute()
+{
+	// reference documents must survive the round trip
+	ut::XmlDoc xml_doc;
+	ut::JsonDoc json_doc;
+	if (xml_doc.Parse(g_xml_file_contents) || json_doc.Parse(g_json_file_contents))
+	{
+		report += "failed to parse reference documents.";
+		failed_test_counter.Increment();
+		return;
+	}
+
+	if (!RoundTrip(xml_doc, "xml") || !RoundTrip(json_doc, "json"))
+	{
+		return;
+	}
+
+	// generate a large array of records to compare size and speed
+	ut::String text("{ \"records\": [");
+	const ut::uint32 record_count = 5000;
+	for (ut::uint32 i = 0; i < record_count; i++)
+	{
+		ut::String record;
+		record.Print("%s\n\t{ \"id\": %u, \"name\": \"record %u\", \"valid\": %s, \"values\": [%u, %u] }",
+		             i == 0 ? "" : ",", i, i, i % 2 ? "true" : "false", i * 3, i * 7);
+		text += record;
+	}
+	text += "] }";
+
+	ut::JsonDoc large_json;
+	ut::time::Counter counter;
+	counter.Start();
+	ut::Optional<ut::Error> parse_error = large_json.Parse(text);
+	const double json_time = counter.GetTime();
+	if (parse_error)
+	{
+		report += "failed to parse generated json document.";
+		failed_test_counter.Increment();
+		return;
+	}
+
+	ut::BinaryDoc large_binary;
+	large_binary.nodes = large_json.nodes;
+	ut::BinaryStream binary_stream;
+	binary_stream << large_binary;
+	const size_t binary_size = binary_stream.GetSize().Get();
+	binary_stream.MoveCursor(0);
+
+	ut::BinaryDoc parsed_binary;
+	counter.Start();
+	binary_stream >> parsed_binary;
+	const double binary_time = counter.GetTime();
+
+	report += ut::String("json: ") + ut::Print(text.Length()) + " bytes, " + ut::Print(json_time) + "ms; ";
+	report += ut::String("binary: ") + ut::Print(binary_size) + " bytes, " + ut::Print(binary_time) + "ms. ";
+	if (binary_size >= text.Length() || parsed_binary.nodes.Count() != large_json.nodes.Count() ||
+	    !CompareTextNodes(parsed_binary.nodes[0], large_json.nodes[0]))
+	{
+		report += "binary document is invalid.";
+		failed_test_counter.Increment();
+		return;
+	}
+
+	// truncated data must be rejected
+	ut::String truncated(binary_size / 2);
+	binary_stream.MoveCursor(0);
+	binary_stream.Read(truncated.GetAddress(), 1, truncated.Length());
+	if (!parsed_binary.Parse(truncated))
+	{
+		report += "truncated binary document was accepted.";
+		failed_test_counter.Increment();
+		return;
+	}
+
+	report += "success";
+}
+
+// Writes provided document in binary format, reads it back
+// and compares the result with the original document.
+bool BinaryDocTask::RoundTrip(ut::text::Document& source, const ut::String& name)
+{
+	ut::BinaryDoc binary_doc;
+	binary_doc.nodes = source.nodes;
+
+	ut::BinaryStream stream;
+	ut::BinaryDoc read_doc;
+	try
+	{
+		stream << binary_doc;
+		stream.MoveCursor(0);
+		stream >> read_doc;
+	}
+	catch (const ut::Error& error)
+	{
+		report += name + " round trip failed: " + error.GetDesc();
+		failed_test_counter.Increment();
+		return false;
+	}
+
+	bool equal = read_doc.nodes.Count() == source.nodes.Count();
+	for (size_t i = 0; equal && i < source.nodes.Count(); i++)
+	{
+		equal = CompareTextNodes(read_doc.nodes[i], source.nodes[i]);
+	}
+
+	if (!equal)
+	{
+		report += name + " document differs after the binary round trip.";
+		failed_test_counter.Increment();
+		return false;
+	}
+
+	return true;
+}
+
+//----------------------------------------------------------------------------//
+JsonPathTask::JsonPathTask() : TestTask("JSON Pointer") {}
+
+void JsonPathTask::Execute()
+{
+	const char* json = "{ \"skip\": { \"a\": [1, \"}]\\\"\", { \"b\": null }] },"
+	                   "  \"a/b\": { \"m~n\": \"escaped\" },"
+	                   "  \"records\": [ { \"id\": 1, \"name\": \"first\" },"
+	                   "                 { \"id\": 2, \"name\": \"second\" } ] }";
 
+	ut::JsonDoc doc;
+	if (doc.Parse(json))
+	{
+		report += "failed to parse test document.";
+		failed_test_counter.Increment();
+		return;
+	}
+
+	// pointer -> expected values of all matches, separated by ';'
+	const char* queries[][2] =
+	{
+		{ "/records/1/name", "second;" },
+		{ "/records/*/id", "1;2;" },
+		{ "/a~1b/m~0n", "escaped;" },
+		{ "/records/2", "" },
+		{ "/records/18446744073709551617/id", "" },
+		{ "/skip/a/0", "1;" },
+		{ "/missing/x", "" },
+	};
+
+	for (size_t i = 0; i < sizeof(queries) / sizeof(queries[0]); i++)
+	{
+		ut::Result<ut::JsonPath, ut::Error> path = ut::JsonPath::Create(queries[i][0]);
+		if (!path)
+		{
+			report += ut::String("failed to create query ") + queries[i][0];
+			failed_test_counter.Increment();
+			return;
+		}
+
+		// tree mode
+		ut::String tree_values;
+		ut::Array< ut::ConstRef< ut::Tree<ut::text::Node> > > selected = path->Select(doc);
+		for (size_t j = 0; j < selected.Count(); j++)
+		{
+			tree_values += selected[j]->data.value.Get() + ";";
+		}
+
+		// raw text mode
+		ut::String scan_values;
+		ut::Result<ut::Array< ut::Tree<ut::text::Node> >, ut::Error> scanned = path->Scan(json);
+		if (!scanned)
+		{
+			report += ut::String("failed to scan ") + queries[i][0] + ": " + scanned.GetAlt().GetDesc();
+			failed_test_counter.Increment();
+			return;
+		}
+		for (size_t j = 0; j < scanned->Count(); j++)
+		{
+			scan_values += scanned.Get()[j].data.value.Get() + ";";
+		}
+
+		if (tree_values != queries[i][1] || scan_values != queries[i][1])
+		{
+			report += ut::String("unexpected result for ") + queries[i][0] + ": " + tree_values + " / " + scan_values;
+			failed_test_counter.Increment();
+			return;
+		}
+	}
+
+	// scanned object must be the same as the parsed one
+	ut::Result<ut::JsonPath, ut::Error> record_path = ut::JsonPath::Create("/records/0");
+	ut::Result<ut::Array< ut::Tree<ut::text::Node> >, ut::Error> record = record_path->Scan(json);
+	if (!record || record->Count() != 1 ||
+	    !CompareTextNodes(record.Get()[0], record_path->Select(doc)[0].Get()))
+	{
+		report += "scanned object differs from the parsed one.";
+		failed_test_counter.Increment();
+		return;
+	}
+
+	// invalid pointers
+	if (ut::JsonPath::Create("records") || ut::JsonPath::Create("/a~2"))
+	{
+		report += "invalid pointer was accepted.";
+		failed_test_counter.Increment();
+		return;
+	}
+
+	report += "success";
+}
+
+// Builds a tree from the events of the reader.
+ut::Optional<ut::Error> XmlReaderTask::ReadTree(ut::XmlReader& reader,
+                                                ut::Array< ut::Tree<ut::text::Node> >& nodes)
+{
+	ut::Array<ut::Tree<ut::text::Node>*> stack;
+	while (true)
+	{
+		ut::Result<ut::XmlReader::Event, ut::Error> result = reader.Next();
+		if (!result)
+		{
+			return result.MoveAlt();
+		}
+
+		ut::XmlReader::Event event = result.Move();
+		if (event.type == ut::XmlReader::Event::Type::end_document)
+		{
+			return ut::Optional<ut::Error>();
+		}
+
+		if (event.type == ut::XmlReader::Event::Type::end_element)
+		{
+			stack.PopBack();
+			continue;
+		}
+
+		if (event.type == ut::XmlReader::Event::Type::text)
+		{
+			stack.GetLast()->data.value = event.node.data.value;
+			continue;
+		}
+
+		ut::Tree<ut::text::Node>* node;
+		if (stack.Count() == 0)
+		{
+			nodes.Add(ut::Move(event.node));
+			node = &nodes.GetLast();
+		}
+		else
+		{
+			stack.GetLast()->Add(ut::Move(event.node));
+			node = &stack.GetLast()->GetLastChild();
+		}
+
+		if (event.type == ut::XmlReader::Event::Type::start_element)
+		{
+			stack.Add(node);
+		}
+	}
+}
+
+//----------------------------------------------------------------------------//
 const char* g_xml_file_contents =
 	"<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
 	"<!DOCTYPE breakfast_menu>"
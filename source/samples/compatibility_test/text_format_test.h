@@ -29,6 +29,62 @@ public:
 	void Execute();
 };
 
+// Input stream of unknown size serving the provided text, fails with
+// ut::error::out_of_bounds at the end of the text or with ut::error::fail
+// if the stream is broken.
+class UnsizedStream : public ut::InputStream
+{
+public:
+	UnsizedStream(const ut::String& in_text, bool in_broken);
+	ut::Optional<ut::Error> Read(void* ptr, size_t size, size_t count);
+
+private:
+	ut::String text;
+	size_t cursor;
+	bool broken;
+};
+
+class XmlReaderTask : public TestTask
+{
+public:
+	XmlReaderTask();
+	void Execute();
+
+private:
+	ut::Optional<ut::Error> ReadTree(ut::XmlReader& reader, ut::Array< ut::Tree<ut::text::Node> >& nodes);
+};
+
+class ParallelJsonTask : public TestTask
+{
+public:
+	ParallelJsonTask();
+	void Execute();
+};
+
+class BinaryDocTask : public TestTask
+{
+public:
+	BinaryDocTask();
+	void Execute();
+
+private:
+	bool RoundTrip(ut::text::Document& source, const ut::String& name);
+};
+
+class JsonPathTask : public TestTask
+{
+public:
+	JsonPathTask();
+	void Execute();
+};
+
+class ChildIndexTask : public TestTask
+{
+public:
+	ChildIndexTask();
+	void Execute();
+};
+
 //----------------------------------------------------------------------------//
 extern const char* g_xml_file_contents;
 extern const char* g_json_file_contents;
@@ -9,6 +9,18 @@ ThreadTestUnit::ThreadTestUnit() : TestUnit("THREAD")
 	tasks.Add(ut::MakeUnique<ThreadProcTask>());
 	tasks.Add(ut::MakeUnique<ThreadLauncherTask>());
 	tasks.Add(ut::MakeUnique<ThreadPoolTask>());
+	tasks.Add(ut::MakeUnique<ThreadPoolScalingTask>());
+	tasks.Add(ut::MakeUnique<AtomicPoolParkingTask>());
+	tasks.Add(ut::MakeUnique<MpmcQueueTask>());
+	tasks.Add(ut::MakeUnique<ParallelAlgorithmsTask>());
+	tasks.Add(ut::MakeUnique<FutureTask>());
+	tasks.Add(ut::MakeUnique<TaskGraphTask>());
+	tasks.Add(ut::MakeUnique<ThreadAffinityTask>());
+	tasks.Add(ut::MakeUnique<ReaderWriterLockTask>());
+	tasks.Add(ut::MakeUnique<AtomicTask>());
+#if CPP_STANDARD >= 2020
+	tasks.Add(ut::MakeUnique<CoroutineTask>());
+#endif
 }
 
 //----------------------------------------------------------------------------//
@@ -277,6 +289,1016 @@ void ThreadPoolTask::AddReport(const ut::String& str)
 	}
 }
 
+//----------------------------------------------------------------------------//
+// Thread pool scaling
+ThreadPoolScalingTask::ThreadPoolScalingTask() : TestTask("Thread pool scaling")
+{}
+
+void ThreadPoolScalingTask::Execute()
+{
+	const ut::uint32 task_count = 20000;
+	const ut::uint32 task_iterations = 64;
+	const ut::uint32 max_threads = 64;
+
+	// every outer task adds 1, every inner task adds the lowest
+	// bit of the value it calculates
+	ut::uint32 expected_sum = task_count / 2;
+	for (ut::uint32 i = 0; i < task_count / 2; i++)
+	{
+		ut::uint32 value = i;
+		for (ut::uint32 j = 0; j < task_iterations; j++)
+		{
+			value = value * 1664525u + 1013904223u;
+		}
+		expected_sum += value & 1;
+	}
+
+	report += ut::String("Tiny tasks: ") + ut::Print(task_count) + ut::cret;
+	for (ut::uint32 thread_count = 1; thread_count <= max_threads; thread_count *= 2)
+	{
+		ut::ThreadPool<void, ut::pool_sync::Method::cond_var> pool(thread_count);
+		ut::Atomic<ut::uint32> sum;
+
+		ut::time::Counter counter;
+		counter.Start();
+
+		// half of tasks is enqueued from the main thread and
+		// every task of the first half enqueues one more task
+		// from the worker thread with the nested scheduler
+		ut::Scheduler<void> scheduler = pool.CreateScheduler();
+		for (ut::uint32 i = 0; i < task_count / 2; i++)
+		{
+			scheduler.Enqueue(ut::MakeUnique< ut::Task<void()> >([&, i]
+			{
+				ut::Scheduler<void> nested_scheduler = pool.CreateScheduler();
+				nested_scheduler.Enqueue(ut::MakeUnique< ut::Task<void()> >([&, i]
+				{
+					ut::uint32 value = i;
+					for (ut::uint32 j = 0; j < task_iterations; j++)
+					{
+						value = value * 1664525u + 1013904223u;
+					}
+					sum.Add(value & 1);
+				}));
+				nested_scheduler.WaitForCompletion();
+				sum.Increment();
+			}));
+		}
+		scheduler.WaitForCompletion();
+
+		const double time = counter.GetTime();
+		report += ut::String("    ") + ut::Print(thread_count) + " threads: " + ut::Print(time) + "ms." + ut::cret;
+
+		const ut::uint32 result = sum.Read();
+		if (result != expected_sum)
+		{
+			report += ut::String("FAIL: Invalid sum - ") + ut::Print(result);
+			failed_test_counter.Increment();
+			return;
+		}
+	}
+}
+
+//----------------------------------------------------------------------------//
+// Atomic pool parking
+AtomicPoolParkingTask::AtomicPoolParkingTask() : TestTask("Atomic pool parking")
+{}
+
+void AtomicPoolParkingTask::Execute()
+{
+	const ut::uint32 rounds = 4;
+	const ut::uint32 task_count = 64;
+
+	// tiny thresholds make workers and schedulers park almost immediately
+	ut::ThreadPool<void, ut::pool_sync::Method::atomic> pool(4, ut::Backoff::Thresholds(4, 4));
+	ut::Atomic<ut::uint32> counter;
+	for (ut::uint32 round = 0; round < rounds; round++)
+	{
+		// let all workers park
+		ut::this_thread::Sleep(20);
+
+		ut::time::Counter timer;
+		timer.Start();
+
+		// every task sleeps to make the scheduler park too
+		ut::Scheduler<void, ut::DefaultCombiner<void>, ut::pool_sync::Method::atomic> scheduler = pool.CreateScheduler();
+		for (ut::uint32 i = 0; i < task_count; i++)
+		{
+			scheduler.Enqueue(ut::MakeUnique< ut::Task<void()> >([&, i]
+			{
+				ut::this_thread::Sleep(i % 8 == 0 ? 1 : 0);
+				counter.Increment();
+			}));
+		}
+		scheduler.WaitForCompletion();
+
+		report += ut::String("round ") + ut::Print(round) + ": " + ut::Print(timer.GetTime()) + "ms. ";
+	}
+
+	const ut::uint32 result = counter.Read();
+	if (result != rounds * task_count)
+	{
+		report += ut::String("FAIL: Invalid number of processed tasks - ") + ut::Print(result);
+		failed_test_counter.Increment();
+		return;
+	}
+
+	// tasks left in the queue must be processed before the pool is destroyed,
+	// every task also enqueues one more task while workers are stopping
+	ut::Atomic<ut::uint32> stop_counter;
+	{
+		ut::ThreadPool<void, ut::pool_sync::Method::atomic> stopping_pool(2);
+		for (ut::uint32 i = 0; i < task_count; i++)
+		{
+			stopping_pool.Enqueue(ut::MakeUnique< ut::Task<void()> >([&]
+			{
+				ut::this_thread::Sleep(1);
+				stopping_pool.Enqueue(ut::MakeUnique< ut::Task<void()> >([&] { stop_counter.Increment(); }));
+				stop_counter.Increment();
+			}));
+		}
+	}
+
+	if (stop_counter.Read() != task_count * 2)
+	{
+		report += ut::String("FAIL: pool was stopped with unprocessed tasks - ") + ut::Print(stop_counter.Read());
+		failed_test_counter.Increment();
+		return;
+	}
+}
+
+//----------------------------------------------------------------------------//
+// MPMC queue
+MpmcQueueTask::MpmcQueueTask() : TestTask("MPMC queue")
+{}
+
+void MpmcQueueTask::Execute()
+{
+	const ut::uint32 thread_count = 4;
+	const ut::uint32 element_count = 10000;
+
+	// small capacity makes producers meet the full queue
+	ut::MpmcQueue<ut::uint32> queue(64);
+	ut::uint32 element = 1;
+	for (size_t i = 0; i < queue.GetCapacity(); i++)
+	{
+		queue.Push(element);
+	}
+	if (queue.Push(element))
+	{
+		report += "FAIL: full queue accepted an element.";
+		failed_test_counter.Increment();
+		return;
+	}
+	while (queue.Pop());
+	if (!queue.IsEmpty())
+	{
+		report += "FAIL: queue is not empty.";
+		failed_test_counter.Increment();
+		return;
+	}
+
+	ut::Atomic<ut::uint64> sum;
+	ut::Atomic<ut::uint32> popped;
+	ut::Array< ut::UniquePtr<ut::Thread> > threads;
+	for (ut::uint32 i = 0; i < thread_count; i++)
+	{
+		threads.Add(ut::MakeUnique<ut::Thread>([&, i]
+		{
+			for (ut::uint32 j = 0; j < element_count; j++)
+			{
+				ut::uint32 value = i * element_count + j;
+				while (!queue.Push(value))
+				{
+					ut::this_thread::Yield();
+				}
+			}
+		}));
+
+		threads.Add(ut::MakeUnique<ut::Thread>([&]
+		{
+			while (popped.Read() != thread_count * element_count)
+			{
+				ut::Optional<ut::uint32> value = queue.Pop();
+				if (value)
+				{
+					sum.Add(value.Get());
+					popped.Increment();
+				}
+				else
+				{
+					ut::this_thread::Yield();
+				}
+			}
+		}));
+	}
+	threads.Reset();
+
+	const ut::uint64 total = thread_count * element_count;
+	const ut::uint64 expected_sum = total * (total - 1) / 2;
+	if (sum.Read() != expected_sum)
+	{
+		report += ut::String("FAIL: invalid sum - ") + ut::Print(sum.Read());
+		failed_test_counter.Increment();
+		return;
+	}
+
+	report += ut::String("success, ") + ut::Print(popped.Read()) + " elements.";
+}
+
+//----------------------------------------------------------------------------//
+// Parallel algorithms
+ParallelAlgorithmsTask::ParallelAlgorithmsTask() : TestTask("Parallel algorithms")
+{}
+
+void ParallelAlgorithmsTask::Execute()
+{
+	const size_t count = 100000;
+	ut::ThreadPool<void> pool(4);
+
+	// for
+	ut::Array<ut::uint32> values(count);
+	ut::ParallelFor(pool, 0, count, [&](size_t i)
+	{
+		values[i] = static_cast<ut::uint32>(i) * 2654435761u;
+	});
+	for (size_t i = 0; i < count; i++)
+	{
+		if (values[i] != static_cast<ut::uint32>(i) * 2654435761u)
+		{
+			report += ut::String("FAIL: ParallelFor() skipped element ") + ut::Print(i);
+			failed_test_counter.Increment();
+			return;
+		}
+	}
+
+	// reduce
+	const ut::uint64 sum = ut::ParallelReduce(pool, 0, count, ut::uint64(0),
+		[](size_t i) { return static_cast<ut::uint64>(i); },
+		[](ut::uint64 left, ut::uint64 right) { return left + right; });
+	if (sum != static_cast<ut::uint64>(count) * (count - 1) / 2)
+	{
+		report += ut::String("FAIL: ParallelReduce() sum is ") + ut::Print(sum);
+		failed_test_counter.Increment();
+		return;
+	}
+
+	// reduce must keep the order of non-commutative operation
+	const ut::String digits = ut::ParallelReduce(pool, 0, 10, ut::String(),
+		[](size_t i) { return ut::Print(i); },
+		[](const ut::String& left, const ut::String& right) { return left + right; }, 1);
+	if (digits != "0123456789")
+	{
+		report += ut::String("FAIL: ParallelReduce() concatenated ") + digits;
+		failed_test_counter.Increment();
+		return;
+	}
+
+	// scan
+	ut::Array<ut::uint64> ones(count);
+	ut::Array<ut::uint64> prefix;
+	ut::ParallelFor(pool, 0, count, [&](size_t i) { ones[i] = 1; });
+	ut::Optional<ut::Error> scan_error = ut::ParallelScan(pool, ones, prefix, ut::uint64(0),
+		[](ut::uint64 left, ut::uint64 right) { return left + right; });
+	if (scan_error)
+	{
+		report += ut::String("FAIL: ParallelScan() failed: ") + scan_error->GetDesc();
+		failed_test_counter.Increment();
+		return;
+	}
+	for (size_t i = 0; i < count; i++)
+	{
+		if (prefix[i] != i + 1)
+		{
+			report += ut::String("FAIL: ParallelScan() invalid element ") + ut::Print(i);
+			failed_test_counter.Increment();
+			return;
+		}
+	}
+
+	// merge sort, stability is checked by the second
+	// member holding the original position
+	ut::Array< ut::Pair<ut::uint32, ut::uint32> > pairs(count);
+	ut::ParallelFor(pool, 0, count, [&](size_t i)
+	{
+		pairs[i] = ut::Pair<ut::uint32, ut::uint32>(values[i] % 1000, static_cast<ut::uint32>(i));
+	});
+
+	ut::time::Counter timer;
+	timer.Start();
+	ut::ParallelSort(pool, pairs, [](const ut::Pair<ut::uint32, ut::uint32>& left,
+	                                 const ut::Pair<ut::uint32, ut::uint32>& right)
+	{
+		return left.first < right.first;
+	});
+	report += ut::String("merge sort: ") + ut::Print(timer.GetTime()) + "ms. ";
+	for (size_t i = 1; i < count; i++)
+	{
+		if (pairs[i - 1].first > pairs[i].first ||
+		    (pairs[i - 1].first == pairs[i].first && pairs[i - 1].second > pairs[i].second))
+		{
+			report += ut::String("FAIL: ParallelSort() invalid order at ") + ut::Print(i);
+			failed_test_counter.Increment();
+			return;
+		}
+	}
+
+	// radix sort
+	ut::Array<ut::uint32> radix_values(values);
+	timer.Start();
+	ut::ParallelRadixSort(pool, radix_values);
+	report += ut::String("radix sort: ") + ut::Print(timer.GetTime()) + "ms. ";
+
+	ut::ThreadPool<void, ut::pool_sync::Method::atomic> atomic_pool(4);
+	ut::ParallelSort(atomic_pool, values);
+	for (size_t i = 0; i < count; i++)
+	{
+		if (values[i] != radix_values[i] || (i > 0 && values[i - 1] > values[i]))
+		{
+			report += ut::String("FAIL: ParallelRadixSort() invalid order at ") + ut::Print(i);
+			failed_test_counter.Increment();
+			return;
+		}
+	}
+}
+
+//----------------------------------------------------------------------------//
+// Futures
+FutureTask::FutureTask() : TestTask("Futures")
+{}
+
+void FutureTask::Execute()
+{
+	ut::ThreadPool<void> pool(4);
+
+	// pipeline of dependent stages
+	ut::Future<ut::String> pipeline = ut::Async(pool, [] { return 20; })
+		.Then([](const int& value) { return value + 1; })
+		.Then([](const int& value) { return value * 2; })
+		.Then([](const int& value) { return ut::Print(value); });
+	const ut::Result<ut::String, ut::Error>& pipeline_result = pipeline.Wait();
+	if (!pipeline_result || pipeline_result.Get() != "42")
+	{
+		report += "FAIL: invalid result of the pipeline.";
+		failed_test_counter.Increment();
+		return;
+	}
+
+	// void stages
+	ut::Atomic<ut::uint32> counter;
+	ut::Future<void> void_chain = ut::Async(pool, [&] { counter.Increment(); })
+		.Then([&] { counter.Increment(); })
+		.Then([&] { counter.Increment(); });
+	if (!void_chain.Wait() || counter.Read() != 3)
+	{
+		report += "FAIL: invalid result of the void chain.";
+		failed_test_counter.Increment();
+		return;
+	}
+
+	// moved promise, the moved-from object must not break the shared state
+	ut::Promise<int> source_promise(pool);
+	ut::Future<int> moved_future = source_promise.GetFuture();
+	ut::Promise<int> constructed_promise(ut::Move(source_promise));
+	ut::Promise<int> assigned_promise(pool);
+	assigned_promise = ut::Move(constructed_promise);
+	assigned_promise.SetValue(7);
+	if (!moved_future.Wait() || moved_future.Wait().Get() != 7)
+	{
+		report += "FAIL: moved promise failed to set the value.";
+		failed_test_counter.Increment();
+		return;
+	}
+
+	// all
+	const ut::uint32 future_count = 16;
+	ut::Array< ut::Future<ut::uint32> > futures;
+	for (ut::uint32 i = 0; i < future_count; i++)
+	{
+		futures.Add(ut::Async(pool, [i] { ut::this_thread::Sleep(i % 4); return i; }));
+	}
+	ut::Future<ut::uint32> sum = ut::WhenAll(futures).Then([&futures]
+	{
+		ut::uint32 result = 0;
+		for (size_t i = 0; i < futures.Count(); i++)
+		{
+			result += futures[i].Wait().Get();
+		}
+		return result;
+	});
+	if (!sum.Wait() || sum.Wait().Get() != future_count * (future_count - 1) / 2)
+	{
+		report += "FAIL: invalid result of WhenAll().";
+		failed_test_counter.Increment();
+		return;
+	}
+
+	// any
+	ut::Promise<int> never;
+	ut::Array< ut::Future<int> > any_futures;
+	any_futures.Add(never.GetFuture());
+	any_futures.Add(ut::Async(pool, [] { return 7; }));
+	const ut::Result<size_t, ut::Error>& any = ut::WhenAny(any_futures).Wait();
+	if (!any || any.Get() != 1 || any_futures[1].Wait().Get() != 7)
+	{
+		report += "FAIL: invalid result of WhenAny().";
+		failed_test_counter.Increment();
+		return;
+	}
+
+	// error is propagated through the chain without calling continuations
+	bool continuation_called = false;
+	ut::Future<int> failed;
+	{
+		ut::Promise<int> promise(pool);
+		failed = promise.GetFuture().Then([&](const int& value) { continuation_called = true; return value; });
+		promise.SetError(ut::Error(ut::error::not_found));
+	}
+	const ut::Result<int, ut::Error>& failed_result = failed.Wait();
+	if (failed_result || failed_result.GetAlt().GetCode() != ut::error::not_found || continuation_called)
+	{
+		report += "FAIL: error wasn't propagated.";
+		failed_test_counter.Increment();
+		return;
+	}
+
+	// broken promise
+	ut::Future<int> broken;
+	{
+		ut::Promise<int> promise;
+		broken = promise.GetFuture();
+	}
+	if (broken.Wait())
+	{
+		report += "FAIL: broken promise has a value.";
+		failed_test_counter.Increment();
+		return;
+	}
+
+	report += "success";
+}
+
+
+//----------------------------------------------------------------------------//
+TaskGraphTask::TaskGraphTask() : TestTask("Task graph")
+{}
+
+void TaskGraphTask::Execute()
+{
+	// layers of nodes, every node depends on two nodes of the previous layer
+	const size_t layer_count = 6;
+	const size_t layer_size = 8;
+	const size_t node_count = layer_count * layer_size;
+	ut::Array<ut::uint32> start(node_count);
+	ut::Array<ut::uint32> finish(node_count);
+	ut::Atomic<ut::uint32> stamp;
+
+	ut::TaskGraph graph;
+	for (size_t i = 0; i < node_count; i++)
+	{
+		ut::Result<size_t, ut::Error> id = graph.AddNode(ut::MakeUnique< ut::Task<void()> >([&, i]
+		{
+			start[i] = stamp.Increment();
+			ut::this_thread::Sleep(i % 3);
+			finish[i] = stamp.Increment();
+		}));
+		if (!id || id.Get() != i)
+		{
+			report += "FAIL: failed to add a node.";
+			failed_test_counter.Increment();
+			return;
+		}
+	}
+
+	for (size_t layer = 1; layer < layer_count; layer++)
+	{
+		for (size_t j = 0; j < layer_size; j++)
+		{
+			const size_t node = layer * layer_size + j;
+			const size_t previous = (layer - 1) * layer_size;
+			if (graph.AddDependency(previous + j, node) ||
+			    graph.AddDependency(previous + (j + 1) % layer_size, node))
+			{
+				report += "FAIL: failed to add a dependency.";
+				failed_test_counter.Increment();
+				return;
+			}
+		}
+	}
+
+	ut::Optional<ut::Error> build_error = graph.Build();
+	if (build_error)
+	{
+		report += ut::String("FAIL: ") + build_error->GetDesc();
+		failed_test_counter.Increment();
+		return;
+	}
+
+	// the same graph is executed several times in both types of pools
+	ut::ThreadPool<void> pool(4);
+	ut::ThreadPool<void, ut::pool_sync::Method::atomic> atomic_pool(4);
+	for (ut::uint32 run = 0; run < 4; run++)
+	{
+		for (size_t i = 0; i < node_count; i++)
+		{
+			start[i] = 0;
+			finish[i] = 0;
+		}
+
+		ut::Optional<ut::Error> execute_error = run % 2 == 0 ? graph.Execute(pool) : graph.Execute(atomic_pool);
+		if (execute_error)
+		{
+			report += ut::String("FAIL: ") + execute_error->GetDesc();
+			failed_test_counter.Increment();
+			return;
+		}
+
+		for (size_t i = 0; i < node_count; i++)
+		{
+			if (finish[i] == 0)
+			{
+				report += "FAIL: node wasn't executed.";
+				failed_test_counter.Increment();
+				return;
+			}
+
+			if (i < layer_size)
+			{
+				continue;
+			}
+
+			const size_t previous = i - layer_size - i % layer_size;
+			const size_t j = i % layer_size;
+			if (start[i] < finish[previous + j] || start[i] < finish[previous + (j + 1) % layer_size])
+			{
+				report += "FAIL: node was started before its predecessor finished.";
+				failed_test_counter.Increment();
+				return;
+			}
+		}
+	}
+
+	// cycles are rejected
+	ut::TaskGraph cyclic;
+	for (size_t i = 0; i < 3; i++)
+	{
+		cyclic.AddNode(ut::MakeUnique< ut::Task<void()> >([] {}));
+	}
+	cyclic.AddDependency(0, 1);
+	cyclic.AddDependency(1, 2);
+	cyclic.AddDependency(2, 1);
+	if (!cyclic.Execute(pool))
+	{
+		report += "FAIL: graph that wasn't built was executed.";
+		failed_test_counter.Increment();
+		return;
+	}
+
+	if (!cyclic.Build())
+	{
+		report += "FAIL: cycle wasn't detected.";
+		failed_test_counter.Increment();
+		return;
+	}
+
+	if (!cyclic.Execute(atomic_pool))
+	{
+		report += "FAIL: graph with a cycle was executed.";
+		failed_test_counter.Increment();
+		return;
+	}
+
+	report += "success";
+}
+
+
+//----------------------------------------------------------------------------//
+ThreadAffinityTask::ThreadAffinityTask() : TestTask("Thread affinity")
+{}
+
+void ThreadAffinityTask::Execute()
+{
+	// set of processors
+	ut::CpuSet cpu_set;
+	cpu_set.Add(3);
+	cpu_set.Add(70);
+	cpu_set.Add(1);
+	cpu_set.Remove(3);
+	if (cpu_set.Count() != 2 || !cpu_set.Has(70) || cpu_set.Has(3) ||
+	    cpu_set.GetNth(0).Get() != 1 || cpu_set.GetNth(1).Get() != 70 || cpu_set.GetNth(2))
+	{
+		report += "FAIL: invalid set of processors.";
+		failed_test_counter.Increment();
+		return;
+	}
+
+	// process can be restricted to a subset of processors
+	const ut::CpuSet all_cpus = ut::CpuSet::All();
+	const ut::uint32 cpu_count = all_cpus.Count();
+	if (cpu_count == 0 || cpu_count > ut::GetNumberOfProcessors() || !all_cpus.GetNth(cpu_count - 1))
+	{
+		report += "FAIL: invalid set of all processors.";
+		failed_test_counter.Increment();
+		return;
+	}
+
+	// numa
+	ut::Result<ut::CpuSet, ut::Error> node = ut::CpuSet::FromNumaNode(0);
+	if (ut::GetNumberOfNumaNodes() == 0 || !node || node.Get().Count() == 0)
+	{
+		report += "FAIL: failed to get processors of the NUMA node.";
+		failed_test_counter.Increment();
+		return;
+	}
+
+	// thread properties
+	ut::Optional<ut::Error> affinity_error;
+	ut::Optional<ut::Error> name_error;
+	ut::Optional<ut::Error> priority_error;
+	{
+		ut::CpuSet last_cpu;
+		last_cpu.Add(all_cpus.GetNth(cpu_count - 1).Get());
+		ut::Atomic<bool> priority_is_set(false);
+		ut::Thread thread([&]
+		{
+			affinity_error = ut::this_thread::SetAffinity(last_cpu);
+			name_error = ut::this_thread::SetName("ut_affinity_test");
+
+			// the thread must be alive while its priority is changed
+			while (!priority_is_set.Read())
+			{
+				ut::this_thread::Yield();
+			}
+		});
+		priority_error = thread.SetPriority(ut::thread_priority::Level::low);
+		priority_is_set.Store(true);
+	}
+
+	if (affinity_error || name_error || priority_error)
+	{
+		report += "FAIL: failed to set thread properties.";
+		failed_test_counter.Increment();
+		return;
+	}
+
+	// pool with workers pinned one per core
+	ut::WorkerOptions options(ut::pool_affinity::Method::per_core,
+	                          all_cpus,
+	                          "ut_worker",
+	                          ut::thread_priority::Level::low);
+	ut::Atomic<ut::uint32> counter;
+	{
+		ut::ThreadPool<void> pool(cpu_count, options);
+		auto scheduler = pool.CreateScheduler();
+		for (ut::uint32 i = 0; i < 100; i++)
+		{
+			scheduler.Enqueue(ut::MakeUnique< ut::Task<void()> >([&] { counter.Increment(); }));
+		}
+		scheduler.WaitForCompletion();
+	}
+
+	if (counter.Read() != 100)
+	{
+		report += "FAIL: pinned pool failed to execute tasks.";
+		failed_test_counter.Increment();
+		return;
+	}
+
+	report += "success";
+}
+
+//----------------------------------------------------------------------------//
+ReaderWriterLockTask::ReaderWriterLockTask() : TestTask("Sharded RW lock and seqlock")
+{}
+
+// Pair of values that are always modified together.
+struct EqualPair
+{
+	ut::int64 a;
+	ut::int64 b;
+};
+
+void ReaderWriterLockTask::Execute()
+{
+	static const ut::uint32 reader_count = 4;
+	static const ut::int64 write_count = 10000;
+
+	const EqualPair zero = { 0, 0 };
+	ut::SyncRW<EqualPair, ut::ShardedRWLock> rw_pair(zero);
+	ut::SeqLock<EqualPair> seq_pair(zero);
+	ut::Atomic<bool> stop(false);
+	ut::Atomic<ut::uint32> torn_reads(0);
+
+	// readers must never see a half-modified pair
+	ut::Array< ut::UniquePtr<ut::Thread> > readers;
+	for (ut::uint32 i = 0; i < reader_count; i++)
+	{
+		readers.Add(ut::MakeUnique<ut::Thread>([&]
+		{
+			while (!stop.Read())
+			{
+				{
+					ut::ScopeSyncRWLock<EqualPair, ut::ShardedRWLock> lock(rw_pair, ut::RWLock::Access::read);
+					if (lock.Get().a != lock.Get().b)
+					{
+						torn_reads.Increment();
+					}
+				}
+
+				const EqualPair rw_copy = rw_pair.Get();
+				const EqualPair seq_copy = seq_pair.Get();
+				if (rw_copy.a != rw_copy.b || seq_copy.a != seq_copy.b)
+				{
+					torn_reads.Increment();
+				}
+			}
+		}));
+	}
+
+	for (ut::int64 i = 1; i <= write_count; i++)
+	{
+		{
+			ut::ScopeSyncRWLock<EqualPair, ut::ShardedRWLock> lock(rw_pair, ut::RWLock::Access::write);
+			lock.Get().a = i;
+			lock.Get().b = i;
+		}
+
+		EqualPair& pair = seq_pair.Lock();
+		pair.a = i;
+		pair.b = i;
+		seq_pair.Unlock();
+	}
+
+	stop.Store(true);
+	readers.Reset();
+
+	if (torn_reads.Read() != 0)
+	{
+		report += "FAIL: reader observed a partially modified object.";
+		failed_test_counter.Increment();
+		return;
+	}
+
+	if (rw_pair.Get().a != write_count || seq_pair.Get().b != write_count)
+	{
+		report += "FAIL: invalid final value.";
+		failed_test_counter.Increment();
+		return;
+	}
+
+	report += "success";
+}
+
+//----------------------------------------------------------------------------//
+AtomicTask::AtomicTask() : TestTask("Atomics")
+{}
+
+// Pair of 16-bit values for the generic atomic.
+struct ShortPair
+{
+	ut::int16 a;
+	ut::int16 b;
+};
+
+// Pointer with a counter for the double-width atomic.
+struct TaggedPointer
+{
+	void* ptr;
+	ut::uptr tag;
+};
+
+void AtomicTask::Execute()
+{
+	// bitwise operations
+	ut::Atomic<ut::uint32> flags(0);
+	if (flags.FetchOr(3, ut::memory_order::Type::acq_rel) != 0 ||
+	    flags.FetchAnd(~1u, ut::memory_order::Type::release) != 3 ||
+	    flags.Read(ut::memory_order::Type::relaxed) != 2)
+	{
+		report += "FAIL: invalid result of bitwise operation.";
+		failed_test_counter.Increment();
+		return;
+	}
+
+	// pointer arithmetic
+	int elements[4] = { 0, 1, 2, 3 };
+	ut::Atomic<int*> pointer(elements);
+	if (pointer.Add(2) != &elements[2] || pointer.Decrement() != &elements[1] ||
+	    pointer.Exchange(&elements[3], ut::memory_order::Type::acquire) != &elements[1] ||
+	    *pointer.Read() != 3)
+	{
+		report += "FAIL: invalid result of pointer arithmetic.";
+		failed_test_counter.Increment();
+		return;
+	}
+
+	// generic type
+	const ShortPair initial_pair = { 1, 2 };
+	const ShortPair new_pair = { 3, 4 };
+	ut::Atomic<ShortPair> pair(initial_pair);
+	ShortPair expected_pair = new_pair;
+	if (pair.CompareAndSwap(expected_pair, new_pair) || expected_pair.a != 1 ||
+	    !pair.CompareAndSwap(expected_pair, new_pair) || pair.Read().b != 4)
+	{
+		report += "FAIL: invalid result of generic compare-and-swap.";
+		failed_test_counter.Increment();
+		return;
+	}
+
+	// relaxed counters and double-width compare-and-swap from several threads
+	static const ut::uint32 thread_count = 4;
+	static const ut::uint32 iteration_count = 10000;
+	const TaggedPointer initial_tagged = { elements, 0 };
+	ut::Atomic<ut::int64> counter(0);
+	ut::Atomic<TaggedPointer> tagged(initial_tagged);
+	ut::Array< ut::UniquePtr<ut::Thread> > threads;
+	for (ut::uint32 i = 0; i < thread_count; i++)
+	{
+		threads.Add(ut::MakeUnique<ut::Thread>([&]
+		{
+			for (ut::uint32 j = 0; j < iteration_count; j++)
+			{
+				counter.Increment(ut::memory_order::Type::relaxed);
+
+				TaggedPointer current = tagged.Read(ut::memory_order::Type::acquire);
+				TaggedPointer next;
+				do
+				{
+					next.ptr = current.ptr;
+					next.tag = current.tag + 1;
+				} while (!tagged.CompareAndSwap(current, next, ut::memory_order::Type::acq_rel));
+			}
+		}));
+	}
+	threads.Reset();
+
+	if (counter.Read() != thread_count * iteration_count ||
+	    tagged.Read().tag != thread_count * iteration_count ||
+	    tagged.Read().ptr != elements)
+	{
+		report += "FAIL: lost update in concurrent atomic operations.";
+		failed_test_counter.Increment();
+		return;
+	}
+
+	// message passing with release and acquire
+	int message = 0;
+	ut::Atomic<bool> published(false);
+	ut::Thread producer([&]
+	{
+		message = 42;
+		published.Store(true, ut::memory_order::Type::release);
+	});
+	while (!published.Read(ut::memory_order::Type::acquire))
+	{
+		ut::this_thread::Pause();
+	}
+
+	if (message != 42)
+	{
+		report += "FAIL: message is not visible after acquire.";
+		failed_test_counter.Increment();
+		return;
+	}
+
+	report += "success";
+}
+
+//----------------------------------------------------------------------------//
+#if CPP_STANDARD >= 2020
+CoroutineTask::CoroutineTask() : TestTask("Coroutines")
+{}
+
+static ut::Coro<ut::uint32> DoubleCoro(ut::uint32 value)
+{
+	co_return value * 2;
+}
+
+static ut::Coro<ut::uint32> SleepingCoro(ut::net::Reactor& reactor,
+                                         ut::ThreadPool<void>& pool,
+                                         ut::uint32 value)
+{
+	ut::Optional<ut::Error> delay_error = co_await ut::Delay(reactor, pool, 10 + value % 10);
+	if (delay_error)
+	{
+		co_return 0;
+	}
+
+	co_return co_await DoubleCoro(value);
+}
+
+static ut::Coro<ut::uint32> ThrowingCoro(ut::uint32 value)
+{
+	if (value != 0)
+	{
+		throw ut::Error(ut::error::invalid_arg, "Test exception.");
+	}
+	co_return value;
+}
+
+static ut::Coro<ut::uint32> AwaitingThrowingCoro(ut::ThreadPool<void>& pool, ut::uint32 value)
+{
+	co_await ut::Schedule(pool);
+	co_return co_await ThrowingCoro(value);
+}
+
+static ut::Coro<bool> AcceptingCoro(ut::net::Reactor& reactor,
+                                    ut::ThreadPool<void>& pool,
+                                    ut::net::Socket& server)
+{
+	ut::Optional<ut::Error> wait_error = co_await ut::WaitSocket(reactor, pool, server, ut::net::Reactor::Event::read);
+	if (wait_error)
+	{
+		co_return false;
+	}
+
+	ut::Result<ut::UniquePtr<ut::net::Socket>, ut::Error> client = server.Accept();
+	co_return client ? true : false;
+}
+
+void CoroutineTask::Execute()
+{
+	ut::ThreadPool<void> pool(4);
+	ut::net::Reactor reactor;
+
+	// many sleeping coroutines on a few threads
+	const ut::uint32 coro_count = 1000;
+	ut::Array< ut::Future<ut::uint32> > futures;
+	for (ut::uint32 i = 0; i < coro_count; i++)
+	{
+		futures.Add(ut::Spawn(pool, SleepingCoro(reactor, pool, i)));
+	}
+
+	ut::uint32 sum = 0;
+	for (ut::uint32 i = 0; i < coro_count; i++)
+	{
+		const ut::Result<ut::uint32, ut::Error>& result = futures[i].Wait();
+		sum += result ? result.Get() : 0;
+	}
+
+	if (sum != coro_count * (coro_count - 1))
+	{
+		report += "FAIL: invalid sum of coroutine results.";
+		failed_test_counter.Increment();
+		return;
+	}
+
+	// exception is passed through the awaiting coroutine to the future
+	ut::Future<ut::uint32> failed = ut::Spawn(pool, AwaitingThrowingCoro(pool, 1));
+	const ut::Result<ut::uint32, ut::Error>& failed_result = failed.Wait();
+	if (failed_result || failed_result.GetAlt().GetCode() != ut::error::invalid_arg)
+	{
+		report += "FAIL: exception of the coroutine wasn't passed to the future.";
+		failed_test_counter.Increment();
+		return;
+	}
+
+	ut::Future<ut::uint32> succeeded = ut::Spawn(pool, AwaitingThrowingCoro(pool, 0));
+	if (!succeeded.Wait() || succeeded.Wait().Get() != 0)
+	{
+		report += "FAIL: coroutine failed after the exception of another one.";
+		failed_test_counter.Increment();
+		return;
+	}
+
+	// socket readiness
+	try
+	{
+		ut::net::Socket server("127.0.0.1", 50001);
+		ut::Optional<ut::Error> listen_error = server.Bind();
+		if (!listen_error)
+		{
+			listen_error = server.Listen();
+		}
+
+		if (listen_error)
+		{
+			report += ut::String("FAIL: ") + listen_error->GetDesc();
+			failed_test_counter.Increment();
+			return;
+		}
+
+		ut::Future<bool> accepted = ut::Spawn(pool, AcceptingCoro(reactor, pool, server));
+		ut::net::Socket client("127.0.0.1", 50001);
+		ut::Optional<ut::Error> connect_error = client.Connect();
+		if (connect_error || !accepted.Wait() || !accepted.Wait().Get())
+		{
+			report += "FAIL: coroutine failed to accept a connection.";
+			failed_test_counter.Increment();
+			return;
+		}
+	}
+	catch (const ut::Error& error)
+	{
+		report += ut::String("FAIL: ") + error.GetDesc();
+		failed_test_counter.Increment();
+		return;
+	}
+
+	report += "success";
+}
+#endif
+
 //----------------------------------------------------------------------------//
 //----------------------------------------------------------------------------//
 //----------------------------------------------------------------------------//
\ No newline at end of file
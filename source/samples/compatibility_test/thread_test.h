@@ -61,6 +61,88 @@ private:
 	ut::uint32 counter;
 };
 
+//----------------------------------------------------------------------------//
+class ThreadPoolScalingTask : public TestTask
+{
+public:
+	ThreadPoolScalingTask();
+	void Execute();
+};
+
+//----------------------------------------------------------------------------//
+class AtomicPoolParkingTask : public TestTask
+{
+public:
+	AtomicPoolParkingTask();
+	void Execute();
+};
+
+//----------------------------------------------------------------------------//
+class MpmcQueueTask : public TestTask
+{
+public:
+	MpmcQueueTask();
+	void Execute();
+};
+
+//----------------------------------------------------------------------------//
+class ParallelAlgorithmsTask : public TestTask
+{
+public:
+	ParallelAlgorithmsTask();
+	void Execute();
+};
+
+//----------------------------------------------------------------------------//
+class FutureTask : public TestTask
+{
+public:
+	FutureTask();
+	void Execute();
+};
+
+//----------------------------------------------------------------------------//
+class TaskGraphTask : public TestTask
+{
+public:
+	TaskGraphTask();
+	void Execute();
+};
+
+//----------------------------------------------------------------------------//
+class ThreadAffinityTask : public TestTask
+{
+public:
+	ThreadAffinityTask();
+	void Execute();
+};
+
+//----------------------------------------------------------------------------//
+class ReaderWriterLockTask : public TestTask
+{
+public:
+	ReaderWriterLockTask();
+	void Execute();
+};
+
+//----------------------------------------------------------------------------//
+class AtomicTask : public TestTask
+{
+public:
+	AtomicTask();
+	void Execute();
+};
+
+//----------------------------------------------------------------------------//
+#if CPP_STANDARD >= 2020
+class CoroutineTask : public TestTask
+{
+public:
+	CoroutineTask();
+	void Execute();
+};
+#endif
+
 //----------------------------------------------------------------------------//
 //----------------------------------------------------------------------------//
 //----------------------------------------------------------------------------//
\ No newline at end of file
@@ -25,6 +25,24 @@ public:
 	}
 };
 
+// Allocator placing the first element at the address that is a multiple of
+// @alignment bytes, needed for the over-aligned types (alignas() greater than
+// the alignment guaranteed by malloc).
+template<typename ElementType, size_t alignment = alignof(ElementType)>
+class AlignedAllocator
+{
+public:
+	ElementType* Allocate(size_t n)
+	{
+		return static_cast<ElementType*>(ut::memory::AllocateAligned(n * sizeof(ElementType), alignment));
+	}
+
+	void Deallocate(ElementType* addr, size_t)
+	{
+		ut::memory::DeallocateAligned(addr);
+	}
+};
+
 // Default preallocator. A preallocator calculates how many elements must be
 // preallocated (or deallocated) for future uses.
 template<size_t inc_factor, size_t dec_factor>
@@ -0,0 +1,161 @@
+//----------------------------------------------------------------------------//
+//---------------------------------|  U  T  |---------------------------------//
+//----------------------------------------------------------------------------//
+#pragma once
+//----------------------------------------------------------------------------//
+#include "containers/ut_hashmap.h"
+#include "templates/ut_optional.h"
+#include "text/ut_string.h"
+//----------------------------------------------------------------------------//
+START_NAMESPACE(ut)
+//----------------------------------------------------------------------------//
+// ut::ChildNameIndex is a lazily built hash index of the child nodes of a tree
+// node by name. It is meant to be a member of the tree node (or of the node
+// data), child nodes must have the 'data.name' member of the ut::String type.
+// If several children have the same name - the first one is indexed, so the
+// result is always equal to the result of the linear search. The index is
+// rebuilt automatically if the number of children has changed, and every hit
+// is validated, so a stale index can't return a wrong node. But renaming a child
+// without adding or removing nodes must be followed by ChildNameIndex::Reset().
+// Copying or moving the index produces an empty one - it will be built again
+// on the first search. Note that the index is not thread-safe, even search
+// in the const tree can modify it.
+class ChildNameIndex
+{
+public:
+	// Nodes having less children are searched linearly,
+	// building an index for them makes no sense.
+	static constexpr size_t skMinChildren = 8;
+
+	// Constructor
+	ChildNameIndex() : indexed_count(0), built(false)
+	{}
+
+	// Copy constructor, index is not copied
+	ChildNameIndex(const ChildNameIndex&) : indexed_count(0), built(false)
+	{}
+
+	// Move constructor, index is not moved because
+	// it's cheaper to rebuild it on demand
+	ChildNameIndex(ChildNameIndex&&) noexcept : indexed_count(0), built(false)
+	{}
+
+	// Assignment operator, invalidates the index
+	ChildNameIndex& operator = (const ChildNameIndex&)
+	{
+		Reset();
+		return *this;
+	}
+
+	// Move operator, invalidates the index
+	ChildNameIndex& operator = (ChildNameIndex&&) noexcept
+	{
+		Reset();
+		return *this;
+	}
+
+	// Searches for the child node with the desired name.
+	//    @param parent - reference to the tree node owning this index.
+	//    @param name - name of the child node to search for.
+	//    @return - id of the child node, or nothing if not found.
+	template<typename TreeNodeType>
+	Optional<size_t> Find(const TreeNodeType& parent, const String& name) const
+	{
+		const size_t child_count = parent.CountChildren();
+		if (child_count < skMinChildren)
+		{
+			return FindLinear(parent, name);
+		}
+
+		// build the index if it's absent or stale
+		if (!built || indexed_count != child_count)
+		{
+			Build(parent);
+		}
+
+		// search the index, hit is validated to detect renamed nodes
+		Optional<size_t&> find_result = map.Find(name);
+		if (find_result)
+		{
+			const size_t id = find_result.Get();
+			if (id < child_count && parent[id].data.name == name)
+			{
+				return id;
+			}
+
+			// the index is stale, rebuild it and try again
+			Build(parent);
+			find_result = map.Find(name);
+			if (find_result)
+			{
+				return find_result.Get();
+			}
+		}
+
+		// not found
+		return Optional<size_t>();
+	}
+
+	// Invalidates the index, it will be rebuilt on the next search.
+	void Reset() const
+	{
+		map.Reset();
+		indexed_count = 0;
+		built = false;
+	}
+
+private:
+	// Fills the index with the names of all child nodes.
+	//    @param parent - reference to the tree node owning this index.
+	template<typename TreeNodeType>
+	void Build(const TreeNodeType& parent) const
+	{
+		Reset();
+
+		// ut::SparseHashMap::Insert() doesn't overwrite existing keys,
+		// so only the first node with such name is indexed
+		const size_t child_count = parent.CountChildren();
+		for (size_t i = 0; i < child_count; i++)
+		{
+			map.Insert(parent[i].data.name, i);
+		}
+
+		indexed_count = child_count;
+		built = true;
+	}
+
+	// Searches for the child node with the desired name
+	// without using the index.
+	//    @param parent - reference to the tree node to search in.
+	//    @param name - name of the child node to search for.
+	//    @return - id of the child node, or nothing if not found.
+	template<typename TreeNodeType>
+	static Optional<size_t> FindLinear(const TreeNodeType& parent, const String& name)
+	{
+		const size_t child_count = parent.CountChildren();
+		for (size_t i = 0; i < child_count; i++)
+		{
+			if (parent[i].data.name == name)
+			{
+				return i;
+			}
+		}
+
+		return Optional<size_t>();
+	}
+
+	// name -> child id, sparse variant has constant-time insertion
+	mutable SparseHashMap<String, size_t> map;
+
+	// number of children at the moment the index was built
+	mutable size_t indexed_count;
+
+	// 'true' if the index is built
+	mutable bool built;
+};
+
+//----------------------------------------------------------------------------//
+END_NAMESPACE(ut)
+//----------------------------------------------------------------------------//
+//----------------------------------------------------------------------------//
+//----------------------------------------------------------------------------//
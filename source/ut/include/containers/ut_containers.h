@@ -10,6 +10,7 @@
 #include "containers/ut_tree.h"
 #include "containers/ut_avltree.h"
 #include "containers/ut_hashmap.h"
+#include "containers/ut_child_name_index.h"
 
 //----------------------------------------------------------------------------//
 //----------------------------------------------------------------------------//
@@ -303,7 +303,7 @@ public:
 		{
 			return false;
 		}
-		ResetChildsId();
+		SetLastChildId();
 		return true;
 	}
 
@@ -316,7 +316,7 @@ public:
 		{
 			return false;
 		}
-		ResetChildsId();
+		SetLastChildId();
 		return true;
 	}
 
@@ -555,9 +555,7 @@ protected:
 		}
 
 		// set parent and id of the new node
-		size_t child_id = child_nodes.Count() - 1;
-		child_nodes[child_id].parent = static_cast<NodeType*>(this);
-		child_nodes[child_id].id = child_id;
+		SetLastChildId();
 
 		// success
 		return true;
@@ -639,7 +637,10 @@ protected:
 		return child_nodes.Count() == 0 ? static_cast<NodeType*>(this) : child_nodes.GetLast().GetLastNode();
 	}
 
-	// Re-assigns id and a parent of the every child node
+	// Re-assigns id and a parent of the every child node.
+	// Note that only direct children are processed: every node fixes parent
+	// pointers of its own children when it's constructed, copied or moved, so
+	// the deeper levels are always valid.
 	inline void ResetChildsId()
 	{
 		const size_t size = child_nodes.Count();
@@ -647,10 +648,18 @@ protected:
 		{
 			child_nodes[i].id = i;
 			child_nodes[i].parent = static_cast<NodeType*>(this);
-			child_nodes[i].ResetChildsId();
 		}
 	}
 
+	// Sets parent and id of the last child node. It's enough after adding a
+	// node to the end of the array, because relocated nodes keep both values.
+	inline void SetLastChildId()
+	{
+		const size_t child_id = child_nodes.Count() - 1;
+		child_nodes[child_id].id = child_id;
+		child_nodes[child_id].parent = static_cast<NodeType*>(this);
+	}
+
 	// Calculates child node id from iterator
 	//    @param iterator - iterator to be converted
 	//    @return - id of a child, or nothing if failed
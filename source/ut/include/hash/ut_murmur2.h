@@ -39,7 +39,7 @@ uint32 MurmurHash2(const void* key,
 //    @param seed - 64-bit seed.
 //    @return - 64-bit hash.
 uint64 MurmurHash64A(const void* key,
-                     int len,
+                     size_t len,
                      uint64 seed);
 
 // Same as MurmurHash64A, but for 32-bit platforms.
@@ -11,6 +11,7 @@
 #include "meta/linkage/ut_meta_shared_holder.h"
 #include "meta/linkage/ut_meta_link_task.h"
 #include "meta/linkage/ut_meta_link_cache.h"
+#include "containers/ut_hashmap.h"
 //----------------------------------------------------------------------------//
 START_NAMESPACE(ut)
 START_NAMESPACE(meta)
@@ -44,6 +45,8 @@ public:
 	Optional<Error> AddTask(UniquePtr<LinkTask> task);
 
 	// Executes all tasks. Must be called after all parameters have been cached.
+	// Write tasks leave the stream cursor after the last written id, the caller
+	// restores it once for the whole batch.
 	//    @return - ut::Error if failed.
 	Optional<Error> Execute();
 
@@ -79,7 +82,8 @@ public:
 	// inked with.
 	Array<InputSharedCacheElement> MovePreliminarySharedCache();
 
-	// Writes id using a provided state of meta controller.
+	// Writes id using a provided state of meta controller. Stream cursor is
+	// not restored afterwards, see Linker::Execute().
 	//    @param state - state of the meta controller where the id must be
 	//                   written.
 	//    @param id - id value to be written.
@@ -113,19 +117,30 @@ private:
 	// Cached parameters.
 	Array< UniquePtr<Link> > links;
 
+	// Links indexed by parameter, by address of the managed object and by id.
+	// Only the first link is indexed if several links share the same key,
+	// (for example a structure and its first member have the same address).
+	// ut::SparseHashMap is used because it has constant insertion time.
+	SparseHashMap<const BaseParameter*, Link*> parameter_index;
+	SparseHashMap<const void*, Link*> address_index;
+	SparseHashMap<size_t, Link*> id_index;
+
 	// Tasks.
 	Array< UniquePtr<LinkTask> > tasks;
 
 	// Shared objects to be written in the end of the serialization process.
 	Array<OutputSharedCacheElement> output_shared_cache;
+	SparseHashMap<const void*, size_t> output_shared_index;
 
 	// Shared objects that are ready to be linked with during
 	// deserialization process.
 	Array<InputSharedCacheElement> input_shared_cache;
+	SparseHashMap<size_t, size_t> input_shared_index;
 
 	// Shared objects that were registered during serialization, but they must
 	// be loaded separately to be able to be linked with.
 	Array<InputSharedCacheElement> preliminary_shared_cache;
+	SparseHashMap<size_t, size_t> preliminary_shared_index;
 };
 
 //----------------------------------------------------------------------------//
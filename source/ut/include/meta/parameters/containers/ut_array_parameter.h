@@ -9,8 +9,31 @@
 //----------------------------------------------------------------------------//
 START_NAMESPACE(ut)
 START_NAMESPACE(meta)
+//----------------------------------------------------------------------------//
+// ut::meta::IsBulkSerializable checks if arrays of the provided type can be
+// serialized as a single block instead of a separate node per element. Only
+// arithmetic types of the fixed size qualify ('bool' and 'long double' have
+// compiler-specific size, so they are serialized element by element).
+template<typename T> struct IsBulkSerializable { static constexpr bool value = false; };
+template<> struct IsBulkSerializable<int8> { static constexpr bool value = true; };
+template<> struct IsBulkSerializable<uint8> { static constexpr bool value = true; };
+template<> struct IsBulkSerializable<int16> { static constexpr bool value = true; };
+template<> struct IsBulkSerializable<uint16> { static constexpr bool value = true; };
+template<> struct IsBulkSerializable<int32> { static constexpr bool value = true; };
+template<> struct IsBulkSerializable<uint32> { static constexpr bool value = true; };
+template<> struct IsBulkSerializable<int64> { static constexpr bool value = true; };
+template<> struct IsBulkSerializable<uint64> { static constexpr bool value = true; };
+template<> struct IsBulkSerializable<float> { static constexpr bool value = true; };
+template<> struct IsBulkSerializable<double> { static constexpr bool value = true; };
+
 //----------------------------------------------------------------------------//
 // ut::Parameter<Array> is a template specialization for array types.
+// Arrays of the bulk-serializable elements (see ut::meta::IsBulkSerializable)
+// have no child nodes, all elements are written as a single value: binary data
+// is copied at once, text form is a compact string of values. Thus elements
+// of such arrays can't be referenced by the serialized pointers. Archives
+// that were saved element by element are still loaded correctly, the layout
+// of the output is always chosen by the flags of the controller.
 template<typename T, typename Allocator, typename Preallocator>
 class Parameter< Array<T, Allocator, Preallocator> > : public BaseParameter
 {
@@ -20,6 +43,7 @@ public:
 	// Constructor
 	//    @param p - pointer to the managed array
 	Parameter(ArrayType* p) : BaseParameter(p)
+	                        , element_leaves(false)
 	{ }
 
 	// Returns the name of the managed type
@@ -32,6 +56,19 @@ public:
 	//    @param snapshot - reference to the reflection tree
 	void Reflect(Snapshot& snapshot)
 	{
+		// elements of the bulk array are reflected only to load
+		// an archive saved element by element
+		if (IsBulkSerializable<T>::value)
+		{
+			if (!element_leaves)
+			{
+				return;
+			}
+
+			element_leaves = false;
+			snapshot.data.transient = true;
+		}
+
 		// get array reference from pointer
 		ArrayType& arr = *static_cast<ArrayType*>(ptr);
 
@@ -54,7 +91,7 @@ public:
 		if (controller.GetInfo().HasTypeInformation())
 		{
 			String value_type_name = BaseParameter::DeduceTypeName<T>();
-			Optional<Error> write_value_type_error = controller.WriteAttribute(value_type_name, node_names::skValueType);
+			Optional<Error> write_value_type_error = controller.WriteTypeAttribute(value_type_name, node_names::skValueType);
 			if (write_value_type_error)
 			{
 				return write_value_type_error;
@@ -69,6 +106,12 @@ public:
 			return write_num_error;
 		}
 
+		// write all elements at once
+		if (IsBulkSerializable<T>::value && controller.GetInfo().HasBulkArrays())
+		{
+			return SaveBulk<T>(controller);
+		}
+
 		// success
 		return Optional<Error>();
 	}
@@ -84,7 +127,7 @@ public:
 		// read value typename and compare with current one
 		if (controller.GetInfo().HasTypeInformation())
 		{
-			Result<String, Error> read_type_result = controller.ReadAttribute<String>(node_names::skValueType);
+			Result<String, Error> read_type_result = controller.ReadTypeAttribute(node_names::skValueType);
 			if (!read_type_result)
 			{
 				return read_type_result.MoveAlt();
@@ -106,7 +149,40 @@ public:
 		}
 
 		// resize the array
-		arr.Resize(static_cast<size_t>(read_num_result.Get()));
+		const size_t count = static_cast<size_t>(read_num_result.Get());
+		if (!arr.Resize(count))
+		{
+			return Error(error::out_of_memory);
+		}
+
+		// elements of other types are always separate leaves
+		if (!IsBulkSerializable<T>::value)
+		{
+			return Optional<Error>();
+		}
+
+		// archives saved by the older versions of the library
+		// have a separate child node for every element
+		if (!controller.GetInfo().HasBulkArrays())
+		{
+			element_leaves = true;
+			return Optional<Error>();
+		}
+
+		// read all elements at once
+		Optional<Error> read_error = LoadBulk<T>(controller);
+		if (read_error)
+		{
+			// text data was saved element by element
+			if (read_error.Get().GetCode() == error::not_found &&
+			    controller.GetMode() == Controller::Mode::text_input)
+			{
+				element_leaves = true;
+				return Optional<Error>();
+			}
+
+			return read_error;
+		}
 
 		// success
 		return Optional<Error>();
@@ -157,6 +233,52 @@ public:
 			}
 		}
 	}
+
+private:
+	// SFINAE_IS_BULK and SFINAE_IS_NOT_BULK are temporarily defined here to
+	// make short SFINAE parameter, see ut::meta::Parameter<T> for details.
+#define SFINAE_IS_BULK \
+	typename EnableIf<IsBulkSerializable<ElementType>::value>::Type* = nullptr
+#define SFINAE_IS_NOT_BULK \
+	typename EnableIf<!IsBulkSerializable<ElementType>::value>::Type* = nullptr
+
+	// Writes all elements as a single value.
+	template<typename ElementType>
+	inline Optional<Error> SaveBulk(Controller& controller, SFINAE_IS_BULK) const
+	{
+		const ArrayType& arr = *static_cast<const ArrayType*>(ptr);
+		return controller.WriteArrayValue<T>(arr.GetAddress(), arr.Count());
+	}
+
+	// Elements of this type are never written as a single value.
+	template<typename ElementType>
+	inline Optional<Error> SaveBulk(Controller&, SFINAE_IS_NOT_BULK) const
+	{
+		return Error(error::not_supported);
+	}
+
+	// Reads all elements as a single value, array must be already resized.
+	template<typename ElementType>
+	inline Optional<Error> LoadBulk(Controller& controller, SFINAE_IS_BULK)
+	{
+		ArrayType& arr = *static_cast<ArrayType*>(ptr);
+		return controller.ReadArrayValue<T>(arr.GetAddress(), arr.Count());
+	}
+
+	// Elements of this type are never read as a single value.
+	template<typename ElementType>
+	inline Optional<Error> LoadBulk(Controller&, SFINAE_IS_NOT_BULK)
+	{
+		return Error(error::not_supported);
+	}
+
+	// undef macros here
+#undef SFINAE_IS_BULK
+#undef SFINAE_IS_NOT_BULK
+
+	// 'true' if the next Reflect() call must register elements of the bulk
+	// array, set only by Load() if the archive has a leaf per element
+	bool element_leaves;
 };
 
 //----------------------------------------------------------------------------//
@@ -139,7 +139,7 @@ public:
 		{
 			// value type
 			String type_name = BaseParameter::DeduceTypeName<Value>();
-			Optional<Error> write_type_error = controller.WriteAttribute(type_name, node_names::skValueType);
+			Optional<Error> write_type_error = controller.WriteTypeAttribute(type_name, node_names::skValueType);
 			if (write_type_error)
 			{
 				return write_type_error;
@@ -147,7 +147,7 @@ public:
 
 			// key type
 			type_name = BaseParameter::DeduceTypeName<Key>();
-			write_type_error = controller.WriteAttribute(type_name, node_names::skKeyType);
+			write_type_error = controller.WriteTypeAttribute(type_name, node_names::skKeyType);
 			if (write_type_error)
 			{
 				return write_type_error;
@@ -170,7 +170,7 @@ public:
 		if (controller.GetInfo().HasTypeInformation())
 		{
 			// check value type
-			Result<String, Error> type_result = controller.ReadAttribute<String>(node_names::skValueType);
+			Result<String, Error> type_result = controller.ReadTypeAttribute(node_names::skValueType);
 			if (!type_result)
 			{
 				return type_result.MoveAlt();
@@ -181,7 +181,7 @@ public:
 			}
 
 			// check key type
-			type_result = controller.ReadAttribute<String>(node_names::skKeyType);
+			type_result = controller.ReadTypeAttribute(node_names::skKeyType);
 			if (!type_result)
 			{
 				return type_result.MoveAlt();
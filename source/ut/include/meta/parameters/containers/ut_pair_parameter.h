@@ -47,7 +47,7 @@ public:
 
 			// write key type name for type1
 			String key_type_name = BaseParameter::DeduceTypeName<Type1>();
-			Optional<Error> write_key_type_error = controller.WriteAttribute(key_type_name, node_names::skKeyType);
+			Optional<Error> write_key_type_error = controller.WriteTypeAttribute(key_type_name, node_names::skKeyType);
 			if (write_key_type_error)
 			{
 				return write_key_type_error;
@@ -55,7 +55,7 @@ public:
 
 			// write value type name for type2
 			String value_type_name = BaseParameter::DeduceTypeName<Type2>();
-			Optional<Error> write_value_type_error = controller.WriteAttribute(value_type_name, node_names::skValueType);
+			Optional<Error> write_value_type_error = controller.WriteTypeAttribute(value_type_name, node_names::skValueType);
 			if (write_value_type_error)
 			{
 				return write_value_type_error;
@@ -77,7 +77,7 @@ public:
 			PairType& map = *static_cast<PairType*>(ptr);
 
 			// read key type
-			Result<String, Error> read_type_result = controller.ReadAttribute<String>(node_names::skKeyType);
+			Result<String, Error> read_type_result = controller.ReadTypeAttribute(node_names::skKeyType);
 			if (!read_type_result)
 			{
 				return read_type_result.MoveAlt();
@@ -91,7 +91,7 @@ public:
 			}
 
 			// read value type
-			read_type_result = controller.ReadAttribute<String>(node_names::skValueType);
+			read_type_result = controller.ReadTypeAttribute(node_names::skValueType);
 			if (!read_type_result)
 			{
 				return read_type_result.MoveAlt();
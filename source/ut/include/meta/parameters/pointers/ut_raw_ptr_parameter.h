@@ -35,7 +35,7 @@ public:
 		// write value type name
 		const T* ptr_addr = *static_cast<const T**>(ptr);
 		String value_type_name = ptr_addr ? BaseParameter::DeduceTypeName<T>() : String(Type<void>::Name());
-		Optional<Error> write_error = controller.WriteAttribute(value_type_name, node_names::skValueType);
+		Optional<Error> write_error = controller.WriteTypeAttribute(value_type_name, node_names::skValueType);
 		if (write_error)
 		{
 			return write_error;
@@ -51,7 +51,7 @@ public:
 	Optional<Error> Load(Controller& controller)
 	{
 		// read type name
-		Result<String, Error> read_type_result = controller.ReadAttribute<String>(node_names::skValueType);
+		Result<String, Error> read_type_result = controller.ReadTypeAttribute(node_names::skValueType);
 		if (!read_type_result)
 		{
 			return read_type_result.MoveAlt();
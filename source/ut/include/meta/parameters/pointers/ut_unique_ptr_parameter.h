@@ -49,7 +49,7 @@ public:
 		// write value type name
 		const UniquePtrType& ptr_ref = *static_cast<UniquePtrType*>(ptr);
 		String value_type_name = ptr_ref ? GetTypeNameVariant<T>() : String(Type<void>::Name());
-		return controller.WriteAttribute(value_type_name, node_names::skValueType);
+		return controller.WriteTypeAttribute(value_type_name, node_names::skValueType);
 	}
 
 	// Deserializes managed object.
@@ -57,36 +57,7 @@ public:
 	//    @return - ut::Error if encountered an error
 	Optional<Error> Load(Controller& controller) override
 	{
-		// read type name
-		Result<String, Error> read_type_result = controller.ReadAttribute<String>(node_names::skValueType);
-		if (!read_type_result)
-		{
-			return read_type_result.MoveAlt();
-		}
-
-		// get a reference to the unique pointer object
-		UniquePtrType& ptr_ref = *static_cast<UniquePtrType*>(ptr);
-
-		// check if serialized pointer is not null
-		if (read_type_result.Get() == Type<void>::Name())
-		{
-			ptr_ref.Delete(); // reset current value
-			return Optional<Error>(); // exit, ok
-		}
-
-		// create new instance
-		Result<UniquePtrType, Error> create_result = CreateNewInstanceVariant<T>(read_type_result.Get());
-		if (create_result)
-		{
-			ptr_ref = Move(create_result.Move());
-		}
-		else
-		{
-			return create_result.MoveAlt();
-		}
-
-		// success
-		return Optional<Error>();
+		return LoadVariant<T>(controller);
 	}
 
 	// Returns a set of traits specific for this parameter.
@@ -170,6 +141,79 @@ private:
 		return Function<const FactoryView&()>();
 	}
 
+	// Deserializes managed object of the custom (not derived from
+	// ut::Polymorphic) type, serialized type name must match the static one.
+	//    @param controller - meta controller that helps to read data
+	//    @return - ut::Error if encountered an error
+	template<typename ElementType>
+	inline Optional<Error> LoadVariant(Controller& controller, SFINAE_IS_NOT_POLYMORPHIC)
+	{
+		// read type name
+		Result<String, Error> read_type_result = controller.ReadTypeAttribute(node_names::skValueType);
+		if (!read_type_result)
+		{
+			return read_type_result.MoveAlt();
+		}
+
+		// get a reference to the unique pointer object
+		UniquePtrType& ptr_ref = *static_cast<UniquePtrType*>(ptr);
+
+		// check if serialized pointer is not null
+		if (read_type_result.Get() == Type<void>::Name())
+		{
+			ptr_ref.Delete(); // reset current value
+			return Optional<Error>(); // exit, ok
+		}
+
+		// create new instance
+		Result<UniquePtrType, Error> create_result = CreateNewInstanceVariant<T>(read_type_result.Get());
+		if (create_result)
+		{
+			ptr_ref = Move(create_result.Move());
+		}
+		else
+		{
+			return create_result.MoveAlt();
+		}
+
+		// success
+		return Optional<Error>();
+	}
+
+	// Deserializes managed polymorphic object, dynamic type is resolved
+	// directly from the serialized type attribute (see
+	// Controller::ReadPolymorphicTypeAttribute()).
+	//    @param controller - meta controller that helps to read data
+	//    @return - ut::Error if encountered an error
+	template<typename ElementType>
+	inline Optional<Error> LoadVariant(Controller& controller, SFINAE_IS_POLYMORPHIC)
+	{
+		// read dynamic type
+		Result<Optional<const DynamicType&>, Error> read_type_result =
+			controller.ReadPolymorphicTypeAttribute(GetPolymorphicFactory<T>(), node_names::skValueType);
+		if (!read_type_result)
+		{
+			return read_type_result.MoveAlt();
+		}
+
+		// get a reference to the unique pointer object
+		UniquePtrType& ptr_ref = *static_cast<UniquePtrType*>(ptr);
+
+		// check if serialized pointer is not null
+		const Optional<const DynamicType&>& dyn_type = read_type_result.Get();
+		if (!dyn_type)
+		{
+			ptr_ref.Delete(); // reset current value
+			return Optional<Error>(); // exit, ok
+		}
+
+		// create a new object
+		ptr_ref = UniquePtrType(static_cast<T*>(dyn_type->CreateInstance()));
+
+		// success
+		return Optional<Error>();
+	}
+
 	// If managed object is a custom (not derived from ut::Polymorphic)
 	// element - just check static type and create a new inctance
 	template<typename ElementType>
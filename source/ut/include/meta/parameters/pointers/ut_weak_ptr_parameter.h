@@ -39,7 +39,7 @@ public:
 		// write value type name
 		WeakPtrType& ptr_ref = *static_cast<WeakPtrType*>(ptr);
 		String value_type_name = ptr_ref.IsValid() ? GetTypeNameVariant<T>() : String(Type<void>::Name());
-		const Optional<Error> write_error = controller.WriteAttribute(value_type_name, node_names::skValueType);
+		const Optional<Error> write_error = controller.WriteTypeAttribute(value_type_name, node_names::skValueType);
 		if (write_error)
 		{
 			return write_error;
@@ -62,7 +62,7 @@ public:
 	Optional<Error> Load(Controller& controller)
 	{
 		// read type name
-		Result<String, Error> read_type_result = controller.ReadAttribute<String>(node_names::skValueType);
+		Result<String, Error> read_type_result = controller.ReadTypeAttribute(node_names::skValueType);
 		if (!read_type_result)
 		{
 			return read_type_result.MoveAlt();
@@ -25,6 +25,8 @@ class Controller;
 // two functions: ut::BaseParameter::Save() and ut::BaseParameter::Load().
 class BaseParameter : public Reflective
 {
+	// ut::meta::Schema rebinds cached parameters to another object
+	friend class Schema;
 public:
 	// Set of traits specific for this parameter type.
 	struct Traits
@@ -0,0 +1,62 @@
+//----------------------------------------------------------------------------//
+//---------------------------------|  U  T  |---------------------------------//
+//----------------------------------------------------------------------------//
+#pragma once
+//----------------------------------------------------------------------------//
+#include "common/ut_common.h"
+#include "containers/ut_hashmap.h"
+#include "meta/ut_meta_info.h"
+//----------------------------------------------------------------------------//
+START_NAMESPACE(ut)
+START_NAMESPACE(meta)
+//----------------------------------------------------------------------------//
+// ut::meta::Baseline contains digests of the serialized nodes of the tree as
+// it was at the moment of the last delta save (see ut::meta::Snapshot::SaveDelta()).
+// Nodes with the same digests are not written to the next delta. Digests are
+// valid only for the same serialization info and the same platform, so the
+// baseline lives only in memory.
+class Baseline
+{
+	friend class Snapshot;
+public:
+	// Constructor, creates an empty baseline, the first
+	// delta saved against it contains the whole tree.
+	Baseline();
+
+	// Forgets all digests, the next delta will contain the whole tree.
+	void Reset();
+
+	// Returns the number of nodes in the baseline.
+	size_t Count() const;
+
+private:
+	// Digests of the serialized node.
+	struct Digest
+	{
+		// hash of the parameter body and the number of leaves
+		uint64 body;
+
+		// hash of the uniforms, body and all leaves
+		uint64 subtree;
+	};
+
+	// digests of the nodes by path (names separated by slashes)
+	typedef SparseHashMap<String, Digest> Digests;
+
+	// Seed of all digests.
+	static const uint64 skSeed;
+
+	// digests of the last saved tree
+	Digests digests;
+
+	// format the digests were calculated for
+	Info::Version version;
+	Info::Flag flags;
+};
+
+//----------------------------------------------------------------------------//
+END_NAMESPACE(meta)
+END_NAMESPACE(ut)
+//----------------------------------------------------------------------------//
+//----------------------------------------------------------------------------//
+//----------------------------------------------------------------------------//
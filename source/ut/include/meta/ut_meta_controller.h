@@ -6,11 +6,15 @@
 #include "common/ut_common.h"
 #include "templates/ut_ref.h"
 #include "templates/ut_pair.h"
+#include "containers/ut_hashmap.h"
 #include "text/ut_document.h"
 #include "meta/ut_meta_info.h"
 #include "meta/ut_meta_node.h"
+#include "meta/ut_polymorphic.h"
 #include "meta/linkage/ut_meta_link_cache.h"
 #include "pointers/ut_shared_ptr.h"
+#include "streams/ut_binary_stream.h"
+#include "thread/ut_thread_pool.h"
 //----------------------------------------------------------------------------//
 START_NAMESPACE(ut)
 START_NAMESPACE(meta)
@@ -18,6 +22,7 @@ START_NAMESPACE(meta)
 // Forward declarations.
 class Snapshot;
 class Linker;
+class TypeDictionary;
 
 //----------------------------------------------------------------------------//
 // ut::meta::Controller is a class that helps to serialize/deserialize data.
@@ -61,6 +66,31 @@ public:
 		Optional<stream::Cursor> next;
 	};
 
+	// Read-only view of the serialized binary data that lives right in the
+	// memory of the input stream, see Controller::MapBinaryValue().
+	struct BinaryView
+	{
+		const void* data;
+		SizeType size;
+	};
+
+	// Positions of the node in the binary output stream,
+	// see Controller::SetNodeRecorder().
+	struct NodeRecord
+	{
+		// position of the uniforms (name, type, size, etc.)
+		stream::Cursor start;
+		// position of the parameter body right after the uniforms
+		stream::Cursor body;
+		// position of the leaves, starting with the number of leaves
+		stream::Cursor leaves;
+		// position right after the last leaf
+		stream::Cursor end;
+	};
+
+	// Container of the node records, see Controller::SetNodeRecorder().
+	typedef SparseHashMap<const Snapshot*, NodeRecord> NodeRecorder;
+
 	// Represents a combination of possible ways how a
 	// node can be read/written.
 	struct SerializationOptions
@@ -137,6 +167,46 @@ public:
 	//    @return - error if failed.
 	Optional<Error> SyncWithStream();
 
+	// Enables simultaneous serialization of the sibling subtrees in a binary
+	// mode. Every group of siblings is written to a separate buffer, and then
+	// buffers are stitched together in the original order, so the result is
+	// the same as the sequential one. Deserialization requires size
+	// information (see ut::meta::serialization_flags::kSizeInfo) to find
+	// subtree boundaries. Every group of siblings has its own type dictionary
+	// that is merged into the common one afterwards. Archives with linkage
+	// information are always processed sequentially, it is enabled by
+	// default (see ut::meta::Info::CreateComplete()), so the pool has no
+	// effect unless linkage is disabled. Note that log slots of
+	// the ut::meta::Info object can be called from worker threads.
+	//    @param pool - pointer to the thread pool, or nullptr to disable
+	//                  simultaneous serialization.
+	void SetThreadPool(ThreadPool<void>* pool);
+
+	// Enables lazy loading of the leaves of the root node in a binary mode:
+	// leaves aren't read, only their positions in the stream are remembered,
+	// every leaf is loaded later on the first access (see
+	// ut::meta::Snapshot::FindChildByName()). Lazy loading requires size
+	// information (see ut::meta::serialization_flags::kSizeInfo) and is
+	// impossible for archives with linkage information, such archives
+	// are read completely. Input stream must stay alive until all
+	// leaves are loaded.
+	//    @param status - 'true' to enable lazy loading.
+	void SetLazyLoading(bool status);
+
+	// Reads uniforms of the serialized binary parameter (see
+	// ut::meta::BinaryParameter) at the current position of the input stream
+	// and returns a view of its data without copying (see
+	// ut::InputStream::GetData()). Data isn't converted, thus it can be
+	// mapped only if the archive has native byte order.
+	//    @return - view of the binary data or ut::Error if failed.
+	Result<BinaryView, Error> MapBinaryValue();
+
+	// Makes controller remember stream positions of every node written in a
+	// binary mode, sibling subtrees are always written sequentially then.
+	//    @param node_recorder - pointer to the container of records, or
+	//                           nullptr to stop recording.
+	void SetNodeRecorder(NodeRecorder* node_recorder);
+
 	// Creates a task for linker to write a correct id of the linked
 	// object (that is defined as a pointer) into the value node.
 	//    @param parameter - pointer to the parameter representing a link,
@@ -309,6 +379,31 @@ public:
 		return element;
 	}
 
+	// Writes the name of the type as an attribute. If the archive has a type
+	// dictionary (see ut::meta::serialization_flags::kTypeDictionary) only
+	// the index of the name in this dictionary is written.
+	//    @param type_name - name of the type
+	//    @param attribute_name - name of the attribute
+	//    @return - ut::Error if failed
+	Optional<Error> WriteTypeAttribute(const String& type_name,
+	                                   const String& attribute_name);
+
+	// Reads the name of the type that was written
+	// with Controller::WriteTypeAttribute().
+	//    @param attribute_name - name of the attribute
+	//    @return - name of the type or ut::Error if failed
+	Result<String, Error> ReadTypeAttribute(const String& attribute_name);
+
+	// Reads the name of the polymorphic type that was written with
+	// Controller::WriteTypeAttribute() and searches for the corresponding
+	// dynamic type. Names from the type dictionary are resolved only once.
+	//    @param factory - factory of the base type
+	//    @param attribute_name - name of the attribute
+	//    @return - dynamic type, nothing if the name is the name of the
+	//              'void' type (null pointer), or ut::Error if failed
+	Result<Optional<const DynamicType&>, Error> ReadPolymorphicTypeAttribute(const FactoryView& factory,
+	                                                                         const String& attribute_name);
+
 	// Writes value of the parameter
 	//    @param element - reference to the value to be written
 	//    @return - ut::Error if failed
@@ -362,6 +457,103 @@ public:
 		}
 	}
 
+	// Writes an array of arithmetic values as a single value of the parameter.
+	// Binary form is written at once (endianness is resolved for the whole
+	// block), text form is a compact string of values separated by spaces.
+	//    @param elements - pointer to the first element of the array
+	//    @param count - number of elements
+	//    @return - ut::Error if failed
+	template <typename T>
+	Optional<Error> WriteArrayValue(const T* elements, size_t count)
+	{
+		if (mode == Mode::binary_output)
+		{
+			return count == 0 ? Optional<Error>() : WriteBinary(elements, sizeof(T), count);
+		}
+		else if (mode != Mode::text_output)
+		{
+			return Error(error::fail, "Invalid (non-output) mode.");
+		}
+
+		String compact;
+		for (size_t i = 0; i < count; i++)
+		{
+			if (i != 0)
+			{
+				compact.Append(' ');
+			}
+			compact.Append(Print<T>(elements[i]));
+		}
+
+		return WriteValue<String>(compact);
+	}
+
+	// Reads an array of arithmetic values that was written
+	// with Controller::WriteArrayValue().
+	//    @param elements - pointer to the first element of the array
+	//    @param count - number of elements, the array must be already resized
+	//    @return - ut::Error if failed, error::not_found means that
+	//              the value is absent (text mode only)
+	template <typename T>
+	Optional<Error> ReadArrayValue(T* elements, size_t count)
+	{
+		if (mode == Mode::binary_input)
+		{
+			return count == 0 ? Optional<Error>() : ReadBinary(elements, sizeof(T), count);
+		}
+		else if (mode != Mode::text_input)
+		{
+			return Error(error::fail, "Invalid (non-input) mode.");
+		}
+
+		Result<String, Error> read_result = ReadValue<String>();
+		if (!read_result)
+		{
+			return read_result.MoveAlt();
+		}
+
+		// scan values one by one
+		const String& compact = read_result.Get();
+		const char* cursor = compact.GetAddress();
+		const char* end = cursor + compact.Length();
+		size_t id = 0;
+		for (;;)
+		{
+			while (cursor != end && IsArrayValueSeparator(*cursor))
+			{
+				cursor++;
+			}
+
+			if (cursor == end)
+			{
+				break;
+			}
+
+			const char* token = cursor;
+			while (cursor != end && !IsArrayValueSeparator(*cursor))
+			{
+				cursor++;
+			}
+
+			if (id == count)
+			{
+				return Error(error::out_of_bounds, "Compact array has too many values.");
+			}
+
+			elements[id++] = Scan<T>(String(token, static_cast<size_t>(cursor - token)));
+		}
+
+		// empty value means that there is no compact array at all
+		if (id != count)
+		{
+			return id == 0 ? Error(error::not_found) :
+			                 Error(error::out_of_bounds, "Compact array has too few values.");
+		}
+
+		// success
+		return Optional<Error>();
+	}
+
 	// Searches for a child text node by name
 	//    @param parent_node - reference to the parent text node to search in
 	//    @param node_name - name of the node to search for
@@ -370,24 +562,24 @@ public:
 	Optional< RefContainer< Tree<text::Node> > > FindTextNode(RefContainer< Tree<text::Node> > parent_node,
 	                                                              const String& node_name) const
 	{
-		// search for a desired node
-		for (size_t i = 0; i < parent_node->CountChildren(); i++)
+		// search for a desired node, input (const) trees are
+		// searched using the index, output trees - linearly
+		auto find_result = text::FindChild(parent_node.Get(), node_name);
+		if (!find_result)
 		{
-			// skip if name doesn't match
-			if (node_name != parent_node.Get()[i].data.name)
-			{
-				continue;
-			}
-
-			// success
-			return RefContainer< Tree<text::Node> >(parent_node.Get()[i]);
+			// error - not found a node with such a name
+			return Optional< RefContainer< Tree<text::Node> > >();
 		}
 
-		// error - not found a node with such a name
-		return Optional< RefContainer< Tree<text::Node> > >();
+		// success
+		return RefContainer< Tree<text::Node> >(find_result.Get());
 	}
 
 private:
+	// Shared objects waiting to be deserialized, the key is the id of the object.
+	// Loaded objects stay in the map with an empty holder.
+	typedef SparseHashMap< size_t, SharedPtr<SharedPtrHolderBase> > SharedObjectRegistry;
+
 	// Initializes intermediate modules (such as linker) before reading/writing a node.
 	//    @param node - reference to the node to initialize.
 	//    @return - ut::Error if failed.
@@ -444,6 +636,60 @@ private:
 	//    @return - ut::Error if failed.
 	Optional<Error> ReadChildNodes(Snapshot& node, stream::Cursor start);
 
+	// Returns 'true' if sibling subtrees can be written/read simultaneously.
+	//    @param child_count - number of the sibling subtrees.
+	bool ParallelIsPossible(size_t child_count) const;
+
+	// Serializes leaves of the provided node simultaneously in the thread pool,
+	// see Controller::SetThreadPool().
+	//    @param node - reference to a parent node.
+	//    @return - ut::Error if failed.
+	Optional<Error> WriteChildNodesParallel(Snapshot& node);
+
+	// Deserializes leaves of the provided node simultaneously in the thread
+	// pool, see Controller::SetThreadPool().
+	//    @param node - reference to a parent node.
+	//    @param child_count - number of the serialized leaves.
+	//    @return - 'true' if leaves were read, 'false' if serialized leaves
+	//              don't match the node and must be read sequentially,
+	//              or ut::Error if failed.
+	Result<bool, Error> ReadChildNodesParallel(Snapshot& node, size_t child_count);
+
+	// Remembers stream positions of the serialized leaves instead of reading
+	// them, every leaf is loaded on demand, see Controller::SetLazyLoading().
+	//    @param node - reference to a parent node.
+	//    @param child_count - number of the serialized leaves.
+	//    @return - ut::Error if failed.
+	Optional<Error> IndexChildNodes(Snapshot& node, size_t child_count);
+
+	// Serializes a range of the leaves to the separate buffer.
+	//    @param state - state of the controller to write leaves with.
+	//    @param node - reference to a parent node.
+	//    @param first - id of the first leaf to be written.
+	//    @param count - number of leaves to be written.
+	//    @param buffer - reference to the stream to write leaves to.
+	//    @param error - is set if failed.
+	static void WriteSubtrees(Controller state,
+	                          Snapshot& node,
+	                          size_t first,
+	                          size_t count,
+	                          BinaryStream& buffer,
+	                          Optional<Error>& error);
+
+	// Deserializes a range of the leaves from the separate buffer.
+	//    @param state - state of the controller to read leaves with.
+	//    @param node - reference to a parent node.
+	//    @param first - id of the first leaf to be read.
+	//    @param count - number of leaves to be read.
+	//    @param buffer - reference to the stream to read leaves from.
+	//    @param error - is set if failed.
+	static void ReadSubtrees(Controller state,
+	                         Snapshot& node,
+	                         size_t first,
+	                         size_t count,
+	                         BinaryStream& buffer,
+	                         Optional<Error>& error);
+
 	// Writes a name of the node.
 	//    @param name - name of the node.
 	//    @return - ut::Error if failed.
@@ -540,17 +786,46 @@ private:
 	//    @return - ut::Error if failed.
 	Optional<Error> ReadSharedObjects();
 
+	// Writes all type names registered in the type dictionary and
+	// writes the offset of the dictionary to the archive header.
+	//    @return - ut::Error if failed.
+	Optional<Error> WriteTypeDictionary();
+
+	// Reads the type dictionary from the end of the archive, stream cursor
+	// is moved back to the current position afterwards.
+	//    @return - ut::Error if failed.
+	Optional<Error> ReadTypeDictionary();
+
+	// Registers entries of the dictionary of the separately serialized
+	// subtrees in the current dictionary and replaces serialized indices
+	// with the indices of the current dictionary.
+	//    @param dictionary - dictionary of the subtrees, must track references.
+	//    @param buffer - reference to the stream the subtrees were written to.
+	//    @param offset - position of the buffer in the current stream.
+	//    @return - ut::Error if failed.
+	Optional<Error> MergeTypeDictionary(const TypeDictionary& dictionary,
+	                                    BinaryStream& buffer,
+	                                    stream::Cursor offset);
+
 	// Searches for the shared parameter in the registry using provided name,
 	// then tries to load this parameter.
-	//    @param registry - reference to the array of shared cache elements,
+	//    @param registry - reference to the map of shared objects (by id),
 	//                      that are waiting to be deserialized.
 	//    @param name - name of the serialized shared object.
 	//    @param scope_state - state preceding reading of any shared parameter.
 	//    @return - ut::Error if failed.
-	Optional<Error> LoadSharedObject(Array<InputSharedCacheElement>& registry,
+	Optional<Error> LoadSharedObject(SharedObjectRegistry& registry,
 	                                 const String& name,
 	                                 const Controller& scope_state);
 
+	// Adds provided shared cache elements to the registry of shared objects
+	// waiting to be deserialized. Elements with ids that are already present
+	// in the registry are skipped.
+	//    @param registry - reference to the registry.
+	//    @param elements - array of shared cache elements to be added.
+	static void AddToSharedRegistry(SharedObjectRegistry& registry,
+	                                Array<InputSharedCacheElement> elements);
+
 	// Uses provided id to generate a name of the shared parameter. Calling the
 	// same function to generate names both for serialization and deserialization
 	// you ensure that parameters would be loaded correctly.
@@ -564,6 +839,13 @@ private:
 	// Loads a provided state.
 	void LoadState(const Controller& controller);
 
+	// Returns 'true' if provided character separates values of the compact
+	// array, see Controller::WriteArrayValue().
+	static bool IsArrayValueSeparator(char c)
+	{
+		return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+	}
+
 	// Modifies @info object according to the provided options.
 	// Note that one must restore original @info after reading/writing
 	// a node is done.
@@ -610,7 +892,6 @@ private:
 	}
 
 	// Overloaded function to read ut::String from the binary stream.
-	// Every character is read separately to preserve endianness.
 	//    @str_ptr - pointer to string to be read
 	//    @count - number of strings to be read
 	//    @return - ut::Error if failed
@@ -618,25 +899,13 @@ private:
 	{
 		for (size_t str_id = 0; str_id < count; str_id++)
 		{
-			// get string reference from the pointer
-			String& str = str_ptr[str_id];
-
-			// clear the string
-			str.Reset();
-
-			// read symbol by symbol and exit after
-			// meeting a null-terminator
-			char c;
-			do
+			Optional<Error> read_error = info.HasLengthPrefixedStrings() ?
+			                             ReadLengthPrefixedString(str_ptr[str_id]) :
+			                             ReadNullTerminatedString(str_ptr[str_id]);
+			if (read_error)
 			{
-				Optional<Error> read_error = ReadBinary<char>(&c, 1);
-				if (read_error)
-				{
-					return read_error;
-				}
-
-				str.Append(c);
-			} while (c != '\0');
+				return read_error;
+			}
 		}
 
 		// success
@@ -644,7 +913,6 @@ private:
 	}
 
 	// Overloaded function to write ut::String to the binary stream.
-	// Every character is written separately to preserve endianness.
 	//    @address - pointer to the string to be written
 	//    @count - number of strings to write
 	//    @return - ut::Error if failed
@@ -652,19 +920,12 @@ private:
 	{
 		for (size_t str_id = 0; str_id < count; str_id++)
 		{
-			// get string object and calculate it's length
-			const String& str = str_ptr[str_id];
-			size_t len = str.Length() + 1;
-
-			// write a string character by character
-			const char* start = str.GetAddress();
-			for (size_t char_id = 0; char_id < len; char_id++)
+			Optional<Error> write_error = info.HasLengthPrefixedStrings() ?
+			                              WriteLengthPrefixedString(str_ptr[str_id]) :
+			                              WriteNullTerminatedString(str_ptr[str_id]);
+			if (write_error)
 			{
-				Optional<Error> write_error = WriteBinary<char>(start + char_id, 1);
-				if (write_error)
-				{
-					return write_error;
-				}
+				return write_error;
 			}
 		}
 
@@ -672,6 +933,27 @@ private:
 		return Optional<Error>();
 	}
 
+	// Reads a string prefixed with its length (see
+	// serialization_flags::kLengthPrefixedStrings) at once.
+	//    @str - reference to the string to be read
+	//    @return - ut::Error if failed
+	Optional<Error> ReadLengthPrefixedString(String& str);
+
+	// Writes a string prefixed with its length.
+	//    @str - reference to the string to be written
+	//    @return - ut::Error if failed
+	Optional<Error> WriteLengthPrefixedString(const String& str);
+
+	// Reads a null-terminated string character by character.
+	//    @str - reference to the string to be read
+	//    @return - ut::Error if failed
+	Optional<Error> ReadNullTerminatedString(String& str);
+
+	// Writes a string with a null-terminator.
+	//    @str - reference to the string to be written
+	//    @return - ut::Error if failed
+	Optional<Error> WriteNullTerminatedString(const String& str);
+
 	// Overloaded function to read boolean from the binary stream.
 	// Size of the 'bool' type is compiler-specific, so it's read/written
 	// with a conversion to the 'ut::byte' type.
@@ -727,6 +1009,28 @@ private:
 
 	// Linker helps to read/write links (such as pointers or references).
 	SharedPtr<Linker> linker;
+
+	// Type names used in the binary archive, see
+	// ut::meta::serialization_flags::kTypeDictionary.
+	SharedPtr<TypeDictionary> type_dictionary;
+
+	// Thread pool to serialize sibling subtrees in, see Controller::SetThreadPool().
+	ThreadPool<void>* thread_pool;
+
+	// Maximum number of subtrees that can be serialized simultaneously on
+	// the current level, nested levels share this number.
+	size_t parallel_budget;
+
+	// Indicates that leaves of the next deserialized node must be loaded
+	// on demand, see Controller::SetLazyLoading().
+	bool lazy;
+
+	// Positions of the written nodes, see Controller::SetNodeRecorder().
+	NodeRecorder* recorder;
+
+	// Number of subtrees per thread of the pool, a few subtrees
+	// per thread balance the load if subtrees differ in size.
+	static const size_t skParallelTasksPerThread;
 };
 
 //----------------------------------------------------------------------------//
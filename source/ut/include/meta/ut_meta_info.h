@@ -103,6 +103,37 @@ public:
 	//    @param status - boolean that turns on/off value encapsulation.
 	void EnableValueEncapsulation(bool status);
 
+	// Returns 'true' if binary strings are prefixed with their length.
+	// See ut::meta::serialization_flags::kLengthPrefixedStrings for details.
+	bool HasLengthPrefixedStrings() const;
+
+	// Turns on/off length prefixes of the binary strings, turn it off
+	// to produce data readable by the older versions of the library.
+	// See ut::meta::serialization_flags::kLengthPrefixedStrings for details.
+	//    @param status - boolean that turns on/off length prefixes.
+	void EnableLengthPrefixedStrings(bool status);
+
+	// Returns 'true' if type names are written once per binary archive.
+	// See ut::meta::serialization_flags::kTypeDictionary for details.
+	bool HasTypeDictionary() const;
+
+	// Turns on/off the type dictionary, turn it off to produce
+	// data readable by the older versions of the library.
+	// See ut::meta::serialization_flags::kTypeDictionary for details.
+	//    @param status - boolean that turns on/off the type dictionary.
+	void EnableTypeDictionary(bool status);
+
+	// Returns 'true' if arithmetic arrays are serialized as a single value.
+	// See ut::meta::serialization_flags::kBulkArrays for details.
+	bool HasBulkArrays() const;
+
+	// Turns on/off the bulk layout of arithmetic arrays, the flag is set
+	// automatically by ut::meta::Controller, because arrays are always saved
+	// in bulk, so there is no need to call this function manually.
+	// See ut::meta::serialization_flags::kBulkArrays for details.
+	//    @param status - boolean that turns on/off the bulk layout.
+	void EnableBulkArrays(bool status);
+
 	// Returns current set of binary flags.
 	Flag GetFlags() const;
 
@@ -34,6 +34,14 @@ public:
 
 	// identifier of the parameter
 	uint32 id;
+
+	// 'true' if child nodes can't be changed by loading the parameter, so
+	// they are not reflected once again after loading (see ut::meta::Schema)
+	bool fixed;
+
+	// 'true' if child nodes were reflected only to read the archive of the
+	// older layout, they are reflected once again after loading
+	bool transient;
 };
 
 //----------------------------------------------------------------------------//
@@ -174,7 +174,7 @@ public:
 		if (controller.GetInfo().HasTypeInformation())
 		{
 			String value_type_name = BaseParameter::DeduceTypeName<T>();
-			Optional<Error> write_value_type_error = controller.WriteAttribute(value_type_name, node_names::skValueType);
+			Optional<Error> write_value_type_error = controller.WriteTypeAttribute(value_type_name, node_names::skValueType);
 			if (write_value_type_error)
 			{
 				return write_value_type_error;
@@ -204,7 +204,7 @@ public:
 		// read value typename and compare with current one
 		if (controller.GetInfo().HasTypeInformation())
 		{
-			Result<String, Error> read_type_result = controller.ReadAttribute<String>(node_names::skValueType);
+			Result<String, Error> read_type_result = controller.ReadTypeAttribute(node_names::skValueType);
 			if (!read_type_result)
 			{
 				return read_type_result.MoveAlt();
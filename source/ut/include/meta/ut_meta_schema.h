@@ -0,0 +1,330 @@
+//----------------------------------------------------------------------------//
+//---------------------------------|  U  T  |---------------------------------//
+//----------------------------------------------------------------------------//
+#pragma once
+//----------------------------------------------------------------------------//
+#include "common/ut_common.h"
+#include "meta/ut_meta_snapshot.h"
+#include "meta/ut_polymorphic.h"
+#include "thread/ut_mutex.h"
+//----------------------------------------------------------------------------//
+START_NAMESPACE(ut)
+START_NAMESPACE(meta)
+//----------------------------------------------------------------------------//
+// ut::meta::Schema is a once-per-type cache of the reflection trees. Capturing
+// a snapshot calls Reflect() for every node and allocates parameters, names
+// and child arrays, though the tree of the same type is the same every time.
+// Schema remembers the offset of every node relative to the reflected object
+// (an 'anchor') after the first capture, and then reuses the cached trees for
+// other objects of the same type just by rebinding parameters to the new
+// addresses. Containers and pointers (nodes having container traits) are the
+// only nodes that are reflected on every use, because their children depend
+// on the contents. All other nodes are marked as fixed (see Node::fixed), so
+// loading doesn't reflect them once again too.
+//
+// Schema can be used only for types whose Reflect() function registers the
+// same members for every instance, and all these members (except the content
+// of containers) must lie inside the object. Schema detects types violating
+// the second rule and falls back to capturing a new snapshot every time.
+// The first rule can't be checked, so schema is never used implicitly, every
+// type must opt in (network commands do it with
+// ut::net::Command::HasFixedReflection()).
+//
+// Example:
+//     Schema::Lease lease = Schema::Get<MyType>().Acquire(my_object).Move();
+//     lease->Save(stream);
+class Schema : public NonCopyable
+{
+	// Memory range of the reflected object.
+	struct Anchor
+	{
+		byte* address;
+		size_t size;
+	};
+
+	// maximum number of anchors, see Schema::Acquire()
+	static constexpr size_t skMaxAnchors = 2;
+
+public:
+	// ut::meta::Schema::Lease gives exclusive access to the snapshot bound to
+	// the object, the snapshot is returned to the cache on destruction.
+	class Lease : public NonCopyable
+	{
+		friend class Schema;
+	public:
+		// Move constructor
+		Lease(Lease&& other) noexcept;
+
+		// Move operator
+		Lease& operator = (Lease&& other) noexcept;
+
+		// Destructor, returns the snapshot to the cache.
+		~Lease();
+
+		// Returns a reference to the snapshot bound to the object.
+		Snapshot& Get();
+
+		// Dereference operators
+		Snapshot& operator *();
+		Snapshot* operator ->();
+
+	private:
+		// Constructor, is called only by ut::meta::Schema.
+		//    @param owner - schema the snapshot belongs to, or nullptr
+		//                   if the snapshot must not be cached.
+		//    @param snapshot_ptr - unique pointer to the snapshot.
+		//    @param in_anchors - pointer to the array of anchors.
+		//    @param in_anchor_count - number of anchors.
+		Lease(Schema* owner,
+		      UniquePtr<Snapshot> snapshot_ptr,
+		      const Anchor* in_anchors,
+		      size_t in_anchor_count);
+
+		// schema the snapshot belongs to
+		Schema* schema;
+
+		// the snapshot bound to the object
+		UniquePtr<Snapshot> snapshot;
+
+		// anchors the snapshot is bound to
+		Anchor anchors[skMaxAnchors];
+		size_t anchor_count;
+	};
+
+	// Returns the schema of the provided static type.
+	//    @return - reference to the schema.
+	template<typename T>
+	static Schema& Get()
+	{
+		static Schema schema;
+		return schema;
+	}
+
+	// Returns the schema of the pointer to the polymorphic object of the
+	// provided dynamic type, use it with the Acquire(UniquePtr<T>&) overload.
+	//    @param dynamic_type - dynamic type of the managed object.
+	//    @return - reference to the schema.
+	template<typename T>
+	static Schema& Get(const DynamicType& dynamic_type)
+	{
+		static Mutex mutex;
+		static HashMap<DynamicType::Handle, UniquePtr<Schema> > schemas;
+
+		ScopeLock lock(mutex);
+		const DynamicType::Handle handle = dynamic_type.GetHandle();
+		Optional< UniquePtr<Schema>& > find_result = schemas.Find(handle);
+		if (find_result)
+		{
+			return find_result.Get().GetRef();
+		}
+
+		// schema is kept by the unique pointer, so the
+		// reference stays valid when the map grows
+		UniquePtr<Schema> schema = MakeUnique<Schema>();
+		Schema& ref = schema.GetRef();
+		schemas.Insert(handle, Move(schema));
+		return ref;
+	}
+
+	// Constructor, use Schema::Get() to access the schema of the desired type.
+	Schema();
+
+	// Binds a snapshot to the provided object.
+	//    @param object - reference to the object to be reflected.
+	//    @param name - name of the parameter associated with the @object.
+	//    @param info - serialization info (see Snapshot::Capture()).
+	//    @return - lease of the snapshot or ut::Error if failed.
+	template<typename T>
+	Result<Lease, Error> Acquire(T& object,
+	                             String name = "snapshot",
+	                             Info info = Info::CreateComplete())
+	{
+		// object of the derived type has different reflection
+		Optional<Error> type_error = CheckDynamicType(GetDynamicType<T>(object));
+		if (type_error)
+		{
+			return MakeError(type_error.Move());
+		}
+
+		Anchor anchor = { reinterpret_cast<byte*>(&object), sizeof(T) };
+		return AcquireSnapshot(&anchor, 1, Move(name), Move(info),
+		                       [&]() { return Snapshot::Capture(object, "snapshot"); });
+	}
+
+	// Binds a snapshot to the provided unique pointer. Both the pointer and the
+	// managed object are anchors, so that the object is not reflected again.
+	// The object must be of the dynamic type passed to Schema::Get().
+	//    @param ptr - reference to the unique pointer to be reflected.
+	//    @param name - name of the parameter associated with the @ptr.
+	//    @param info - serialization info (see Snapshot::Capture()).
+	//    @return - lease of the snapshot or ut::Error if failed.
+	template<typename T>
+	Result<Lease, Error> Acquire(UniquePtr<T>& ptr,
+	                             String name = "snapshot",
+	                             Info info = Info::CreateComplete())
+	{
+		static_assert(IsBaseOf<Polymorphic, T>::value, "Pointer schema requires a polymorphic type.");
+		if (!ptr)
+		{
+			return MakeError(error::invalid_arg, "Pointer schema can't reflect a null pointer.");
+		}
+
+		const DynamicType& dynamic_type = ptr->Identify();
+		Optional<Error> type_error = CheckDynamicType(&dynamic_type);
+		if (type_error)
+		{
+			return MakeError(type_error.Move());
+		}
+
+		// the most derived object is the second anchor
+		Anchor anchors[2] = { { reinterpret_cast<byte*>(&ptr), sizeof(UniquePtr<T>) },
+		                      { static_cast<byte*>(dynamic_cast<void*>(ptr.Get())), dynamic_type.GetSize() } };
+		return AcquireSnapshot(anchors, 2, Move(name), Move(info),
+		                       [&]() { return Snapshot::Capture(ptr, "snapshot"); });
+	}
+
+	// Returns 'true' if cached snapshots can be reused,
+	// 'false' if the type violates the rules (see class description).
+	bool IsCacheable() const;
+
+private:
+	// Description of the cached node, nodes are enumerated depth-first.
+	struct Entry
+	{
+		// id of the anchor containing the managed object
+		uint32 anchor;
+
+		// offset of the managed object from the anchor address
+		size_t offset;
+
+		// 'true' if the parameter is not a container, see Node::fixed
+		bool fixed;
+
+		// 'true' if children must be reflected on every use
+		bool reflect;
+
+		// number of children if they are not reflected on every use
+		size_t child_count;
+	};
+
+	// Cache state.
+	enum class State
+	{
+		empty,
+		cacheable,
+		not_cacheable
+	};
+
+	// Returns a cached snapshot bound to the anchors, or captures a new one.
+	//    @param anchors - pointer to the array of anchors.
+	//    @param anchor_count - number of anchors.
+	//    @param name - name of the snapshot.
+	//    @param info - serialization info.
+	//    @param capture - function capturing a new snapshot.
+	//    @return - lease of the snapshot or ut::Error if failed.
+	Result<Lease, Error> AcquireSnapshot(const Anchor* anchors,
+	                                     size_t anchor_count,
+	                                     String name,
+	                                     Info info,
+	                                     const Function<Snapshot()>& capture);
+
+	// Returns the snapshot to the cache if it's still bound to the anchors,
+	// loading can replace objects managed by pointers.
+	//    @param snapshot - unique pointer to the snapshot.
+	//    @param anchors - pointer to the array of anchors.
+	void Release(UniquePtr<Snapshot> snapshot, const Anchor* anchors);
+
+	// Describes every node of the newly captured snapshot.
+	//    @param node - reference to the current node.
+	//    @param anchors - pointer to the array of anchors.
+	//    @param anchor_count - number of anchors.
+	//    @param out - array to receive node descriptions.
+	//    @return - 'true' if the snapshot can be cached.
+	static bool Describe(Snapshot& node,
+	                     const Anchor* anchors,
+	                     size_t anchor_count,
+	                     Array<Entry>& out);
+
+	// Rebinds every node of the cached snapshot to the new anchors.
+	//    @param node - reference to the current node.
+	//    @param anchors - pointer to the array of anchors.
+	//    @param entry_id - reference to the id of the current entry.
+	void Bind(Snapshot& node, const Anchor* anchors, size_t& entry_id) const;
+
+	// Checks that the snapshot is still bound to the anchors and removes
+	// children of the nodes that are reflected on every use.
+	//    @param node - reference to the current node.
+	//    @param anchors - pointer to the array of anchors.
+	//    @param entry_id - reference to the id of the current entry.
+	//    @return - 'true' if the snapshot can be cached.
+	bool Strip(Snapshot& node, const Anchor* anchors, size_t& entry_id) const;
+
+	// Compares provided description with the cached one.
+	//    @param description - description of the snapshot.
+	//    @return - 'true' if descriptions are equal.
+	bool MatchEntries(const Array<Entry>& description) const;
+
+	// Marks nodes of the newly captured snapshot as fixed.
+	//    @param node - reference to the current node.
+	//    @param entry_id - reference to the id of the current entry.
+	void Mark(Snapshot& node, size_t& entry_id) const;
+
+	// Returns the id of the anchor containing provided address.
+	//    @param address - address of the object.
+	//    @param anchors - pointer to the array of anchors.
+	//    @param anchor_count - number of anchors.
+	//    @return - id of the anchor or nothing if not found.
+	static Optional<uint32> FindAnchor(const void* address,
+	                                   const Anchor* anchors,
+	                                   size_t anchor_count);
+
+	// Checks that all objects bound to this schema have the same dynamic type.
+	//    @param dynamic_type - dynamic type of the object, or nullptr if
+	//                          the type is not polymorphic.
+	//    @return - ut::Error if types don't match.
+	Optional<Error> CheckDynamicType(const DynamicType* dynamic_type);
+
+	// Returns the dynamic type of the polymorphic object.
+	template<typename T>
+	static typename EnableIf<IsBaseOf<Polymorphic, T>::value, const DynamicType*>::Type
+		GetDynamicType(const T& object)
+	{
+		return &object.Identify();
+	}
+
+	// Returns nullptr for the non-polymorphic object.
+	template<typename T>
+	static typename EnableIf<!IsBaseOf<Polymorphic, T>::value, const DynamicType*>::Type
+		GetDynamicType(const T&)
+	{
+		return nullptr;
+	}
+
+	// maximum number of the unused snapshots kept in the cache
+	static constexpr size_t skMaxCachedSnapshots = 8;
+
+	// protects all members
+	mutable Mutex mutex;
+
+	// cache state
+	State state;
+
+	// descriptions of the nodes
+	Array<Entry> entries;
+
+	// sizes of the anchors
+	Array<size_t> anchor_sizes;
+
+	// dynamic type of the reflected objects
+	const DynamicType* dynamic_type;
+
+	// unused snapshots
+	Array< UniquePtr<Snapshot> > cache;
+};
+
+//----------------------------------------------------------------------------//
+END_NAMESPACE(meta)
+END_NAMESPACE(ut)
+//----------------------------------------------------------------------------//
+//----------------------------------------------------------------------------//
+//----------------------------------------------------------------------------//
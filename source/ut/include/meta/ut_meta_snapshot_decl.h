@@ -5,12 +5,15 @@
 //----------------------------------------------------------------------------//
 #include "common/ut_common.h"
 #include "containers/ut_tree.h"
+#include "containers/ut_child_name_index.h"
 #include "pointers/ut_shared_ptr.h"
 #include "text/ut_document.h"
 #include "meta/ut_meta_node.h"
 #include "meta/ut_meta_info.h"
+#include "meta/ut_meta_baseline.h"
 #include "meta/parameters/ut_binary_parameter.h"
 #include "templates/ut_function.h"
+#include "thread/ut_thread_pool.h"
 //----------------------------------------------------------------------------//
 START_NAMESPACE(ut)
 START_NAMESPACE(meta)
@@ -21,6 +24,10 @@ START_NAMESPACE(meta)
 // ut::meta::Snapshot::Save() and ut::meta::Snapshot::Load().
 class Snapshot : public BaseTree<Node, Snapshot>
 {
+	// ut::meta::Schema reuses cached snapshots
+	friend class Schema;
+	// ut::meta::Controller loads subtrees in separate threads
+	friend class Controller;
 	typedef BaseTree<Node, Snapshot> Base;
 	typedef SharedPtr<Info, ut::thread_safety::Mode::off> InfoSharedPtr;
 public:
@@ -123,16 +130,84 @@ public:
 	// Renames the snapshot.
 	void Rename(String new_name);
 
-	// Saves full tree to a binary stream.
+	// Removes child nodes of the snapshot.
+	void Reset();
+
+	// Saves full tree to a binary stream. If the stream doesn't support
+	// positioning (socket, pipe, etc.) - the tree is written to the
+	// ut::BufferedOutputStream first and then flushed to the @stream.
+	// Wrap seekable streams (like ut::File) into ut::BufferedOutputStream
+	// manually to avoid a system call for every serialized value.
 	//    @param stream - reference to the output stream to serialize a tree to
 	//    @return - optionally ut::Error if failed
 	Optional<Error> Save(OutputStream& stream);
 
-	// Loads full tree from a binary stream.
+	// Loads full tree from a binary stream. If the stream doesn't support
+	// positioning - it's read via ut::BufferedInputStream.
 	//    @param stream - reference to the input stream to deserialize from
 	//    @return - optionally ut::Error if failed
 	Optional<Error> Load(InputStream& stream);
 
+	// Saves full tree to a binary stream, sibling subtrees are serialized
+	// simultaneously in the provided thread pool (see
+	// ut::meta::Controller::SetThreadPool() for details). Linkage information
+	// is enabled by default and forces sequential serialization, disable it
+	// in the ut::meta::Info object of the snapshot to make use of the pool.
+	//    @param stream - reference to the output stream to serialize a tree to
+	//    @param pool - thread pool to serialize subtrees in
+	//    @return - optionally ut::Error if failed
+	Optional<Error> Save(OutputStream& stream, ThreadPool<void>& pool);
+
+	// Loads full tree from a binary stream, sibling subtrees are deserialized
+	// simultaneously in the provided thread pool if the archive has size
+	// information (see ut::meta::Controller::SetThreadPool() for details).
+	// Archives saved with the default flags have linkage information, such
+	// archives are always read sequentially.
+	//    @param stream - reference to the input stream to deserialize from
+	//    @param pool - thread pool to deserialize subtrees in
+	//    @return - optionally ut::Error if failed
+	Optional<Error> Load(InputStream& stream, ThreadPool<void>& pool);
+
+	// Loads the tree from a binary stream lazily: only the root node is read,
+	// leaves of the root node are indexed by position and every one of them is
+	// loaded on the first access via Snapshot::FindChildByName(). Archive must
+	// have size information, otherwise (or if it has linkage information) the
+	// tree is loaded completely. Use ut::MappedFile to avoid reading the whole
+	// file, binary leaves can be accessed even without loading, see
+	// Snapshot::MapBinary(). Note that @stream must stay alive until
+	// all needed leaves are loaded.
+	//    @param stream - reference to the input stream supporting positioning
+	//    @return - optionally ut::Error if failed
+	Optional<Error> LoadLazy(InputStream& stream);
+
+	// Returns a view of the serialized data of the binary leaf (see
+	// ut::meta::BinaryParameter) that is waiting to be loaded lazily (see
+	// Snapshot::LoadLazy()). Data isn't copied, it lives in the memory of the
+	// input stream, so the stream must support ut::InputStream::GetData().
+	// The leaf itself stays unloaded.
+	//    @param child_name - name of the leaf.
+	//    @return - view of the data or ut::Error if failed.
+	Result<Controller::BinaryView, Error> MapBinary(const String& child_name);
+
+	// Saves only the nodes that changed since the previous delta was saved
+	// against the same @baseline, the first delta contains the whole tree.
+	// A node is compared by the digest of its binary form, the leaves of the
+	// changed node are compared separately only if the node itself (its body
+	// and the number of leaves) didn't change. Linkage information and type
+	// dictionary are always disabled in the delta, because they refer to
+	// the whole archive. @baseline is updated after saving.
+	//    @param stream - reference to the output stream to write the delta to
+	//    @param baseline - reference to the digests of the previous state
+	//    @return - optionally ut::Error if failed
+	Optional<Error> SaveDelta(OutputStream& stream, Baseline& baseline);
+
+	// Applies the delta saved with Snapshot::SaveDelta(). Deltas must be
+	// applied in the same order they were saved, every delta expects the
+	// tree to be in the state the previous one has left it.
+	//    @param stream - reference to the input stream to read the delta from
+	//    @return - optionally ut::Error if failed
+	Optional<Error> LoadDelta(InputStream& stream);
+
 	// Saves full tree to a text node.
 	//    @param text_node - reference to the text node to be serialized
 	//    @return - optionally ut::Error if failed
@@ -143,7 +218,8 @@ public:
 	//    @return - optionally ut::Error if failed
 	Optional<Error> Load(const Tree<text::Node>& text_node);
 
-	// Searches for a child node with a specific name.
+	// Searches for a child node with a specific name, nodes that are
+	// waiting to be loaded lazily are loaded here (see Snapshot::LoadLazy()).
 	//    @param node_name - name of the node to search for.
 	//    @return - reference to the node, or error if not found.
 	Optional<Snapshot&> FindChildByName(const String& node_name);
@@ -179,6 +255,63 @@ private:
 	//                      info structure, that is shared among all tree branches
 	Snapshot(const InfoSharedPtr& info_ptr);
 
+	// Saves full tree to a binary stream.
+	//    @param stream - reference to the output stream to serialize a tree to
+	//    @param pool - thread pool to serialize subtrees in, or nullptr
+	//    @return - optionally ut::Error if failed
+	Optional<Error> SaveBinary(OutputStream& stream, ThreadPool<void>* pool);
+
+	// Loads full tree from a binary stream.
+	//    @param stream - reference to the input stream to deserialize from
+	//    @param pool - thread pool to deserialize subtrees in, or nullptr
+	//    @param lazy - 'true' to load leaves on demand, see Snapshot::LoadLazy()
+	//    @return - optionally ut::Error if failed
+	Optional<Error> LoadBinary(InputStream& stream, ThreadPool<void>* pool, bool lazy);
+
+	// Loads the node that was waiting to be loaded lazily.
+	//    @return - optionally ut::Error if failed
+	Optional<Error> LoadDeferred();
+
+	// Calculates digests of the serialized subtree, see Snapshot::SaveDelta().
+	//    @param path - path to this node.
+	//    @param records - positions of the serialized nodes.
+	//    @param data - serialized tree.
+	//    @param digests - reference to the container to add digests to.
+	//    @return - digest of this node or ut::Error if failed
+	Result<Baseline::Digest, Error> CalculateDigests(const String& path,
+	                                                 const Controller::NodeRecorder& records,
+	                                                 const Array<byte>& data,
+	                                                 Baseline::Digests& digests) const;
+
+	// Adds serialized nodes that differ from the baseline to the delta.
+	//    @param path - path to this node.
+	//    @param records - positions of the serialized nodes.
+	//    @param data - serialized tree.
+	//    @param previous - digests of the baseline.
+	//    @param current - digests of the serialized tree.
+	//    @param paths - reference to the array of paths of the changed nodes.
+	//    @param nodes - reference to the array of the changed nodes.
+	//    @return - optionally ut::Error if failed
+	Optional<Error> CollectDelta(const String& path,
+	                             const Controller::NodeRecorder& records,
+	                             const Array<byte>& data,
+	                             const Baseline::Digests& previous,
+	                             const Baseline::Digests& current,
+	                             Array<String>& paths,
+	                             Array< Array<byte> >& nodes) const;
+
+	// Returns the path of the leaf with provided name.
+	//    @param path - path to this node.
+	//    @param name - name of the leaf.
+	static String MakeChildPath(const String& path, const String& name);
+
+	// Makes the whole subtree share provided serialization info. Reference
+	// counter of the info isn't atomic, so every subtree that is modified
+	// in a separate thread must have a separate copy of the info.
+	//    @param info_ptr - reference to the shared pointer with the
+	//                      serialization info structure.
+	void ShareInfo(const InfoSharedPtr& info_ptr);
+
 	// Recursively calls desired callback function.
 	//    @param callback_ptr - pointer to the member object
 	//                          representing a callback function
@@ -197,6 +330,14 @@ private:
 	// Callback functions that are called before/after saving/loading actions.
 	Function<void()> presave, postsave;
 	Function<void()> preload, postload;
+	// Index of the child nodes by name, used by Snapshot::FindChildByName().
+	ChildNameIndex child_index;
+
+	// State of the controller to load this node lazily and the position of
+	// the node in the stream, see Snapshot::LoadLazy(). Pointer is empty
+	// if the node isn't waiting to be loaded.
+	SharedPtr<Controller> deferred_source;
+	stream::Cursor deferred_offset;
 };
 
 //----------------------------------------------------------------------------//
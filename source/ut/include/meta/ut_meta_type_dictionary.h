@@ -0,0 +1,116 @@
+//----------------------------------------------------------------------------//
+//---------------------------------|  U  T  |---------------------------------//
+//----------------------------------------------------------------------------//
+#pragma once
+//----------------------------------------------------------------------------//
+#include "common/ut_common.h"
+#include "containers/ut_array.h"
+#include "containers/ut_hashmap.h"
+#include "meta/ut_polymorphic.h"
+#include "streams/ut_base_stream.h"
+#include "thread/ut_lock.h"
+//----------------------------------------------------------------------------//
+START_NAMESPACE(ut)
+START_NAMESPACE(meta)
+//----------------------------------------------------------------------------//
+// ut::meta::TypeDictionary is a table of type names used in one binary archive
+// (see ut::meta::serialization_flags::kTypeDictionary). Every name is stored
+// only once, serialized entities refer to it by index. During deserialization
+// every entry caches the dynamic type it was resolved to, so the factory is
+// searched only once per type, not once per object. Sibling subtrees that are
+// serialized simultaneously use separate dictionaries tracking references to
+// the entries, these dictionaries are merged in the original order, so the
+// result is the same as the sequential one. Resolve() can be called from
+// several threads at once.
+class TypeDictionary : public NonCopyable
+{
+public:
+	// type of the index of the entry
+	typedef uint32 Id;
+
+	// Position of the serialized index of the entry.
+	struct Reference
+	{
+		stream::Cursor position;
+		Id id;
+	};
+
+	// Constructor
+	//    @param in_track_references - 'true' to remember positions of the
+	//                                 serialized indices, see AddReference().
+	TypeDictionary(bool in_track_references = false);
+
+	// Returns the index of the entry with provided type name, a new entry
+	// is created if this name wasn't registered yet.
+	//    @param name - name of the type.
+	//    @return - index of the entry or ut::Error if failed.
+	Result<Id, Error> Register(const String& name);
+
+	// Adds a new entry to the end of the table, use it to fill the
+	// dictionary while reading it from the archive.
+	//    @param name - name of the type.
+	//    @return - ut::Error if failed.
+	Optional<Error> Add(String name);
+
+	// Returns the name of the type by index.
+	//    @param id - index of the entry.
+	//    @return - reference to the name or ut::Error if failed.
+	Result<const String&, Error> GetName(Id id) const;
+
+	// Returns the dynamic type of the entry, the result is cached so that
+	// subsequent calls with the same factory don't search for the type again.
+	//    @param id - index of the entry.
+	//    @param factory - factory of the base type.
+	//    @return - reference to the dynamic type or ut::Error if failed.
+	Result<const DynamicType&, Error> Resolve(Id id, const FactoryView& factory);
+
+	// Returns the number of entries.
+	size_t Count() const;
+
+	// Remembers the position of the serialized index if the dictionary
+	// tracks references, does nothing otherwise.
+	//    @param position - position of the index in the stream.
+	//    @param id - index of the entry.
+	//    @return - ut::Error if failed.
+	Optional<Error> AddReference(stream::Cursor position, Id id);
+
+	// Checks if the dictionary remembers positions of the serialized indices.
+	bool TracksReferences() const;
+
+	// Returns all references in order of serialization.
+	const Array<Reference>& GetReferences() const;
+
+	// Position in the binary stream associated with the dictionary: position
+	// of the dictionary offset while writing, or the end of the dictionary
+	// while reading.
+	stream::Cursor anchor;
+
+private:
+	// Name of the type and the cached result of the name resolution.
+	struct Entry
+	{
+		String name;
+		const FactoryView* factory;
+		const DynamicType* type;
+	};
+
+	// all entries in order of registration
+	Array<Entry> entries;
+
+	// indices of the entries, used only for serialization
+	HashMap<String, Id> ids;
+
+	// positions of the serialized indices, see AddReference()
+	Array<Reference> references;
+	bool track_references;
+
+	// guards cached types, see Resolve()
+	Mutex mutex;
+};
+
+//----------------------------------------------------------------------------//
+END_NAMESPACE(meta)
+END_NAMESPACE(ut)
+//----------------------------------------------------------------------------//
+//----------------------------------------------------------------------------//
+//----------------------------------------------------------------------------//
@@ -58,6 +58,9 @@ public:
 	// Copies an object of the derived type.
 	virtual Polymorphic* CloneObject(const Polymorphic& copy) const = 0;
 
+	// Returns the size of the derived type in bytes.
+	virtual size_t GetSize() const = 0;
+
 	// Returns full identifier of the dynamic type.
 	const Id& GetId() const
 	{
@@ -134,6 +137,12 @@ public:
 		return CopyObjectTemplate<T>(copy);
 	}
 
+	// Returns the size of the managed type in bytes.
+	size_t GetSize() const override
+	{
+		return sizeof(T);
+	}
+
 	// Gets type name.
 	static const String& GetName()
 	{
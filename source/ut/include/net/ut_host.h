@@ -67,8 +67,9 @@ public:
 	Signal<void(const HostAddress& address)> connection_closed;
 
 protected:
-	// active connections - one connection per one node
-	SyncRW< Array< UniquePtr<Connection> > > connections;
+	// active connections - one connection per one node, are read
+	// by every sending thread and modified rarely
+	SyncRW< Array< UniquePtr<Connection> >, ShardedRWLock > connections;
 
 	// address of the current node
 	HostAddress address;
@@ -9,6 +9,7 @@
 #include "net/ut_host_address.h"
 #include "net/ut_host.h"
 #include "net/ut_socket.h"
+#include "net/ut_reactor.h"
 #include "net/ut_net_cmd.h"
 #include "net/ut_net_action.h"
 #include "net/ut_connection.h"
@@ -39,6 +39,12 @@ public:
 	// Identify() method must be implemented for the polymorphic types.
 	virtual const DynamicType& Identify() const = 0;
 
+	// Returns 'true' if every instance of the command registers the same
+	// members in Reflect() and all of them lie inside the command object,
+	// so the reflection tree can be cached (see ut::meta::Schema). Commands
+	// are reflected on every send by default.
+	virtual bool HasFixedReflection() const;
+
 	// Executes command if received by client.
 	//    @param connection - connection owning the command.
 	//    @return - error if failed.
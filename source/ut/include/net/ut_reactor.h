@@ -0,0 +1,126 @@
+//----------------------------------------------------------------------------//
+//---------------------------------|  U  T  |---------------------------------//
+//----------------------------------------------------------------------------//
+#pragma once
+//----------------------------------------------------------------------------//
+#include "common/ut_common.h"
+#include "containers/ut_array.h"
+#include "templates/ut_function.h"
+#include "thread/ut_thread.h"
+#include "thread/ut_mutex.h"
+#include "system/ut_time.h"
+#include "net/ut_socket.h"
+//----------------------------------------------------------------------------//
+START_NAMESPACE(ut)
+START_NAMESPACE(net)
+//----------------------------------------------------------------------------//
+// class ut::net::Reactor owns a single thread waiting for timers and socket
+// readiness with one poll() call for all registered operations, so thousands
+// of pending operations don't need a thread each. Every operation is one-shot:
+// the callback is called in the reactor thread exactly once, when the timer
+// expires, the socket becomes ready or the reactor is destroyed. Callbacks
+// must not block, the usual callback just passes the work to a thread pool.
+class Reactor : public NonCopyable
+{
+public:
+	// Type of the socket event to wait for.
+	enum class Event
+	{
+		read,
+		write
+	};
+
+	// Callback of the operation, argument is ut::Error if the socket was
+	// closed or failed, or if the reactor was destroyed before the
+	// operation completed.
+	typedef Function<void(Optional<Error>)> Callback;
+
+	// Constructor, starts the reactor thread. Throws ut::Error
+	// if failed to create the socket used to wake up the thread.
+	Reactor();
+
+	// Destructor, stops the reactor thread and calls callbacks
+	// of the pending operations with an error.
+	~Reactor();
+
+	// Registers a timer.
+	//    @param timeout_ms - timeout in milliseconds.
+	//    @param callback - function to be called when the timer expires.
+	void AddTimer(uint32 timeout_ms, Callback callback);
+
+	// Registers a socket operation.
+	//    @param socket - socket to wait for, must outlive the operation.
+	//    @param event - type of the event to wait for.
+	//    @param callback - function to be called when the socket is ready.
+	void AddSocket(const Socket& socket, Event event, Callback callback);
+
+private:
+	// Pending timer.
+	struct Timer
+	{
+		uint64 deadline;
+		Callback callback;
+	};
+
+	// Pending socket operation.
+	struct Waiter
+	{
+		socket_t socket;
+		Event event;
+		Callback callback;
+	};
+
+	// Completed operation waiting for its callback to be called.
+	struct Completion
+	{
+		Callback callback;
+		Optional<Error> error;
+	};
+
+	// Procedure of the reactor thread.
+	void Run();
+
+	// Wakes up the reactor thread if it waits in poll().
+	void Wake();
+
+	// Reads all pending bytes from the wake up socket.
+	void Drain();
+
+	// Returns the time passed since the reactor was created in milliseconds.
+	uint64 GetTime() const;
+
+	// Creates the wake up socket connected to itself.
+	//    @return - ut::Error if failed.
+	Optional<Error> CreateWakeSocket();
+
+	// Closes the wake up socket.
+	void CloseWakeSocket();
+
+	// pending operations, are protected by @mutex
+	Array<Timer> timers;
+	Array<Waiter> waiters;
+	Mutex mutex;
+
+	// indicates if the reactor thread must exit, is protected by @mutex
+	bool stop;
+
+	// datagram socket connected to itself, any byte sent to it
+	// interrupts poll() in the reactor thread
+	socket_t wake_socket;
+
+	// clock for timers
+	time::Counter clock;
+
+	// reactor thread
+	UniquePtr<Thread> thread;
+
+	// Makes socket libraries to be loaded, see ut::Socket::skSystem.
+	static const SocketSystem& skSystem;
+};
+
+//----------------------------------------------------------------------------//
+END_NAMESPACE(net)
+END_NAMESPACE(ut)
+//----------------------------------------------------------------------------//
+//----------------------------------------------------------------------------//
+//----------------------------------------------------------------------------//
@@ -21,6 +21,9 @@ START_NAMESPACE(net)
 // socket. Thus copying is forbidden. Use unique sockets and avoid copying.
 class Socket : public NonCopyable
 {
+	// ut::net::Reactor polls native sockets.
+	friend class Reactor;
+
 public:
 	// Default constructor, calls ut::Socket::Create() internally
 	Socket();
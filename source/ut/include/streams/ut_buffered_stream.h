@@ -0,0 +1,144 @@
+//----------------------------------------------------------------------------//
+//---------------------------------|  U  T  |---------------------------------//
+//----------------------------------------------------------------------------//
+#pragma once
+//----------------------------------------------------------------------------//
+#include "common/ut_common.h"
+#include "streams/ut_input_stream.h"
+#include "streams/ut_output_stream.h"
+#include "containers/ut_array.h"
+//----------------------------------------------------------------------------//
+START_NAMESPACE(ut)
+//----------------------------------------------------------------------------//
+// ut::BufferedOutputStream accumulates written data in memory and passes it to
+// the target stream only on Flush() call. Cursor is tracked arithmetically, so
+// GetCursor() and MoveCursor() never touch the target stream. Data can be
+// overwritten (back-patched) until it's flushed, this allows to write data
+// that needs random access (like sizes of the serialized parameters) into
+// streams that don't support positioning at all (sockets, pipes, etc.).
+// Note that the data that is not flushed is lost on destruction.
+class BufferedOutputStream : public OutputStream
+{
+public:
+	// Constructor, cursor is set to the current position of the target
+	// stream, or to zero if the target stream doesn't support positioning.
+	//    @param target_stream - reference to the stream to flush data to.
+	BufferedOutputStream(OutputStream& target_stream);
+
+	// Writes an array of @count elements, each one with a size of @size bytes,
+	// from the block of memory pointed by @ptr to the current position
+	//    @param ptr - pointer to the array of elements to be written
+	//    @param size - size in bytes of each element to be written
+	//    @param count - number of elements, each one with a size of @size bytes
+	//    @return - ut::Error if encountered an error
+	Optional<Error> Write(const void* ptr, size_t size, size_t count);
+
+	// Writes all buffered data to the target stream and flushes it,
+	// cursor is moved to the end of the written data.
+	//    @return - error code if failed
+	Optional<Error> Flush();
+
+	// Returns stream offset to the current cursor position (in bytes)
+	//    @return - cursor position
+	Result<stream::Cursor, Error> GetCursor() const;
+
+	// Sets stream offset to the current cursor position (in bytes),
+	// cursor can be moved only inside the data that is not flushed yet.
+	//    @param offset - offset in bytes from @origin
+	//    @param origin - offset from the beginning of the stream
+	//                    @offset will be added to this parameter
+	//    @return - error code if failed
+	Optional<Error> MoveCursor(stream::Cursor offset,
+	                           stream::Position origin = stream::Position::start);
+
+	// Returns size of the stream including flushed data
+	Result<size_t, Error> GetSize();
+
+private:
+	// stream receiving flushed data
+	OutputStream& target;
+
+	// position of the first buffered byte
+	stream::Cursor start;
+
+	// cursor position relative to @start
+	stream::Cursor cursor;
+
+	// data that is not flushed yet
+	Array<byte> buffer;
+};
+
+//----------------------------------------------------------------------------//
+// ut::BufferedInputStream reads data from the source stream strictly in order
+// and keeps everything it has read in memory. Cursor is tracked arithmetically
+// and can be moved back to any position read previously, moving it forward
+// reads skipped data. Thus the source stream doesn't need to support
+// positioning (sockets, pipes, etc.). If the size of the source stream is
+// known - data is read in large blocks, otherwise exactly as many bytes are
+// read as requested, so that reading never blocks waiting for unneeded data.
+// Note that in the first case the cursor of the source stream can be moved
+// past the data that was actually consumed.
+class BufferedInputStream : public InputStream
+{
+public:
+	// Constructor, cursor is set to the current position of the source
+	// stream, or to zero if the source stream doesn't support positioning.
+	//    @param source_stream - reference to the stream to read data from.
+	BufferedInputStream(InputStream& source_stream);
+
+	// Reads an array of @count elements, each one with a size of @size bytes,
+	// from the stream and stores them in the block of memory specified by @ptr.
+	//    @param ptr - pointer to a block of memory with a size of
+	//                 at least (@size*@count) bytes
+	//    @param size - Size, in bytes, of each element to be read
+	//    @param count - Number of elements, each one with a size of @size bytes
+	//    @return - ut::Error if encountered an error
+	Optional<Error> Read(void* ptr, size_t size, size_t count);
+
+	// Returns stream offset to the current cursor position (in bytes)
+	//    @return - cursor position
+	Result<stream::Cursor, Error> GetCursor() const;
+
+	// Sets stream offset to the current cursor position (in bytes),
+	// cursor can't be moved before the initial position.
+	//    @param offset - offset in bytes from @origin
+	//    @param origin - offset from the beginning of the stream
+	//                    @offset will be added to this parameter
+	//    @return - error code if failed
+	Optional<Error> MoveCursor(stream::Cursor offset,
+	                           stream::Position origin = stream::Position::start);
+
+	// Returns size of the source stream, or error if it's unknown
+	Result<size_t, Error> GetSize();
+
+	// size of the block read at once if the size of the source is known
+	static constexpr size_t skBlockSize = 64 * 1024;
+
+private:
+	// Reads data from the source stream until the buffer
+	// contains at least @size bytes.
+	//    @param size - desired size of the buffer.
+	//    @return - error code if failed
+	Optional<Error> Fetch(size_t size);
+
+	// stream to read data from
+	InputStream& source;
+
+	// position of the first buffered byte
+	stream::Cursor start;
+
+	// cursor position relative to @start
+	stream::Cursor cursor;
+
+	// number of bytes left in the source stream, if known
+	Optional<size_t> remaining;
+
+	// all data that was read from the source stream
+	Array<byte> buffer;
+};
+
+//----------------------------------------------------------------------------//
+END_NAMESPACE(ut)
+//----------------------------------------------------------------------------//
+//----------------------------------------------------------------------------//
+//----------------------------------------------------------------------------//
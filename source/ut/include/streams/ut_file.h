@@ -173,6 +173,15 @@ public:
 	//    @return - ut::Error if encountered an error
 	Optional<Error> Read(void* ptr, size_t size, size_t count);
 
+	// Reads at most @size bytes, fewer bytes are read only if the end of the
+	// file is reached.
+	//    @param ptr - pointer to a block of memory with a size of
+	//                 at least @size bytes
+	//    @param size - maximum number of bytes to read
+	//    @return - number of bytes that were read, 0 if the file has
+	//              no more data, or ut::Error if failed
+	Result<size_t, Error> ReadSome(void* ptr, size_t size);
+
 	// Synchronizes the associated stream buffer with file.
 	//    @return - error code if failed
 	Optional<Error> Flush();
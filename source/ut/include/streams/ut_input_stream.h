@@ -23,6 +23,17 @@ public:
 	//    @return - ut::Error if encountered an error
 	virtual Optional<Error> Read(void* ptr, size_t size, size_t count) = 0;
 
+	// Reads at most @size bytes, fewer bytes are read only if the end of the
+	// stream is reached. Default implementation reads the whole block at once
+	// if the size of the stream is known, otherwise it reads byte by byte,
+	// and ut::error::out_of_bounds error is treated as the end of the stream.
+	//    @param ptr - pointer to a block of memory with a size of
+	//                 at least @size bytes
+	//    @param size - maximum number of bytes to read
+	//    @return - number of bytes that were read, 0 if the stream has
+	//              no more data, or ut::Error if failed
+	virtual Result<size_t, Error> ReadSome(void* ptr, size_t size);
+
 	// Synchronizes the associated stream buffer with its controlled input sequence.
 	//    @return - error code if failed
 	virtual Optional<Error> Sync();
@@ -43,6 +54,14 @@ public:
 	// returns "not_implemented" error if not overridend by child class
 	virtual Result<size_t, Error> GetSize();
 
+	// Returns a pointer to the data at the provided offset if the stream is
+	// backed by contiguous memory (binary stream, memory-mapped file, etc.),
+	// the data stays valid while the stream is alive and isn't modified.
+	// Returns "not_supported" error if not overridden by child class.
+	//    @param offset - offset in bytes from the beginning of the stream
+	//    @return - pointer to the data or error if failed
+	virtual Result<const void*, Error> GetData(stream::Cursor offset = 0) const;
+
 	// Operator '>>' applied to an input stream is known as extraction operator.
 	// Use it for formatted human-readable text data input.
 	InputStream& operator >> (InputStream& stream);
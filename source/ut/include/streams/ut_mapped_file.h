@@ -0,0 +1,101 @@
+//----------------------------------------------------------------------------//
+//---------------------------------|  U  T  |---------------------------------//
+//----------------------------------------------------------------------------//
+#pragma once
+//----------------------------------------------------------------------------//
+#include "common/ut_common.h"
+#include "text/ut_string.h"
+#include "streams/ut_input_stream.h"
+#include "error/ut_error.h"
+//----------------------------------------------------------------------------//
+START_NAMESPACE(ut)
+//----------------------------------------------------------------------------//
+// ut::MappedFile is a read-only input stream over the file mapped into memory.
+// Reading doesn't involve system calls and data can be accessed directly
+// (see ut::MappedFile::GetData()) without copying, pages are loaded by the
+// operating system only when they are touched. File is unmapped and closed
+// in destructor or Close() function.
+class MappedFile : public InputStream
+{
+public:
+	// Default constructor
+	MappedFile();
+
+	// Constructor, maps file @filename
+	//    @param filename - path to the file
+	MappedFile(const String& filename);
+
+	// Move constructor.
+	MappedFile(MappedFile&& other) noexcept;
+
+	// Move operator.
+	MappedFile& operator = (MappedFile&& other) noexcept;
+
+	// Copying is prohibited.
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator = (const MappedFile&) = delete;
+
+	// Destructor, unmaps the file (if it was previously mapped)
+	~MappedFile();
+
+	// Maps file @filename into memory, previously mapped file is closed
+	//    @param filename - path to the file
+	//    @return - ut::Error if encountered an error
+	Optional<Error> Open(const String& filename);
+
+	// Unmaps and closes the file (if it was previously mapped), pointers
+	// returned by GetData() become invalid.
+	//    @return - ut::Error if encountered an error
+	Optional<Error> Close();
+
+	// Returns 'true' if a file was opened, and hasn't been closed yet
+	bool IsOpened() const;
+
+	// Reads an array of @count elements, each one with a size of @size bytes,
+	// from the file and stores them in the block of memory specified by @ptr.
+	//    @param ptr - pointer to a block of memory with a size of
+	//                 at least (@size*@count) bytes
+	//    @param element_size - Size, in bytes, of each element to be read
+	//    @param count - Number of elements, each one with a size of @size bytes
+	//    @return - ut::Error if encountered an error
+	Optional<Error> Read(void* ptr, size_t element_size, size_t count);
+
+	// Returns file offset to the current cursor position (in bytes)
+	//    @return - cursor position if file is mapped, or error otherwise
+	Result<stream::Cursor, Error> GetCursor() const;
+
+	// Sets file offset to the current cursor position (in bytes)
+	//    @param offset - offset in bytes from @origin
+	//    @param origin - offset from the beginning of the file
+	//                    @offset will be added to this parameter
+	//    @return - error code if failed
+	Optional<Error> MoveCursor(stream::Cursor offset,
+	                           stream::Position origin = stream::Position::start);
+
+	// Returns size of the file or error if failed
+	Result<size_t, Error> GetSize();
+
+	// Returns a pointer to the mapped data, it's valid until the file is closed
+	//    @param offset - offset in bytes from the beginning of the file
+	//    @return - pointer to the data or error if failed
+	Result<const void*, Error> GetData(stream::Cursor offset = 0) const;
+
+private:
+	// start of the mapped memory, nullptr if nothing is mapped
+	const byte* data;
+
+	// size of the mapped memory in bytes
+	size_t size;
+
+	// current cursor position
+	stream::Cursor cursor;
+
+	// 'true' if the file is opened (even if empty and not mapped)
+	bool opened;
+};
+
+//----------------------------------------------------------------------------//
+END_NAMESPACE(ut)
+//----------------------------------------------------------------------------//
+//----------------------------------------------------------------------------//
+//----------------------------------------------------------------------------//
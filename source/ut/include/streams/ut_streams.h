@@ -9,7 +9,9 @@
 #include "streams/ut_input_stream.h"
 #include "streams/ut_output_stream.h"
 #include "streams/ut_binary_stream.h"
+#include "streams/ut_buffered_stream.h"
 #include "streams/ut_file.h"
+#include "streams/ut_mapped_file.h"
 
 //----------------------------------------------------------------------------//
 //----------------------------------------------------------------------------//
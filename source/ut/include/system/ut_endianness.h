@@ -20,6 +20,26 @@ enum class Order
 // Use this function to know endianness order of the current platform.
 Order GetNative();
 
+//----------------------------------------------------------------------------//
+// Reverses byte order of every element of the array in place. Elements of
+// 2, 4 and 8 bytes are swapped using byte-swap intrinsics.
+//    @param data - address of the first element.
+//    @param granularity - size of one element.
+//    @param count - number of elements.
+void Swap(void* data, size_t granularity, size_t count);
+
+// Writes elements to the stream in reverse byte order. Elements are swapped
+// in a small intermediate buffer, so that stream is written in large blocks.
+//    @param stream - reference to the output stream.
+//    @param data - address of the data to be written.
+//    @param granularity - size of one element.
+//    @param count - number of elements.
+//    @return - ut::Error if failed.
+Optional<Error> WriteSwapped(OutputStream& stream,
+                             const void* data,
+                             size_t granularity,
+                             size_t count);
+
 //----------------------------------------------------------------------------//
 // Use this function to read custom data in custom byte order from the stream.
 //    @param order - byte order of the variable in memory.
@@ -44,21 +64,15 @@ Optional<Error> Read(InputStream& stream,
 	{
 		return stream.Read(dst, granularity, count);
 	}
-	else // otherwise bytes are read in reverse order one by one
+	else // otherwise the whole block is read and then swapped in place
 	{
-		byte* start = static_cast<byte*>(dst);
-		for (size_t i = 0; i < count; i++)
+		Optional<Error> read_error = stream.Read(dst, granularity, count);
+		if (read_error)
 		{
-			for (size_t b = granularity; b--; )
-			{
-				Optional<Error> read_error = stream.Read(start + b, 1, 1);
-				if (read_error)
-				{
-					return read_error;
-				}
-			}
-			start += granularity;
+			return read_error;
 		}
+
+		Swap(dst, granularity, count);
 	}
 
 	// success
@@ -95,7 +109,7 @@ Optional<Error> Write(OutputStream& stream,
 {
 	// check if order is straight, note that this action is performed
 	// only once during runtime for performance reason
-	static bool order_match = order == GetNative();
+	static const bool order_match = order == GetNative();
 
 	// check if order is the same in stream buffer and memory, and if so - just write
 	// bytes in forward order (making only one call to stream::Write function)
@@ -103,25 +117,10 @@ Optional<Error> Write(OutputStream& stream,
 	{
 		return stream.Write(data, 1, granularity * count);
 	}
-	else // otherwise bytes are written in reverse order one by one
+	else // otherwise bytes are swapped in a temporary buffer
 	{
-		const byte* start = static_cast<const byte*>(data);
-		for (size_t i = 0; i < count; i++)
-		{
-			for (size_t b = granularity; b--; )
-			{
-				Optional<Error> write_error = stream.Write(start + b, 1, 1);
-				if (write_error)
-				{
-					return write_error;
-				}
-			}
-			start += granularity;
-		}
+		return WriteSwapped(stream, data, granularity, count);
 	}
-
-	// success
-	return Optional<Error>();
 }
 
 // Use this function to write variables in custom byte order to the stream.
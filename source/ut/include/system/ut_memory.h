@@ -7,6 +7,12 @@
 //----------------------------------------------------------------------------//
 START_NAMESPACE(ut)
 START_NAMESPACE(memory)
+//----------------------------------------------------------------------------//
+// Assumed size of the processor cache line in bytes, data written by
+// different threads should be placed at least this far apart to avoid
+// false sharing. 64 bytes is true for all modern x86 and most ARM cores.
+static const size_t skCacheLineSize = 64;
+
 //----------------------------------------------------------------------------//
 // Copies specified number of bytes (@size) from the object pointed to by @src
 // to the object pointed to by @dst. Both objects are reinterpreted as arrays of
@@ -25,6 +31,18 @@ inline void* Copy(void *dst, const void *src, size_t size)
 	return memcpy(dst, src, size);
 }
 
+// Copies specified number of bytes (@size) from the object pointed to by @src
+// to the object pointed to by @dst. Unlike ut::memory::Copy(), memory areas
+// are allowed to overlap.
+//    @param dst - pointer to the memory location to copy to.
+//    @param src - pointer to the memory location to copy from.
+//    @param size - number of bytes to copy.
+//    @return - @dst value.
+inline void* Move(void *dst, const void *src, size_t size)
+{
+	return memmove(dst, src, size);
+}
+
 // Converts the value @val to unsigned char and copies it into each of the first
 // @size characters of the object pointed to by @dst.
 //    @param dst - pointer to the object to fill.
@@ -58,6 +76,42 @@ inline void Deallocate(void* ptr)
 	return free(ptr);
 }
 
+// Allocates a block of @size bytes of memory with the address being a multiple
+// of @alignment. Memory is allocated with ut::memory::Allocate() with some
+// extra space, the address of the whole block is stored right before the
+// aligned address.
+//    @param size - size of the memory block, in bytes.
+//    @param alignment - alignment of the block in bytes, must be a power of two.
+//    @return - on success, a pointer to the aligned memory block; if the
+//              function failed to allocate the requested block of memory,
+//              a null pointer is returned.
+inline void* AllocateAligned(size_t size, size_t alignment)
+{
+	UT_ASSERT(alignment != 0 && (alignment & (alignment - 1)) == 0);
+	const size_t offset = alignment - 1 + sizeof(void*);
+	void* block = Allocate(size + offset);
+	if (block == nullptr)
+	{
+		return nullptr;
+	}
+
+	const uptr address = (reinterpret_cast<uptr>(block) + offset) & ~static_cast<uptr>(alignment - 1);
+	void** aligned = reinterpret_cast<void**>(address);
+	aligned[-1] = block;
+	return aligned;
+}
+
+// A block of memory previously allocated by a call to
+// ut::memory::AllocateAligned is deallocated, making it available
+// again for further allocations.
+inline void DeallocateAligned(void* ptr)
+{
+	if (ptr != nullptr)
+	{
+		Deallocate(static_cast<void**>(ptr)[-1]);
+	}
+}
+
 //----------------------------------------------------------------------------//
 END_NAMESPACE(memory)
 END_NAMESPACE(ut)
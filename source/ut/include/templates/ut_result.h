@@ -288,6 +288,20 @@ public:
 	constexpr Result(Result&& rval) noexcept : Base(ut::Move(rval))
 	{}
 
+	// Assignment operator
+	Result& operator = (const Result& copy)
+	{
+		Base::operator = (copy);
+		return *this;
+	}
+
+	// Assignment (move) operator
+	Result& operator = (Result&& rval) noexcept
+	{
+		Base::operator = (ut::Move(rval));
+		return *this;
+	}
+
 	// Function to check if object was constructed with void type or @A
 	constexpr bool HasResult() const
 	{
@@ -0,0 +1,135 @@
+//----------------------------------------------------------------------------//
+//---------------------------------|  U  T  |---------------------------------//
+//----------------------------------------------------------------------------//
+#pragma once
+//----------------------------------------------------------------------------//
+#include "text/ut_document.h"
+#include "containers/ut_hashmap.h"
+//----------------------------------------------------------------------------//
+START_NAMESPACE(ut)
+//----------------------------------------------------------------------------//
+// ut::BinaryDoc is a compact binary document format for the machine-to-machine
+// traffic. It's self-describing, schema-less and holds exactly the same
+// Tree<text::Node> model as text documents do, so it can replace ut::JsonDoc or
+// ut::XmlDoc anywhere (for example, in Snapshot::Save(Tree<text::Node>&)).
+//
+// Layout (all integers are LEB128 varints):
+//    header: "UTBD" + version byte
+//    document: <node count> <node>...
+//    node: <flags byte> <name> [value] [value type] [encapsulation name]
+//          <child count> <child node>...
+//    flags: bit 0 - has value, bit 1 - has value type, bit 2 - has encapsulation
+//           name, bit 3 - attribute, bit 4 - array, bits 5-7 - text::node::Type
+//    value: <length> <bytes>
+//    name, value type, encapsulation name: <length * 2> <bytes> for a new
+//           string that is added to the string table, or <id * 2 + 1> for
+//           the string that is already in the table. Names of the nodes in
+//           the arrays of records are repeated a lot, thus every such name is
+//           stored only once.
+class BinaryDoc : public text::Document
+{
+public:
+	// Parses binary data, note that @doc can contain null characters,
+	// String::Length() is used to determine the size of the data
+	//    @param doc - string with the binary data to be parsed
+	//    @return - ut::Error if encountered an error
+	Optional<Error> Parse(const String& doc);
+
+	// Writes contents to the output stream
+	//    @param stream - output stream
+	//    @return - ut::Error if encountered an error
+	Optional<Error> Write(OutputStream& stream) const;
+
+	// signature of the document
+	static const char* skSignature;
+
+	// current version of the format
+	static const byte skVersion;
+
+private:
+	// Bit flags describing a node.
+	enum Flags : byte
+	{
+		has_value = 1 << 0,
+		has_value_type = 1 << 1,
+		has_encapsulation_name = 1 << 2,
+		is_attribute = 1 << 3,
+		is_array = 1 << 4,
+		type_shift = 5
+	};
+
+	// ut::BinaryDoc::Writer accumulates encoded data
+	// before writing it to the stream at once.
+	struct Writer
+	{
+		// encoded data
+		Array<byte> data;
+
+		// string -> id of the string in the table
+		HashMap<String, uint32> table;
+	};
+
+	// ut::BinaryDoc::Reader is a cursor over the encoded data.
+	struct Reader
+	{
+		// current position
+		const byte* cursor;
+
+		// end of the data
+		const byte* end;
+
+		// strings that were already read
+		Array<String> table;
+	};
+
+	// Encodes a node with all its children.
+	//    @param writer - reference to the writer to encode node to
+	//    @param node - node to be encoded
+	//    @return - ut::Error if encountered an error
+	static Optional<Error> WriteNode(Writer& writer, const Tree<text::Node>& node);
+
+	// Encodes a string that is likely to be repeated (see class description).
+	//    @param writer - reference to the writer to encode string to
+	//    @param str - string to be encoded
+	//    @return - ut::Error if encountered an error
+	static Optional<Error> WriteTableString(Writer& writer, const String& str);
+
+	// Encodes a string with a length prefix.
+	//    @param writer - reference to the writer to encode string to
+	//    @param str - string to be encoded
+	//    @return - ut::Error if encountered an error
+	static Optional<Error> WriteString(Writer& writer, const String& str);
+
+	// Encodes an unsigned integer as a LEB128 varint.
+	//    @param writer - reference to the writer to encode number to
+	//    @param value - number to be encoded
+	//    @return - ut::Error if encountered an error
+	static Optional<Error> WriteVarint(Writer& writer, uint64 value);
+
+	// Decodes a node with all its children.
+	//    @param reader - reference to the reader to decode node from
+	//    @param node - node to be filled
+	//    @return - ut::Error if encountered an error
+	static Optional<Error> ReadNode(Reader& reader, Tree<text::Node>& node);
+
+	// Decodes a string that was encoded with BinaryDoc::WriteTableString().
+	//    @param reader - reference to the reader to decode string from
+	//    @return - decoded string or ut::Error if encountered an error
+	static Result<String, Error> ReadTableString(Reader& reader);
+
+	// Decodes a string with a length prefix.
+	//    @param reader - reference to the reader to decode string from
+	//    @return - decoded string or ut::Error if encountered an error
+	static Result<String, Error> ReadString(Reader& reader);
+
+	// Decodes a LEB128 varint.
+	//    @param reader - reference to the reader to decode number from
+	//    @return - decoded number or ut::Error if encountered an error
+	static Result<uint64, Error> ReadVarint(Reader& reader);
+};
+
+//----------------------------------------------------------------------------//
+END_NAMESPACE(ut)
+//----------------------------------------------------------------------------//
+//----------------------------------------------------------------------------//
+//----------------------------------------------------------------------------//
@@ -4,41 +4,102 @@
 #pragma once
 //----------------------------------------------------------------------------//
 #include "text/ut_document.h"
+#include "thread/ut_thread_pool.h"
 //----------------------------------------------------------------------------//
 START_NAMESPACE(ut)
 //----------------------------------------------------------------------------//
 
 class JsonDoc : public text::Document
 {
+	// ut::JsonPath parses matched values using ut::JsonDoc routines
+	friend class JsonPath;
 public:
 	// Parses raw text
 	//    @param text - string with a text to be parsed
 	//    @return - ut::Error if encountered an error
 	Optional<Error> Parse(const String& doc);
 
+	// Parses raw text, elements of the large arrays are parsed simultaneously
+	// in the provided thread pool. Array boundaries are found by the structural
+	// pre-scan, then every element is parsed separately and results are merged
+	// in the original order. If any element fails - the array is parsed once
+	// again sequentially, so the result (and the error) is always the same as
+	// the result of JsonDoc::Parse(const String&).
+	//    @param text - string with a text to be parsed
+	//    @param pool - thread pool to parse array elements in
+	//    @return - ut::Error if encountered an error
+	Optional<Error> Parse(const String& doc, ThreadPool<void>& pool);
+
 	// Writes contents to the output stream
 	//    @param stream - output stream
 	//    @return - ut::Error if encountered an error
 	Optional<Error> Write(OutputStream& stream) const;
 
+	// Arrays having less elements are always parsed sequentially.
+	static const size_t skMinParallelArraySize;
+
 private:
+	// Parses raw text
+	//    @param text - string with a text to be parsed
+	//    @param pool - thread pool to parse large arrays in, or nullptr
+	//    @return - ut::Error if encountered an error
+	Optional<Error> ParseDocument(const String& doc, ThreadPool<void>* pool);
+
 	// Parses the value of the node
 	//    @param cursor - reference to the current parsing position
 	//    @param node - reference to the parent node
+	//    @param pool - thread pool to parse large arrays in, or nullptr
 	//    @return - ut::Error if encountered an error
-	static Optional<Error> ParseValue(text::Reader& cursor, Tree<text::Node>& node);
+	static Optional<Error> ParseValue(text::Reader& cursor,
+	                                  Tree<text::Node>& node,
+	                                  ThreadPool<void>* pool);
 
 	// Parses '{}' object node
 	//    @param cursor - reference to the current parsing position
 	//    @param node - reference to the parent node
+	//    @param pool - thread pool to parse large arrays in, or nullptr
 	//    @return - ut::Error if encountered an error
-	static Optional<Error> ParseObject(text::Reader& cursor, Tree<text::Node>& node);
+	static Optional<Error> ParseObject(text::Reader& cursor,
+	                                  Tree<text::Node>& node,
+	                                  ThreadPool<void>* pool);
 
 	// Parses '[]' array node
 	//    @param cursor - reference to the current parsing position
 	//    @param node - reference to the parent node
+	//    @param pool - thread pool to parse large arrays in, or nullptr
 	//    @return - ut::Error if encountered an error
-	static Optional<Error> ParseArray(text::Reader& cursor, Tree<text::Node>& node);
+	static Optional<Error> ParseArray(text::Reader& cursor,
+	                                 Tree<text::Node>& node,
+	                                 ThreadPool<void>* pool);
+
+	// Parses elements of the '[]' array node simultaneously.
+	//    @param cursor - reference to the current parsing position
+	//    @param node - reference to the parent node
+	//    @param pool - thread pool to parse elements in
+	//    @return - 'true' if array was parsed, 'false' if the array is too
+	//              small or malformed and must be parsed sequentially
+	static bool ParseArrayParallel(text::Reader& cursor,
+	                               Tree<text::Node>& node,
+	                               ThreadPool<void>& pool);
+
+	// Parses a range of the array elements found by JsonDoc::ScanArray().
+	//    @param separators - positions of the '[', ',' and ']' characters
+	//    @param elements - array of element nodes to be filled
+	//    @param first - id of the first element to be parsed
+	//    @param count - number of elements to be parsed
+	//    @param failed - is set to 'true' if any element failed
+	static void ParseArrayElements(const Array<const char*>& separators,
+	                               Array< Tree<text::Node> >& elements,
+	                               size_t first,
+	                               size_t count,
+	                               bool& failed);
+
+	// Finds boundaries of the array elements without parsing them.
+	//    @param start - pointer to the '[' character
+	//    @param separators - array to receive positions of the opening '[',
+	//                        top-level ',' characters and the closing ']'
+	//    @return - 'false' if the array is malformed
+	static bool ScanArray(const char* start, Array<const char*>& separators);
 
 	// Extracts a JSON String as defined by the spec - "<some chars>"
 	// Any escaped characters are swapped out for their unescaped values
@@ -0,0 +1,121 @@
+//----------------------------------------------------------------------------//
+//---------------------------------|  U  T  |---------------------------------//
+//----------------------------------------------------------------------------//
+#pragma once
+//----------------------------------------------------------------------------//
+#include "text/ut_json.h"
+#include "templates/ut_ref.h"
+//----------------------------------------------------------------------------//
+START_NAMESPACE(ut)
+//----------------------------------------------------------------------------//
+// ut::JsonPath is a compiled JSON Pointer (RFC 6901) query, for example
+// "/records/0/name". In addition to the standard syntax the "*" segment is
+// a wildcard matching every member of an object or every element of an
+// array. Query can be evaluated against an already parsed tree, or against
+// the raw text: in this case only matched values are parsed into nodes, all
+// other subtrees are skipped by brace matching without building any nodes.
+// If path has no wildcards - only the first match is returned (the same way
+// duplicate keys are resolved by text::FindChild()) and the raw text is not
+// scanned after this match. Note that in the raw text mode skipped subtrees
+// are not validated, so errors are reported only for the visited values.
+class JsonPath
+{
+public:
+	// Creates a query from the JSON Pointer string.
+	//    @param pointer - JSON Pointer, empty string refers to the whole
+	//                     document, otherwise it must start with '/'
+	//    @return - compiled query, or ut::Error if @pointer is invalid
+	static Result<JsonPath, Error> Create(const String& pointer);
+
+	// Evaluates the query against the child nodes of the provided tree.
+	//    @param root - reference to the root node
+	//    @return - array of references to the matched nodes
+	Array< ConstRef< Tree<text::Node> > > Select(const Tree<text::Node>& root) const;
+
+	// Evaluates the query against the nodes of the provided document.
+	//    @param doc - reference to the parsed document
+	//    @return - array of references to the matched nodes
+	Array< ConstRef< Tree<text::Node> > > Select(const text::Document& doc) const;
+
+	// Evaluates the query against the raw JSON text.
+	//    @param json - string with a JSON text
+	//    @return - array of matched nodes (named after the key of the value,
+	//              elements of the arrays have empty names), or ut::Error if
+	//              encountered an error
+	Result<Array< Tree<text::Node> >, Error> Scan(const String& json) const;
+
+	// Returns 'true' if the query has at least one wildcard segment.
+	bool HasWildcards() const;
+
+	// wildcard segment
+	static const char* skWildcard;
+
+private:
+	// Single step of the path.
+	struct Segment
+	{
+		// name of the member, or array index in a text form
+		String key;
+
+		// array index if @key is a valid number
+		Optional<size_t> index;
+
+		// 'true' if this segment matches everything
+		bool wildcard;
+	};
+
+	// Constructor, use JsonPath::Create() to create a query.
+	JsonPath() = default;
+
+	// Recursively evaluates the query against the tree.
+	//    @param node - reference to the current node
+	//    @param segment_id - id of the segment to match children of @node
+	//    @param out - array to receive matched nodes
+	//    @return - 'true' if search must be stopped
+	bool SelectChildren(const Tree<text::Node>& node,
+	                    size_t segment_id,
+	                    Array< ConstRef< Tree<text::Node> > >& out) const;
+
+	// Checks if the node matches the segment and continues the search.
+	//    @param node - reference to the node to be checked
+	//    @param segment_id - id of the segment to match @node
+	//    @param out - array to receive matched nodes
+	//    @return - 'true' if search must be stopped
+	bool SelectNode(const Tree<text::Node>& node,
+	                size_t segment_id,
+	                Array< ConstRef< Tree<text::Node> > >& out) const;
+
+	// Recursively evaluates the query against the raw text.
+	//    @param cursor - reference to the current position, the beginning of
+	//                    the value, cursor is moved to the end of this value
+	//    @param name - name of the current value
+	//    @param segment_id - id of the segment to match children of the value
+	//    @param out - array to receive matched nodes
+	//    @return - 'true' if search must be stopped, or ut::Error if failed
+	Result<bool, Error> ScanValue(text::Reader& cursor,
+	                              const String& name,
+	                              size_t segment_id,
+	                              Array< Tree<text::Node> >& out) const;
+
+	// Skips the value without parsing it, nested objects and arrays are
+	// skipped by brace matching, so their contents are not validated.
+	//    @param cursor - reference to the current position, the beginning of
+	//                    the value, cursor is moved to the end of this value
+	//    @return - ut::Error if the value is malformed
+	static Optional<Error> SkipValue(text::Reader& cursor);
+
+	// Skips the string without unescaping it.
+	//    @param cursor - reference to the current position, the opening
+	//                    quote, cursor is moved past the closing quote
+	//    @return - ut::Error if the string is not terminated
+	static Optional<Error> SkipString(text::Reader& cursor);
+
+	// steps of the path
+	Array<Segment> segments;
+};
+
+//----------------------------------------------------------------------------//
+END_NAMESPACE(ut)
+//----------------------------------------------------------------------------//
+//----------------------------------------------------------------------------//
+//----------------------------------------------------------------------------//
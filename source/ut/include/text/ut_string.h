@@ -51,7 +51,10 @@ public:
 		}
 
 		// heap case
-		heap.Resize(length);
+		if (!heap.Resize(length))
+		{
+			ThrowError(error::out_of_memory);
+		}
 		heap[size] = '\0';
 	}
 
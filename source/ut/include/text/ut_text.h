@@ -11,6 +11,9 @@
 #include "text/ut_document.h"
 #include "text/ut_xml.h"
 #include "text/ut_json.h"
+#include "text/ut_xml_reader.h"
+#include "text/ut_binary_doc.h"
+#include "text/ut_json_path.h"
 
 //----------------------------------------------------------------------------//
 //----------------------------------------------------------------------------//
@@ -5,6 +5,7 @@
 //----------------------------------------------------------------------------//
 #include "common/ut_common.h"
 #include "containers/ut_tree.h"
+#include "containers/ut_child_name_index.h"
 #include "error/ut_error.h"
 #include "pointers/ut_unique_ptr.h"
 #include "text/ut_string.h"
@@ -65,11 +66,31 @@ public:
 	// this member takes effect only for json documents
 	bool is_array;
 
+	// index of the child nodes by name, is built lazily by ut::text::FindChild()
+	ChildNameIndex child_index;
+
 private:
 	// type of this node
 	node::Type type;
 };
 
+//----------------------------------------------------------------------------//
+// Searches for a child node with the desired name. Nodes with many children
+// are searched using the lazily built index (see ut::ChildNameIndex), so
+// names of the child nodes must not be changed between subsequent calls.
+//    @param parent - reference to the parent node to search in.
+//    @param name - name of the child node to search for.
+//    @return - reference to the child node, or nothing if not found.
+Optional<const Tree<Node>&> FindChild(const Tree<Node>& parent, const String& name);
+
+// Searches for a child node with the desired name. This variant is meant for
+// the trees that are being built, names of such nodes can change at any
+// moment, so it always performs a linear search and ignores the index.
+//    @param parent - reference to the parent node to search in.
+//    @param name - name of the child node to search for.
+//    @return - reference to the child node, or nothing if not found.
+Optional<Tree<Node>&> FindChild(Tree<Node>& parent, const String& name);
+
 //----------------------------------------------------------------------------//
 END_NAMESPACE(text)
 END_NAMESPACE(ut)
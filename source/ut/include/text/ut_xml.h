@@ -11,6 +11,9 @@ START_NAMESPACE(ut)
 // Inspired by RapidXml (Marcin Kalicinski).
 class XmlDoc : public text::Document
 {
+	// incremental reader reuses tokenization routines of the document
+	friend class XmlReader;
+
 public:
 	// Parses raw text
 	//    @param text - string with a text to be parsed
@@ -25,7 +28,7 @@ public:
 private:
 	// Parses BOM, if any
 	//    @param cursor - reference to the current reader position
-	void ParseBOM(text::Reader& cursor) const;
+	static void ParseBOM(text::Reader& cursor);
 	
 	// Determines node type first, then parses it
 	//    @param cursor - reference to the current reader position
@@ -40,33 +43,33 @@ private:
 	// Parses XML declaration (<?xml...)
 	//    @param cursor - reference to the current reader position
 	//    @return - new node or ut::Error if encountered an error
-	Result<Tree<text::Node>, Error> ParseXmlDeclaration(text::Reader& cursor);
+	static Result<Tree<text::Node>, Error> ParseXmlDeclaration(text::Reader& cursor);
 
 	// Parses PI
 	//    @param cursor - reference to the current reader position
 	//    @return - new node or ut::Error if encountered an error
-	Result<Tree<text::Node>, Error> ParsePi(text::Reader& cursor);
+	static Result<Tree<text::Node>, Error> ParsePi(text::Reader& cursor);
 
 	// Parses XML comment (<!--...)
 	//    @param cursor - reference to the current reader position
 	//    @return - new node or ut::Error if encountered an error
-	Result<Tree<text::Node>, Error> ParseComment(text::Reader& cursor);
+	static Result<Tree<text::Node>, Error> ParseComment(text::Reader& cursor);
 
 	// Parses CDATA
 	//    @param cursor - reference to the current reader position
 	//    @return - new node or ut::Error if encountered an error
-	Result<Tree<text::Node>, Error> ParseCData(text::Reader& cursor);
+	static Result<Tree<text::Node>, Error> ParseCData(text::Reader& cursor);
 
 	// Parses DOCTYPE
 	//    @param cursor - reference to the current reader position
 	//    @return - new node or ut::Error if encountered an error
-	Result<Tree<text::Node>, Error> ParseDoctype(text::Reader& cursor);
+	static Result<Tree<text::Node>, Error> ParseDoctype(text::Reader& cursor);
 
 	// Parses XML attributes of the node
 	//    @param cursor - reference to the current reader position
 	//    @param node - reference to the parent node
 	//    @return - ut::Error if encountered an error
-	Optional<Error> ParseNodeAttributes(text::Reader& cursor, Tree<text::Node>& node);
+	static Optional<Error> ParseNodeAttributes(text::Reader& cursor, Tree<text::Node>& node);
 
 	// Parses contents of the node - children, data etc.
 	//    @param cursor - reference to the current reader position
@@ -87,11 +90,11 @@ private:
 	//    @param normalize_whitespace - boolean whether to normalize whitespaces or not
 	//    @param trim_whitespace - boolean whether to trim whitespaces or not
 	//    @return - character or ut::Error if encountered an error
-	Result<char, Error> ParseAndAppendData(Tree<text::Node>& node,
-	                                       text::Reader& cursor,
-	                                       const char* contents_start,
-	                                       bool normalize_whitespace,
-	                                       bool trim_whitespace);
+	static Result<char, Error> ParseAndAppendData(Tree<text::Node>& node,
+	                                              text::Reader& cursor,
+	                                              const char* contents_start,
+	                                              bool normalize_whitespace,
+	                                              bool trim_whitespace);
 
 	// Skips characters until predicate evaluates to true while doing the following:
 	// - replacing XML character entity references with proper characters (&apos; &amp; &quot; &lt; &gt; &#...;)
@@ -0,0 +1,153 @@
+//----------------------------------------------------------------------------//
+//---------------------------------|  U  T  |---------------------------------//
+//----------------------------------------------------------------------------//
+#pragma once
+//----------------------------------------------------------------------------//
+#include "text/ut_xml.h"
+//----------------------------------------------------------------------------//
+START_NAMESPACE(ut)
+//----------------------------------------------------------------------------//
+// ut::XmlReader is an incremental pull (StAX-style) XML parser. Unlike
+// ut::XmlDoc it never holds the whole document in memory: data is consumed
+// from the input stream (or pushed by the user with XmlReader::Feed())
+// chunk by chunk into a bounded internal buffer, and every call to
+// XmlReader::Next() yields one event. Tokens that span a chunk boundary are
+// completed by reading more data before they are parsed, so the size of the
+// buffer limits only the size of a single token, not the size of a document.
+// Tokenization itself (attributes, character references, CDATA, PI,
+// comments, doctype) is performed by the ut::XmlDoc routines.
+class XmlReader
+{
+public:
+	// ut::XmlReader::Event is a single entity yielded by the reader.
+	struct Event
+	{
+		// possible event types
+		enum class Type
+		{
+			start_element, // <name attr="..."> or <name/>, attributes are children of the node
+			end_element,   // </name>, or the end of the <name/> element
+			text,          // character data, the value of the node
+			cdata,         // <![CDATA[...]]>, the value of the node
+			comment,       // <!--...-->, the value of the node
+			pi,            // <?target ...?>, the name and the value of the node
+			doctype,       // <!DOCTYPE ...>, the value of the node
+			declaration,   // <?xml ...?>, attributes are children of the node
+			end_document   // all data was processed, no more events will follow
+		};
+
+		// Constructor
+		Event(Type event_type = Type::end_document);
+
+		// type of the event
+		Type type;
+
+		// contents of the event in the same form ut::XmlDoc uses for nodes
+		Tree<text::Node> node;
+	};
+
+	// Constructor, creates a reader pulling data from the provided stream.
+	//    @param input - stream to read data from, reader doesn't own it
+	//    @param chunk_size - number of bytes to request from the stream at once
+	//    @param buffer_capacity - maximum size of the internal buffer in bytes,
+	//                             this is also the maximum size of one token
+	XmlReader(InputStream& input,
+	          size_t chunk_size = skDefaultChunkSize,
+	          size_t buffer_capacity = skDefaultBufferCapacity);
+
+	// Constructor, creates a reader for the push mode, use XmlReader::Feed()
+	// to supply data and XmlReader::Finish() to signal the end of the data.
+	//    @param buffer_capacity - maximum size of the internal buffer in bytes,
+	//                             this is also the maximum size of one token
+	XmlReader(size_t buffer_capacity = skDefaultBufferCapacity);
+
+	// Appends a chunk of data to the internal buffer (push mode).
+	//    @param data - pointer to the data
+	//    @param size - size of the data in bytes
+	//    @return - ut::Error if buffer capacity is exceeded
+	Optional<Error> Feed(const void* data, size_t size);
+
+	// Signals that no more data will be fed (push mode).
+	void Finish();
+
+	// Parses the next token and returns it as an event.
+	//    @return - event, or ut::Error if encountered an error. In push mode
+	//              error::empty means that more data must be fed to complete
+	//              the current token, calling Next() again after feeding is safe.
+	Result<Event, Error> Next();
+
+	// Returns current depth of the element hierarchy.
+	size_t GetDepth() const;
+
+	// default number of bytes requested from the stream at once
+	static const size_t skDefaultChunkSize;
+
+	// default maximum size of the internal buffer
+	static const size_t skDefaultBufferCapacity;
+
+private:
+	// Scans the buffer for the end of the token starting at @start.
+	//    @param start - offset of the first character of the token ('<' or text)
+	//    @return - offset of the character following the token, or
+	//              nothing if the token is incomplete
+	Optional<size_t> FindTokenEnd(size_t start) const;
+
+	// Parses a complete token that is located in the buffer.
+	//    @param start - offset of the first character of the token
+	//    @param end - offset of the character following the token
+	//    @return - event, or ut::Error if encountered an error
+	Result<Event, Error> ParseToken(size_t start, size_t end);
+
+	// Parses start tag of the element (<name attr="...">).
+	//    @param cursor - reference to the current reader position
+	//    @return - event, or ut::Error if encountered an error
+	Result<Event, Error> ParseStartTag(text::Reader& cursor);
+
+	// Parses closing tag of the element (</name>).
+	//    @param cursor - reference to the current reader position
+	//    @return - event, or ut::Error if encountered an error
+	Result<Event, Error> ParseEndTag(text::Reader& cursor);
+
+	// Moves unprocessed data to the beginning of the buffer.
+	void Compact();
+
+	// Reads the next chunk from the stream into the buffer.
+	//    @return - ut::Error if encountered an error
+	Optional<Error> Fill();
+
+	// Returns 'true' if there is no more data to receive.
+	bool IsEndOfData() const;
+
+	// stream to read from, nullptr in push mode
+	InputStream* stream;
+
+	// number of bytes requested from the stream at once
+	size_t chunk_size;
+
+	// internal buffer, always has one extra byte for the null terminator
+	Array<char> buffer;
+
+	// offset of the first unprocessed character
+	size_t begin;
+
+	// offset of the character following the last received one
+	size_t end;
+
+	// 'true' if the stream is over or XmlReader::Finish() was called
+	bool finished;
+
+	// 'true' if the BOM check was already performed
+	bool bom_checked;
+
+	// 'true' if the last start element was self-closing (<name/>)
+	bool pending_end;
+
+	// names of the opened elements
+	Array<String> open_elements;
+};
+
+//----------------------------------------------------------------------------//
+END_NAMESPACE(ut)
+//----------------------------------------------------------------------------//
+//----------------------------------------------------------------------------//
+//----------------------------------------------------------------------------//
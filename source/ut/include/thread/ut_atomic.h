@@ -4,231 +4,211 @@
 #pragma once
 //----------------------------------------------------------------------------//
 #include "thread/ut_interlocked.h"
+#include "thread/ut_memory_order.h"
 //----------------------------------------------------------------------------//
 START_NAMESPACE(ut)
 //----------------------------------------------------------------------------//
-// Each instantiation and full specialization of the ut::Atomic template defines
-// an atomic type. If one thread writes to an atomic object while another
-// thread reads from it, the behavior is well-defined.
-template<typename T> class Atomic {};
-
-// Helper class for signed values.
-template<typename SignedType>
-class AtomicSigned : public NonCopyable
+// Common part of every ut::Atomic type: loads, stores and exchanges.
+// Every operation accepts the memory order (see ut::memory_order::Type),
+// sequentially consistent order is used by default.
+template<typename T>
+class AtomicBase : public NonCopyable
 {
+	static_assert(sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8 ||
+	              (UT_DOUBLE_WIDTH_CAS && sizeof(T) == 2 * sizeof(void*)),
+	              "ut::Atomic supports only objects of 1, 2, 4, 8 bytes or of the size of two pointers.");
 public:
-	AtomicSigned(SignedType ini_val = 0) : var(ini_val)
+	AtomicBase(const T& ini_val) : var(ini_val)
 	{}
 
-	inline SignedType Increment()
-	{
-		return atomics::interlocked::Increment(&var);
-	}
-
-	inline SignedType Decrement()
+	inline T Read(memory_order::Type order = memory_order::Type::seq_cst)
 	{
-		return atomics::interlocked::Decrement(&var);
+		return atomics::ordered::Load(&var, order);
 	}
 
-	inline SignedType Add(SignedType amount)
+	inline void Store(const T& val, memory_order::Type order = memory_order::Type::seq_cst)
 	{
-		return atomics::interlocked::Add(&var, amount);
+		atomics::ordered::Store(&var, val, order);
 	}
 
-	inline SignedType Exchange(SignedType exchange)
+	inline T Exchange(const T& exchange, memory_order::Type order = memory_order::Type::seq_cst)
 	{
-		return atomics::interlocked::Exchange(&var, exchange);
+		return atomics::ordered::Exchange(&var, exchange, order);
 	}
 
-	inline SignedType CompareExchange(SignedType exchange, SignedType comparand)
+	// Replaces the value with @exchange if it's equal to @comparand.
+	//    @return - previous value.
+	inline T CompareExchange(const T& exchange,
+	                         const T& comparand,
+	                         memory_order::Type order = memory_order::Type::seq_cst)
 	{
-		return atomics::interlocked::CompareExchange(&var, exchange, comparand);
+		T previous = comparand;
+		atomics::ordered::CompareExchange(&var, previous, exchange, order);
+		return previous;
 	}
 
-	inline SignedType Read()
+	// Replaces the value with @desired if it's equal to @expected,
+	// otherwise @expected receives the current value.
+	//    @return - 'true' if the value was replaced.
+	inline bool CompareAndSwap(T& expected,
+	                           const T& desired,
+	                           memory_order::Type order = memory_order::Type::seq_cst)
 	{
-		return atomics::interlocked::Read(&var);
+		return atomics::ordered::CompareExchange(&var, expected, desired, order);
 	}
 
-	inline void Store(SignedType val)
-	{
-		return atomics::interlocked::Store(&var, val);
-	}
-
-	SignedType UnsafeRead()
+	T UnsafeRead()
 	{
 		return var;
 	}
 
-	void UnsafeStore(SignedType val)
+	void UnsafeStore(const T& val)
 	{
 		var = val;
 	}
 
-private:
-	SignedType var;
+protected:
+	alignas(sizeof(T)) T var;
 };
 
-// Helper class for unsigned values which must be reinterpreted from signed ones.
-template<typename SignedType, typename UnsignedType>
-class AtomicUnsigned : public NonCopyable
+//----------------------------------------------------------------------------//
+// Each instantiation and full specialization of the ut::Atomic template defines
+// an atomic type. If one thread writes to an atomic object while another
+// thread reads from it, the behavior is well-defined.
+// Generic version is intended for small trivially copyable types (pair of
+// 16-bit values, tagged pointer, etc.), objects are compared bytewise, so
+// structures must not have padding.
+template<typename T>
+class Atomic : public AtomicBase<T>
 {
 public:
-	AtomicUnsigned(UnsignedType ini_val = 0) : var(ini_val)
+	Atomic(const T& ini_val = T()) : AtomicBase<T>(ini_val)
 	{}
+};
 
-	inline UnsignedType Increment()
-	{
-		SignedType result = atomics::interlocked::Increment(reinterpret_cast<SignedType*>(&var));
-		return *reinterpret_cast<UnsignedType*>(&result);
-	}
-
-	inline UnsignedType Decrement()
-	{
-		SignedType result = atomics::interlocked::Decrement(reinterpret_cast<SignedType*>(&var));
-		return *reinterpret_cast<UnsignedType*>(&result);
-	}
-
-	inline UnsignedType Add(UnsignedType amount)
-	{
-		SignedType result = atomics::interlocked::Add(reinterpret_cast<SignedType*>(&var),
-		                                              *reinterpret_cast<SignedType*>(&amount));
-		return *reinterpret_cast<UnsignedType*>(&result);
-	}
-
-	inline UnsignedType Exchange(UnsignedType exchange)
-	{
-		SignedType result = atomics::interlocked::Exchange(reinterpret_cast<SignedType*>(&var),
-		                                                   *reinterpret_cast<SignedType*>(&exchange));
-		return *reinterpret_cast<UnsignedType*>(&result);
-	}
+// Helper class for integer values, arithmetic operations return the new value,
+// bitwise operations return the previous value.
+template<typename IntegerType>
+class AtomicInteger : public AtomicBase<IntegerType>
+{
+public:
+	AtomicInteger(IntegerType ini_val = 0) : AtomicBase<IntegerType>(ini_val)
+	{}
 
-	inline UnsignedType CompareExchange(UnsignedType exchange, UnsignedType comparand)
+	inline IntegerType Increment(memory_order::Type order = memory_order::Type::seq_cst)
 	{
-		SignedType result = atomics::interlocked::CompareExchange(reinterpret_cast<SignedType*>(&var),
-		                                                          *reinterpret_cast<SignedType*>(&exchange),
-			                                                      *reinterpret_cast<SignedType*>(&comparand));
-		return *reinterpret_cast<UnsignedType*>(&result);
+		return Add(1, order);
 	}
 
-	inline UnsignedType Read()
+	inline IntegerType Decrement(memory_order::Type order = memory_order::Type::seq_cst)
 	{
-		SignedType result = atomics::interlocked::Read(reinterpret_cast<SignedType*>(&var));
-		return *reinterpret_cast<UnsignedType*>(&result);
+		return Add(static_cast<IntegerType>(-1), order);
 	}
 
-	inline void Store(UnsignedType val)
+	inline IntegerType Add(IntegerType amount, memory_order::Type order = memory_order::Type::seq_cst)
 	{
-		atomics::interlocked::Store(reinterpret_cast<SignedType*>(&var),
-		                            *reinterpret_cast<SignedType*>(&val));
+		return static_cast<IntegerType>(atomics::ordered::FetchAdd(&this->var, amount, order) + amount);
 	}
 
-	UnsignedType UnsafeRead()
+	inline IntegerType FetchOr(IntegerType mask, memory_order::Type order = memory_order::Type::seq_cst)
 	{
-		return var;
+		return atomics::ordered::FetchOr(&this->var, mask, order);
 	}
 
-	void UnsafeStore(UnsignedType val)
+	inline IntegerType FetchAnd(IntegerType mask, memory_order::Type order = memory_order::Type::seq_cst)
 	{
-		var = val;
+		return atomics::ordered::FetchAnd(&this->var, mask, order);
 	}
-
-private:
-	UnsignedType var;
 };
 
 // Specialization of the ut::Atomic tempate for 'int32' type.
-template<> class Atomic<int32> : public AtomicSigned<int32>
+template<> class Atomic<int32> : public AtomicInteger<int32>
 {
 public:
-	Atomic(int32 ini_val = 0) : AtomicSigned<int32>(ini_val)
+	Atomic(int32 ini_val = 0) : AtomicInteger<int32>(ini_val)
 	{}
 };
 
 // Specialization of the ut::Atomic tempate for 'uint32' type.
-template<> class Atomic<uint32> : public AtomicUnsigned<int32, uint32>
+template<> class Atomic<uint32> : public AtomicInteger<uint32>
 {
 public:
-	Atomic(uint32 ini_val = 0) : AtomicUnsigned<int32, uint32>(ini_val)
+	Atomic(uint32 ini_val = 0) : AtomicInteger<uint32>(ini_val)
 	{}
 };
 
 // Specialization of the ut::Atomic tempate for 'int64' type.
-template<> class Atomic<int64> : public AtomicSigned<int64>
+template<> class Atomic<int64> : public AtomicInteger<int64>
 {
 public:
-	Atomic(int64 ini_val = 0) : AtomicSigned<int64>(ini_val)
+	Atomic(int64 ini_val = 0) : AtomicInteger<int64>(ini_val)
 	{}
 };
 
 // Specialization of the ut::Atomic tempate for 'uint64' type.
-template<> class Atomic<uint64> : public AtomicUnsigned<int64, uint64>
+template<> class Atomic<uint64> : public AtomicInteger<uint64>
 {
 public:
-	Atomic(uint64 ini_val = 0) : AtomicUnsigned<int64, uint64>(ini_val)
+	Atomic(uint64 ini_val = 0) : AtomicInteger<uint64>(ini_val)
 	{}
 };
 
-// Specialization of the ut::Atomic tempate for 'bool' type.
-template<> class Atomic<bool> : public NonCopyable
+// Specialization of the ut::Atomic tempate for pointers, arithmetic
+// operations move the pointer by the number of elements and return
+// the new value, like the built-in pointer arithmetic.
+template<typename T> class Atomic<T*> : public AtomicBase<T*>
 {
 public:
-	Atomic(bool ini_val = false) : var(ini_val ? 1 : 0)
+	Atomic(T* ini_val = nullptr) : AtomicBase<T*>(ini_val)
 	{}
 
-	inline bool Increment()
-	{
-		Store(true);
-		return true;
-	}
-
-	inline bool Decrement()
-	{
-		Store(false);
-		return false;
-	}
-
-	inline bool Add(bool amount)
+	inline T* Increment(memory_order::Type order = memory_order::Type::seq_cst)
 	{
-		return CompareExchange(amount, false);
+		return Add(1, order);
 	}
 
-	inline bool Exchange(bool exchange)
+	inline T* Decrement(memory_order::Type order = memory_order::Type::seq_cst)
 	{
-		return atomics::interlocked::Exchange(&var, exchange ? 1 : 0) != 0;
+		return Add(-1, order);
 	}
 
-	inline bool CompareExchange(bool exchange, bool comparand)
+	inline T* Add(iptr count, memory_order::Type order = memory_order::Type::seq_cst)
 	{
-		return atomics::interlocked::CompareExchange(&var, exchange ? 1 : 0, comparand ? 1 : 0) != 0;
+		const iptr offset = count * static_cast<iptr>(sizeof(T));
+		const iptr previous = atomics::ordered::FetchAdd(reinterpret_cast<volatile iptr*>(&this->var),
+		                                                 offset,
+		                                                 order);
+		return reinterpret_cast<T*>(previous + offset);
 	}
+};
 
-	inline bool Read()
-	{
-		return atomics::interlocked::Read(&var) != 0;
-	}
+// Specialization of the ut::Atomic tempate for 'bool' type.
+template<> class Atomic<bool> : public AtomicBase<bool>
+{
+public:
+	Atomic(bool ini_val = false) : AtomicBase<bool>(ini_val)
+	{}
 
-	inline void Store(bool val)
+	inline bool Increment(memory_order::Type order = memory_order::Type::seq_cst)
 	{
-		return atomics::interlocked::Store(&var, val ? 1 : 0);
+		Store(true, order);
+		return true;
 	}
 
-	bool UnsafeRead()
+	inline bool Decrement(memory_order::Type order = memory_order::Type::seq_cst)
 	{
-		return var != 0;
+		Store(false, order);
+		return false;
 	}
 
-	void UnsafeStore(bool val)
+	inline bool Add(bool amount, memory_order::Type order = memory_order::Type::seq_cst)
 	{
-		var = val ? 1 : 0;
+		return CompareExchange(amount, false, order);
 	}
-
-private:
-	int32 var;
 };
 
 //----------------------------------------------------------------------------//
 END_NAMESPACE(ut)
 //----------------------------------------------------------------------------//
 //----------------------------------------------------------------------------//
-//----------------------------------------------------------------------------//
\ No newline at end of file
+//----------------------------------------------------------------------------//
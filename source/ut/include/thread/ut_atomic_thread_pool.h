@@ -4,48 +4,54 @@
 #pragma once
 //----------------------------------------------------------------------------//
 #include "thread/ut_thread_pool.h"
+#include "thread/ut_backoff.h"
+#include "thread/ut_mpmc_queue.h"
 //----------------------------------------------------------------------------//
 START_NAMESPACE(ut)
 //----------------------------------------------------------------------------//
 // ut::AtomicPoolJob is a template class representing a job for each thread
 // in a thread pool. Template argument is a return type of a thread task.
+// Worker takes tasks from the queue shared by the whole pool. Idle worker
+// waits for a task using ut::Backoff strategy: it spins and yields for a short
+// time to react quickly while the pool is busy, and then parks on a condition
+// variable of the pool not to waste processor time.
 template<typename ReturnType>
 class AtomicPoolJob : public ut::Job
 {
-	// Type of the unique pointer to the managed task.
-	typedef UniquePtr< BaseTask<void> > UniqueTaskPtr;
 public:
 	// Constructor.
-	AtomicPoolJob() : busy(0)
+	//    @param thread_pool - pool that owns the job.
+	AtomicPoolJob(ThreadPool<ReturnType, pool_sync::Method::atomic>& thread_pool) : pool(thread_pool)
+	                                                                              , busy(0)
 	{}
 
-	// Waits for a task and then executes it.
+	// Waits for a task and then executes it, tasks remaining
+	// in the queue are processed before exit.
 	void Execute()
 	{
+		Backoff backoff(pool.GetBackoffThresholds());
 		while (!exit_request.Read())
 		{
-			if (atomics::interlocked::Read(&busy) == 2)
+			if (pool.DispatchTask(busy))
+			{
+				backoff.Reset();
+			}
+			else if (!backoff.Wait())
 			{
-				task->Execute();
-				atomics::interlocked::Store(&busy, 0);
+				pool.Park(exit_request);
+				backoff.Reset();
 			}
-			this_thread::Yield();
 		}
+
+		while (pool.DispatchTask(busy))
+		{}
 	}
 
-	// Assigns a new task if thread is in idle state.
-	//    @param new_task - reference to the unique pointer to the task
-	//                      to be executed.
-	//    @return - 'true' if task was accepted or 'false' if thread is busy.
-	bool SetTask(UniqueTaskPtr& new_task)
+	// Sends exit request and wakes the thread if it's parked.
+	void Exit()
 	{
-		if (atomics::interlocked::CompareExchange(&busy, 1, 0) == 0)
-		{
-			task = Move(new_task);
-			atomics::interlocked::Store(&busy, 2);
-			return true;
-		}
-		return false;
+		Job::Exit();
+		pool.WakeAll();
 	}
 
 	// Checks if thread is processing a task in the moment.
@@ -55,8 +61,12 @@ public:
 	}
 
 private:
-	UniqueTaskPtr task;
-	int32 busy;
+	// pool that owns the job
+	ThreadPool<ReturnType, pool_sync::Method::atomic>& pool;
+
+	// '1' if the thread is processing a task, is written by the owner
+	// thread for every task, so it's kept away from the data of other jobs
+	alignas(memory::skCacheLineSize) int32 busy;
 };
 
 //----------------------------------------------------------------------------//
@@ -73,8 +83,7 @@ class Scheduler<ReturnType, Combiner, pool_sync::Method::atomic>
 	typedef UniquePtr< BaseTask<ReturnType> > UniqueTaskPtr;
 
 public:
-	// Assigns a task to a thread from the thread pool. If all threads are busy,
-	// waits until one of them ends current task.
+	// Puts a task to the queue of the thread pool, never blocks.
 	//    @param task - unique pointer to the task to be executed.
 	void Enqueue(UniqueTaskPtr task)
 	{
@@ -83,13 +92,24 @@ public:
 		pool.Enqueue(MakeUnique< Task<void(UniqueTaskPtr)> >(function, Move(task)));
 	}
 
-	// Waits until all tasks finish.
+	// Waits until all tasks finish. Tasks from the queue are processed in
+	// the current thread while waiting (this way nested schedulers don't
+	// block worker threads), if the queue is empty - spins for a short time
+	// and then parks until the last task is processed.
 	//    @return - reference to the combiner.
 	Combiner& WaitForCompletion()
 	{
+		Backoff backoff(pool.GetBackoffThresholds());
 		while (atomics::interlocked::Read(&counter) != 0)
 		{
-			this_thread::Yield();
+			if (pool.DispatchTask())
+			{
+				backoff.Reset();
+			}
+			else if (!backoff.Wait())
+			{
+				pool.WaitForZero(counter);
+			}
 		}
 		return combiner;
 	}
@@ -100,7 +120,14 @@ private:
 	void ExecuteTask(UniqueTaskPtr task)
 	{
 		ThreadCombinerHelper<ReturnType, Combiner>::Combine(combiner, task.GetRef(), lock);
-		atomics::interlocked::Decrement(&counter);
+
+		// scheduler can be destroyed right after the decrement,
+		// so the reference to the pool must be copied before
+		ThreadPool<ReturnType, pool_sync::Method::atomic>& owner = pool;
+		if (atomics::interlocked::Decrement(&counter) == 0)
+		{
+			owner.NotifyZero();
+		}
 	}
 
 	// Constructor.
@@ -112,7 +139,7 @@ private:
 	ThreadPool<ReturnType, pool_sync::Method::atomic>& pool;
 
 	// counter of the active tasks
-	int counter;
+	int32 counter;
 
 	// combiner that combines results
 	Combiner combiner;
@@ -123,10 +150,16 @@ private:
 
 //----------------------------------------------------------------------------//
 // Specialized ut::ThreadPool template version where synchronization is
-// performed using atomic operations.
+// performed using atomic operations. All tasks are stored in a single
+// lock-free queue (see ut::MpmcQueue), workers take tasks from this queue.
+// If the queue is full, the task is processed in the calling thread, so
+// enqueueing never blocks.
 template<typename ReturnType>
-class ThreadPool<ReturnType, pool_sync::Method::atomic>
+class ThreadPool<ReturnType, pool_sync::Method::atomic> : NonCopyable
 {
+	// Job must have access to the queue and parking functions.
+	friend class AtomicPoolJob<ReturnType>;
+
 	// Job type for all threads in a pool.
 	typedef AtomicPoolJob<ReturnType> JobType;
 
@@ -134,16 +167,44 @@ class ThreadPool<ReturnType, pool_sync::Method::atomic>
 	typedef UniquePtr< BaseTask<void> > UniqueTaskPtr;
 
 public:
-	// Constructor.
+	// Default maximum number of tasks waiting in the queue.
+	static const size_t skDefaultQueueCapacity = 1024;
+
+	// Constructor. Throws ut::Error if failed to apply worker options.
 	//    @param num_threads - number of active threads.
-	ThreadPool(size_t num_threads = GetNumberOfProcessors()) : size(num_threads)
-	                                                         , threads(num_threads)
+	//    @param backoff_thresholds - number of spinning and yielding
+	//                                iterations before an idle worker
+	//                                or a waiting scheduler is parked.
+	//    @param queue_capacity - maximum number of tasks waiting in the queue,
+	//                            must be a power of two.
+	//    @param options - affinity, names and priority of the workers.
+	ThreadPool(size_t num_threads = GetNumberOfProcessors(),
+	           Backoff::Thresholds backoff_thresholds = Backoff::Thresholds(),
+	           size_t queue_capacity = skDefaultQueueCapacity,
+	           const WorkerOptions& options = WorkerOptions()) : size(num_threads)
+	                                                           , threads(num_threads)
+	                                                           , thresholds(backoff_thresholds)
+	                                                           , queue(queue_capacity)
 	{
 		for (size_t i = 0; i < size; i++)
 		{
-			UniquePtr<Job> job(MakeUnique<JobType>());
+			UniquePtr<Job> job(MakeUnique<JobType>(*this));
 			threads[i] = ut::MakeUnique<Thread>(Move(job));
 		}
+
+		Optional<Error> options_error = options.Apply(threads);
+		if (options_error)
+		{
+			Stop();
+			throw options_error.Move();
+		}
+	}
+
+	// Destructor. Joins worker threads, tasks remaining
+	// in the queue are processed before exit.
+	~ThreadPool()
+	{
+		Stop();
 	}
 
 	// Returns the number of threads in this pool.
@@ -152,6 +213,12 @@ public:
 		return size;
 	}
 
+	// Returns number of spinning and yielding iterations before parking.
+	const Backoff::Thresholds& GetBackoffThresholds() const
+	{
+		return thresholds;
+	}
+
 	// Creates a scheduler with custom combiner.
 	template<typename Combiner>
 	Scheduler<ReturnType, Combiner, pool_sync::Method::atomic> CreateScheduler()
@@ -165,56 +232,149 @@ public:
 		return Scheduler<ReturnType, DefaultCombiner<ReturnType>, pool_sync::Method::atomic>(*this);
 	}
 
-	// Waits for a free thread and assigns provided task to it.
+	// Puts provided task to the queue, never blocks. Task is processed
+	// immediately in the current thread if the queue is full or
+	// the pool has no workers.
 	//    @param task - task to be executed in a thread.
 	void Enqueue(UniqueTaskPtr task)
 	{
-		while (true)
+		if (size == 0 || !queue.Push(task))
 		{
-			bool thread_belongs_to_pool = false;
-			const ut::ThreadId current_thread_id = this_thread::GetId();
-			for (size_t i = 0; i < size; i++)
-			{
-				// check if current thread is one of the threads in a pool
-				if (threads[i]->GetId() == current_thread_id)
-				{
-					thread_belongs_to_pool = true;
-					continue;
-				}
-
-				// extract reference to the job
-				Optional<Job&> job = threads[i]->GetJob();
-				if (!job)
-				{
-					continue;
-				}
-
-				// attempt to enqueue a task
-				JobType& job_ref = static_cast<JobType&>(job.Get());
-				if (job_ref.SetTask(task))
-				{
-					return; // thread was free and accepted a task
-				}
-			}
+			task->Execute();
+			return;
+		}
 
-			// check if task must be executed in the current thread
-			if (thread_belongs_to_pool)
-			{
-				task->Execute(); // task wasn't enqueued, but current
-				return;          // thread is one of the threads in a pool
-			}
+		// wake one of the parked workers, the queue position is incremented
+		// before reading @sleepers, and each worker increments @sleepers
+		// before checking the queue, so at least one side sees the other
+		if (sleepers.Read() != 0)
+		{
+			ScopeLock lock(mutex);
+			worker_cvar.WakeOne();
+		}
+	}
 
-			// task wasn't enqueued, and we must try again
-			this_thread::Yield();
+	// Takes a task from the queue and processes it in the current thread.
+	//    @return - 'true' if a task was processed, 'false' if queue is empty.
+	bool DispatchTask()
+	{
+		Optional<UniqueTaskPtr> task = queue.Pop();
+		if (!task)
+		{
+			return false;
+		}
+
+		task.Get()->Execute();
+		return true;
+	}
+
+	// Blocks the current thread until provided counter becomes zero,
+	// counter must be decremented to zero by the thread calling NotifyZero().
+	//    @param counter - reference to the counter.
+	void WaitForZero(int32& counter)
+	{
+		ScopeLock lock(mutex);
+		waiters.Increment();
+		while (atomics::interlocked::Read(&counter) != 0)
+		{
+			waiter_cvar.Wait(lock);
+		}
+		waiters.Decrement();
+	}
+
+	// Wakes all threads waiting in WaitForZero() function. The same
+	// condition variable is shared between all schedulers of the pool,
+	// so it's not worth tracking which scheduler is waiting.
+	void NotifyZero()
+	{
+		// counter is decremented before reading @waiters, and WaitForZero()
+		// increments @waiters before reading counter, so at least one side
+		// sees the other
+		if (waiters.Read() != 0)
+		{
+			ScopeLock lock(mutex);
+			waiter_cvar.WakeAll();
 		}
 	}
 
 private:
-	// array of active threads
-	Array< UniquePtr<Thread> > threads;
+	// Joins worker threads, workers must be joined before the
+	// queue and synchronization objects are destroyed.
+	void Stop()
+	{
+		for (size_t i = 0; i < size; i++)
+		{
+			threads[i]->Join();
+		}
+
+		// workers drain the queue before exit, but a task that is still
+		// being processed by one worker can enqueue a new task after other
+		// workers have exited, such tasks are processed in this thread
+		while (DispatchTask())
+		{}
+	}
+
+	// Takes a task from the queue and processes it in the worker thread.
+	//    @param busy - reference to the flag of the worker that is set
+	//                  while the task is being processed.
+	//    @return - 'true' if a task was processed, 'false' if queue is empty.
+	bool DispatchTask(int32& busy)
+	{
+		Optional<UniqueTaskPtr> task = queue.Pop();
+		if (!task)
+		{
+			return false;
+		}
+
+		atomics::interlocked::Store(&busy, 1);
+		task.Get()->Execute();
+		atomics::interlocked::Store(&busy, 0);
+		return true;
+	}
+
+	// Blocks the worker thread until a new task is enqueued
+	// or exit is requested.
+	//    @param exit_request - exit flag of the worker.
+	void Park(Atomic<bool>& exit_request)
+	{
+		ScopeLock lock(mutex);
+		sleepers.Increment();
+		while (queue.IsEmpty() && !exit_request.Read())
+		{
+			worker_cvar.Wait(lock);
+		}
+		sleepers.Decrement();
+	}
+
+	// Wakes all parked workers.
+	void WakeAll()
+	{
+		ScopeLock lock(mutex);
+		worker_cvar.WakeAll();
+	}
 
 	// number of active threads
 	const size_t size;
+
+	// array of active threads
+	Array< UniquePtr<Thread> > threads;
+
+	// number of spinning and yielding iterations before parking
+	const Backoff::Thresholds thresholds;
+
+	// tasks waiting to be processed
+	MpmcQueue<UniqueTaskPtr> queue;
+
+	// number of workers parked on @worker_cvar
+	Atomic<int32> sleepers;
+
+	// number of threads waiting in WaitForZero() function
+	Atomic<int32> waiters;
+
+	// synchronization objects for parked workers and waiting schedulers
+	Mutex mutex;
+	ConditionVariable worker_cvar;
+	ConditionVariable waiter_cvar;
 };
 
 //----------------------------------------------------------------------------//
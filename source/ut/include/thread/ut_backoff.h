@@ -0,0 +1,70 @@
+//----------------------------------------------------------------------------//
+//---------------------------------|  U  T  |---------------------------------//
+//----------------------------------------------------------------------------//
+#pragma once
+//----------------------------------------------------------------------------//
+#include "common/ut_common.h"
+//----------------------------------------------------------------------------//
+START_NAMESPACE(ut)
+//----------------------------------------------------------------------------//
+// ut::Backoff implements adaptive waiting for a condition that is expected
+// to become true soon. At first the thread spins with exponentially growing
+// number of processor pauses (the lowest latency), then it gives up the time
+// slice to other threads, and finally ut::Backoff::Wait() returns 'false' to
+// inform the caller that the thread must be parked on a blocking primitive
+// (mutex, condition variable, etc.) until it's explicitly woken up.
+class Backoff
+{
+public:
+	// Default number of spinning iterations.
+	static const uint32 skDefaultSpinCount = 64;
+
+	// Default number of yielding iterations.
+	static const uint32 skDefaultYieldCount = 16;
+
+	// Maximum number of processor pauses per spinning iteration.
+	static const uint32 skMaxPauseCount = 32;
+
+	// Number of iterations of every waiting stage.
+	struct Thresholds
+	{
+		// Constructor.
+		//    @param spin_count - number of spinning iterations.
+		//    @param yield_count - number of yielding iterations.
+		Thresholds(uint32 spin_count = skDefaultSpinCount,
+		           uint32 yield_count = skDefaultYieldCount);
+
+		// number of iterations spinning on the processor
+		uint32 spin;
+
+		// number of iterations giving up the time slice
+		uint32 yield;
+	};
+
+	// Constructor.
+	//    @param thresholds - number of iterations of every stage.
+	Backoff(Thresholds thresholds = Thresholds());
+
+	// Performs one waiting iteration according to the current stage.
+	//    @return - 'true' if the caller must check the condition and call
+	//              Wait() again, or 'false' if all iterations were spent
+	//              and the thread must be parked.
+	bool Wait();
+
+	// Starts from the spinning stage again, must be called
+	// when the condition became true.
+	void Reset();
+
+private:
+	// number of iterations of every stage
+	Thresholds thresholds;
+
+	// number of iterations since the last reset
+	uint32 iteration;
+};
+
+//----------------------------------------------------------------------------//
+END_NAMESPACE(ut)
+//----------------------------------------------------------------------------//
+//----------------------------------------------------------------------------//
+//----------------------------------------------------------------------------//
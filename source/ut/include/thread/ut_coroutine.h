@@ -0,0 +1,463 @@
+//----------------------------------------------------------------------------//
+//---------------------------------|  U  T  |---------------------------------//
+//----------------------------------------------------------------------------//
+#pragma once
+//----------------------------------------------------------------------------//
+#include "common/ut_common.h"
+//----------------------------------------------------------------------------//
+// Coroutines are available only if the library is compiled with C++20.
+#if CPP_STANDARD >= 2020
+#include <coroutine>
+#include <exception>
+#include "thread/ut_thread_pool.h"
+#include "thread/ut_atomic_thread_pool.h"
+#include "thread/ut_future.h"
+#include "templates/ut_is_same.h"
+#include "net/ut_reactor.h"
+//----------------------------------------------------------------------------//
+START_NAMESPACE(ut)
+//----------------------------------------------------------------------------//
+// ut::Coro is a template class of the lazy stackless coroutine returning a
+// value of type T. Coroutine starts only when it's awaited by another
+// coroutine (co_await), and the awaiting coroutine is resumed right after
+// the awaited one finishes without going through any queue. The top-level
+// coroutine is launched with ut::Spawn(). A suspended coroutine holds no
+// thread, so thousands of them can wait for timers and sockets (see
+// ut::Delay() and ut::WaitSocket()) while a pool of a few threads executes
+// those that are ready. An exception escaping the coroutine is converted to
+// ut::Error and thrown once again in the awaiting coroutine, the future
+// returned by ut::Spawn() receives the error instead of the value.
+template<typename T> class Coro;
+
+//----------------------------------------------------------------------------//
+namespace coro_helper
+{
+	// Converts the exception being handled to ut::Error,
+	// must be called only inside a catch block.
+	//    @return - ut::Error describing the exception.
+	inline Error ConvertCurrentException() noexcept
+	{
+		try
+		{
+			throw;
+		}
+		catch (const Error& error)
+		{
+			return error;
+		}
+		catch (const std::exception& exception)
+		{
+			return Error(error::fail, exception.what());
+		}
+		catch (...)
+		{
+			return Error(error::fail, "Unknown exception.");
+		}
+	}
+
+	// Awaiter of the final suspension point, transfers control
+	// to the awaiting coroutine if there is one.
+	struct FinalAwaiter
+	{
+		bool await_ready() const noexcept
+		{
+			return false;
+		}
+
+		template<typename Promise>
+		std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) const noexcept
+		{
+			std::coroutine_handle<> continuation = handle.promise().continuation;
+			return continuation ? continuation : std::noop_coroutine();
+		}
+
+		void await_resume() const noexcept
+		{}
+	};
+
+	// Common part of the promise of every ut::Coro.
+	struct BasePromise
+	{
+		std::suspend_always initial_suspend() const noexcept
+		{
+			return std::suspend_always();
+		}
+
+		FinalAwaiter final_suspend() const noexcept
+		{
+			return FinalAwaiter();
+		}
+
+		// exception can't be rethrown here, it would escape
+		// to the worker thread of the pool and terminate it
+		void unhandled_exception() noexcept
+		{
+			error = ConvertCurrentException();
+		}
+
+		// Throws the error of the finished coroutine if any.
+		void ThrowError()
+		{
+			if (error)
+			{
+				throw error.Move();
+			}
+		}
+
+		// coroutine to be resumed when this one finishes
+		std::coroutine_handle<> continuation;
+
+		// error the coroutine has finished with
+		Optional<Error> error;
+	};
+
+	// Promise of the ut::Coro returning a value.
+	template<typename T>
+	struct PromiseType : BasePromise
+	{
+		Coro<T> get_return_object();
+
+		template<typename U>
+		void return_value(U&& value)
+		{
+			result = T(Forward<U>(value));
+		}
+
+		T GetResult()
+		{
+			ThrowError();
+			UT_ASSERT(result.HasValue());
+			return result.Move();
+		}
+
+		Optional<T> result;
+	};
+
+	// Promise of the ut::Coro returning nothing.
+	template<>
+	struct PromiseType<void> : BasePromise
+	{
+		Coro<void> get_return_object();
+
+		void return_void() const noexcept
+		{}
+
+		void GetResult()
+		{
+			ThrowError();
+		}
+	};
+}
+
+//----------------------------------------------------------------------------//
+// ut::Coro is a template class of the lazy stackless coroutine, see the
+// description at the top of the file.
+template<typename T>
+class Coro : NonCopyable
+{
+public:
+	// Type of the promise, the name is required by the language.
+	typedef coro_helper::PromiseType<T> promise_type;
+
+	// Type of the coroutine handle.
+	typedef std::coroutine_handle<promise_type> Handle;
+
+	// Awaiter starting the coroutine and returning its result.
+	struct Awaiter
+	{
+		bool await_ready() const noexcept
+		{
+			return handle.done();
+		}
+
+		std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) const noexcept
+		{
+			handle.promise().continuation = awaiting;
+			return handle;
+		}
+
+		T await_resume() const
+		{
+			return handle.promise().GetResult();
+		}
+
+		Handle handle;
+	};
+
+	// Move constructor.
+	Coro(Coro&& other) noexcept : handle(other.handle)
+	{
+		other.handle = nullptr;
+	}
+
+	// Move operator.
+	Coro& operator = (Coro&& other) noexcept
+	{
+		if (this != &other)
+		{
+			Destroy();
+			handle = other.handle;
+			other.handle = nullptr;
+		}
+		return *this;
+	}
+
+	// Destructor, destroys the coroutine frame.
+	~Coro()
+	{
+		Destroy();
+	}
+
+	// Checks if the object owns a coroutine.
+	bool IsValid() const
+	{
+		return static_cast<bool>(handle);
+	}
+
+	// Starts the coroutine, the awaiting coroutine is resumed with
+	// the result when this one finishes.
+	Awaiter operator co_await() && noexcept
+	{
+		UT_ASSERT(handle);
+		return Awaiter{ handle };
+	}
+
+private:
+	// Only the promise can create a coroutine object.
+	friend struct coro_helper::PromiseType<T>;
+
+	// Constructor.
+	//    @param in_handle - handle of the new coroutine.
+	explicit Coro(Handle in_handle) : handle(in_handle)
+	{}
+
+	// Destroys the coroutine frame if it's owned by this object.
+	void Destroy()
+	{
+		if (handle)
+		{
+			handle.destroy();
+			handle = nullptr;
+		}
+	}
+
+	// handle of the owned coroutine
+	Handle handle;
+};
+
+//----------------------------------------------------------------------------//
+namespace coro_helper
+{
+	// Creates a coroutine object from the promise.
+	template<typename T>
+	Coro<T> PromiseType<T>::get_return_object()
+	{
+		return Coro<T>(Coro<T>::Handle::from_promise(*this));
+	}
+
+	// Creates a coroutine object from the promise.
+	inline Coro<void> PromiseType<void>::get_return_object()
+	{
+		return Coro<void>(Coro<void>::Handle::from_promise(*this));
+	}
+
+	// Resumes the coroutine in a thread pool.
+	template<typename Pool>
+	void Resume(Pool& pool, std::coroutine_handle<> handle)
+	{
+		pool.Enqueue(MakeUnique< Task<void()> >([handle] { handle.resume(); }));
+	}
+
+	// Awaiter resuming the coroutine in a thread pool.
+	template<typename Pool>
+	struct ScheduleAwaiter
+	{
+		bool await_ready() const noexcept
+		{
+			return false;
+		}
+
+		void await_suspend(std::coroutine_handle<> handle) const
+		{
+			Resume(pool, handle);
+		}
+
+		void await_resume() const noexcept
+		{}
+
+		Pool& pool;
+	};
+
+	// Awaiter of the reactor operation (timer or socket event), the
+	// coroutine is resumed in a thread pool when the operation completes.
+	template<typename Pool>
+	struct ReactorAwaiter
+	{
+		bool await_ready() const noexcept
+		{
+			return false;
+		}
+
+		void await_suspend(std::coroutine_handle<> handle)
+		{
+			// the coroutine can be resumed in another thread before
+			// Add*() returns, so members must not be used after the call
+			Pool* pool_ptr = &pool;
+			ReactorAwaiter* awaiter = this;
+			net::Reactor::Callback callback([pool_ptr, awaiter, handle](Optional<Error> result)
+			{
+				awaiter->error = Move(result);
+				Resume(*pool_ptr, handle);
+			});
+
+			if (socket == nullptr)
+			{
+				reactor.AddTimer(timeout_ms, Move(callback));
+			}
+			else
+			{
+				reactor.AddSocket(*socket, event, Move(callback));
+			}
+		}
+
+		Optional<Error> await_resume()
+		{
+			return Move(error);
+		}
+
+		net::Reactor& reactor;
+		Pool& pool;
+		const net::Socket* socket;
+		net::Reactor::Event event;
+		uint32 timeout_ms;
+		Optional<Error> error;
+	};
+
+	// Coroutine that starts immediately and destroys itself when finished.
+	struct Detached
+	{
+		struct promise_type
+		{
+			Detached get_return_object() const noexcept
+			{
+				return Detached();
+			}
+
+			std::suspend_never initial_suspend() const noexcept
+			{
+				return std::suspend_never();
+			}
+
+			std::suspend_never final_suspend() const noexcept
+			{
+				return std::suspend_never();
+			}
+
+			void return_void() const noexcept
+			{}
+
+			// Launch() catches all exceptions itself, the promise
+			// is broken if anything else throws
+			void unhandled_exception() const noexcept
+			{}
+		};
+	};
+
+	// Moves to the thread pool, awaits the coroutine and passes its
+	// result or the error it has finished with to the promise.
+	template<typename T, typename Pool>
+	Detached Launch(Pool& pool, Coro<T> coro, Promise<T> promise)
+	{
+		co_await ScheduleAwaiter<Pool>{ pool };
+		try
+		{
+			if constexpr (IsSame<T, void>::value)
+			{
+				co_await Move(coro);
+				promise.SetValue();
+			}
+			else
+			{
+				promise.SetValue(co_await Move(coro));
+			}
+		}
+		catch (...)
+		{
+			promise.SetError(ConvertCurrentException());
+		}
+	}
+}
+
+//----------------------------------------------------------------------------//
+// Suspends the coroutine and resumes it in a worker thread of the provided
+// pool: co_await ut::Schedule(pool).
+//    @param pool - thread pool to resume the coroutine in.
+//    @return - awaitable object.
+template<typename ReturnType, pool_sync::Method sync_method>
+coro_helper::ScheduleAwaiter< ThreadPool<ReturnType, sync_method> > Schedule(ThreadPool<ReturnType, sync_method>& pool)
+{
+	return coro_helper::ScheduleAwaiter< ThreadPool<ReturnType, sync_method> >{ pool };
+}
+
+// Suspends the coroutine for the provided time, no thread is blocked
+// meanwhile: Optional<Error> error = co_await ut::Delay(reactor, pool, 10).
+//    @param reactor - reactor owning the timer.
+//    @param pool - thread pool to resume the coroutine in.
+//    @param timeout_ms - time to sleep in milliseconds.
+//    @return - awaitable object, the result of co_await is ut::Error
+//              if the reactor was destroyed before the timer expired.
+template<typename ReturnType, pool_sync::Method sync_method>
+coro_helper::ReactorAwaiter< ThreadPool<ReturnType, sync_method> > Delay(net::Reactor& reactor,
+                                                                          ThreadPool<ReturnType, sync_method>& pool,
+                                                                          uint32 timeout_ms)
+{
+	return coro_helper::ReactorAwaiter< ThreadPool<ReturnType, sync_method> >{ reactor,
+	                                                                            pool,
+	                                                                            nullptr,
+	                                                                            net::Reactor::Event::read,
+	                                                                            timeout_ms };
+}
+
+// Suspends the coroutine until the socket is ready for reading or writing,
+// no thread is blocked meanwhile:
+// Optional<Error> error = co_await ut::WaitSocket(reactor, pool, socket, net::Reactor::Event::read).
+//    @param reactor - reactor polling the socket.
+//    @param pool - thread pool to resume the coroutine in.
+//    @param socket - socket to wait for, must outlive the operation.
+//    @param event - type of the event to wait for.
+//    @return - awaitable object, the result of co_await is ut::Error if the
+//              socket was closed or the reactor was destroyed.
+template<typename ReturnType, pool_sync::Method sync_method>
+coro_helper::ReactorAwaiter< ThreadPool<ReturnType, sync_method> > WaitSocket(net::Reactor& reactor,
+                                                                               ThreadPool<ReturnType, sync_method>& pool,
+                                                                               const net::Socket& socket,
+                                                                               net::Reactor::Event event)
+{
+	return coro_helper::ReactorAwaiter< ThreadPool<ReturnType, sync_method> >{ reactor,
+	                                                                            pool,
+	                                                                            &socket,
+	                                                                            event,
+	                                                                            0 };
+}
+
+// Launches the coroutine in the provided thread pool.
+//    @param pool - thread pool to start the coroutine in, continuations
+//                  of the returned future are enqueued to this pool too.
+//    @param coro - coroutine to be launched.
+//    @return - future of the value returned by the coroutine.
+template<typename T, typename ReturnType, pool_sync::Method sync_method>
+Future<T> Spawn(ThreadPool<ReturnType, sync_method>& pool, Coro<T> coro)
+{
+	Promise<T> promise(pool);
+	Future<T> future = promise.GetFuture();
+	coro_helper::Launch(pool, Move(coro), Move(promise));
+	return future;
+}
+
+//----------------------------------------------------------------------------//
+END_NAMESPACE(ut)
+//----------------------------------------------------------------------------//
+#endif // CPP_STANDARD >= 2020
+//----------------------------------------------------------------------------//
+//----------------------------------------------------------------------------//
+//----------------------------------------------------------------------------//
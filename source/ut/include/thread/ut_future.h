@@ -0,0 +1,625 @@
+//----------------------------------------------------------------------------//
+//---------------------------------|  U  T  |---------------------------------//
+//----------------------------------------------------------------------------//
+#pragma once
+//----------------------------------------------------------------------------//
+#include "thread/ut_thread_pool.h"
+#include "thread/ut_atomic_thread_pool.h"
+#include "pointers/ut_shared_ptr.h"
+#include "error/ut_error.h"
+//----------------------------------------------------------------------------//
+START_NAMESPACE(ut)
+//----------------------------------------------------------------------------//
+// ut::Future is a template class providing access to the result of an
+// asynchronous operation, the result is set by the corresponding ut::Promise.
+template<typename T> class Future;
+
+// ut::Promise is a template class storing the result of an asynchronous
+// operation that is later acquired via ut::Future object.
+template<typename T> class Promise;
+
+// Returns a future that becomes ready when all provided futures are ready.
+template<typename T> Future<void> WhenAll(const Array< Future<T> >& futures);
+
+// Returns a future holding the index of the first ready future.
+template<typename T> Future<size_t> WhenAny(const Array< Future<T> >& futures);
+
+//----------------------------------------------------------------------------//
+namespace future_helper
+{
+	// Type of the unique pointer to the continuation task.
+	typedef UniquePtr< BaseTask<void> > UniqueTaskPtr;
+
+	// Function scheduling continuation tasks (usually to a thread pool).
+	typedef Function<void(UniqueTaskPtr)> Executor;
+
+	// Executor is shared between all futures of the chain.
+	typedef SharedPtr<Executor, thread_safety::Mode::on> ExecutorPtr;
+
+	// Creates executor enqueueing tasks to the provided thread pool,
+	// pool must outlive all futures using this executor.
+	//    @param pool - reference to the thread pool.
+	//    @return - shared pointer to the executor.
+	template<typename ReturnType, pool_sync::Method sync_method>
+	ExecutorPtr MakeExecutor(ThreadPool<ReturnType, sync_method>& pool)
+	{
+		return MakeSafeShared<Executor>([&pool](UniqueTaskPtr task) { pool.Enqueue(Move(task)); });
+	}
+
+	// Shared state of the promise and all its futures.
+	template<typename T>
+	class State : NonCopyable
+	{
+	public:
+		// Type of the stored result.
+		typedef Result<T, Error> ResultType;
+
+		// Constructor.
+		//    @param in_executor - executor for continuations, can be empty.
+		State(ExecutorPtr in_executor) : executor(Move(in_executor))
+		{}
+
+		// Stores the result and launches all attached continuations.
+		//    @param value - result of the operation.
+		//    @return - 'true' if result was set, 'false' if it
+		//              had been already set before.
+		bool Set(ResultType value)
+		{
+			Array<Callback> ready_callbacks;
+
+			{ // result can be set only once
+				ScopeLock lock(mutex);
+				if (result)
+				{
+					return false;
+				}
+
+				result = Move(value);
+				ready_callbacks = Move(callbacks);
+				cvar.WakeAll();
+			}
+
+			// callbacks are launched without the lock, result
+			// is never changed after it was set
+			const size_t callback_count = ready_callbacks.Count();
+			for (size_t i = 0; i < callback_count; i++)
+			{
+				Launch(ready_callbacks[i]);
+			}
+
+			return true;
+		}
+
+		// Attaches a task that is launched when the result is set,
+		// or launches it immediately if the result is already set.
+		//    @param task - unique pointer to the task.
+		//    @param schedule - 'true' to pass the task to the executor,
+		//                      'false' to execute it in the thread
+		//                      setting the result.
+		void AddCallback(UniqueTaskPtr task, bool schedule) const
+		{
+			Callback callback;
+			callback.task = Move(task);
+			callback.schedule = schedule;
+
+			{ // attach if not ready yet
+				ScopeLock lock(mutex);
+				if (!result)
+				{
+					callbacks.Add(Move(callback));
+					return;
+				}
+			}
+
+			Launch(callback);
+		}
+
+		// Blocks the current thread until the result is set.
+		//    @return - const reference to the result.
+		const ResultType& Wait() const
+		{
+			ScopeLock lock(mutex);
+			while (!result)
+			{
+				cvar.Wait(lock);
+			}
+			return result.Get();
+		}
+
+		// Returns the result, must be called only when it's set.
+		const ResultType& GetResult() const
+		{
+			UT_ASSERT(result);
+			return result.Get();
+		}
+
+		// Checks if the result is set.
+		bool IsReady() const
+		{
+			ScopeLock lock(mutex);
+			return result.HasValue();
+		}
+
+		// Returns executor for continuations.
+		const ExecutorPtr& GetExecutor() const
+		{
+			return executor;
+		}
+
+	private:
+		// Task waiting for the result.
+		struct Callback
+		{
+			UniqueTaskPtr task;
+			bool schedule;
+		};
+
+		// Executes the task or passes it to the executor.
+		//    @param callback - reference to the callback to be launched.
+		void Launch(Callback& callback) const
+		{
+			if (callback.schedule && executor)
+			{
+				executor.GetRef()(Move(callback.task));
+			}
+			else
+			{
+				callback.task->Execute();
+			}
+		}
+
+		// result of the operation, set only once
+		Optional<ResultType> result;
+
+		// tasks waiting for the result, can be attached to a constant state
+		mutable Array<Callback> callbacks;
+
+		// executor for continuations
+		ExecutorPtr executor;
+
+		// synchronization objects
+		mutable Mutex mutex;
+		mutable ConditionVariable cvar;
+	};
+
+	// Type of the value returned by the continuation @F of the future
+	// with a value of type @T.
+	template<typename T, typename F>
+	struct ContinuationResult
+	{
+		typedef decltype((*static_cast<F*>(nullptr))(*static_cast<const T*>(nullptr))) Type;
+	};
+
+	// Specialization of the ut::future_helper::ContinuationResult
+	// template for 'void' type.
+	template<typename F>
+	struct ContinuationResult<void, F>
+	{
+		typedef decltype((*static_cast<F*>(nullptr))()) Type;
+	};
+
+	// Calls the function and sets its return value to the promise.
+	template<typename U>
+	struct Fulfil
+	{
+		template<typename F, typename... Args>
+		static void Call(Promise<U>& promise, F& function, Args&... args)
+		{
+			promise.SetValue(function(args...));
+		}
+	};
+
+	// Specialization of the ut::future_helper::Fulfil template for
+	// 'void' type, the promise is set after the call. Type of the promise
+	// is a template parameter, because ut::Promise is not defined yet.
+	template<>
+	struct Fulfil<void>
+	{
+		template<typename PromiseType, typename F, typename... Args>
+		static void Call(PromiseType& promise, F& function, Args&... args)
+		{
+			function(args...);
+			promise.SetValue();
+		}
+	};
+
+	// Calls the continuation with the value of the antecedent future.
+	template<typename T>
+	struct Continue
+	{
+		template<typename U, typename F>
+		static void Call(Promise<U>& promise, F& function, const Result<T, Error>& result)
+		{
+			Fulfil<U>::Call(promise, function, result.Get());
+		}
+	};
+
+	// Specialization of the ut::future_helper::Continue template for
+	// 'void' type, the continuation has no arguments.
+	template<>
+	struct Continue<void>
+	{
+		template<typename U, typename F>
+		static void Call(Promise<U>& promise, F& function, const Result<void, Error>&)
+		{
+			Fulfil<U>::Call(promise, function);
+		}
+	};
+
+	// Task calling the continuation when the antecedent future is ready.
+	template<typename T, typename U, typename F> struct Continuation;
+}
+
+//----------------------------------------------------------------------------//
+// ut::Future is a template class providing access to the result of an
+// asynchronous operation. Future can be copied, all copies share the same
+// result. Dependent work must be attached with ut::Future::Then() rather than
+// waiting for the result: continuation is scheduled to the thread pool of the
+// promise as soon as the result is set, so no thread is blocked in between.
+template<typename T>
+class Future
+{
+	// Promise creates futures from its shared state.
+	template<typename> friend class Promise;
+
+	// Other futures access the shared state in Then().
+	template<typename> friend class Future;
+
+	// Helper functions attach internal callbacks.
+	template<typename U> friend Future<void> WhenAll(const Array< Future<U> >& futures);
+	template<typename U> friend Future<size_t> WhenAny(const Array< Future<U> >& futures);
+
+	// Type of the shared state.
+	typedef future_helper::State<T> StateType;
+	typedef SharedPtr<StateType, thread_safety::Mode::on> StatePtr;
+
+public:
+	// Constructor, creates invalid future without a shared state.
+	Future()
+	{}
+
+	// Checks if the future has a shared state.
+	bool IsValid() const
+	{
+		return state;
+	}
+
+	// Checks if the result is ready.
+	bool IsReady() const
+	{
+		UT_ASSERT(state);
+		return state->IsReady();
+	}
+
+	// Blocks the current thread until the result is ready. Avoid calling
+	// this function from the worker threads, use Then() instead.
+	//    @return - const reference to the result, valid while this
+	//              future object is alive.
+	const Result<T, Error>& Wait() const
+	{
+		UT_ASSERT(state);
+		return state->Wait();
+	}
+
+	// Attaches a continuation that is called with the value of this future
+	// when it's ready. If the future holds an error, the continuation isn't
+	// called and the error is passed to the returned future.
+	//    @param function - continuation, signature: U(const T& value), or
+	//                      U() if T is void.
+	//    @return - future of the value returned by @function.
+	template<typename F>
+	Future<typename future_helper::ContinuationResult<T, F>::Type> Then(F function) const
+	{
+		typedef typename future_helper::ContinuationResult<T, F>::Type ContinuationType;
+		typedef SharedPtr<Promise<ContinuationType>, thread_safety::Mode::on> PromisePtr;
+
+		UT_ASSERT(state);
+		PromisePtr promise(MakeSafeShared< Promise<ContinuationType> >(state->GetExecutor()));
+		Future<ContinuationType> future = promise->GetFuture();
+
+		future_helper::Continuation<T, ContinuationType, F> continuation(state, Move(promise), Move(function));
+		state->AddCallback(MakeUnique< Task<void()> >(Move(continuation)), true);
+
+		return future;
+	}
+
+private:
+	// Constructor.
+	//    @param in_state - shared state of the promise.
+	Future(StatePtr in_state) : state(Move(in_state))
+	{}
+
+	// shared state of the promise
+	StatePtr state;
+};
+
+//----------------------------------------------------------------------------//
+// ut::Promise is a template class storing the result of an asynchronous
+// operation, the result is acquired via ut::Future object. Promise is
+// fulfilled only once, if it's destroyed without a result - futures get
+// an error. Promise created with a thread pool passes continuations of
+// its futures to this pool.
+template<typename T>
+class Promise : NonCopyable
+{
+	// Type of the shared state.
+	typedef future_helper::State<T> StateType;
+	typedef SharedPtr<StateType, thread_safety::Mode::on> StatePtr;
+
+public:
+	// Constructor, continuations are executed in the
+	// thread that sets the result.
+	Promise() : state(MakeSafeShared<StateType>(future_helper::ExecutorPtr()))
+	{}
+
+	// Constructor, continuations are enqueued to the provided pool.
+	//    @param pool - thread pool to execute continuations in,
+	//                  must outlive all futures of this promise.
+	template<typename ReturnType, pool_sync::Method sync_method>
+	explicit Promise(ThreadPool<ReturnType, sync_method>& pool)
+		: state(MakeSafeShared<StateType>(future_helper::MakeExecutor(pool)))
+	{}
+
+	// Constructor, continuations are passed to the provided executor.
+	//    @param executor - shared pointer to the executor, can be empty.
+	explicit Promise(future_helper::ExecutorPtr executor) : state(MakeSafeShared<StateType>(Move(executor)))
+	{}
+
+	// Move constructor.
+	Promise(Promise&& other) noexcept : state(Move(other.state))
+	{
+		// moved ut::SharedPtr still points to the object,
+		// reset it to not break the promise in destructor
+		other.state.Reset();
+	}
+
+	// Move operator.
+	Promise& operator = (Promise&& other) noexcept
+	{
+		if (this != &other)
+		{
+			Break();
+			state = other.state;
+			other.state.Reset();
+		}
+		return *this;
+	}
+
+	// Destructor, futures get an error if the result wasn't set.
+	~Promise()
+	{
+		Break();
+	}
+
+	// Returns a future sharing the result with this promise.
+	Future<T> GetFuture() const
+	{
+		return Future<T>(state);
+	}
+
+	// Sets the result and launches continuations.
+	//    @param args - arguments to construct the value from,
+	//                  nothing for 'void' type.
+	//    @return - 'true' if result was set, 'false' if it
+	//              had been already set before.
+	template<typename... Args>
+	bool SetValue(Args&&... args)
+	{
+		return state->Set(typename StateType::ResultType(Forward<Args>(args)...));
+	}
+
+	// Sets an error and launches continuations.
+	//    @param error - error to be passed to the futures.
+	//    @return - 'true' if error was set, 'false' if the result
+	//              had been already set before.
+	bool SetError(Error error)
+	{
+		return state->Set(MakeError(Move(error)));
+	}
+
+private:
+	// Sets an error if the result wasn't set.
+	void Break()
+	{
+		if (state && !state->IsReady())
+		{
+			state->Set(MakeError(Error(error::fail, "broken promise")));
+		}
+	}
+
+	// shared state of the promise and all its futures
+	StatePtr state;
+};
+
+//----------------------------------------------------------------------------//
+namespace future_helper
+{
+	// Task calling the continuation when the antecedent future is ready.
+	// Members are mutable because ut::Function calls the functor
+	// via constant reference.
+	template<typename T, typename U, typename F>
+	struct Continuation
+	{
+		Continuation(SharedPtr<State<T>, thread_safety::Mode::on> in_source,
+		             SharedPtr<Promise<U>, thread_safety::Mode::on> in_promise,
+		             F in_function) : source(Move(in_source))
+		                            , promise(Move(in_promise))
+		                            , function(Move(in_function))
+		{}
+
+		void operator()() const
+		{
+			const Result<T, Error>& result = source->GetResult();
+			if (result)
+			{
+				Continue<T>::Call(promise.GetRef(), function, result);
+			}
+			else
+			{
+				promise->SetError(result.GetAlt());
+			}
+		}
+
+		SharedPtr<State<T>, thread_safety::Mode::on> source;
+		mutable SharedPtr<Promise<U>, thread_safety::Mode::on> promise;
+		mutable F function;
+	};
+
+	// Task calling the function enqueued with ut::Async().
+	template<typename U, typename F>
+	struct AsyncCall
+	{
+		AsyncCall(SharedPtr<Promise<U>, thread_safety::Mode::on> in_promise,
+		          F in_function) : promise(Move(in_promise))
+		                         , function(Move(in_function))
+		{}
+
+		void operator()() const
+		{
+			Fulfil<U>::Call(promise.GetRef(), function);
+		}
+
+		mutable SharedPtr<Promise<U>, thread_safety::Mode::on> promise;
+		mutable F function;
+	};
+
+	// Counter of the futures that are not ready yet, see ut::WhenAll().
+	struct WhenAllCounter : NonCopyable
+	{
+		WhenAllCounter(ExecutorPtr executor, int32 count) : promise(Move(executor))
+		                                                  , remaining(count)
+		{}
+
+		Promise<void> promise;
+		Atomic<int32> remaining;
+	};
+
+	// Callback of every future passed to ut::WhenAll().
+	template<typename T>
+	struct WhenAllCallback
+	{
+		WhenAllCallback(SharedPtr<State<T>, thread_safety::Mode::on> in_source,
+		                SharedPtr<WhenAllCounter, thread_safety::Mode::on> in_counter) : source(Move(in_source))
+		                                                                               , counter(Move(in_counter))
+		{}
+
+		void operator()() const
+		{
+			const Result<T, Error>& result = source->GetResult();
+			if (!result)
+			{
+				counter->promise.SetError(result.GetAlt());
+			}
+
+			if (counter->remaining.Decrement() == 0)
+			{
+				counter->promise.SetValue();
+			}
+		}
+
+		SharedPtr<State<T>, thread_safety::Mode::on> source;
+		mutable SharedPtr<WhenAllCounter, thread_safety::Mode::on> counter;
+	};
+
+	// Callback of every future passed to ut::WhenAny().
+	struct WhenAnyCallback
+	{
+		WhenAnyCallback(SharedPtr<Promise<size_t>, thread_safety::Mode::on> in_promise,
+		                size_t in_index) : promise(Move(in_promise))
+		                                 , index(in_index)
+		{}
+
+		void operator()() const
+		{
+			promise->SetValue(index);
+		}
+
+		mutable SharedPtr<Promise<size_t>, thread_safety::Mode::on> promise;
+		size_t index;
+	};
+}
+
+//----------------------------------------------------------------------------//
+// Enqueues provided function to the thread pool.
+//    @param pool - thread pool to execute @function in, also continuations of
+//                  the returned future are enqueued to this pool.
+//    @param function - function to be called, signature: U().
+//    @return - future of the value returned by @function.
+template<typename ReturnType, pool_sync::Method sync_method, typename F>
+Future<typename future_helper::ContinuationResult<void, F>::Type> Async(ThreadPool<ReturnType, sync_method>& pool,
+                                                                        F function)
+{
+	typedef typename future_helper::ContinuationResult<void, F>::Type ValueType;
+	SharedPtr<Promise<ValueType>, thread_safety::Mode::on> promise = MakeSafeShared< Promise<ValueType> >(pool);
+	Future<ValueType> future = promise->GetFuture();
+
+	future_helper::AsyncCall<ValueType, F> call(Move(promise), Move(function));
+	pool.Enqueue(MakeUnique< Task<void()> >(Move(call)));
+	return future;
+}
+
+//----------------------------------------------------------------------------//
+// Returns a future that becomes ready when all provided futures are ready.
+// If any of them holds an error, the first one is passed to the returned
+// future. Continuations of the returned future use the executor of the
+// first future in the array.
+//    @param futures - array of valid futures.
+//    @return - future without a value.
+template<typename T>
+Future<void> WhenAll(const Array< Future<T> >& futures)
+{
+	const size_t count = futures.Count();
+	SharedPtr<future_helper::WhenAllCounter, thread_safety::Mode::on> counter =
+		MakeSafeShared<future_helper::WhenAllCounter>(count == 0 ? future_helper::ExecutorPtr()
+		                                                         : futures[0].state->GetExecutor(),
+		                                              static_cast<int32>(count));
+	Future<void> result = counter->promise.GetFuture();
+	if (count == 0)
+	{
+		counter->promise.SetValue();
+		return result;
+	}
+
+	for (size_t i = 0; i < count; i++)
+	{
+		future_helper::WhenAllCallback<T> callback(futures[i].state, counter);
+		futures[i].state->AddCallback(MakeUnique< Task<void()> >(Move(callback)), false);
+	}
+
+	return result;
+}
+
+//----------------------------------------------------------------------------//
+// Returns a future holding the index of the first ready future, the result of
+// this future can be acquired via the provided array (it's ready, so it won't
+// block). Continuations of the returned future use the executor of the first
+// future in the array.
+//    @param futures - array of valid futures.
+//    @return - future of the index or error::empty if @futures is empty.
+template<typename T>
+Future<size_t> WhenAny(const Array< Future<T> >& futures)
+{
+	const size_t count = futures.Count();
+	SharedPtr<Promise<size_t>, thread_safety::Mode::on> promise =
+		MakeSafeShared< Promise<size_t> >(count == 0 ? future_helper::ExecutorPtr() : futures[0].state->GetExecutor());
+	Future<size_t> result = promise->GetFuture();
+	if (count == 0)
+	{
+		promise->SetError(Error(error::empty));
+		return result;
+	}
+
+	for (size_t i = 0; i < count; i++)
+	{
+		future_helper::WhenAnyCallback callback(promise, i);
+		futures[i].state->AddCallback(MakeUnique< Task<void()> >(Move(callback)), false);
+	}
+
+	return result;
+}
+
+//----------------------------------------------------------------------------//
+END_NAMESPACE(ut)
+//----------------------------------------------------------------------------//
+//----------------------------------------------------------------------------//
+//----------------------------------------------------------------------------//
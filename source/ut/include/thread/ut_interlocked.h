@@ -251,6 +251,18 @@ static inline void* CompareExchangePointer(void** dst, void* exchange, void* com
 #endif
 }
 
+// Full memory barrier, no load or store can be reordered across this call.
+static inline void Fence()
+{
+#if UT_WINDOWS
+	::MemoryBarrier();
+#elif UT_UNIX
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+#else
+#error ut::atomics::interlocked::Fence() is not implemented
+#endif
+}
+
 //----------------------------------------------------------------------------//
 END_NAMESPACE(interlocked)
 END_NAMESPACE(atomics)
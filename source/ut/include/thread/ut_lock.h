@@ -5,6 +5,8 @@
 //----------------------------------------------------------------------------//
 #include "common/ut_common.h"
 #include "thread/ut_mutex.h"
+#include "thread/ut_backoff.h"
+#include "system/ut_memory.h"
 //----------------------------------------------------------------------------//
 START_NAMESPACE(ut)
 //----------------------------------------------------------------------------//
@@ -155,6 +157,58 @@ private:
 	Access access;
 };
 
+//----------------------------------------------------------------------------//
+// ut::ShardedRWLock is a reader-writer lock for read-mostly data, it has the
+// same interface as ut::RWLock. Every thread is bound to one of the reader
+// counters (shards), each lying in a separate cache line, so readers from
+// different threads never write to the same memory and don't serialize on
+// one mutex. The price is paid by the writer: it has to wait until every shard
+// is empty. Writers have priority: new readers step back while the writer is
+// active and are parked on the writer mutex if waiting takes too long.
+// Lock and Unlock with 'read' access must be called from the same thread.
+class ShardedRWLock : public NonCopyable
+{
+public:
+	typedef RWLock::Access Access;
+
+	// Number of reader counters.
+	static const size_t skShardCount = 32;
+
+	// Constructor
+	ShardedRWLock();
+
+	// Locks section with 'RWLock::Access::write' access
+	void Lock();
+
+	// Unlocks section with 'RWLock::Access::write' access
+	void Unlock();
+
+	// Locks section with desired access
+	void Lock(Access access);
+
+	// Unlocks section with desired access
+	void Unlock(Access access);
+
+private:
+	// Counter of the readers, occupies the whole cache line.
+	struct alignas(memory::skCacheLineSize) Shard
+	{
+		int32 readers;
+	};
+
+	// Returns the shard of the current thread.
+	Shard& GetShard();
+
+	// reader counters, are modified atomically
+	Shard shards[skShardCount];
+
+	// indicates if there is an active writer, is modified atomically
+	alignas(memory::skCacheLineSize) int32 writer;
+
+	// serializes writers and parks readers waiting for the writer
+	Mutex writer_mutex;
+};
+
 //----------------------------------------------------------------------------//
 END_NAMESPACE(ut)
 //----------------------------------------------------------------------------//
@@ -0,0 +1,501 @@
+//----------------------------------------------------------------------------//
+//---------------------------------|  U  T  |---------------------------------//
+//----------------------------------------------------------------------------//
+#pragma once
+//----------------------------------------------------------------------------//
+#include "common/ut_common.h"
+#include "system/ut_memory.h"
+//----------------------------------------------------------------------------//
+#if UT_WINDOWS
+#include <intrin.h>
+#endif
+//----------------------------------------------------------------------------//
+// UT_DOUBLE_WIDTH_CAS is 1 if the platform can atomically compare and swap
+// an object of the size of two pointers (tagged pointers, pointer + counter).
+// 32-bit platforms use ordinary 64-bit operations, 64-bit platforms need
+// a special instruction (CMPXCHG16B) that is supported only on x64.
+#if UT_PLATFORM_32BITS || (UT_WINDOWS && defined(_M_X64)) || (UT_UNIX && defined(__x86_64__))
+#define UT_DOUBLE_WIDTH_CAS 1
+#else
+#define UT_DOUBLE_WIDTH_CAS 0
+#endif
+//----------------------------------------------------------------------------//
+START_NAMESPACE(ut)
+//----------------------------------------------------------------------------//
+// ut::memory_order::Type describes how memory accesses around an atomic
+// operation can be reordered, values have the same meaning as the values
+// of std::memory_order:
+//    @relaxed - operation is atomic, but doesn't order other accesses
+//    @acquire - accesses after the load can't be moved before it
+//    @release - accesses before the store can't be moved after it
+//    @acq_rel - both acquire and release, for read-modify-write operations
+//    @seq_cst - acquire and release plus a single total order of all
+//               sequentially consistent operations (full barrier)
+// Loads ignore the 'release' part of the order, stores ignore the 'acquire'
+// part, so one can pass the same order to every operation of the algorithm.
+namespace memory_order
+{
+	enum class Type
+	{
+		relaxed,
+		acquire,
+		release,
+		acq_rel,
+		seq_cst
+	};
+}
+
+//----------------------------------------------------------------------------//
+namespace atomic_helper
+{
+#if UT_UNIX
+	// Converts ut::memory_order::Type to the order of GCC atomic builtins.
+	inline int ToNativeOrder(memory_order::Type order)
+	{
+		switch (order)
+		{
+			case memory_order::Type::relaxed: return __ATOMIC_RELAXED;
+			case memory_order::Type::acquire: return __ATOMIC_ACQUIRE;
+			case memory_order::Type::release: return __ATOMIC_RELEASE;
+			case memory_order::Type::acq_rel: return __ATOMIC_ACQ_REL;
+			default: return __ATOMIC_SEQ_CST;
+		}
+	}
+
+	// Returns the order of GCC atomic builtins that is valid for loads.
+	inline int ToLoadOrder(memory_order::Type order)
+	{
+		switch (order)
+		{
+			case memory_order::Type::relaxed:
+			case memory_order::Type::release: return __ATOMIC_RELAXED;
+			case memory_order::Type::acquire:
+			case memory_order::Type::acq_rel: return __ATOMIC_ACQUIRE;
+			default: return __ATOMIC_SEQ_CST;
+		}
+	}
+
+	// Returns the order of GCC atomic builtins that is valid for stores.
+	inline int ToStoreOrder(memory_order::Type order)
+	{
+		switch (order)
+		{
+			case memory_order::Type::relaxed:
+			case memory_order::Type::acquire: return __ATOMIC_RELAXED;
+			case memory_order::Type::release:
+			case memory_order::Type::acq_rel: return __ATOMIC_RELEASE;
+			default: return __ATOMIC_SEQ_CST;
+		}
+	}
+
+	// Operations on the integer of the provided size, GCC builtins
+	// choose the instruction according to the memory order.
+	template<typename NativeType>
+	struct Operations
+	{
+		typedef NativeType Type;
+
+		static Type Load(const volatile Type* src, memory_order::Type order)
+		{
+			return __atomic_load_n(src, ToLoadOrder(order));
+		}
+
+		static void Store(volatile Type* dst, Type value, memory_order::Type order)
+		{
+			__atomic_store_n(dst, value, ToStoreOrder(order));
+		}
+
+		static Type Exchange(volatile Type* dst, Type value, memory_order::Type order)
+		{
+			return __atomic_exchange_n(dst, value, ToNativeOrder(order));
+		}
+
+		static bool CompareExchange(volatile Type* dst, Type& expected, Type desired, memory_order::Type order)
+		{
+			return __atomic_compare_exchange_n(dst, &expected, desired, false,
+			                                   ToNativeOrder(order), ToLoadOrder(order));
+		}
+
+		static Type FetchAdd(volatile Type* dst, Type value, memory_order::Type order)
+		{
+			return __atomic_fetch_add(dst, value, ToNativeOrder(order));
+		}
+
+		static Type FetchOr(volatile Type* dst, Type value, memory_order::Type order)
+		{
+			return __atomic_fetch_or(dst, value, ToNativeOrder(order));
+		}
+
+		static Type FetchAnd(volatile Type* dst, Type value, memory_order::Type order)
+		{
+			return __atomic_fetch_and(dst, value, ToNativeOrder(order));
+		}
+	};
+
+	// Integer types of the operations.
+	typedef uint8 Native8;
+	typedef uint16 Native16;
+	typedef uint32 Native32;
+	typedef uint64 Native64;
+#elif UT_WINDOWS
+	// Orders memory accesses around plain loads and stores, x86 and x64
+	// processors don't reorder them, so only the compiler must be stopped.
+	inline void Barrier()
+	{
+#if defined(_M_IX86) || defined(_M_X64)
+		_ReadWriteBarrier();
+#else
+		MemoryBarrier();
+#endif
+	}
+
+	// Overloads of interlocked intrinsics for every integer size,
+	// all of them are full barriers.
+	inline char Exchange(volatile char* dst, char value) { return _InterlockedExchange8(dst, value); }
+	inline short Exchange(volatile short* dst, short value) { return _InterlockedExchange16(dst, value); }
+	inline long Exchange(volatile long* dst, long value) { return _InterlockedExchange(dst, value); }
+	inline char CompareExchange(volatile char* dst, char exchange, char comparand) { return _InterlockedCompareExchange8(dst, exchange, comparand); }
+	inline short CompareExchange(volatile short* dst, short exchange, short comparand) { return _InterlockedCompareExchange16(dst, exchange, comparand); }
+	inline long CompareExchange(volatile long* dst, long exchange, long comparand) { return _InterlockedCompareExchange(dst, exchange, comparand); }
+	inline __int64 CompareExchange(volatile __int64* dst, __int64 exchange, __int64 comparand) { return _InterlockedCompareExchange64(dst, exchange, comparand); }
+	inline char FetchAdd(volatile char* dst, char value) { return _InterlockedExchangeAdd8(dst, value); }
+	inline short FetchAdd(volatile short* dst, short value) { return _InterlockedExchangeAdd16(dst, value); }
+	inline long FetchAdd(volatile long* dst, long value) { return _InterlockedExchangeAdd(dst, value); }
+	inline char FetchOr(volatile char* dst, char value) { return _InterlockedOr8(dst, value); }
+	inline short FetchOr(volatile short* dst, short value) { return _InterlockedOr16(dst, value); }
+	inline long FetchOr(volatile long* dst, long value) { return _InterlockedOr(dst, value); }
+	inline char FetchAnd(volatile char* dst, char value) { return _InterlockedAnd8(dst, value); }
+	inline short FetchAnd(volatile short* dst, short value) { return _InterlockedAnd16(dst, value); }
+	inline long FetchAnd(volatile long* dst, long value) { return _InterlockedAnd(dst, value); }
+#if UT_PLATFORM_64BITS
+	inline __int64 Exchange(volatile __int64* dst, __int64 value) { return _InterlockedExchange64(dst, value); }
+	inline __int64 FetchAdd(volatile __int64* dst, __int64 value) { return _InterlockedExchangeAdd64(dst, value); }
+	inline __int64 FetchOr(volatile __int64* dst, __int64 value) { return _InterlockedOr64(dst, value); }
+	inline __int64 FetchAnd(volatile __int64* dst, __int64 value) { return _InterlockedAnd64(dst, value); }
+#else
+	// No explicit instructions for 64-bit operations on 32-bit processors;
+	// have to be implemented in terms of CMPXCHG8B
+	inline __int64 Exchange(volatile __int64* dst, __int64 value)
+	{
+		__int64 old_val = *dst;
+		for (__int64 prev; (prev = CompareExchange(dst, value, old_val)) != old_val; old_val = prev);
+		return old_val;
+	}
+
+	inline __int64 FetchAdd(volatile __int64* dst, __int64 value)
+	{
+		__int64 old_val = *dst;
+		for (__int64 prev; (prev = CompareExchange(dst, old_val + value, old_val)) != old_val; old_val = prev);
+		return old_val;
+	}
+
+	inline __int64 FetchOr(volatile __int64* dst, __int64 value)
+	{
+		__int64 old_val = *dst;
+		for (__int64 prev; (prev = CompareExchange(dst, old_val | value, old_val)) != old_val; old_val = prev);
+		return old_val;
+	}
+
+	inline __int64 FetchAnd(volatile __int64* dst, __int64 value)
+	{
+		__int64 old_val = *dst;
+		for (__int64 prev; (prev = CompareExchange(dst, old_val & value, old_val)) != old_val; old_val = prev);
+		return old_val;
+	}
+#endif
+
+	// Operations on the integer of the provided size. Interlocked intrinsics
+	// are full barriers on x86 and x64, so the order matters only for
+	// plain loads and stores.
+	template<typename NativeType>
+	struct Operations
+	{
+		typedef NativeType Type;
+
+		static Type Load(const volatile Type* src, memory_order::Type order)
+		{
+			// plain 64-bit loads are not atomic on 32-bit processors
+			if (sizeof(Type) > sizeof(void*))
+			{
+				return atomic_helper::CompareExchange(const_cast<volatile Type*>(src), Type(0), Type(0));
+			}
+
+			const Type value = *src;
+			if (order != memory_order::Type::relaxed)
+			{
+				Barrier();
+			}
+			return value;
+		}
+
+		static void Store(volatile Type* dst, Type value, memory_order::Type order)
+		{
+			if (sizeof(Type) > sizeof(void*) || order == memory_order::Type::seq_cst)
+			{
+				atomic_helper::Exchange(dst, value);
+				return;
+			}
+
+			if (order != memory_order::Type::relaxed)
+			{
+				Barrier();
+			}
+			*dst = value;
+		}
+
+		static Type Exchange(volatile Type* dst, Type value, memory_order::Type)
+		{
+			return atomic_helper::Exchange(dst, value);
+		}
+
+		static bool CompareExchange(volatile Type* dst, Type& expected, Type desired, memory_order::Type)
+		{
+			const Type comparand = expected;
+			expected = atomic_helper::CompareExchange(dst, desired, comparand);
+			return expected == comparand;
+		}
+
+		static Type FetchAdd(volatile Type* dst, Type value, memory_order::Type)
+		{
+			return atomic_helper::FetchAdd(dst, value);
+		}
+
+		static Type FetchOr(volatile Type* dst, Type value, memory_order::Type)
+		{
+			return atomic_helper::FetchOr(dst, value);
+		}
+
+		static Type FetchAnd(volatile Type* dst, Type value, memory_order::Type)
+		{
+			return atomic_helper::FetchAnd(dst, value);
+		}
+	};
+
+	// Integer types of the operations.
+	typedef char Native8;
+	typedef short Native16;
+	typedef long Native32;
+	typedef __int64 Native64;
+#else
+	#error ut::atomic_helper::Operations are not implemented
+#endif
+
+#if UT_DOUBLE_WIDTH_CAS && UT_PLATFORM_64BITS
+	// Object of the size of two pointers.
+	struct alignas(16) DoubleWord
+	{
+		uint64 low;
+		uint64 high;
+	};
+
+	// Compares @dst with @expected and replaces it with @desired if they are
+	// equal, otherwise @expected receives the current value. Full barrier.
+	inline bool CompareExchangeDoubleWord(volatile DoubleWord* dst, DoubleWord& expected, DoubleWord desired)
+	{
+#if UT_WINDOWS
+		return _InterlockedCompareExchange128(reinterpret_cast<volatile __int64*>(dst),
+		                                      static_cast<__int64>(desired.high),
+		                                      static_cast<__int64>(desired.low),
+		                                      reinterpret_cast<__int64*>(&expected)) != 0;
+#elif UT_UNIX
+		bool result;
+		__asm__ __volatile__("lock cmpxchg16b %1\n\t"
+		                     "setz %0"
+		                     : "=q"(result), "+m"(*dst), "+a"(expected.low), "+d"(expected.high)
+		                     : "b"(desired.low), "c"(desired.high)
+		                     : "cc", "memory");
+		return result;
+#else
+		#error ut::atomic_helper::CompareExchangeDoubleWord() is not implemented
+#endif
+	}
+
+	// Operations on the double word, everything is implemented
+	// in terms of the double-width compare-and-swap.
+	struct DoubleWordOperations
+	{
+		typedef DoubleWord Type;
+
+		static Type Load(const volatile Type* src, memory_order::Type)
+		{
+			// writes the same value back if it's zero, so the memory
+			// must be writable even if the object is only read
+			Type expected = { 0, 0 };
+			CompareExchangeDoubleWord(const_cast<volatile Type*>(src), expected, expected);
+			return expected;
+		}
+
+		static void Store(volatile Type* dst, Type value, memory_order::Type order)
+		{
+			Exchange(dst, value, order);
+		}
+
+		static Type Exchange(volatile Type* dst, Type value, memory_order::Type)
+		{
+			Type expected = { 0, 0 };
+			while (!CompareExchangeDoubleWord(dst, expected, value));
+			return expected;
+		}
+
+		static bool CompareExchange(volatile Type* dst, Type& expected, Type desired, memory_order::Type)
+		{
+			return CompareExchangeDoubleWord(dst, expected, desired);
+		}
+	};
+#endif
+
+	// Operations for the objects of the provided size.
+	template<size_t size> struct Native;
+	template<> struct Native<1> : Operations<Native8> {};
+	template<> struct Native<2> : Operations<Native16> {};
+	template<> struct Native<4> : Operations<Native32> {};
+	template<> struct Native<8> : Operations<Native64> {};
+#if UT_DOUBLE_WIDTH_CAS && UT_PLATFORM_64BITS
+	template<> struct Native<16> : DoubleWordOperations {};
+#endif
+
+	// Reinterprets the object as the integer of the same size.
+	template<typename T>
+	typename Native<sizeof(T)>::Type ToNative(const T& value)
+	{
+		typename Native<sizeof(T)>::Type result;
+		memory::Copy(&result, &value, sizeof(T));
+		return result;
+	}
+
+	// Reinterprets the integer as the object of the same size.
+	template<typename T>
+	T FromNative(const typename Native<sizeof(T)>::Type& value)
+	{
+		T result;
+		memory::Copy(&result, &value, sizeof(T));
+		return result;
+	}
+
+	// Reinterprets the pointer to the object as the pointer to the integer.
+	template<typename T>
+	volatile typename Native<sizeof(T)>::Type* ToNativePtr(volatile T* ptr)
+	{
+		return reinterpret_cast<volatile typename Native<sizeof(T)>::Type*>(ptr);
+	}
+}
+
+//----------------------------------------------------------------------------//
+// Atomic operations with explicit memory order on the objects of 1, 2, 4
+// and 8 bytes (and of the size of two pointers if UT_DOUBLE_WIDTH_CAS is 1).
+// The object must be aligned to its size. Objects are compared bytewise, so
+// structures must not have padding. Use them in lock-free algorithms instead
+// of ut::atomics::interlocked functions when a full barrier is not needed.
+START_NAMESPACE(atomics)
+START_NAMESPACE(ordered)
+//----------------------------------------------------------------------------//
+// Atomically loads the value.
+//    @param src - pointer to the object.
+//    @param order - memory order.
+//    @return - loaded value.
+template<typename T>
+inline T Load(const volatile T* src, memory_order::Type order = memory_order::Type::seq_cst)
+{
+	typedef atomic_helper::Native<sizeof(T)> Ops;
+	return atomic_helper::FromNative<T>(Ops::Load(atomic_helper::ToNativePtr(const_cast<volatile T*>(src)), order));
+}
+
+// Atomically stores the value.
+//    @param dst - pointer to the object.
+//    @param value - value to store.
+//    @param order - memory order.
+template<typename T>
+inline void Store(volatile T* dst, const T& value, memory_order::Type order = memory_order::Type::seq_cst)
+{
+	typedef atomic_helper::Native<sizeof(T)> Ops;
+	Ops::Store(atomic_helper::ToNativePtr(dst), atomic_helper::ToNative(value), order);
+}
+
+// Atomically replaces the value.
+//    @param dst - pointer to the object.
+//    @param value - new value.
+//    @param order - memory order.
+//    @return - previous value.
+template<typename T>
+inline T Exchange(volatile T* dst, const T& value, memory_order::Type order = memory_order::Type::seq_cst)
+{
+	typedef atomic_helper::Native<sizeof(T)> Ops;
+	return atomic_helper::FromNative<T>(Ops::Exchange(atomic_helper::ToNativePtr(dst),
+	                                                  atomic_helper::ToNative(value),
+	                                                  order));
+}
+
+// Atomically replaces the value with @desired if it's equal to @expected.
+//    @param dst - pointer to the object.
+//    @param expected - expected value, receives the current value if
+//                      the values are not equal.
+//    @param desired - new value.
+//    @param order - memory order of the successful exchange, the failed
+//                   one is a load with the same order.
+//    @return - 'true' if the value was replaced.
+template<typename T>
+inline bool CompareExchange(volatile T* dst, T& expected, const T& desired,
+                            memory_order::Type order = memory_order::Type::seq_cst)
+{
+	typedef atomic_helper::Native<sizeof(T)> Ops;
+	typename Ops::Type native_expected = atomic_helper::ToNative(expected);
+	const bool exchanged = Ops::CompareExchange(atomic_helper::ToNativePtr(dst),
+	                                            native_expected,
+	                                            atomic_helper::ToNative(desired),
+	                                            order);
+	if (!exchanged)
+	{
+		expected = atomic_helper::FromNative<T>(native_expected);
+	}
+	return exchanged;
+}
+
+// Atomically adds the value, is available only for integers.
+//    @param dst - pointer to the integer.
+//    @param value - value to add.
+//    @param order - memory order.
+//    @return - previous value.
+template<typename T>
+inline T FetchAdd(volatile T* dst, T value, memory_order::Type order = memory_order::Type::seq_cst)
+{
+	typedef atomic_helper::Native<sizeof(T)> Ops;
+	return atomic_helper::FromNative<T>(Ops::FetchAdd(atomic_helper::ToNativePtr(dst),
+	                                                  atomic_helper::ToNative(value),
+	                                                  order));
+}
+
+// Atomically performs bitwise OR, is available only for integers.
+//    @param dst - pointer to the integer.
+//    @param value - second operand.
+//    @param order - memory order.
+//    @return - previous value.
+template<typename T>
+inline T FetchOr(volatile T* dst, T value, memory_order::Type order = memory_order::Type::seq_cst)
+{
+	typedef atomic_helper::Native<sizeof(T)> Ops;
+	return atomic_helper::FromNative<T>(Ops::FetchOr(atomic_helper::ToNativePtr(dst),
+	                                                 atomic_helper::ToNative(value),
+	                                                 order));
+}
+
+// Atomically performs bitwise AND, is available only for integers.
+//    @param dst - pointer to the integer.
+//    @param value - second operand.
+//    @param order - memory order.
+//    @return - previous value.
+template<typename T>
+inline T FetchAnd(volatile T* dst, T value, memory_order::Type order = memory_order::Type::seq_cst)
+{
+	typedef atomic_helper::Native<sizeof(T)> Ops;
+	return atomic_helper::FromNative<T>(Ops::FetchAnd(atomic_helper::ToNativePtr(dst),
+	                                                  atomic_helper::ToNative(value),
+	                                                  order));
+}
+
+//----------------------------------------------------------------------------//
+END_NAMESPACE(ordered)
+END_NAMESPACE(atomics)
+END_NAMESPACE(ut)
+//----------------------------------------------------------------------------//
+//----------------------------------------------------------------------------//
+//----------------------------------------------------------------------------//
@@ -0,0 +1,164 @@
+//----------------------------------------------------------------------------//
+//---------------------------------|  U  T  |---------------------------------//
+//----------------------------------------------------------------------------//
+#pragma once
+//----------------------------------------------------------------------------//
+#include "thread/ut_interlocked.h"
+#include "thread/ut_memory_order.h"
+#include "containers/ut_array.h"
+#include "system/ut_memory.h"
+//----------------------------------------------------------------------------//
+START_NAMESPACE(ut)
+//----------------------------------------------------------------------------//
+// ut::MpmcQueue is a bounded lock-free queue with multiple producers and
+// multiple consumers (D. Vyukov's algorithm). Every cell of the ring buffer
+// holds a sequence number telling whether the cell is ready to be written
+// (sequence == position) or read (sequence == position + 1). Producers and
+// consumers reserve a position with a single CompareExchange operation, so
+// both Push() and Pop() complete in O(1) without locks when there is no
+// contention. Cells and positions are padded to the cache line size to
+// avoid false sharing between producers and consumers. The sequence number
+// of the cell is published with a release store and read with an acquire
+// load, so no full barrier is needed to pass the element; reservations of
+// positions stay full barriers, thread pools rely on them to park workers.
+template<typename T>
+class MpmcQueue : NonCopyable
+{
+public:
+	// Constructor.
+	//    @param capacity - maximum number of elements, must be a power of two.
+	MpmcQueue(size_t capacity = 1024) : cells(capacity)
+	                                  , mask(capacity - 1)
+	                                  , enqueue_position(0)
+	                                  , dequeue_position(0)
+	{
+		UT_ASSERT(capacity >= 2 && (capacity & (capacity - 1)) == 0);
+		UT_ASSERT(reinterpret_cast<uptr>(cells.GetAddress()) % memory::skCacheLineSize == 0);
+		for (size_t i = 0; i < capacity; i++)
+		{
+			cells[i].sequence = static_cast<int64>(i);
+		}
+	}
+
+	// Adds a new element to the end of the queue.
+	//    @param element - reference to the element to be moved into the
+	//                     queue, it's left untouched if the queue is full.
+	//    @return - 'true' if element was added or 'false' if queue is full.
+	bool Push(T& element)
+	{
+		Cell* cell;
+		int64 position = atomics::ordered::Load(&enqueue_position, memory_order::Type::relaxed);
+		while (true)
+		{
+			cell = &cells[static_cast<size_t>(position) & mask];
+			const int64 sequence = atomics::ordered::Load(&cell->sequence, memory_order::Type::acquire);
+			const int64 diff = sequence - position;
+			if (diff == 0)
+			{
+				// cell is free, try to reserve it
+				const int64 prev = atomics::interlocked::CompareExchange(&enqueue_position,
+				                                                         position + 1,
+				                                                         position);
+				if (prev == position)
+				{
+					break;
+				}
+				position = prev;
+			}
+			else if (diff < 0)
+			{
+				// the cell wasn't read yet after the previous lap
+				return false;
+			}
+			else // another producer has reserved the cell
+			{
+				position = atomics::ordered::Load(&enqueue_position, memory_order::Type::relaxed);
+			}
+		}
+
+		cell->data = Move(element);
+		atomics::ordered::Store(&cell->sequence, position + 1, memory_order::Type::release);
+		return true;
+	}
+
+	// Extracts the first element of the queue.
+	//    @return - element or nothing if queue is empty.
+	Optional<T> Pop()
+	{
+		Cell* cell;
+		int64 position = atomics::ordered::Load(&dequeue_position, memory_order::Type::relaxed);
+		while (true)
+		{
+			cell = &cells[static_cast<size_t>(position) & mask];
+			const int64 sequence = atomics::ordered::Load(&cell->sequence, memory_order::Type::acquire);
+			const int64 diff = sequence - (position + 1);
+			if (diff == 0)
+			{
+				// cell is written, try to reserve it
+				const int64 prev = atomics::interlocked::CompareExchange(&dequeue_position,
+				                                                         position + 1,
+				                                                         position);
+				if (prev == position)
+				{
+					break;
+				}
+				position = prev;
+			}
+			else if (diff < 0)
+			{
+				// the cell wasn't written yet
+				return Optional<T>();
+			}
+			else // another consumer has reserved the cell
+			{
+				position = atomics::ordered::Load(&dequeue_position, memory_order::Type::relaxed);
+			}
+		}
+
+		Optional<T> element(Move(cell->data));
+		atomics::ordered::Store(&cell->sequence,
+		                        position + static_cast<int64>(mask) + 1,
+		                        memory_order::Type::release);
+		return element;
+	}
+
+	// Checks if there are elements reserved by producers and not yet
+	// reserved by consumers. Returned value can be changed by another
+	// thread right after the call.
+	bool IsEmpty() const
+	{
+		return atomics::interlocked::Read(&enqueue_position) <=
+		       atomics::interlocked::Read(&dequeue_position);
+	}
+
+	// Returns maximum number of elements in the queue.
+	size_t GetCapacity() const
+	{
+		return mask + 1;
+	}
+
+private:
+	// Element of the ring buffer.
+	struct alignas(memory::skCacheLineSize) Cell
+	{
+		int64 sequence;
+		T data;
+	};
+
+	// ring buffer, capacity is always a power of two, cells are over-aligned
+	// so the default allocator can't be used
+	Array<Cell, AlignedAllocator<Cell, memory::skCacheLineSize> > cells;
+	const size_t mask;
+
+	// position of the next element to be pushed
+	alignas(memory::skCacheLineSize) int64 enqueue_position;
+
+	// position of the next element to be popped
+	alignas(memory::skCacheLineSize) int64 dequeue_position;
+};
+
+//----------------------------------------------------------------------------//
+END_NAMESPACE(ut)
+//----------------------------------------------------------------------------//
+//----------------------------------------------------------------------------//
+//----------------------------------------------------------------------------//
@@ -6,14 +6,23 @@
 //  This file is a set of all header files for multithreading techniques.
 //----------------------------------------------------------------------------//
 #include "thread/ut_interlocked.h"
+#include "thread/ut_memory_order.h"
 #include "thread/ut_atomic.h"
 #include "thread/ut_mutex.h"
 #include "thread/ut_condition_variable.h"
 #include "thread/ut_lock.h"
 #include "thread/ut_sync.h"
+#include "thread/ut_seq_lock.h"
 #include "thread/ut_thread.h"
+#include "thread/ut_work_stealing_queue.h"
+#include "thread/ut_backoff.h"
+#include "thread/ut_mpmc_queue.h"
 #include "thread/ut_thread_pool.h"
 #include "thread/ut_atomic_thread_pool.h"
+#include "thread/ut_parallel.h"
+#include "thread/ut_future.h"
+#include "thread/ut_task_graph.h"
+#include "thread/ut_coroutine.h"
 
 //----------------------------------------------------------------------------//
 //----------------------------------------------------------------------------//
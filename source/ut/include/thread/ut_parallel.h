@@ -0,0 +1,529 @@
+//----------------------------------------------------------------------------//
+//---------------------------------|  U  T  |---------------------------------//
+//----------------------------------------------------------------------------//
+#pragma once
+//----------------------------------------------------------------------------//
+#include "thread/ut_thread_pool.h"
+#include "thread/ut_atomic_thread_pool.h"
+#include "error/ut_error.h"
+#include "templates/ut_remove_ref.h"
+//----------------------------------------------------------------------------//
+START_NAMESPACE(ut)
+//----------------------------------------------------------------------------//
+// Data-parallel algorithms on top of ut::ThreadPool. A range is split in
+// halves recursively until it's smaller than the grain size, one half is
+// enqueued to the pool and the other one is processed in the current thread.
+// ut::Scheduler::WaitForCompletion() processes pending tasks when called
+// inside a worker, so the recursion doesn't block worker threads. Only one
+// task is allocated per split, not per element.
+namespace parallel_helper
+{
+	// Number of elements sorted with insertion sort in ut::ParallelSort().
+	static const size_t skInsertionSortThreshold = 32;
+
+	// Number of pieces per thread when the grain size isn't specified,
+	// several pieces per thread make the load balanced if elements
+	// need different time to process.
+	static const size_t skPiecesPerThread = 8;
+
+	// Returns grain size for the range of @count elements.
+	//    @param count - number of elements in the range.
+	//    @param thread_count - number of threads in the pool.
+	//    @param grain - desired grain size, 0 to calculate automatically.
+	//    @return - grain size, always > 0.
+	inline size_t GetGrain(size_t count, size_t thread_count, size_t grain)
+	{
+		if (grain != 0)
+		{
+			return grain;
+		}
+
+		const size_t pieces = (thread_count == 0 ? 1 : thread_count) * skPiecesPerThread;
+		const size_t auto_grain = count / pieces;
+		return auto_grain == 0 ? 1 : auto_grain;
+	}
+
+	// Recursively splits the range [@begin, @end) and calls @body(begin, end)
+	// for every piece not bigger than @grain.
+	template<pool_sync::Method sync_method, typename Body>
+	void ForRange(ThreadPool<void, sync_method>& pool,
+	              size_t begin,
+	              size_t end,
+	              size_t grain,
+	              Body& body)
+	{
+		if (end - begin <= grain)
+		{
+			body(begin, end);
+			return;
+		}
+
+		const size_t middle = begin + (end - begin) / 2;
+		auto scheduler = pool.CreateScheduler();
+		scheduler.Enqueue(MakeUnique< Task<void()> >([&pool, middle, end, grain, &body]
+		{
+			ForRange(pool, middle, end, grain, body);
+		}));
+		ForRange(pool, begin, middle, grain, body);
+		scheduler.WaitForCompletion();
+	}
+
+	// Recursively splits the range [@begin, @end) and reduces results
+	// of @map(i) for every element with @reduce(left, right) keeping
+	// the order of the elements.
+	template<typename T, pool_sync::Method sync_method, typename Map, typename Reduce>
+	T ReduceRange(ThreadPool<void, sync_method>& pool,
+	              size_t begin,
+	              size_t end,
+	              size_t grain,
+	              const T& identity,
+	              Map& map,
+	              Reduce& reduce)
+	{
+		if (end - begin <= grain)
+		{
+			T result(identity);
+			for (size_t i = begin; i < end; i++)
+			{
+				result = reduce(result, map(i));
+			}
+			return result;
+		}
+
+		const size_t middle = begin + (end - begin) / 2;
+		T right(identity);
+		auto scheduler = pool.CreateScheduler();
+		scheduler.Enqueue(MakeUnique< Task<void()> >([&]
+		{
+			right = ReduceRange(pool, middle, end, grain, identity, map, reduce);
+		}));
+		T left = ReduceRange(pool, begin, middle, grain, identity, map, reduce);
+		scheduler.WaitForCompletion();
+		return reduce(left, right);
+	}
+
+	// Sorts @count elements of @data with insertion sort.
+	template<typename T, typename Less>
+	void InsertionSort(T* data, size_t count, Less& less)
+	{
+		for (size_t i = 1; i < count; i++)
+		{
+			T element(Move(data[i]));
+			size_t j = i;
+			for (; j > 0 && less(element, data[j - 1]); j--)
+			{
+				data[j] = Move(data[j - 1]);
+			}
+			data[j] = Move(element);
+		}
+	}
+
+	// Stable merge sort of @count elements of @data, @buffer is a temporary
+	// storage of the same size. Halves bigger than @grain are sorted in
+	// parallel, merging is performed in the current thread.
+	template<typename T, pool_sync::Method sync_method, typename Less>
+	void MergeSort(ThreadPool<void, sync_method>& pool,
+	               T* data,
+	               T* buffer,
+	               size_t count,
+	               size_t grain,
+	               Less& less)
+	{
+		if (count <= skInsertionSortThreshold)
+		{
+			InsertionSort(data, count, less);
+			return;
+		}
+
+		const size_t middle = count / 2;
+		if (count > grain)
+		{
+			auto scheduler = pool.CreateScheduler();
+			scheduler.Enqueue(MakeUnique< Task<void()> >([&]
+			{
+				MergeSort(pool, data + middle, buffer + middle, count - middle, grain, less);
+			}));
+			MergeSort(pool, data, buffer, middle, grain, less);
+			scheduler.WaitForCompletion();
+		}
+		else
+		{
+			MergeSort(pool, data, buffer, middle, grain, less);
+			MergeSort(pool, data + middle, buffer + middle, count - middle, grain, less);
+		}
+
+		// halves are already in order
+		if (!less(data[middle], data[middle - 1]))
+		{
+			return;
+		}
+
+		// merge to the buffer, left element goes first if equal
+		size_t left = 0;
+		size_t right = middle;
+		size_t out = 0;
+		while (left < middle && right < count)
+		{
+			buffer[out++] = less(data[right], data[left]) ? Move(data[right++]) : Move(data[left++]);
+		}
+		while (left < middle)
+		{
+			buffer[out++] = Move(data[left++]);
+		}
+		while (right < count)
+		{
+			buffer[out++] = Move(data[right++]);
+		}
+
+		for (size_t i = 0; i < count; i++)
+		{
+			data[i] = Move(buffer[i]);
+		}
+	}
+
+	// Default comparison for ut::ParallelSort().
+	template<typename T>
+	struct DefaultLess
+	{
+		bool operator()(const T& left, const T& right) const
+		{
+			return left < right;
+		}
+	};
+
+	// Default key for ut::ParallelRadixSort(), element is the key itself.
+	template<typename T>
+	struct IdentityKey
+	{
+		T operator()(const T& element) const
+		{
+			return element;
+		}
+	};
+}
+
+//----------------------------------------------------------------------------//
+// Calls @body(i) for every index i in range [@begin, @end) in parallel.
+//    @param pool - thread pool to process elements in.
+//    @param begin - index of the first element.
+//    @param end - index of the element after the last one.
+//    @param body - function to be called for every index,
+//                  signature: void(size_t index).
+//    @param grain - maximum number of indices processed by one task,
+//                   0 to calculate it from the number of threads.
+template<pool_sync::Method sync_method, typename Body>
+void ParallelFor(ThreadPool<void, sync_method>& pool,
+                 size_t begin,
+                 size_t end,
+                 Body body,
+                 size_t grain = 0)
+{
+	if (end <= begin)
+	{
+		return;
+	}
+
+	auto range_body = [&body](size_t range_begin, size_t range_end)
+	{
+		for (size_t i = range_begin; i < range_end; i++)
+		{
+			body(i);
+		}
+	};
+
+	grain = parallel_helper::GetGrain(end - begin, pool.GetThreadCount(), grain);
+	parallel_helper::ForRange(pool, begin, end, grain, range_body);
+}
+
+//----------------------------------------------------------------------------//
+// Reduces values @map(i) for every index i in range [@begin, @end) in
+// parallel. @reduce must be associative, but needn't be commutative:
+// operands are always combined in the order of indices.
+//    @param pool - thread pool to process elements in.
+//    @param begin - index of the first element.
+//    @param end - index of the element after the last one.
+//    @param identity - identity element of @reduce, the result for
+//                      an empty range.
+//    @param map - function returning a value for the index,
+//                 signature: T(size_t index).
+//    @param reduce - function combining two values,
+//                    signature: T(const T& left, const T& right).
+//    @param grain - maximum number of indices processed by one task,
+//                   0 to calculate it from the number of threads.
+//    @return - reduced value.
+template<typename T, pool_sync::Method sync_method, typename Map, typename Reduce>
+T ParallelReduce(ThreadPool<void, sync_method>& pool,
+                 size_t begin,
+                 size_t end,
+                 const T& identity,
+                 Map map,
+                 Reduce reduce,
+                 size_t grain = 0)
+{
+	if (end <= begin)
+	{
+		return identity;
+	}
+
+	grain = parallel_helper::GetGrain(end - begin, pool.GetThreadCount(), grain);
+	return parallel_helper::ReduceRange(pool, begin, end, grain, identity, map, reduce);
+}
+
+//----------------------------------------------------------------------------//
+// Calculates inclusive prefix scan of @input in parallel: output[i] is
+// @op(input[0], ..., input[i]). @op must be associative. Scan is performed
+// in two passes: totals of the blocks are calculated in parallel, then every
+// block is scanned in parallel starting from the total of previous blocks.
+//    @param pool - thread pool to process elements in.
+//    @param input - source array.
+//    @param output - array to store results in, is resized to the size
+//                    of @input, can be the same object as @input.
+//    @param identity - identity element of @op.
+//    @param op - function combining two values,
+//                signature: T(const T& left, const T& right).
+//    @param grain - minimum number of elements in a block,
+//                   0 to calculate it from the number of threads.
+//    @return - ut::Error if failed to allocate memory.
+template<typename T, pool_sync::Method sync_method, typename Operation>
+Optional<Error> ParallelScan(ThreadPool<void, sync_method>& pool,
+                             const Array<T>& input,
+                             Array<T>& output,
+                             const T& identity,
+                             Operation op,
+                             size_t grain = 0)
+{
+	const size_t count = input.Count();
+	if (&output != &input && !output.Resize(count))
+	{
+		return Error(error::out_of_memory);
+	}
+
+	if (count == 0)
+	{
+		return Optional<Error>();
+	}
+
+	grain = parallel_helper::GetGrain(count, pool.GetThreadCount(), grain);
+	const size_t block_count = (count + grain - 1) / grain;
+	Array<T> totals;
+	if (!totals.Resize(block_count))
+	{
+		return Error(error::out_of_memory);
+	}
+
+	// the first pass, totals of all blocks
+	ParallelFor(pool, 0, block_count, [&](size_t block)
+	{
+		const size_t block_end = block * grain + grain < count ? block * grain + grain : count;
+		T total(identity);
+		for (size_t i = block * grain; i < block_end; i++)
+		{
+			total = op(total, input[i]);
+		}
+		totals[block] = Move(total);
+	}, 1);
+
+	// exclusive scan of the totals
+	T offset(identity);
+	for (size_t block = 0; block < block_count; block++)
+	{
+		T block_total(Move(totals[block]));
+		totals[block] = offset;
+		offset = op(offset, block_total);
+	}
+
+	// the second pass, every block starts from the total of previous blocks
+	ParallelFor(pool, 0, block_count, [&](size_t block)
+	{
+		const size_t block_end = block * grain + grain < count ? block * grain + grain : count;
+		T accumulator(totals[block]);
+		for (size_t i = block * grain; i < block_end; i++)
+		{
+			accumulator = op(accumulator, input[i]);
+			output[i] = accumulator;
+		}
+	}, 1);
+
+	return Optional<Error>();
+}
+
+//----------------------------------------------------------------------------//
+// Sorts elements of the array in parallel (stable merge sort).
+//    @param pool - thread pool to sort in.
+//    @param arr - array to be sorted.
+//    @param less - comparison function, returns 'true' if the first
+//                  argument goes before the second one,
+//                  signature: bool(const T& left, const T& right).
+//    @param grain - minimum number of elements sorted by one task,
+//                   0 to calculate it from the number of threads.
+//    @return - ut::Error if failed to allocate memory.
+template<typename T, pool_sync::Method sync_method, typename Less>
+Optional<Error> ParallelSort(ThreadPool<void, sync_method>& pool,
+                             Array<T>& arr,
+                             Less less,
+                             size_t grain = 0)
+{
+	const size_t count = arr.Count();
+	if (count < 2)
+	{
+		return Optional<Error>();
+	}
+
+	Array<T> buffer;
+	if (!buffer.Resize(count))
+	{
+		return Error(error::out_of_memory);
+	}
+
+	grain = parallel_helper::GetGrain(count, pool.GetThreadCount(), grain);
+	parallel_helper::MergeSort(pool, arr.GetAddress(), buffer.GetAddress(), count, grain, less);
+	return Optional<Error>();
+}
+
+// Sorts elements of the array in ascending order in parallel using
+// operator < (stable merge sort).
+//    @param pool - thread pool to sort in.
+//    @param arr - array to be sorted.
+//    @return - ut::Error if failed to allocate memory.
+template<typename T, pool_sync::Method sync_method>
+Optional<Error> ParallelSort(ThreadPool<void, sync_method>& pool, Array<T>& arr)
+{
+	return ParallelSort(pool, arr, parallel_helper::DefaultLess<T>());
+}
+
+//----------------------------------------------------------------------------//
+// Sorts elements of the array by unsigned integer keys in parallel (stable
+// LSD radix sort, one byte per pass). Every pass builds histograms of the
+// blocks in parallel, then elements of every block are scattered in parallel
+// to the positions calculated from the histograms. Passes where all elements
+// have the same byte are skipped.
+//    @param pool - thread pool to sort in.
+//    @param arr - array to be sorted.
+//    @param key - function returning unsigned integer key of the element,
+//                 signature: KeyType(const T& element).
+//    @return - ut::Error if failed to allocate memory.
+template<typename T, pool_sync::Method sync_method, typename KeyFunction>
+Optional<Error> ParallelRadixSort(ThreadPool<void, sync_method>& pool,
+                                  Array<T>& arr,
+                                  KeyFunction key)
+{
+	typedef typename RemoveReference<decltype(key(arr[0]))>::Type KeyType;
+	static_assert(static_cast<KeyType>(-1) > static_cast<KeyType>(0),
+	              "ut::ParallelRadixSort() supports only unsigned keys, "
+	              "flip the sign bit of a signed key to keep the order.");
+	static const size_t skRadix = 256;
+
+	const size_t count = arr.Count();
+	if (count < 2)
+	{
+		return Optional<Error>();
+	}
+
+	Array<T> buffer;
+	if (!buffer.Resize(count))
+	{
+		return Error(error::out_of_memory);
+	}
+
+	const size_t grain = parallel_helper::GetGrain(count, pool.GetThreadCount(), 0);
+	const size_t block_count = (count + grain - 1) / grain;
+	Array<size_t> histograms;
+	if (!histograms.Resize(block_count * skRadix))
+	{
+		return Error(error::out_of_memory);
+	}
+
+	T* source = arr.GetAddress();
+	T* destination = buffer.GetAddress();
+	for (size_t pass = 0; pass < sizeof(KeyType); pass++)
+	{
+		const size_t shift = pass * 8;
+
+		// histogram of every block
+		ParallelFor(pool, 0, block_count, [&](size_t block)
+		{
+			size_t* histogram = histograms.GetAddress() + block * skRadix;
+			for (size_t i = 0; i < skRadix; i++)
+			{
+				histogram[i] = 0;
+			}
+
+			const size_t block_end = block * grain + grain < count ? block * grain + grain : count;
+			for (size_t i = block * grain; i < block_end; i++)
+			{
+				histogram[static_cast<size_t>(key(source[i]) >> shift) & (skRadix - 1)]++;
+			}
+		}, 1);
+
+		// histograms are converted to offsets: digits go in ascending
+		// order, blocks with the same digit go in the order of blocks
+		size_t offset = 0;
+		bool skip_pass = false;
+		for (size_t digit = 0; digit < skRadix; digit++)
+		{
+			for (size_t block = 0; block < block_count; block++)
+			{
+				size_t& value = histograms[block * skRadix + digit];
+				const size_t digit_count = value;
+				value = offset;
+				offset += digit_count;
+			}
+
+			// all elements have the same digit
+			if (offset == count && histograms[digit] == 0)
+			{
+				skip_pass = true;
+				break;
+			}
+		}
+
+		if (skip_pass)
+		{
+			continue;
+		}
+
+		// scatter elements
+		ParallelFor(pool, 0, block_count, [&](size_t block)
+		{
+			size_t* positions = histograms.GetAddress() + block * skRadix;
+			const size_t block_end = block * grain + grain < count ? block * grain + grain : count;
+			for (size_t i = block * grain; i < block_end; i++)
+			{
+				const size_t digit = static_cast<size_t>(key(source[i]) >> shift) & (skRadix - 1);
+				destination[positions[digit]++] = Move(source[i]);
+			}
+		}, 1);
+
+		T* swap = source;
+		source = destination;
+		destination = swap;
+	}
+
+	// sorted data is in the buffer after an odd number of performed passes
+	if (source != arr.GetAddress())
+	{
+		ParallelFor(pool, 0, count, [&](size_t i)
+		{
+			arr[i] = Move(buffer[i]);
+		});
+	}
+
+	return Optional<Error>();
+}
+
+// Sorts the array of unsigned integers in ascending order in
+// parallel (stable LSD radix sort, one byte per pass).
+//    @param pool - thread pool to sort in.
+//    @param arr - array to be sorted.
+//    @return - ut::Error if failed to allocate memory.
+template<typename T, pool_sync::Method sync_method>
+Optional<Error> ParallelRadixSort(ThreadPool<void, sync_method>& pool, Array<T>& arr)
+{
+	return ParallelRadixSort(pool, arr, parallel_helper::IdentityKey<T>());
+}
+
+//----------------------------------------------------------------------------//
+END_NAMESPACE(ut)
+//----------------------------------------------------------------------------//
+//----------------------------------------------------------------------------//
+//----------------------------------------------------------------------------//
@@ -0,0 +1,118 @@
+//----------------------------------------------------------------------------//
+//---------------------------------|  U  T  |---------------------------------//
+//----------------------------------------------------------------------------//
+#pragma once
+//----------------------------------------------------------------------------//
+#include "common/ut_common.h"
+#include "thread/ut_interlocked.h"
+#include "thread/ut_mutex.h"
+#include "thread/ut_lock.h"
+#include "thread/ut_backoff.h"
+#include "system/ut_memory.h"
+//----------------------------------------------------------------------------//
+START_NAMESPACE(ut)
+//----------------------------------------------------------------------------//
+// ut::SeqLock template class is a thread-safe container for a small object
+// that is read much more often than written (coordinates, statistics,
+// configuration flags, etc.). Readers don't write to the shared memory at all:
+// ut::SeqLock::Get() optimistically copies the object and retries if a writer
+// modified it meanwhile, this is detected by the sequence number that is odd
+// while the writer is active. Writers are serialized with a mutex.
+// @T must be a trivially copyable type (no pointers to own data, no virtual
+// functions, no custom copy constructor), because a reader can copy an object
+// that is being modified, such copy is discarded but must not crash.
+// Unlike ut::SyncRW, there is no way to lock the object for reading, the
+// interface is otherwise the same: ut::SeqLock::Lock() and
+// ut::SeqLock::Unlock() provide a write access to the object.
+template<typename T>
+class SeqLock : public NonCopyable
+{
+public:
+	// Default constructor
+	SeqLock() : sequence(0)
+	{}
+
+	// Constructor, @object is explicitly copied from @copy
+	SeqLock(const T& copy) : object(copy)
+	                       , sequence(0)
+	{}
+
+	// Assignment operator, @object is safely extracted from @copy
+	SeqLock& operator = (const T& copy)
+	{
+		Set(copy);
+		return *this;
+	}
+
+	// Getter function, safely returns a copy of managed object,
+	// never blocks if there are no writers
+	//    @return - copy(!) of the @object
+	T Get()
+	{
+		T copy;
+		Backoff backoff;
+		while (true)
+		{
+			const int32 start = atomics::interlocked::Read(&sequence);
+			if ((start & 1) == 0)
+			{
+				memory::Copy(&copy, &object, sizeof(T));
+
+				// the copy must be completed before checking the sequence
+				atomics::interlocked::Fence();
+				if (atomics::interlocked::Read(&sequence) == start)
+				{
+					return copy;
+				}
+			}
+
+			// writer holds the mutex while modifying the object,
+			// so the reader is parked here if waiting takes too long
+			if (!backoff.Wait())
+			{
+				ScopeLock lock(mutex);
+				backoff.Reset();
+			}
+		}
+	}
+
+	// Locks the object for writing, and returns @object reference
+	T& Lock()
+	{
+		mutex.Lock();
+		atomics::interlocked::Increment(&sequence);
+		return object;
+	}
+
+	// Unlocks the object, readers will see the new value
+	void Unlock()
+	{
+		atomics::interlocked::Increment(&sequence);
+		mutex.Unlock();
+	}
+
+	// Setter function, @object is safely extracted from @copy
+	void Set(const T& copy)
+	{
+		Lock() = copy;
+		Unlock();
+	}
+
+private:
+	// Managed object, readers copy it byte by byte
+	// concurrently with the writer
+	T object;
+
+	// Sequence number, is odd while the object is being modified,
+	// is modified atomically
+	int32 sequence;
+
+	// Mutex serializing writers
+	Mutex mutex;
+};
+
+//----------------------------------------------------------------------------//
+END_NAMESPACE(ut)
+//----------------------------------------------------------------------------//
+//----------------------------------------------------------------------------//
+//----------------------------------------------------------------------------//
@@ -99,6 +99,10 @@ private:
 	Mutex m;
 };
 
+//----------------------------------------------------------------------------//
+// ut::ScopeSyncRWLock is a ut::SyncRW wrapper, see the definition below.
+template<typename T, typename LockType = RWLock> class ScopeSyncRWLock;
+
 //----------------------------------------------------------------------------//
 // ut::SyncRW template class is a thread-safe container for @object that
 // implements 'read-write lock' pattern.
@@ -108,7 +112,9 @@ private:
 // with ut::SyncRW::Unlock(), inside such a section you must use the reference
 // received from calling ut::SyncRW::Lock(), but not ut::SyncRW::Get(),
 // ut::SyncRW::Set() or assignment operator.
-template<typename T>
+// @LockType is a lock policy: ut::RWLock by default, or ut::ShardedRWLock
+// for read-mostly objects accessed by many threads simultaneously.
+template<typename T, typename LockType = RWLock>
 class SyncRW
 {
 public:
@@ -144,8 +150,8 @@ public:
 	//    @return - copy(!) of the @object
 	T Get()
 	{
-		ScopeRWLock scl(lock, Access::read);
-		return object;
+		ScopeSyncRWLock<T, LockType> scl(*this, Access::read);
+		return scl.Get();
 	}
 
 	// Locks mutex @m, and returns @object reference
@@ -164,15 +170,15 @@ public:
 	// Setter function, @object is safely extracted from @copy
 	void Set(const T& copy)
 	{
-		ScopeRWLock scl(lock, Access::write);
-		object = copy;
+		ScopeSyncRWLock<T, LockType> scl(*this, Access::write);
+		scl.Get() = copy;
 	}
 
 	// Setter function, @object is moved from @rval
 	void Set(T&& rval)
 	{
-		ScopeRWLock scl(lock, Access::write);
-		object = Move(rval);
+		ScopeSyncRWLock<T, LockType> scl(*this, Access::write);
+		scl.Get() = Move(rval);
 	}
 
 private:
@@ -180,7 +186,7 @@ private:
 	T object;
 
 	// Read-Write lock to provide thread-safe behaviour
-	RWLock lock;
+	LockType lock;
 };
 
 //----------------------------------------------------------------------------//
@@ -243,14 +249,14 @@ private:
 //----------------------------------------------------------------------------//
 // ut::ScopeSyncRWLock is a ut::SyncRW wrapper that provides a convenient
 // RAII-style mechanism for owning a mutex for the duration of a scoped block.
-template<typename T>
+template<typename T, typename LockType>
 class ScopeSyncRWLock : public NonCopyable
 {
 public:
 	typedef RWLock::Access Access;
 
 	// Constructor
-	ScopeSyncRWLock(SyncRW<T>& sync_variable,
+	ScopeSyncRWLock(SyncRW<T, LockType>& sync_variable,
 	                Access sync_access) : access(sync_access)
 	                                    , sync(sync_variable)
 	                                    , object(sync_variable.Lock(sync_access))
@@ -297,7 +303,7 @@ public:
 
 private:
 	Access access;
-	SyncRW<T>& sync;
+	SyncRW<T, LockType>& sync;
 	T& object;
 	bool locked;
 };
@@ -0,0 +1,174 @@
+//----------------------------------------------------------------------------//
+//---------------------------------|  U  T  |---------------------------------//
+//----------------------------------------------------------------------------//
+#pragma once
+//----------------------------------------------------------------------------//
+#include "thread/ut_thread_pool.h"
+#include "thread/ut_atomic_thread_pool.h"
+#include "error/ut_error.h"
+//----------------------------------------------------------------------------//
+START_NAMESPACE(ut)
+//----------------------------------------------------------------------------//
+// ut::TaskGraph is a directed acyclic graph of tasks, where an edge means that
+// the successor can't start until the predecessor is finished. The graph is
+// executed in a thread pool: every node is enqueued as soon as its last
+// predecessor finishes, so independent branches run in parallel without
+// barriers between them. Nodes and edges are stored in flat arrays, and
+// the counters of unfinished predecessors are reset in place before every
+// run, so a built graph can be executed many times without reallocation.
+// The graph can't be executed simultaneously from several threads.
+class TaskGraph : NonCopyable
+{
+public:
+	// Type of the unique pointer to the task of the node.
+	typedef UniquePtr< BaseTask<void> > UniqueTaskPtr;
+
+	// Constructor.
+	TaskGraph();
+
+	// Adds a new node to the graph, invalidates the result of Build().
+	//    @param task - unique pointer to the task of the node.
+	//    @return - identifier of the new node or ut::Error if failed.
+	Result<size_t, Error> AddNode(UniqueTaskPtr task);
+
+	// Adds a dependency between two nodes, invalidates the result of Build().
+	//    @param predecessor - identifier of the node that must finish first.
+	//    @param successor - identifier of the node that must start after
+	//                       @predecessor is finished.
+	//    @return - ut::Error if identifiers are invalid or failed
+	//              to allocate memory.
+	Optional<Error> AddDependency(size_t predecessor, size_t successor);
+
+	// Validates the graph and prepares it for execution, must be called
+	// after the last modification and before the first execution.
+	//    @return - ut::Error if the graph has a cycle or failed
+	//              to allocate memory.
+	Optional<Error> Build();
+
+	// Returns the number of nodes in the graph.
+	size_t GetNodeCount() const;
+
+	// Executes all nodes in the provided thread pool according to the
+	// dependencies and waits until all of them are finished. Can be called
+	// inside a worker thread of the same pool, pending tasks are processed
+	// in the current thread while waiting.
+	//    @param pool - thread pool to execute nodes in.
+	//    @return - ut::Error if the graph wasn't built after the last
+	//              modification or Build() has failed.
+	template<pool_sync::Method sync_method>
+	Optional<Error> Execute(ThreadPool<void, sync_method>& pool)
+	{
+		// nodes of the cycle would never be launched, so waiting for
+		// them would block forever
+		if (!built)
+		{
+			return Error(error::fail, "Task graph isn't built or has a cycle.");
+		}
+
+		const size_t count = nodes.Count();
+		for (size_t i = 0; i < count; i++)
+		{
+			atomics::interlocked::Store(&nodes[i].remaining, nodes[i].predecessor_count);
+		}
+
+		auto scheduler = pool.CreateScheduler();
+		const size_t root_count = roots.Count();
+		for (size_t i = 0; i < root_count; i++)
+		{
+			Launch(scheduler, roots[i]);
+		}
+		scheduler.WaitForCompletion();
+
+		return Optional<Error>();
+	}
+
+private:
+	// Node of the graph.
+	struct Node
+	{
+		// task to be executed
+		UniqueTaskPtr task;
+
+		// identifiers of the dependent nodes
+		Array<size_t> successors;
+
+		// number of the nodes this node depends on
+		int32 predecessor_count;
+
+		// number of the predecessors that are not finished yet
+		// during current run, is modified atomically
+		int32 remaining;
+	};
+
+	// Enqueues the node to the scheduler.
+	//    @param scheduler - scheduler of the current run.
+	//    @param id - identifier of the node.
+	template<pool_sync::Method sync_method>
+	void Launch(Scheduler<void, DefaultCombiner<void>, sync_method>& scheduler, size_t id)
+	{
+		scheduler.Enqueue(MakeUnique< Task<void()> >([this, &scheduler, id]
+		{
+			this->Run(scheduler, id);
+		}));
+	}
+
+	// Executes the node and launches successors that became ready. One of
+	// the ready successors is executed in the current thread right away
+	// instead of being enqueued, so chains of nodes don't go through the
+	// queue of the pool.
+	//    @param scheduler - scheduler of the current run.
+	//    @param id - identifier of the node.
+	template<pool_sync::Method sync_method>
+	void Run(Scheduler<void, DefaultCombiner<void>, sync_method>& scheduler, size_t id)
+	{
+		while (true)
+		{
+			Node& node = nodes[id];
+			node.task->Execute();
+
+			bool has_next = false;
+			size_t next = 0;
+			const size_t successor_count = node.successors.Count();
+			for (size_t i = 0; i < successor_count; i++)
+			{
+				const size_t successor = node.successors[i];
+				if (atomics::interlocked::Decrement(&nodes[successor].remaining) != 0)
+				{
+					continue;
+				}
+
+				if (has_next)
+				{
+					Launch(scheduler, successor);
+				}
+				else
+				{
+					next = successor;
+					has_next = true;
+				}
+			}
+
+			if (!has_next)
+			{
+				return;
+			}
+
+			id = next;
+		}
+	}
+
+	// all nodes of the graph, identifier of the node is its index
+	Array<Node> nodes;
+
+	// nodes without predecessors, are collected in Build()
+	Array<size_t> roots;
+
+	// indicates if the graph was validated after the last modification
+	bool built;
+};
+
+//----------------------------------------------------------------------------//
+END_NAMESPACE(ut)
+//----------------------------------------------------------------------------//
+//----------------------------------------------------------------------------//
+//----------------------------------------------------------------------------//
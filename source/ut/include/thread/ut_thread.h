@@ -7,6 +7,8 @@
 #include "containers/ut_array.h"
 #include "pointers/ut_unique_ptr.h"
 #include "system/ut_time.h"
+#include "text/ut_string.h"
+#include "error/ut_error.h"
 #include "templates/ut_task.h"
 #include "thread/ut_mutex.h"
 #include "thread/ut_lock.h"
@@ -37,6 +39,83 @@ START_NAMESPACE(ut)
 	#error Thread types are not implemented
 #endif
 
+//----------------------------------------------------------------------------//
+// ut::thread_priority namespace contains scheduling priorities of a thread.
+namespace thread_priority
+{
+	enum class Level
+	{
+		// runs only when the processor has nothing else to do
+		lowest,
+
+		// background work, yields to normal threads
+		low,
+
+		// default priority of a new thread
+		normal,
+
+		// latency-sensitive work, might require privileges
+		high,
+
+		// time-critical work, might require privileges
+		highest,
+
+		// real-time scheduling, preempts all threads of the levels
+		// above, usually requires privileges
+		realtime
+	};
+}
+
+//----------------------------------------------------------------------------//
+// ut::CpuSet is a set of logical processors a thread is allowed to run on.
+// Processors are identified by the index in range [0, skMaxCpuCount).
+class CpuSet
+{
+public:
+	// Maximum number of processors in a set.
+	static const uint32 skMaxCpuCount = 1024;
+
+	// Constructor, creates an empty set.
+	CpuSet();
+
+	// Returns the set of all processors the current process is allowed to
+	// run on (process affinity mask), indices of the processors can have gaps.
+	static CpuSet All();
+
+	// Returns the set of processors belonging to the NUMA node.
+	//    @param node - index of the NUMA node.
+	//    @return - set of processors or ut::Error if failed.
+	static Result<CpuSet, Error> FromNumaNode(uint32 node);
+
+	// Adds a processor to the set.
+	//    @param cpu - index of the processor.
+	void Add(uint32 cpu);
+
+	// Removes a processor from the set.
+	//    @param cpu - index of the processor.
+	void Remove(uint32 cpu);
+
+	// Checks if the processor belongs to the set.
+	//    @param cpu - index of the processor.
+	bool Has(uint32 cpu) const;
+
+	// Returns the number of processors in the set.
+	uint32 Count() const;
+
+	// Returns the processor with the provided ordinal number in the set,
+	// processors are sorted by index.
+	//    @param n - ordinal number of the processor, starting from 0.
+	//    @return - index of the processor or nothing if @n >= Count().
+	Optional<uint32> GetNth(uint32 n) const;
+
+private:
+	// number of 64-bit words in the mask
+	static const uint32 skWordCount = skMaxCpuCount / 64;
+
+	// bit mask of processors
+	uint64 mask[skWordCount];
+};
+
 //----------------------------------------------------------------------------//
 // ut::this_thread namespace groups a set of functions that access the
 // current thread.
@@ -60,9 +139,30 @@ namespace this_thread
 	// threads, allowing other threads to run.
 	void Yield();
 
+	// Hints the processor that the calling thread is in a spin-wait loop,
+	// reduces power consumption and frees resources for the sibling
+	// hyper-thread. Doesn't give up the time slice, see Yield() for that.
+	void Pause();
+
 	// Returns the id of the current thread
 	//    @return - id of the current thread
 	ThreadId GetId();
+
+	// Restricts the current thread to the provided processors.
+	//    @param cpu_set - set of processors, must not be empty.
+	//    @return - ut::Error if failed.
+	Optional<Error> SetAffinity(const CpuSet& cpu_set);
+
+	// Sets the name of the current thread visible in debuggers
+	// and profilers, long names are truncated on Linux (15 characters).
+	//    @param name - name of the thread.
+	//    @return - ut::Error if failed.
+	Optional<Error> SetName(const String& name);
+
+	// Sets the scheduling priority of the current thread.
+	//    @param priority - priority level.
+	//    @return - ut::Error if failed.
+	Optional<Error> SetPriority(thread_priority::Level priority);
 }
 
 //----------------------------------------------------------------------------//
@@ -70,6 +170,10 @@ namespace this_thread
 //    @return - number of processors
 uint32 GetNumberOfProcessors();
 
+// Returns the number of NUMA nodes, 1 if the system isn't NUMA.
+//    @return - number of NUMA nodes
+uint32 GetNumberOfNumaNodes();
+
 //----------------------------------------------------------------------------//
 // ut::Job is an atomic piece of work, used in ut::Thread
 // ut::Job::Execute() is performed asynchronously, you have to implement
@@ -145,9 +249,25 @@ public:
 	// use this function only for extreme cases.
 	void Kill();
 
+	// Restricts the thread to the provided processors.
+	//    @param cpu_set - set of processors, must not be empty.
+	//    @return - ut::Error if failed.
+	Optional<Error> SetAffinity(const CpuSet& cpu_set);
+
+	// Sets the name of the thread visible in debuggers and
+	// profilers, long names are truncated on Linux (15 characters).
+	//    @param name - name of the thread.
+	//    @return - ut::Error if failed.
+	Optional<Error> SetName(const String& name);
+
+	// Sets the scheduling priority of the thread.
+	//    @param priority - priority level.
+	//    @return - ut::Error if failed.
+	Optional<Error> SetPriority(thread_priority::Level priority);
+
 private:
 	// Entry function for the new thread, calls @task->Execute() internally.
-	static THREAD_PROCEDURE Entry(BaseTask<void>* proc);
+	static THREAD_PROCEDURE Entry(Thread* thread);
 
 	// Starts a new thread using @task member, windows variant uses
 	// _beginthreadex() to run a thread, Linux variant uses pthread_create().
@@ -165,6 +285,10 @@ private:
 	// Thread id
 	ThreadId id;
 
+	// Kernel id of the thread, used only in unix, it's published by
+	// the thread itself, so it's 0 until the thread starts
+	Atomic<int32> native_id;
+
 	// Thread is valid till this variable is 'true'
 	bool active;
 };
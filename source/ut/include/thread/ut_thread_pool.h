@@ -5,6 +5,7 @@
 //----------------------------------------------------------------------------//
 #include "thread/ut_thread.h"
 #include "thread/ut_condition_variable.h"
+#include "thread/ut_work_stealing_queue.h"
 #include "containers/ut_array.h"
 #include "pointers/ut_unique_ptr.h"
 #include "templates/ut_task.h"
@@ -29,6 +30,112 @@ namespace pool_sync
 	static const Method skDefaultMethod = Method::cond_var;
 }
 
+//----------------------------------------------------------------------------//
+// UT provides different methods to place worker threads of a pool
+// on processors.
+namespace pool_affinity
+{
+	enum class Method
+	{
+		// workers can run on any processor, common case
+		none,
+
+		// every worker is pinned to its own processor from the set, workers
+		// are assigned to processors in order, so the pool must not have more
+		// threads than processors in the set to avoid sharing processors
+		per_core,
+
+		// every worker can run on any processor from the set
+		cpu_set
+	};
+}
+
+//----------------------------------------------------------------------------//
+// ut::WorkerOptions describes the properties of the worker threads of
+// ut::ThreadPool: placement on processors, names and priority.
+struct WorkerOptions
+{
+	// Constructor.
+	//    @param in_affinity - method to place workers on processors.
+	//    @param in_cpu_set - set of processors for the workers, empty set
+	//                        means all processors of the process (see
+	//                        CpuSet::All()), ignored if @in_affinity is 'none'.
+	//    @param in_name - name prefix of the workers, index of the worker
+	//                     is appended, empty name leaves default names.
+	//    @param in_priority - scheduling priority of the workers.
+	WorkerOptions(pool_affinity::Method in_affinity = pool_affinity::Method::none,
+	              CpuSet in_cpu_set = CpuSet(),
+	              String in_name = String(),
+	              thread_priority::Level in_priority = thread_priority::Level::normal) : affinity(in_affinity)
+	                                                                                   , cpu_set(in_cpu_set)
+	                                                                                   , name(Move(in_name))
+	                                                                                   , priority(in_priority)
+	{}
+
+	// Applies options to the worker threads.
+	//    @param threads - array of the worker threads.
+	//    @return - ut::Error if failed to apply any option.
+	Optional<Error> Apply(Array< UniquePtr<Thread> >& threads) const
+	{
+		// processors are queried only if they are needed
+		const CpuSet processors = affinity == pool_affinity::Method::none || cpu_set.Count() != 0 ?
+		                          cpu_set : CpuSet::All();
+		const uint32 cpu_count = processors.Count();
+		if (affinity != pool_affinity::Method::none && cpu_count == 0)
+		{
+			return Error(error::invalid_arg, "Set of processors is empty.");
+		}
+
+		for (size_t i = 0; i < threads.Count(); i++)
+		{
+			Thread& thread = threads[i].GetRef();
+
+			Optional<Error> error;
+			if (affinity == pool_affinity::Method::per_core)
+			{
+				CpuSet core;
+				core.Add(processors.GetNth(static_cast<uint32>(i % cpu_count)).Get());
+				error = thread.SetAffinity(core);
+			}
+			else if (affinity == pool_affinity::Method::cpu_set)
+			{
+				error = thread.SetAffinity(processors);
+			}
+
+			if (!error && name.Length() != 0)
+			{
+				String worker_name;
+				worker_name.Print("%s%u", name.GetAddress(), static_cast<uint32>(i));
+				error = thread.SetName(worker_name);
+			}
+
+			if (!error && priority != thread_priority::Level::normal)
+			{
+				error = thread.SetPriority(priority);
+			}
+
+			if (error)
+			{
+				return error;
+			}
+		}
+
+		return Optional<Error>();
+	}
+
+	// method to place workers on processors
+	pool_affinity::Method affinity;
+
+	// set of processors for the workers
+	CpuSet cpu_set;
+
+	// name prefix of the workers
+	String name;
+
+	// scheduling priority of the workers
+	thread_priority::Level priority;
+};
+
 //----------------------------------------------------------------------------//
 // ut::Scheduler is a template class that syncronizes execution of the tasks
 // in a thread pool and combines the result of this execution.
@@ -83,15 +190,13 @@ class Scheduler<ReturnType, Combiner, pool_sync::Method::cond_var>
 	typedef UniquePtr< BaseTask<ReturnType> > UniqueTaskPtr;
 
 public:
-	// Assigns a task to a thread from the thread pool. If all threads are busy,
-	// waits until one of them ends current task.
+	// Assigns a task to a thread from the thread pool. Never blocks, the task
+	// is queued and will be processed by the first free worker thread.
 	//    @param task - unique pointer to the task to be executed.
 	void Enqueue(UniqueTaskPtr task)
 	{
-		{ // increment task counter
-			ScopeLock lock(mutex);
-			counter++;
-		}
+		// increment task counter
+		atomics::interlocked::Increment(&counter);
 
 		// create and send a task to the pool
 		auto function = MemberFunction<Scheduler, void(UniqueTaskPtr)>(this, &Scheduler::ExecuteTask);
@@ -107,18 +212,22 @@ public:
 		// current worker thread
 		if (pool.InWorkerThread())
 		{
-			while (counter != 0)
+			while (atomics::interlocked::Read(&counter) != 0)
 			{
 				if(!pool.DispatchTask(false))
 				{
 					break;
 				}
 			}
+
+			// the last task could still hold the lock after
+			// decrementing the counter, wait for it to leave
+			ScopeLock lock(mutex);
 		}
 		else // otherwise - just wait until all tasks are processed
 		{
 			ScopeLock lock(mutex);
-			while (counter != 0)
+			while (atomics::interlocked::Read(&counter) != 0)
 			{
 				cvar.Wait(lock);
 			}
@@ -136,10 +245,11 @@ private:
 
 		{ // decrement counter after the task was processed
 			ScopeLock lock(mutex);
-			counter--;
-			
-			// notify scheduler if it waits in WaitForCompletion() function
-			cvar.WakeOne();
+			if (atomics::interlocked::Decrement(&counter) == 0)
+			{
+				// notify scheduler if it waits in WaitForCompletion() function
+				cvar.WakeOne();
+			}
 		}
 	}
 
@@ -152,8 +262,8 @@ private:
 	// pool that owns the scheduler
 	ThreadPool<ReturnType, pool_sync::Method::cond_var>& pool;
 
-	// counter of the active tasks
-	int counter;
+	// counter of the active tasks, is modified atomically
+	int32 counter;
 
 	// combiner that combines results
 	Combiner combiner;
@@ -166,42 +276,58 @@ private:
 
 //----------------------------------------------------------------------------//
 // Specialized ut::ThreadPool template version where synchronization is
-// performed using condition variables.
+// performed using condition variables. Every worker thread owns a queue of
+// tasks (see ut::WorkStealingQueue), tasks enqueued by a worker go to its own
+// queue and other tasks are distributed between queues in round-robin order.
+// Worker processes its own queue first and steals tasks from the queues of
+// other workers when it runs out of work. Idle workers sleep on a condition
+// variable and are woken up only if there are sleeping workers at the moment
+// of enqueueing.
 template<typename ReturnType>
 class ThreadPool<ReturnType, pool_sync::Method::cond_var> : NonCopyable
 {
 	// Type of the task to be executed in a thread.
 	typedef UniquePtr< BaseTask<void> > UniqueTaskPtr;
 
+	// Type of the queue of tasks owned by a worker thread.
+	typedef WorkStealingQueue<UniqueTaskPtr> QueueType;
+
 public:
-	// Constructor.
+	// Constructor. Throws ut::Error if failed to apply worker options.
 	//    @param num_threads - number of active threads.
-	ThreadPool(size_t num_threads = GetNumberOfProcessors()) : size(num_threads)
-	                                                         , threads(num_threads)
-	                                                         , stop(false)
+	//    @param options - affinity, names and priority of the workers.
+	ThreadPool(size_t num_threads = GetNumberOfProcessors(),
+	           const WorkerOptions& options = WorkerOptions()) : size(num_threads)
+	                                                           , threads(num_threads)
+	                                                           , queues(num_threads)
+	                                                           , stop(false)
 	{
+		// all queues must exist before the first worker starts stealing
 		for (size_t i = 0; i < size; i++)
 		{
-			threads[i] = MakeUnique<Thread>([this] { while (this->DispatchTask(true)); });
+			queues[i] = MakeUnique<QueueType>();
 		}
-	}
 
-	// Destructor. Notifies and joins worker threads.
-	~ThreadPool()
-	{
-		{ // inform all workers before closing
-			ScopeLock lock(mutex);
-			stop = true;
-			worker_cvar.WakeAll();
+		for (size_t i = 0; i < size; i++)
+		{
+			threads[i] = MakeUnique<Thread>([this, i] { while (this->DispatchTask(i, true)); });
 		}
 
-		// wait for all workers to finish corresponding thread
-		for (size_t i = 0; i < size; i++)
+		Optional<Error> options_error = options.Apply(threads);
+		if (options_error)
 		{
-			threads[i]->Join();
+			Stop();
+			throw options_error.Move();
 		}
 	}
 
+	// Destructor. Notifies and joins worker threads, tasks
+	// remaining in queues are processed before exit.
+	~ThreadPool()
+	{
+		Stop();
+	}
+
 	// Returns the number of threads in this pool.
 	size_t GetThreadCount() const
 	{
@@ -224,124 +350,178 @@ public:
 	// Checks if current thread belongs to pool.
 	bool InWorkerThread()
 	{
-		const ut::ThreadId current_thread_id = this_thread::GetId();
-		for (size_t i = 0; i < size; i++)
-		{
-			if (threads[i]->GetId() == current_thread_id)
-			{
-				return true;
-			}
-		}
-		return false;
+		return GetWorkerId().HasValue();
 	}
 
-	// Takes current task from the pool and processes it in the current thread.
+	// Takes a task from the queue of the current worker thread (or steals
+	// it from another worker) and processes it in the current thread.
 	//    @param wait - boolean variable whether to wait for a new task to occur
 	//    @return - 'true' if ok, 'false' if pool is about to exit
 	bool DispatchTask(bool wait)
 	{
-		Optional<UniqueTaskPtr> task;
+		Optional<size_t> worker_id = GetWorkerId();
+		return DispatchTask(worker_id ? worker_id.Get() : 0, wait);
+	}
+
+	// Puts provided task to the queue, never blocks. Task is processed
+	// immediately in the current thread only if the pool has no workers
+	// or failed to allocate memory for the queue.
+	//    @param task - unique pointer to the task to be executed
+	//                  in a worker thread.
+	void Enqueue(UniqueTaskPtr task)
+	{
+		if (size == 0)
+		{
+			task->Execute();
+			return;
+		}
 
-		{ // get a new task to execute
+		// workers put new tasks to their own queues,
+		// other threads distribute them in round-robin order
+		Optional<size_t> worker_id = GetWorkerId();
+		const size_t queue_id = worker_id ? worker_id.Get()
+		                                  : static_cast<size_t>(next_queue.Increment()) % size;
+		if (!queues[queue_id]->Push(Move(task)))
+		{
+			task->Execute();
+			return;
+		}
+
+		// wake one of the sleeping workers, @pending is incremented before
+		// reading @sleepers, and each worker increments @sleepers before
+		// checking @pending, so at least one side sees the other
+		pending.Increment();
+		if (sleepers.Read() != 0)
+		{
 			ScopeLock lock(mutex);
+			worker_cvar.WakeOne();
+		}
+	}
 
-			// wait until a task was provided
-			while (wait && !stop && !current_task)
-			{
-				worker_cvar.Wait(lock);
-			}
+private:
+	// Notifies and joins worker threads.
+	void Stop()
+	{
+		{ // inform all workers before closing
+			ScopeLock lock(mutex);
+			stop.Store(true);
+			worker_cvar.WakeAll();
+		}
 
-			// check the reason of awakening
-			if (current_task)
-			{
-				task = current_task.Move();
-				current_task.Reset();
-			}
-			else if (stop)
+		// wait for all workers to finish corresponding thread
+		for (size_t i = 0; i < size; i++)
+		{
+			threads[i]->Join();
+		}
+	}
+
+	// Returns index of the worker thread the function is called from.
+	//    @return - index of the worker or nothing if current
+	//              thread doesn't belong to the pool.
+	Optional<size_t> GetWorkerId()
+	{
+		const ut::ThreadId current_thread_id = this_thread::GetId();
+		for (size_t i = 0; i < size; i++)
+		{
+			if (threads[i] && threads[i]->GetId() == current_thread_id)
 			{
-				// fail, exiting right now
-				return false;
+				return i;
 			}
 		}
+		return Optional<size_t>();
+	}
 
-		// execute task
-		if (task)
+	// Extracts a task from the queue of the worker @worker_id, if it's empty
+	// - steals a task from the other queues starting from the next one.
+	//    @param worker_id - index of the queue to start searching from.
+	//    @return - task or nothing if all queues are empty.
+	Optional<UniqueTaskPtr> TakeTask(size_t worker_id)
+	{
+		Optional<UniqueTaskPtr> task = queues[worker_id]->Pop();
+		for (size_t i = 1; !task && i < size; i++)
 		{
-			// wake ut::ThreadPool::Enqueue() if it's waiting
-			pool_cvar.WakeOne();
+			task = queues[(worker_id + i) % size]->Steal();
+		}
 
-			// execute a task
-			task.Get()->Execute();
+		if (task)
+		{
+			pending.Decrement();
 		}
 
-		// success
-		return true;
+		return task;
 	}
 
-	// Waits for a free thread and assigns provided task to it.
-	//    @param task - unique pointer to the task to be executed
-	//                  in a worker thread.
-	void Enqueue(UniqueTaskPtr task)
+	// Takes a task and processes it in the current thread.
+	//    @param worker_id - index of the queue to take tasks from first.
+	//    @param wait - boolean variable whether to wait for a new task to occur
+	//    @return - 'true' if ok, 'false' if pool is about to exit
+	bool DispatchTask(size_t worker_id, bool wait)
 	{
-		// task that needs to be processed immediately without dispatching to
-		// a worker thread, such a case can occur if ut::ThreadPool::Enqueue()
-		// function was called within one of the worker threads
-		Optional<UniqueTaskPtr> immediate_task;
+		if (size == 0)
+		{
+			return !stop.Read();
+		}
 
-		{ // wait for current task to be dispatched by a worker thread
-			ScopeLock lock(mutex);
-			if (current_task)
+		Optional<UniqueTaskPtr> task = TakeTask(worker_id);
+		while (!task)
+		{
+			if (!wait)
 			{
-				// if task from the previous call is still unprocessed, then
-				// maybe it's because we are in one of the worker threads
-				if (InWorkerThread())
-				{
-					immediate_task = current_task.Move();
-				}
-				else // otherwise wait for another thread
+				// nothing to do, let other threads finish their tasks
+				this_thread::Yield();
+				return !stop.Read();
+			}
+
+			{ // sleep until a new task is enqueued
+				ScopeLock lock(mutex);
+				sleepers.Increment();
+				while (pending.Read() <= 0 && !stop.Read())
 				{
-					do
-					{
-						pool_cvar.Wait(lock);
-					} while (current_task);
+					worker_cvar.Wait(lock);
 				}
+				sleepers.Decrement();
 			}
 
-			// set a new task that will be grabbed by a worker thread
-			current_task = Move(task);
+			task = TakeTask(worker_id);
+			if (!task && stop.Read() && pending.Read() <= 0)
+			{
+				// fail, exiting right now
+				return false;
+			}
 		}
 
-		// notify one of the worker threads that a 
-		// new task is ready to be processed
-		worker_cvar.WakeOne();
+		// execute task
+		task.Get()->Execute();
 
-		// if current thread is one of the worker threads and all other
-		// threads are busy - previous task must be processed immediately,
-		// and the task provided as argument remains for the next round
-		if (immediate_task)
-		{
-			immediate_task.Get()->Execute();
-		}
+		// success
+		return true;
 	}
 
-private:
+	// number of active threads
+	const size_t size;
+
 	// array of active threads
 	Array< UniquePtr<Thread> > threads;
 
-	// number of active threads
-	const size_t size;
+	// queue of tasks for every thread
+	Array< UniquePtr<QueueType> > queues;
+
+	// number of tasks that were enqueued but not taken yet, can be
+	// negative for a short time if a task was stolen before increment
+	Atomic<int32> pending;
+
+	// number of workers sleeping on @worker_cvar
+	Atomic<int32> sleepers;
 
-	// task that is waiting to be processed by
-	// one of the worker threads
-	Optional<UniqueTaskPtr> current_task;
+	// index of the queue for the next task enqueued outside of the pool
+	Atomic<uint32> next_queue;
 
 	// bool variable indicating when to stop workers
-	bool stop;
+	Atomic<bool> stop;
 
-	// synchronization objects
+	// synchronization objects for sleeping workers
 	Mutex mutex;
-	ConditionVariable worker_cvar; // every worker waits for a task
-	ConditionVariable pool_cvar; // pool waits for a free worker
+	ConditionVariable worker_cvar;
 };
 
 //----------------------------------------------------------------------------//
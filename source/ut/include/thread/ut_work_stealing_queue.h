@@ -0,0 +1,146 @@
+//----------------------------------------------------------------------------//
+//---------------------------------|  U  T  |---------------------------------//
+//----------------------------------------------------------------------------//
+#pragma once
+//----------------------------------------------------------------------------//
+#include "thread/ut_mutex.h"
+#include "thread/ut_lock.h"
+#include "thread/ut_atomic.h"
+#include "containers/ut_array.h"
+//----------------------------------------------------------------------------//
+START_NAMESPACE(ut)
+//----------------------------------------------------------------------------//
+// ut::WorkStealingQueue is a double-ended queue owned by a single worker
+// thread. The owner pushes and pops elements at the back (LIFO order keeps
+// recently produced data hot in cache), while other threads steal elements
+// from the front (FIFO order makes thieves take the oldest, usually the
+// biggest pieces of work). Every queue has its own lock, so the owner
+// competes only with occasional thieves instead of all threads of a pool.
+template<typename T>
+class WorkStealingQueue : NonCopyable
+{
+public:
+	// Constructor.
+	//    @param initial_capacity - number of elements to preallocate,
+	//                              must be a power of two.
+	WorkStealingQueue(size_t initial_capacity = 64) : buffer(initial_capacity)
+	                                                , head(0)
+	                                                , count(0)
+	{
+		UT_ASSERT(initial_capacity != 0 && (initial_capacity & (initial_capacity - 1)) == 0);
+	}
+
+	// Adds a new element to the back of the queue, buffer grows if needed.
+	//    @param element - r-value reference to the element to be added.
+	//    @return - 'true' if element was added or 'false' if failed
+	//              to allocate memory.
+	bool Push(T&& element)
+	{
+		ScopeLock lock(mutex);
+		const size_t capacity = buffer.Count();
+		if (count == capacity && !Grow(capacity * 2))
+		{
+			return false;
+		}
+
+		buffer[(head + count) & (buffer.Count() - 1)] = Move(element);
+		count++;
+		size_hint.Increment();
+		return true;
+	}
+
+	// Extracts the last added element, must be called by the owner.
+	//    @return - element or nothing if queue is empty.
+	Optional<T> Pop()
+	{
+		if (size_hint.Read() == 0)
+		{
+			return Optional<T>();
+		}
+
+		ScopeLock lock(mutex);
+		if (count == 0)
+		{
+			return Optional<T>();
+		}
+
+		count--;
+		size_hint.Decrement();
+		return Move(buffer[(head + count) & (buffer.Count() - 1)]);
+	}
+
+	// Extracts the first (the oldest) element, is called by other threads.
+	//    @return - element or nothing if queue is empty.
+	Optional<T> Steal()
+	{
+		if (size_hint.Read() == 0)
+		{
+			return Optional<T>();
+		}
+
+		ScopeLock lock(mutex);
+		if (count == 0)
+		{
+			return Optional<T>();
+		}
+
+		T& element = buffer[head];
+		head = (head + 1) & (buffer.Count() - 1);
+		count--;
+		size_hint.Decrement();
+		return Move(element);
+	}
+
+	// Returns approximate number of elements in the queue, the value can be
+	// changed by another thread right after the call.
+	size_t Count()
+	{
+		return static_cast<size_t>(size_hint.Read());
+	}
+
+private:
+	// Moves all elements to a new buffer of @new_capacity elements.
+	//    @param new_capacity - number of elements in a new buffer,
+	//                          must be a power of two.
+	//    @return - 'true' if succeeded or 'false' if failed to allocate memory.
+	bool Grow(size_t new_capacity)
+	{
+		Array<T> new_buffer;
+		if (!new_buffer.Resize(new_capacity))
+		{
+			return false;
+		}
+
+		const size_t mask = buffer.Count() - 1;
+		for (size_t i = 0; i < count; i++)
+		{
+			new_buffer[i] = Move(buffer[(head + i) & mask]);
+		}
+
+		buffer = Move(new_buffer);
+		head = 0;
+		return true;
+	}
+
+	// ring buffer of elements, capacity is always a power of two
+	Array<T> buffer;
+
+	// index of the first element in the ring buffer
+	size_t head;
+
+	// number of elements in the ring buffer
+	size_t count;
+
+	// copy of @count that can be read without locking, is used
+	// to skip empty queues quickly
+	Atomic<int32> size_hint;
+
+	// lock guarding all members above
+	Mutex mutex;
+};
+
+//----------------------------------------------------------------------------//
+END_NAMESPACE(ut)
+//----------------------------------------------------------------------------//
+//----------------------------------------------------------------------------//
+//----------------------------------------------------------------------------//
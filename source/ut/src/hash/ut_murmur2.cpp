@@ -81,7 +81,7 @@ uint32 MurmurHash2(const void* key,
 //    @param seed - 64-bit seed.
 //    @return - 64-bit hash.
 uint64 MurmurHash64A(const void* key,
-                     int len,
+                     size_t len,
                      uint64 seed)
 {
 	const uint64 m = MURMUR2_BIG_CONSTANT(0xc6a4a7935bd1e995);
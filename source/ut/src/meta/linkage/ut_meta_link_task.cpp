@@ -13,7 +13,7 @@ START_NAMESPACE(meta)
 //                      parameter will be written here on execution.
 //    @param in_address - address of the linked parameter.
 WriteLinkTask::WriteLinkTask(Controller in_state,
-                             const void* in_address) : state(in_state)
+                             const void* in_address) : state(Move(in_state))
                                                      , linked_address(in_address)
 {}
 
@@ -35,8 +35,8 @@ Optional<Error> WriteLinkTask::Execute(Linker& linker)
 		return Error(error::not_found, error_desc);
 	}
 
-	// write id
-	return linker.WriteLinkId(state, dst_link->id);
+	// write id, task is executed only once, so the state can be moved
+	return linker.WriteLinkId(Move(state), dst_link->id);
 }
 
 //----------------------------------------------------------------------------//
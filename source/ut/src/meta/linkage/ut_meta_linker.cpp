@@ -37,6 +37,12 @@ Optional<Error> Linker::AddLink(const SharedPtr<BaseParameter>& parameter, size_
 		return Error(error::out_of_memory);
 	}
 
+	// index the link, the first link with the same key takes precedence
+	Link* cached_link = links.GetLast().Get();
+	parameter_index.Insert(cached_link->parameter.Get(), cached_link);
+	address_index.Insert(static_cast<const void*>(cached_link->parameter->GetAddress()), cached_link);
+	id_index.Insert(id, cached_link);
+
 	// Success.
 	return Optional<Error>();
 }
@@ -57,6 +63,8 @@ Optional<Error> Linker::AddTask(UniquePtr<LinkTask> task)
 
 //----------------------------------------------------------------------------->
 // Executes all tasks. Must be called after all parameters have been cached.
+// Write tasks leave the stream cursor after the last written id, the caller
+// restores it once for the whole batch.
 //    @return - ut::Error if failed.
 Optional<Error> Linker::Execute()
 {
@@ -87,12 +95,9 @@ Optional<Error> Linker::CacheOutputSharedObject(const SharedPtr<SharedPtrHolderB
                                                 const void* address)
 {
 	// check if this object already exists
-	for (size_t i = 0; i < output_shared_cache.Count(); i++)
+	if (output_shared_index.Find(address))
 	{
-		if (output_shared_cache[i].address == address)
-		{
-			return Optional<Error>(); // e x i t
-		}
+		return Optional<Error>(); // e x i t
 	}
 
 	// add to the cache
@@ -101,6 +106,7 @@ Optional<Error> Linker::CacheOutputSharedObject(const SharedPtr<SharedPtrHolderB
 	{
 		return Error(error::out_of_memory);
 	}
+	output_shared_index.Insert(address, output_shared_cache.Count() - 1);
 
 	// success
 	return Optional<Error>();
@@ -116,12 +122,9 @@ Optional<Error> Linker::CacheInputSharedObject(const SharedPtr<SharedPtrHolderBa
                                                size_t id)
 {
 	// check if this object already exists
-	for (size_t i = 0; i < input_shared_cache.Count(); i++)
+	if (input_shared_index.Find(id))
 	{
-		if (input_shared_cache[i].id == id)
-		{
-			return Optional<Error>(); // e x i t
-		}
+		return Optional<Error>(); // e x i t
 	}
 
 	// add to the cache
@@ -130,6 +133,7 @@ Optional<Error> Linker::CacheInputSharedObject(const SharedPtr<SharedPtrHolderBa
 	{
 		return Error(error::out_of_memory);
 	}
+	input_shared_index.Insert(id, input_shared_cache.Count() - 1);
 
 	// success
 	return Optional<Error>();
@@ -144,22 +148,10 @@ Optional<Error> Linker::CacheInputSharedObject(const SharedPtr<SharedPtrHolderBa
 Optional<Error> Linker::RegisterInputSharedObject(const SharedPtr<SharedPtrHolderBase>& ptr,
                                                   size_t id)
 {
-	// check if this object already exists
-	for (size_t i = 0; i < preliminary_shared_cache.Count(); i++)
-	{
-		if (preliminary_shared_cache[i].id == id)
-		{
-			return Optional<Error>(); // e x i t
-		}
-	}
-
-	// check final cache too
-	for (size_t i = 0; i < input_shared_cache.Count(); i++)
+	// check if this object already exists, check final cache too
+	if (preliminary_shared_index.Find(id) || input_shared_index.Find(id))
 	{
-		if (input_shared_cache[i].id == id)
-		{
-			return Optional<Error>(); // e x i t
-		}
+		return Optional<Error>(); // e x i t
 	}
 
 	// add to the cache
@@ -168,6 +160,7 @@ Optional<Error> Linker::RegisterInputSharedObject(const SharedPtr<SharedPtrHolde
 	{
 		return Error(error::out_of_memory);
 	}
+	preliminary_shared_index.Insert(id, preliminary_shared_cache.Count() - 1);
 
 	// success
 	return Optional<Error>();
@@ -179,6 +172,7 @@ Array<OutputSharedCacheElement> Linker::MoveOutputSharedCache()
 {
 	Array<OutputSharedCacheElement> cache(Move(output_shared_cache));
 	output_shared_cache.Reset();
+	output_shared_index.Reset();
 	return cache;
 }
 
@@ -190,11 +184,13 @@ Array<InputSharedCacheElement> Linker::MovePreliminarySharedCache()
 {
 	Array<InputSharedCacheElement> cache(Move(preliminary_shared_cache));
 	preliminary_shared_cache.Reset();
+	preliminary_shared_index.Reset();
 	return cache;
 }
 
 //----------------------------------------------------------------------------->
-// Writes id using a provided state of meta controller.
+// Writes id using a provided state of meta controller. Stream cursor is
+// not restored afterwards, see Linker::Execute().
 //    @param state - state of the meta controller where the id must be
 //                   written.
 //    @param id - id value to be written.
@@ -207,13 +203,6 @@ Optional<Error> Linker::WriteLinkId(Controller state, size_t id) const
 	// convert id
 	Controller::SizeType converted_id = static_cast<Controller::SizeType>(id);
 
-	// save current stream position
-	Result<stream::Cursor, Error> stream_position = controller.GetStreamCursor();
-	if (!stream_position)
-	{
-		return stream_position.MoveAlt();
-	}
-
 	// synchronize stream so that it's internal cursor pointed to the place
 	// where our id value must be written
 	Optional<Error> sync_error = controller.Sync();
@@ -223,14 +212,7 @@ Optional<Error> Linker::WriteLinkId(Controller state, size_t id) const
 	}
 
 	// write id
-	Optional<Error> write_error = controller.WriteValue<Controller::SizeType>(converted_id);
-	if (write_error)
-	{
-		return write_error;
-	}
-
-	// set stream position back to the origin value
-	return controller.SetCursor(stream_position.Get(), true);
+	return controller.WriteValue<Controller::SizeType>(converted_id);
 }
 
 //----------------------------------------------------------------------------->
@@ -239,16 +221,13 @@ Optional<Error> Linker::WriteLinkId(Controller state, size_t id) const
 //    @return - reference to the cached link.
 Optional<Link&> Linker::FindLinkByParameter(const BaseParameter* parameter)
 {
-	for (size_t i = 0; i < links.Count(); i++)
+	Optional<Link*&> find_result = parameter_index.Find(parameter);
+	if (!find_result)
 	{
-		if (links[i]->parameter.Get() == parameter)
-		{
-			return links[i].GetRef();
-		}
+		return Optional<Link&>();
 	}
 
-	// nothing was found
-	return Optional<Link&>();
+	return *find_result.Get();
 }
 
 //----------------------------------------------------------------------------->
@@ -257,16 +236,13 @@ Optional<Link&> Linker::FindLinkByParameter(const BaseParameter* parameter)
 //    @return - reference to the cached link.
 Optional<Link&> Linker::FindLinkByAddress(const void* address)
 {
-	for (size_t i = 0; i < links.Count(); i++)
+	Optional<Link*&> find_result = address_index.Find(address);
+	if (!find_result)
 	{
-		if (links[i]->parameter->GetAddress() == address)
-		{
-			return links[i].GetRef();
-		}
+		return Optional<Link&>();
 	}
 
-	// nothing was found
-	return Optional<Link&>();
+	return *find_result.Get();
 }
 
 //----------------------------------------------------------------------------->
@@ -275,16 +251,13 @@ Optional<Link&> Linker::FindLinkByAddress(const void* address)
 //    @return - reference to the cached link.
 Optional<Link&> Linker::FindLinkById(size_t id)
 {
-	for (size_t i = 0; i < links.Count(); i++)
+	Optional<Link*&> find_result = id_index.Find(id);
+	if (!find_result)
 	{
-		if (links[i]->id == id)
-		{
-			return links[i].GetRef();
-		}
+		return Optional<Link&>();
 	}
 
-	// nothing was found
-	return Optional<Link&>();
+	return *find_result.Get();
 }
 
 //----------------------------------------------------------------------------->
@@ -293,18 +266,13 @@ Optional<Link&> Linker::FindLinkById(size_t id)
 //    @return - reference to the cached element.
 Optional<InputSharedCacheElement&> Linker::FindSharedLinkById(size_t id)
 {
-	// find linked parameter by id
-	for (size_t i = 0; i < input_shared_cache.Count(); i++)
+	Optional<size_t&> find_result = input_shared_index.Find(id);
+	if (!find_result)
 	{
-		// check if identifiers match
-		if (input_shared_cache[i].id == id)
-		{
-			return input_shared_cache[i];
-		}
+		return Optional<InputSharedCacheElement&>();
 	}
 
-	// nothing was found
-	return Optional<InputSharedCacheElement&>();
+	return input_shared_cache[find_result.Get()];
 }
 
 //----------------------------------------------------------------------------//
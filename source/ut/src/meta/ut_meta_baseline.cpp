@@ -0,0 +1,38 @@
+//----------------------------------------------------------------------------//
+//---------------------------------|  U  T  |---------------------------------//
+//----------------------------------------------------------------------------//
+#include "meta/ut_meta_baseline.h"
+//----------------------------------------------------------------------------//
+START_NAMESPACE(ut)
+START_NAMESPACE(meta)
+//----------------------------------------------------------------------------//
+// Seed of all digests.
+const uint64 Baseline::skSeed = 0x9E3779B97F4A7C15ull;
+
+//----------------------------------------------------------------------------//
+// Constructor, creates an empty baseline, the first
+// delta saved against it contains the whole tree.
+Baseline::Baseline() : version(0)
+                     , flags(0)
+{}
+
+//----------------------------------------------------------------------------->
+// Forgets all digests, the next delta will contain the whole tree.
+void Baseline::Reset()
+{
+	digests = Digests();
+}
+
+//----------------------------------------------------------------------------->
+// Returns the number of nodes in the baseline.
+size_t Baseline::Count() const
+{
+	return digests.Count();
+}
+
+//----------------------------------------------------------------------------//
+END_NAMESPACE(meta)
+END_NAMESPACE(ut)
+//----------------------------------------------------------------------------//
+//----------------------------------------------------------------------------//
+//----------------------------------------------------------------------------//
@@ -4,17 +4,30 @@
 #include "meta/linkage/ut_meta_linker.h"
 #include "meta/ut_meta_controller.h"
 #include "meta/ut_meta_snapshot.h"
+#include "meta/ut_meta_type_dictionary.h"
 #include "encryption/ut_base64.h"
 //----------------------------------------------------------------------------//
 START_NAMESPACE(ut)
 START_NAMESPACE(meta)
+//----------------------------------------------------------------------------//
+// Number of subtrees per thread of the pool.
+const size_t Controller::skParallelTasksPerThread = 4;
+
 //----------------------------------------------------------------------------//
 // Constructor
 //    @param info_copy - copy of the serialization info, that will be
 //                       used during serialization and deserialization
 Controller::Controller(const Info& info_copy) : info(info_copy)
                                               , mode(Mode::empty)
-{ }
+                                              , thread_pool(nullptr)
+                                              , parallel_budget(0)
+                                              , lazy(false)
+                                              , recorder(nullptr)
+{
+	// arithmetic arrays are always saved as a single value, the flag
+	// is overwritten by the info of the archive when loading
+	info.EnableBulkArrays(true);
+}
 
 //----------------------------------------------------------------------------->
 // Extracts a custom entity value from the node.
@@ -207,6 +220,103 @@ Optional<Error> Controller::SyncWithStream()
 	return Optional<Error>();
 }
 
+//----------------------------------------------------------------------------->
+// Enables simultaneous serialization of the sibling subtrees in a binary mode.
+//    @param pool - pointer to the thread pool, or nullptr to disable
+//                  simultaneous serialization.
+void Controller::SetThreadPool(ThreadPool<void>* pool)
+{
+	thread_pool = pool;
+	parallel_budget = pool != nullptr ? pool->GetThreadCount() * skParallelTasksPerThread : 0;
+}
+
+//----------------------------------------------------------------------------->
+// Enables lazy loading of the leaves of the root node in a binary mode.
+//    @param status - 'true' to enable lazy loading.
+void Controller::SetLazyLoading(bool status)
+{
+	lazy = status;
+}
+
+//----------------------------------------------------------------------------->
+// Reads uniforms of the serialized binary parameter at the current position
+// of the input stream and returns a view of its data without copying.
+//    @return - view of the binary data or ut::Error if failed.
+Result<Controller::BinaryView, Error> Controller::MapBinaryValue()
+{
+	if (mode != Mode::binary_input)
+	{
+		return MakeError(error::fail, "Invalid (non-binary-input) mode.");
+	}
+
+	// mapped data can't be converted
+	if (info.GetEndianness() != endianness::GetNative())
+	{
+		return MakeError(error::not_supported, "Binary data with non-native byte order can't be mapped.");
+	}
+
+	// read name, type, etc.
+	Result<Controller::Uniform, Error> uniforms = ReadUniformAttributes();
+	if (!uniforms)
+	{
+		return MakeError(uniforms.MoveAlt());
+	}
+
+	// check type
+	const Optional<String>& type = uniforms.Get().type;
+	if (type && type.Get().CompareCaseInsensitive("binary") != 0)
+	{
+		return MakeError(error::types_not_match, "Serialized parameter is not binary.");
+	}
+
+	// read data size, see ut::meta::BinaryParameter::Load()
+	Result<SizeType, Error> size = ReadAttribute<SizeType>(node_names::skSize);
+	if (!size)
+	{
+		return MakeError(size.MoveAlt());
+	}
+
+	// data starts right after the size
+	Result<stream::Cursor, Error> data_cursor = io.binary_input->GetCursor();
+	if (!data_cursor)
+	{
+		return MakeError(data_cursor.MoveAlt());
+	}
+
+	// check boundaries
+	Result<size_t, Error> stream_size = io.binary_input->GetSize();
+	if (!stream_size)
+	{
+		return MakeError(stream_size.MoveAlt());
+	}
+	else if (data_cursor.Get() + size.Get() > stream_size.Get())
+	{
+		return MakeError(error::out_of_bounds);
+	}
+
+	// get pointer to the data in the stream memory
+	Result<const void*, Error> data = io.binary_input->GetData(data_cursor.Get());
+	if (!data)
+	{
+		return MakeError(data.MoveAlt());
+	}
+
+	BinaryView view;
+	view.data = data.Get();
+	view.size = size.Get();
+	return view;
+}
+
+//----------------------------------------------------------------------------->
+// Makes controller remember stream positions of every node written in a
+// binary mode, sibling subtrees are always written sequentially then.
+//    @param node_recorder - pointer to the container of records, or
+//                           nullptr to stop recording.
+void Controller::SetNodeRecorder(NodeRecorder* node_recorder)
+{
+	recorder = node_recorder;
+}
+
 //----------------------------------------------------------------------------->
 // Creates a task for linker to write a correct id of the linked
 // object (that is defined as a pointer) into the value node.
@@ -686,6 +796,139 @@ Optional<Error> Controller::WriteBinaryValue(const void* data,
 	return Optional<Error>();
 }
 
+//----------------------------------------------------------------------------->
+// Writes the name of the type as an attribute. If the archive has a type
+// dictionary (see ut::meta::serialization_flags::kTypeDictionary) only
+// the index of the name in this dictionary is written.
+//    @param type_name - name of the type
+//    @param attribute_name - name of the attribute
+//    @return - ut::Error if failed
+Optional<Error> Controller::WriteTypeAttribute(const String& type_name,
+                                               const String& attribute_name)
+{
+	if (!type_dictionary || mode != Mode::binary_output)
+	{
+		return WriteAttribute<String>(type_name, attribute_name);
+	}
+
+	Result<TypeDictionary::Id, Error> register_result = type_dictionary->Register(type_name);
+	if (!register_result)
+	{
+		return register_result.MoveAlt();
+	}
+
+	// indices of the subtrees serialized simultaneously are replaced later
+	if (type_dictionary->TracksReferences())
+	{
+		Result<stream::Cursor, Error> id_cursor = io.binary_output->GetCursor();
+		if (!id_cursor)
+		{
+			return id_cursor.MoveAlt();
+		}
+
+		Optional<Error> reference_error = type_dictionary->AddReference(id_cursor.Get(), register_result.Get());
+		if (reference_error)
+		{
+			return reference_error;
+		}
+	}
+
+	const SizeType id = static_cast<SizeType>(register_result.Get());
+	return WriteBinary<SizeType>(&id, 1);
+}
+
+//----------------------------------------------------------------------------->
+// Reads the name of the type that was written
+// with Controller::WriteTypeAttribute().
+//    @param attribute_name - name of the attribute
+//    @return - name of the type or ut::Error if failed
+Result<String, Error> Controller::ReadTypeAttribute(const String& attribute_name)
+{
+	if (!type_dictionary || mode != Mode::binary_input)
+	{
+		return ReadAttribute<String>(attribute_name);
+	}
+
+	SizeType id;
+	Optional<Error> read_error = ReadBinary<SizeType>(&id, 1);
+	if (read_error)
+	{
+		return MakeError(read_error.Move());
+	}
+
+	Result<const String&, Error> name_result = type_dictionary->GetName(id);
+	if (!name_result)
+	{
+		return MakeError(name_result.MoveAlt());
+	}
+
+	return String(name_result.Get());
+}
+
+//----------------------------------------------------------------------------->
+// Reads the name of the polymorphic type that was written with
+// Controller::WriteTypeAttribute() and searches for the corresponding
+// dynamic type. Names from the type dictionary are resolved only once.
+//    @param factory - factory of the base type
+//    @param attribute_name - name of the attribute
+//    @return - dynamic type, nothing if the name is the name of the
+//              'void' type (null pointer), or ut::Error if failed
+Result<Optional<const DynamicType&>, Error> Controller::ReadPolymorphicTypeAttribute(const FactoryView& factory,
+                                                                                    const String& attribute_name)
+{
+	// legacy archives and text nodes contain the name itself
+	if (!type_dictionary || mode != Mode::binary_input)
+	{
+		Result<String, Error> read_result = ReadAttribute<String>(attribute_name);
+		if (!read_result)
+		{
+			return MakeError(read_result.MoveAlt());
+		}
+
+		if (read_result.Get() == Type<void>::Name())
+		{
+			return Optional<const DynamicType&>();
+		}
+
+		Result<const DynamicType&, Error> type_result = factory.GetType(read_result.Get());
+		if (!type_result)
+		{
+			return MakeError(type_result.MoveAlt());
+		}
+
+		return Optional<const DynamicType&>(type_result.Get());
+	}
+
+	// read index of the dictionary entry
+	SizeType id;
+	Optional<Error> read_error = ReadBinary<SizeType>(&id, 1);
+	if (read_error)
+	{
+		return MakeError(read_error.Move());
+	}
+
+	// check if serialized pointer is null
+	Result<const String&, Error> name_result = type_dictionary->GetName(id);
+	if (!name_result)
+	{
+		return MakeError(name_result.MoveAlt());
+	}
+
+	if (name_result.Get() == Type<void>::Name())
+	{
+		return Optional<const DynamicType&>();
+	}
+
+	// resolve cached dynamic type
+	Result<const DynamicType&, Error> type_result = type_dictionary->Resolve(id, factory);
+	if (!type_result)
+	{
+		return MakeError(type_result.MoveAlt());
+	}
+
+	return Optional<const DynamicType&>(type_result.Get());
+}
+
 //----------------------------------------------------------------------------->
 // Initializes intermediate modules (such as linker) before reading/writing a node.
 //    @param node - reference to the node to initialize.
@@ -719,6 +962,13 @@ Optional<Error> Controller::FinalizeNode(Snapshot& node)
 			return shared_error;
 		}
 
+		// linker tasks can move the stream cursor
+		Result<stream::Cursor, Error> stream_cursor = GetStreamCursor();
+		if (!stream_cursor)
+		{
+			return stream_cursor.MoveAlt();
+		}
+
 		// execute linker tasks
 		const Optional<Error> execute_error = linker->Execute();
 		if (execute_error)
@@ -726,10 +976,38 @@ Optional<Error> Controller::FinalizeNode(Snapshot& node)
 			return execute_error;
 		}
 
+		// set stream position back once for all tasks
+		const Optional<Error> cursor_error = SetCursor(stream_cursor.Get(), true);
+		if (cursor_error)
+		{
+			return cursor_error;
+		}
+
 		// linker isn't needed now
 		linker.Reset();
 	}
 
+	// type dictionary follows all other data
+	if (type_dictionary)
+	{
+		Optional<Error> dictionary_error;
+		if (mode == Mode::binary_output)
+		{
+			dictionary_error = WriteTypeDictionary();
+		}
+		else
+		{
+			dictionary_error = io.binary_input->MoveCursor(type_dictionary->anchor);
+		}
+
+		if (dictionary_error)
+		{
+			return dictionary_error;
+		}
+
+		type_dictionary.Reset();
+	}
+
 	// success
 	return Optional<Error>();
 }
@@ -747,6 +1025,26 @@ Optional<Error> Controller::WriteInitializationData(Snapshot& node)
 		return write_info_error;
 	}
 
+	// reserve space for the offset of the type dictionary
+	if (mode == Mode::binary_output && info.HasTypeDictionary())
+	{
+		Result<stream::Cursor, Error> offset_cursor = io.binary_output->GetCursor();
+		if (!offset_cursor)
+		{
+			return offset_cursor.MoveAlt();
+		}
+
+		const SizeType offset = 0;
+		Optional<Error> write_error = WriteBinary<SizeType>(&offset, 1);
+		if (write_error)
+		{
+			return write_error;
+		}
+
+		type_dictionary = MakeShared<TypeDictionary>();
+		type_dictionary->anchor = offset_cursor.Get();
+	}
+
 	// success
 	return Optional<Error>();
 }
@@ -764,6 +1062,16 @@ Optional<Error> Controller::ReadInitializationData(Snapshot& node)
 		return read_info_error;
 	}
 
+	// type dictionary must be read before any other data
+	if (mode == Mode::binary_input && info.HasTypeDictionary())
+	{
+		Optional<Error> dictionary_error = ReadTypeDictionary();
+		if (dictionary_error)
+		{
+			return dictionary_error;
+		}
+	}
+
 	// success
 	return Optional<Error>();
 }
@@ -815,9 +1123,8 @@ Result<Optional<stream::Cursor>, Error> Controller::WriteUniformAttributes(Snaps
 	// write type
 	if (info.HasTypeInformation())
 	{
-		optional_error = WriteAttribute<String>(node.data.parameter->GetTypeName(),
-												node_names::skType,
-												true);
+		optional_error = WriteTypeAttribute(node.data.parameter->GetTypeName(),
+		                                    node_names::skType);
 		if (optional_error)
 		{
 			return MakeError(optional_error.Move());
@@ -878,7 +1185,7 @@ Result<Controller::Uniform, Error> Controller::ReadUniformAttributes()
 	// read type
 	if (info.HasTypeInformation())
 	{
-		Result<String, Error> read_type_result = ReadAttribute<String>(node_names::skType);
+		Result<String, Error> read_type_result = ReadTypeAttribute(node_names::skType);
 		if (!read_type_result)
 		{
 			return MakeError(read_type_result.MoveAlt());
@@ -916,6 +1223,19 @@ Result<Controller::Uniform, Error> Controller::ReadUniformAttributes()
 //    @return - ut::Error if failed.
 Optional<Error> Controller::WriteParameter(Snapshot& node, stream::Cursor start)
 {
+	// uniforms are already written, body starts here
+	NodeRecord record;
+	record.start = start;
+	if (recorder)
+	{
+		Result<stream::Cursor, Error> body_cursor = GetStreamCursor();
+		if (!body_cursor)
+		{
+			return body_cursor.MoveAlt();
+		}
+		record.body = body_cursor.Get();
+	}
+
 	// save parameter body
 	Optional<Error> save_param_error = node.data.parameter->Save(*this);
 	if (save_param_error)
@@ -923,6 +1243,16 @@ Optional<Error> Controller::WriteParameter(Snapshot& node, stream::Cursor start)
 		return save_param_error;
 	}
 
+	if (recorder)
+	{
+		Result<stream::Cursor, Error> leaves_cursor = GetStreamCursor();
+		if (!leaves_cursor)
+		{
+			return leaves_cursor.MoveAlt();
+		}
+		record.leaves = leaves_cursor.Get();
+	}
+
 	// write children (this step is recursive)
 	Optional<Error> save_children_error = WriteChildNodes(node, start);
 	if (save_children_error)
@@ -930,6 +1260,22 @@ Optional<Error> Controller::WriteParameter(Snapshot& node, stream::Cursor start)
 		return save_children_error;
 	}
 
+	// size of the node is written in place, so the end is already known
+	if (recorder)
+	{
+		Result<stream::Cursor, Error> end_cursor = GetStreamCursor();
+		if (!end_cursor)
+		{
+			return end_cursor.MoveAlt();
+		}
+		record.end = end_cursor.Get();
+
+		if (recorder->Insert(&node, record))
+		{
+			return Error(error::already_exists, "Node was written twice.");
+		}
+	}
+
 	// success
 	return Optional<Error>();
 }
@@ -949,9 +1295,13 @@ Optional<Error> Controller::ReadParameter(Snapshot& node, stream::Cursor start)
 		return load_param_error;
 	}
 
-	// reflect once again loaded parameter to create those new 'empty leaves'
-	node.Reset();
-	node.data.parameter->Reflect(node);
+	// reflect once again loaded parameter to create those new 'empty leaves',
+	// fixed nodes already have the same leaves
+	if (!node.data.fixed)
+	{
+		node.Reset();
+		node.data.parameter->Reflect(node);
+	}
 
 	// after the tree structure was restored we can load every leaf separately
 	Optional<Error> read_children_error = ReadChildNodes(node, start);
@@ -960,6 +1310,15 @@ Optional<Error> Controller::ReadParameter(Snapshot& node, stream::Cursor start)
 		return read_children_error;
 	}
 
+	// leaves needed only to read the older layout are replaced with the
+	// current ones, so that the tree could be saved once again
+	if (node.data.transient)
+	{
+		node.data.transient = false;
+		node.Reset();
+		node.data.parameter->Reflect(node);
+	}
+
 	// success
 	return Optional<Error>();
 }
@@ -1013,6 +1372,12 @@ Optional<Error> Controller::WriteChildNodes(Snapshot& node, stream::Cursor start
 		}
 	}
 
+	// serialize sibling subtrees simultaneously if possible
+	if (ParallelIsPossible(node.CountChildren()))
+	{
+		return WriteChildNodesParallel(node);
+	}
+
 	// allocate space for child nodes (only text mode is involved)
 	Result<size_t, Error> alloc_result = AllocateChildNodes(node.CountChildren());
 	if (!alloc_result)
@@ -1105,6 +1470,29 @@ Optional<Error> Controller::ReadChildNodes(Snapshot& node, stream::Cursor start)
 		}
 	}
 
+	// only positions of the subtrees are read if they are loaded on demand,
+	// laziness is applied only to the first level of the tree
+	const bool index_only = lazy;
+	lazy = false;
+	if (index_only && mode == Mode::binary_input && SkipIsPossible() && !info.HasLinkageInformation())
+	{
+		return IndexChildNodes(node, child_num_result.Get());
+	}
+
+	// deserialize sibling subtrees simultaneously if possible
+	if (ParallelIsPossible(child_num_result.Get()))
+	{
+		Result<bool, Error> parallel_result = ReadChildNodesParallel(node, child_num_result.Get());
+		if (!parallel_result)
+		{
+			return parallel_result.MoveAlt();
+		}
+		else if (parallel_result.Get())
+		{
+			return Optional<Error>();
+		}
+	}
+
 	// save current state
 	Controller state = SaveState();
 
@@ -1141,100 +1529,475 @@ Optional<Error> Controller::ReadChildNodes(Snapshot& node, stream::Cursor start)
 }
 
 //----------------------------------------------------------------------------->
-// Writes a name of the node.
-//    @param name - name of the node.
-//    @return ut::Error if failed.
-Optional<Error> Controller::WriteNodeName(const String& name)
+// Returns 'true' if sibling subtrees can be written/read simultaneously.
+//    @param child_count - number of the sibling subtrees.
+bool Controller::ParallelIsPossible(size_t child_count) const
 {
-	if (mode == Mode::binary_output)
-	{
-		return info.HasBinaryNames() ? WriteBinary<String>(&name, 1) : Optional<Error>();
-	}
-	else if (mode == Mode::text_output)
+	// linker and node recorder are shared by all subtrees, type
+	// dictionaries of the subtrees are merged afterwards
+	if (thread_pool == nullptr || child_count < 2 || parallel_budget < 2 ||
+	    info.HasLinkageInformation() || recorder)
 	{
-		io.text_output->data.name = name;
-		return Optional<Error>();
+		return false;
 	}
 
-	return Error(error::fail, "Invalid mode.");
+	// subtree boundaries can be found only using size information
+	return mode == Mode::binary_output || (mode == Mode::binary_input && SkipIsPossible());
 }
 
 //----------------------------------------------------------------------------->
-// Reads a name of the node.
-//    @param name - name of the node.
-//    @return ut::Error if failed.
-Result<Optional<String>, Error> Controller::ReadNodeName()
+// Serializes leaves of the provided node simultaneously in the thread pool.
+//    @param node - reference to a parent node.
+//    @return - ut::Error if failed.
+Optional<Error> Controller::WriteChildNodesParallel(Snapshot& node)
 {
-	if (mode == Mode::binary_input)
-	{
-		// if source has no names - return empty container
-		if (!info.HasBinaryNames())
-		{
-			return Optional<String>();
-		}
+	const size_t child_count = node.CountChildren();
 
-		// otherwise - read a name from stream
-		String name;
-		Optional<Error> read_error = ReadBinary<String>(&name, 1);
-		if (read_error)
-		{
-			return MakeError(read_error.Move());
-		}
-		return Optional<String>(name);
-	}
-	else if (mode == Mode::text_input)
+	// split leaves into groups, every group is written to a separate buffer,
+	// nested levels share the rest of the budget
+	const size_t batch_count = Min<size_t>(child_count, parallel_budget);
+	const size_t batch_size = child_count / batch_count;
+	const size_t remainder = child_count % batch_count;
+	Array< UniquePtr<BinaryStream> > buffers(batch_count);
+	Array< SharedPtr<TypeDictionary> > dictionaries(batch_count);
+	Array< Optional<Error> > errors(batch_count);
+	if (buffers.Count() != batch_count || dictionaries.Count() != batch_count || errors.Count() != batch_count)
 	{
-		return Optional<String>(io.text_input->data.name);
+		return Error(error::out_of_memory);
 	}
 
-	return MakeError(error::fail, "Invalid mode.");
-}
+	Controller group_state = SaveState();
+	group_state.parallel_budget = parallel_budget / child_count;
 
-//----------------------------------------------------------------------------->
-// Writes a number of leaves in a node.
-//    @param count - number of leaves to be written.
-//    @return ut::Error if failed.
-Optional<Error> Controller::WriteNumberOfChildNodes(size_t count)
-{
-	if (mode == Mode::binary_output)
+	// write groups, every group has its own type dictionary
+	Scheduler<void> scheduler = thread_pool->CreateScheduler();
+	size_t first = 0;
+	for (size_t i = 0; i < batch_count; i++)
 	{
-		// there is no sense to write a number of children if they have no name
-		if (!info.HasBinaryNames())
+		const size_t count = batch_size + (i < remainder ? 1 : 0);
+		buffers[i] = MakeUnique<BinaryStream>();
+		if (type_dictionary)
 		{
-			return Optional<Error>();
+			dictionaries[i] = MakeShared<TypeDictionary>(true);
+			group_state.type_dictionary = dictionaries[i];
 		}
 
-		// write a number of children to the stream
-		SizeType converted_count = static_cast<SizeType>(count);
-		return WriteBinary<SizeType>(&converted_count, 1);
-	}
-	else if (mode == Mode::text_output)
-	{
-		// text document retrieves a number of child nodes during a
-		// parsing process, so this information must be already known
-		return Optional<Error>();
+		Controller state = group_state;
+		BinaryStream& buffer = buffers[i].GetRef();
+		Optional<Error>& error = errors[i];
+		Function<void()> function([state, &node, first, count, &buffer, &error]
+		                          {
+		                              WriteSubtrees(state, node, first, count, buffer, error);
+		                          });
+		scheduler.Enqueue(MakeUnique< Task<void()> >(Move(function)));
+		first += count;
 	}
+	scheduler.WaitForCompletion();
 
-	return Error(error::fail, "Invalid mode.");
-}
-
-//----------------------------------------------------------------------------->
-// Reads a number of leaves in a node.
-//    @param count - number of leaves to be read.
-//    @return ut::Error if failed.
-Result<size_t, Error> Controller::ReadNumberOfChildNodes(const Snapshot& node)
-{
-	if (mode == Mode::binary_input)
+	// stitch buffers together in the original order
+	for (size_t i = 0; i < batch_count; i++)
 	{
-		// if there is no names - there is no number of children, we can only hope
-		// that the number of serialized children matches current number of children
-		if (!info.HasBinaryNames())
+		if (errors[i])
 		{
-			return node.CountChildren();
+			return errors[i].Move();
 		}
 
-		// read a number of children from the stream
-		SizeType count;
+		const Array<byte>& data = buffers[i]->GetBuffer();
+		if (data.GetSize() == 0)
+		{
+			continue;
+		}
+
+		if (type_dictionary)
+		{
+			Result<stream::Cursor, Error> offset = io.binary_output->GetCursor();
+			if (!offset)
+			{
+				return offset.MoveAlt();
+			}
+
+			Optional<Error> merge_error = MergeTypeDictionary(dictionaries[i].GetRef(), buffers[i].GetRef(), offset.Get());
+			if (merge_error)
+			{
+				return merge_error;
+			}
+		}
+
+		Optional<Error> write_error = io.binary_output->Write(data.GetAddress(), 1, data.GetSize());
+		if (write_error)
+		{
+			return write_error;
+		}
+	}
+
+	// success
+	return Optional<Error>();
+}
+
+//----------------------------------------------------------------------------->
+// Deserializes leaves of the provided node simultaneously in the thread pool.
+//    @param node - reference to a parent node.
+//    @param child_count - number of the serialized leaves.
+//    @return - 'true' if leaves were read, 'false' if serialized leaves
+//              don't match the node and must be read sequentially,
+//              or ut::Error if failed.
+Result<bool, Error> Controller::ReadChildNodesParallel(Snapshot& node, size_t child_count)
+{
+	// extra leaves are loaded to the last node sequentially
+	if (child_count > node.CountChildren())
+	{
+		return false;
+	}
+
+	Result<stream::Cursor, Error> start_cursor = io.binary_input->GetCursor();
+	if (!start_cursor)
+	{
+		return MakeError(start_cursor.MoveAlt());
+	}
+
+	// find subtree boundaries reading only uniforms, every leaf must have
+	// the name of the corresponding node, otherwise leaves can't be loaded
+	// independently (see Controller::FindSiblingNode())
+	Controller state = SaveState();
+	Array<stream::Cursor> boundaries(child_count + 1);
+	if (boundaries.Count() != child_count + 1)
+	{
+		return MakeError(error::out_of_memory);
+	}
+	boundaries[0] = start_cursor.Get();
+	for (size_t i = 0; i < child_count; i++)
+	{
+		SerializationOptions options;
+		options.initialize = false;
+		options.only_uniforms = true;
+		Result<Uniform, Error> uniform = ReadNode(Optional<Snapshot&>(), options);
+		LoadState(state);
+		if (!uniform)
+		{
+			return MakeError(uniform.MoveAlt());
+		}
+
+		if (!uniform.Get().next || (uniform.Get().name && uniform.Get().name.Get() != node[i].data.name))
+		{
+			Optional<Error> move_error = io.binary_input->MoveCursor(start_cursor.Get());
+			if (move_error)
+			{
+				return MakeError(move_error.Move());
+			}
+			return false;
+		}
+
+		boundaries[i + 1] = uniform.Get().next.Get();
+	}
+
+	// split leaves into groups, every group is read from a separate buffer,
+	// nested levels share the rest of the budget
+	const size_t batch_count = Min<size_t>(child_count, parallel_budget);
+	const size_t batch_size = child_count / batch_count;
+	const size_t remainder = child_count % batch_count;
+	Array< UniquePtr<BinaryStream> > buffers(batch_count);
+	Array< Optional<Error> > errors(batch_count);
+	if (buffers.Count() != batch_count || errors.Count() != batch_count)
+	{
+		return MakeError(error::out_of_memory);
+	}
+
+	// read serialized groups
+	Optional<Error> move_error = io.binary_input->MoveCursor(start_cursor.Get());
+	if (move_error)
+	{
+		return MakeError(move_error.Move());
+	}
+
+	size_t first = 0;
+	for (size_t i = 0; i < batch_count; i++)
+	{
+		const size_t count = batch_size + (i < remainder ? 1 : 0);
+		Array<byte> data(boundaries[first + count] - boundaries[first]);
+		if (data.GetSize() != boundaries[first + count] - boundaries[first])
+		{
+			return MakeError(error::out_of_memory);
+		}
+
+		if (data.GetSize() != 0)
+		{
+			Optional<Error> read_error = io.binary_input->Read(data.GetAddress(), 1, data.GetSize());
+			if (read_error)
+			{
+				return MakeError(read_error.Move());
+			}
+		}
+
+		buffers[i] = MakeUnique<BinaryStream>();
+		buffers[i]->SetBuffer(Move(data));
+		first += count;
+	}
+
+	// every group reflects its leaves once again, thus it must have
+	// a separate serialization info, see Snapshot::ShareInfo()
+	state.parallel_budget = parallel_budget / child_count;
+	Scheduler<void> scheduler = thread_pool->CreateScheduler();
+	first = 0;
+	for (size_t i = 0; i < batch_count; i++)
+	{
+		const size_t count = batch_size + (i < remainder ? 1 : 0);
+		Snapshot::InfoSharedPtr batch_info = MakeUnsafeShared<Info>(node.info.GetRef());
+		for (size_t j = first; j < first + count; j++)
+		{
+			node[j].ShareInfo(batch_info);
+		}
+
+		BinaryStream& buffer = buffers[i].GetRef();
+		Optional<Error>& error = errors[i];
+		Function<void()> function([state, &node, first, count, &buffer, &error]
+		                          {
+		                              ReadSubtrees(state, node, first, count, buffer, error);
+		                          });
+		scheduler.Enqueue(MakeUnique< Task<void()> >(Move(function)));
+		first += count;
+	}
+	scheduler.WaitForCompletion();
+
+	// the first failed group is reported
+	for (size_t i = 0; i < batch_count; i++)
+	{
+		if (errors[i])
+		{
+			return MakeError(errors[i].Move());
+		}
+	}
+
+	// success
+	return true;
+}
+
+//----------------------------------------------------------------------------->
+// Remembers stream positions of the serialized leaves instead of reading them.
+//    @param node - reference to a parent node.
+//    @param child_count - number of the serialized leaves.
+//    @return - ut::Error if failed.
+Optional<Error> Controller::IndexChildNodes(Snapshot& node, size_t child_count)
+{
+	// all leaves are loaded later with the copy of the current state
+	Controller state = SaveState();
+	SharedPtr<Controller> source = MakeShared<Controller>(state);
+
+	for (size_t i = 0; i < child_count; i++)
+	{
+		Result<stream::Cursor, Error> leaf_cursor = io.binary_input->GetCursor();
+		if (!leaf_cursor)
+		{
+			return leaf_cursor.MoveAlt();
+		}
+
+		// read only uniforms to get the name and to skip the leaf
+		SerializationOptions options;
+		options.initialize = false;
+		options.only_uniforms = true;
+		Result<Uniform, Error> uniform = ReadNode(Optional<Snapshot&>(), options);
+		LoadState(state);
+		if (!uniform)
+		{
+			return uniform.MoveAlt();
+		}
+
+		// search for the corresponding node the same way as Controller::ReadNode()
+		// does, note that Snapshot::FindChildByName() can't be used here as it
+		// loads deferred nodes
+		Optional<size_t> node_id;
+		if (uniform.Get().name)
+		{
+			node_id = node.child_index.Find(node, uniform.Get().name.Get());
+		}
+		else
+		{
+			node_id = i >= node.CountChildren() ? node.CountChildren() - 1 : i;
+		}
+
+		// leaves without corresponding nodes are skipped
+		if (!node_id)
+		{
+			continue;
+		}
+
+		Snapshot& leaf = node[node_id.Get()];
+		leaf.deferred_source = source;
+		leaf.deferred_offset = leaf_cursor.Get();
+	}
+
+	// success
+	return Optional<Error>();
+}
+
+//----------------------------------------------------------------------------->
+// Serializes a range of the leaves to the separate buffer.
+//    @param state - state of the controller to write leaves with.
+//    @param node - reference to a parent node.
+//    @param first - id of the first leaf to be written.
+//    @param count - number of leaves to be written.
+//    @param buffer - reference to the stream to write leaves to.
+//    @param error - is set if failed.
+void Controller::WriteSubtrees(Controller state,
+                               Snapshot& node,
+                               size_t first,
+                               size_t count,
+                               BinaryStream& buffer,
+                               Optional<Error>& error)
+{
+	// sizes and offsets are relative, so the buffer can start from zero
+	error = state.SetBinaryOutputStream(buffer);
+	if (error)
+	{
+		return;
+	}
+
+	for (size_t i = first; i < first + count; i++)
+	{
+		SerializationOptions options;
+		options.initialize = false;
+		error = state.WriteNode(node[i], options);
+		if (error)
+		{
+			return;
+		}
+	}
+}
+
+//----------------------------------------------------------------------------->
+// Deserializes a range of the leaves from the separate buffer.
+//    @param state - state of the controller to read leaves with.
+//    @param node - reference to a parent node.
+//    @param first - id of the first leaf to be read.
+//    @param count - number of leaves to be read.
+//    @param buffer - reference to the stream to read leaves from.
+//    @param error - is set if failed.
+void Controller::ReadSubtrees(Controller state,
+                              Snapshot& node,
+                              size_t first,
+                              size_t count,
+                              BinaryStream& buffer,
+                              Optional<Error>& error)
+{
+	error = state.SetBinaryInputStream(buffer);
+	if (error)
+	{
+		return;
+	}
+
+	// save current state
+	Controller subtree_state = state.SaveState();
+
+	for (size_t i = first; i < first + count; i++)
+	{
+		SerializationOptions options;
+		options.initialize = false;
+		Result<Controller::Uniform, Error> read_result = state.ReadNode(node[i], options);
+		if (!read_result)
+		{
+			error = read_result.MoveAlt();
+			return;
+		}
+
+		// get back to the current node
+		state.LoadState(subtree_state);
+	}
+}
+
+//----------------------------------------------------------------------------->
+// Writes a name of the node.
+//    @param name - name of the node.
+//    @return ut::Error if failed.
+Optional<Error> Controller::WriteNodeName(const String& name)
+{
+	if (mode == Mode::binary_output)
+	{
+		return info.HasBinaryNames() ? WriteBinary<String>(&name, 1) : Optional<Error>();
+	}
+	else if (mode == Mode::text_output)
+	{
+		io.text_output->data.name = name;
+		return Optional<Error>();
+	}
+
+	return Error(error::fail, "Invalid mode.");
+}
+
+//----------------------------------------------------------------------------->
+// Reads a name of the node.
+//    @param name - name of the node.
+//    @return ut::Error if failed.
+Result<Optional<String>, Error> Controller::ReadNodeName()
+{
+	if (mode == Mode::binary_input)
+	{
+		// if source has no names - return empty container
+		if (!info.HasBinaryNames())
+		{
+			return Optional<String>();
+		}
+
+		// otherwise - read a name from stream
+		String name;
+		Optional<Error> read_error = ReadBinary<String>(&name, 1);
+		if (read_error)
+		{
+			return MakeError(read_error.Move());
+		}
+		return Optional<String>(name);
+	}
+	else if (mode == Mode::text_input)
+	{
+		return Optional<String>(io.text_input->data.name);
+	}
+
+	return MakeError(error::fail, "Invalid mode.");
+}
+
+//----------------------------------------------------------------------------->
+// Writes a number of leaves in a node.
+//    @param count - number of leaves to be written.
+//    @return ut::Error if failed.
+Optional<Error> Controller::WriteNumberOfChildNodes(size_t count)
+{
+	if (mode == Mode::binary_output)
+	{
+		// there is no sense to write a number of children if they have no name
+		if (!info.HasBinaryNames())
+		{
+			return Optional<Error>();
+		}
+
+		// write a number of children to the stream
+		SizeType converted_count = static_cast<SizeType>(count);
+		return WriteBinary<SizeType>(&converted_count, 1);
+	}
+	else if (mode == Mode::text_output)
+	{
+		// text document retrieves a number of child nodes during a
+		// parsing process, so this information must be already known
+		return Optional<Error>();
+	}
+
+	return Error(error::fail, "Invalid mode.");
+}
+
+//----------------------------------------------------------------------------->
+// Reads a number of leaves in a node.
+//    @param count - number of leaves to be read.
+//    @return ut::Error if failed.
+Result<size_t, Error> Controller::ReadNumberOfChildNodes(const Snapshot& node)
+{
+	if (mode == Mode::binary_input)
+	{
+		// if there is no names - there is no number of children, we can only hope
+		// that the number of serialized children matches current number of children
+		if (!info.HasBinaryNames())
+		{
+			return node.CountChildren();
+		}
+
+		// read a number of children from the stream
+		SizeType count;
 		Optional<Error> read_error = ReadBinary<SizeType>(&count, 1);
 		if (read_error)
 		{
@@ -1733,8 +2496,9 @@ Optional<Error> Controller::WriteSharedObjects()
 		}
 	}
 
-	// save cursor position (where all shared parameters are already written)
-	Result<stream::Cursor, Error> current_cursor = GetCursor();
+	// save cursor position (where all shared parameters are already written),
+	// note that @cursor was reset along with the local state
+	Result<stream::Cursor, Error> current_cursor = GetStreamCursor();
 	if (!current_cursor)
 	{
 		return current_cursor.MoveAlt();
@@ -1785,7 +2549,8 @@ Optional<Error> Controller::ReadSharedObjects()
 	Controller local_state = SaveState();
 
 	// grab a portion of newly registered shared parameters
-	Array<InputSharedCacheElement> registry = linker->MovePreliminarySharedCache();
+	SharedObjectRegistry registry;
+	AddToSharedRegistry(registry, linker->MovePreliminarySharedCache());
 
 	// read all shared objects
 	for (size_t i = 0; i < count.Get(); i++)
@@ -1813,15 +2578,215 @@ Optional<Error> Controller::ReadSharedObjects()
 	return Optional<Error>();
 }
 
+//----------------------------------------------------------------------------->
+// Writes all type names registered in the type dictionary and
+// writes the offset of the dictionary to the archive header.
+//    @return - ut::Error if failed.
+Optional<Error> Controller::WriteTypeDictionary()
+{
+	Result<stream::Cursor, Error> dictionary_cursor = io.binary_output->GetCursor();
+	if (!dictionary_cursor)
+	{
+		return dictionary_cursor.MoveAlt();
+	}
+
+	// write number of names
+	const SizeType count = static_cast<SizeType>(type_dictionary->Count());
+	Optional<Error> write_error = WriteBinary<SizeType>(&count, 1);
+	if (write_error)
+	{
+		return write_error;
+	}
+
+	// write names
+	for (SizeType i = 0; i < count; i++)
+	{
+		write_error = WriteBinary<String>(&type_dictionary->GetName(i).Get(), 1);
+		if (write_error)
+		{
+			return write_error;
+		}
+	}
+
+	// save cursor position (where the dictionary is already written)
+	Result<stream::Cursor, Error> end_cursor = io.binary_output->GetCursor();
+	if (!end_cursor)
+	{
+		return end_cursor.MoveAlt();
+	}
+
+	// offset is relative to the reserved space, so that the archive
+	// doesn't have to start from the beginning of the stream
+	write_error = io.binary_output->MoveCursor(type_dictionary->anchor);
+	if (write_error)
+	{
+		return write_error;
+	}
+
+	const SizeType offset = static_cast<SizeType>(dictionary_cursor.Get() - type_dictionary->anchor);
+	write_error = WriteBinary<SizeType>(&offset, 1);
+	if (write_error)
+	{
+		return write_error;
+	}
+
+	// set cursor back
+	write_error = io.binary_output->MoveCursor(end_cursor.Get());
+	if (write_error)
+	{
+		return write_error;
+	}
+
+	return SyncWithStream();
+}
+
+//----------------------------------------------------------------------------->
+// Reads the type dictionary from the end of the archive, stream cursor
+// is moved back to the current position afterwards.
+//    @return - ut::Error if failed.
+Optional<Error> Controller::ReadTypeDictionary()
+{
+	Result<stream::Cursor, Error> offset_cursor = io.binary_input->GetCursor();
+	if (!offset_cursor)
+	{
+		return offset_cursor.MoveAlt();
+	}
+
+	// read offset of the dictionary
+	SizeType offset;
+	Optional<Error> read_error = ReadBinary<SizeType>(&offset, 1);
+	if (read_error)
+	{
+		return read_error;
+	}
+
+	// save cursor position (where the tree starts)
+	Result<stream::Cursor, Error> tree_cursor = io.binary_input->GetCursor();
+	if (!tree_cursor)
+	{
+		return tree_cursor.MoveAlt();
+	}
+
+	// jump to the dictionary
+	read_error = io.binary_input->MoveCursor(offset_cursor.Get() + offset);
+	if (read_error)
+	{
+		return read_error;
+	}
+
+	// read number of names
+	SizeType count;
+	read_error = ReadBinary<SizeType>(&count, 1);
+	if (read_error)
+	{
+		return read_error;
+	}
+
+	// read names
+	SharedPtr<TypeDictionary> dictionary = MakeShared<TypeDictionary>();
+	for (SizeType i = 0; i < count; i++)
+	{
+		String name;
+		read_error = ReadBinary<String>(&name, 1);
+		if (read_error)
+		{
+			return read_error;
+		}
+
+		read_error = dictionary->Add(Move(name));
+		if (read_error)
+		{
+			return read_error;
+		}
+	}
+
+	// remember where the archive ends
+	Result<stream::Cursor, Error> end_cursor = io.binary_input->GetCursor();
+	if (!end_cursor)
+	{
+		return end_cursor.MoveAlt();
+	}
+	dictionary->anchor = end_cursor.Get();
+	type_dictionary = Move(dictionary);
+
+	// get back to the tree
+	read_error = io.binary_input->MoveCursor(tree_cursor.Get());
+	if (read_error)
+	{
+		return read_error;
+	}
+
+	return SyncWithStream();
+}
+
+//----------------------------------------------------------------------------->
+// Registers entries of the dictionary of the separately serialized
+// subtrees in the current dictionary and replaces serialized indices
+// with the indices of the current dictionary.
+//    @param dictionary - dictionary of the subtrees, must track references.
+//    @param buffer - reference to the stream the subtrees were written to.
+//    @param offset - position of the buffer in the current stream.
+//    @return - ut::Error if failed.
+Optional<Error> Controller::MergeTypeDictionary(const TypeDictionary& dictionary,
+                                                BinaryStream& buffer,
+                                                stream::Cursor offset)
+{
+	// references are ordered by position, so the entries are registered
+	// in the same order as if the subtrees were written sequentially
+	const Array<TypeDictionary::Reference>& references = dictionary.GetReferences();
+	for (size_t i = 0; i < references.Count(); i++)
+	{
+		const TypeDictionary::Reference& reference = references[i];
+		Result<const String&, Error> name = dictionary.GetName(reference.id);
+		if (!name)
+		{
+			return name.MoveAlt();
+		}
+
+		Result<TypeDictionary::Id, Error> register_result = type_dictionary->Register(name.Get());
+		if (!register_result)
+		{
+			return register_result.MoveAlt();
+		}
+
+		// this controller can serialize a subtree itself
+		Optional<Error> reference_error = type_dictionary->AddReference(offset + reference.position,
+		                                                                register_result.Get());
+		if (reference_error)
+		{
+			return reference_error;
+		}
+
+		// overwrite the index using the endianness of the archive
+		Optional<Error> write_error = buffer.MoveCursor(reference.position);
+		if (write_error)
+		{
+			return write_error;
+		}
+
+		const SizeType id = static_cast<SizeType>(register_result.Get());
+		write_error = info.GetEndianness() == endianness::Order::little ?
+		              endianness::Write<endianness::Order::little>(buffer, &id, sizeof(id), 1) :
+		              endianness::Write<endianness::Order::big>(buffer, &id, sizeof(id), 1);
+		if (write_error)
+		{
+			return write_error;
+		}
+	}
+
+	// success
+	return Optional<Error>();
+}
+
 //----------------------------------------------------------------------------->
 // Searches for the shared parameter in the registry using provided name,
 // then tries to load this parameter.
-//    @param registry - reference to the array of shared cache elements,
+//    @param registry - reference to the map of shared objects (by id),
 //                      that are waiting to be deserialized.
 //    @param name - name of the serialized shared object.
 //    @param scope_state - state preceding reading of any shared parameter.
 //    @return - ut::Error if failed.
-Optional<Error> Controller::LoadSharedObject(Array<InputSharedCacheElement>& registry,
+Optional<Error> Controller::LoadSharedObject(SharedObjectRegistry& registry,
                                              const String& name,
                                              const Controller& scope_state)
 {
@@ -1846,48 +2811,37 @@ Optional<Error> Controller::LoadSharedObject(Array<InputSharedCacheElement>& reg
 		return Error(error::fail, error_desc);
 	}
 
-	// iterate all registry entries to find id match
-	for (size_t i = registry.Count(); i-- > 0;)
+	// find registry entry with the same id, loaded entries have no holder
+	const size_t id = static_cast<size_t>(uniform.Get().id.Get());
+	Optional<SharedPtr<SharedPtrHolderBase>&> entry = registry.Find(id);
+	if (entry && entry.Get())
 	{
-		// check if id matches
-		if (registry[i].id != static_cast<size_t>(uniform.Get().id.Get()))
-		{
-			continue;
-		}
+		// entry is marked as loaded by moving the holder out of the registry,
+		// the registry can grow below, so the reference must not be kept
+		SharedPtr<SharedPtrHolderBase> holder = Move(entry.Get());
 
 		// get back to the state where node is not read yet
 		LoadState(node_state);
 		Sync(); // stream cursor is farther after reading uniforms, must be adjusted
 
 		// load shared object
-		Optional<Error> load_error = registry[i].ptr->Load(*this, name);
+		Optional<Error> load_error = holder->Load(*this, name);
 		if (load_error)
 		{
 			return load_error;
 		}
 
 		// add deserialized parameter to the cache
-		Optional<Error> cache_error = linker->CacheInputSharedObject(registry[i].ptr,
-			                                                         registry[i].id);
+		Optional<Error> cache_error = linker->CacheInputSharedObject(holder, id);
 		if (cache_error)
 		{
 			return cache_error;
 		}
 
-		// remove enty from the registry - it's already loaded and ready to be linked with
-		registry.Remove(i);
-
 		// new preliminary links can occur while loading a shared object, thus it's essential
 		// to add these new entries to the current registry so that further shared objects
 		// (that are deeper than 1 level in linking hierarchy) could be deserialized
-		Array<InputSharedCacheElement> new_registry_entries = linker->MovePreliminarySharedCache();
-		for (size_t j = 0; j < new_registry_entries.Count(); j++)
-		{
-			registry.Add(Move(new_registry_entries[j]));
-		}
-
-		// exit the loop
-		break;
+		AddToSharedRegistry(registry, linker->MovePreliminarySharedCache());
 	}
 
 	// save current binary stream position
@@ -1907,6 +2861,21 @@ Optional<Error> Controller::LoadSharedObject(Array<InputSharedCacheElement>& reg
 	return Optional<Error>();
 }
 
+//----------------------------------------------------------------------------->
+// Adds provided shared cache elements to the registry of shared objects
+// waiting to be deserialized. Elements with ids that are already present
+// in the registry are skipped.
+//    @param registry - reference to the registry.
+//    @param elements - array of shared cache elements to be added.
+void Controller::AddToSharedRegistry(SharedObjectRegistry& registry,
+                                     Array<InputSharedCacheElement> elements)
+{
+	for (size_t i = 0; i < elements.Count(); i++)
+	{
+		registry.Insert(elements[i].id, Move(elements[i].ptr));
+	}
+}
+
 //----------------------------------------------------------------------------->
 // Uses provided id to generate a name of the shared parameter. Calling the
 // same function to generate names both for serialization and deserialization
@@ -2091,6 +3060,88 @@ Optional<Error> Controller::WriteBinary(const void* address,
 	return Optional<Error>();
 }
 
+// Reads a string prefixed with its length (see
+// serialization_flags::kLengthPrefixedStrings) at once.
+//    @str - reference to the string to be read
+//    @return - ut::Error if failed
+Optional<Error> Controller::ReadLengthPrefixedString(String& str)
+{
+	SizeType length;
+	Optional<Error> read_error = ReadBinary<SizeType>(&length, 1);
+	if (read_error)
+	{
+		return read_error;
+	}
+
+	// corrupted length must not lead to a huge allocation, the check is
+	// skipped if the stream doesn't know its size
+	Result<stream::Cursor, Error> cursor = io.binary_input->GetCursor();
+	Result<size_t, Error> stream_size = cursor ? io.binary_input->GetSize() :
+	                                             Result<size_t, Error>(MakeError(error::not_supported));
+	if (stream_size)
+	{
+		const size_t available = stream_size.Get() > cursor.Get() ? stream_size.Get() - cursor.Get() : 0;
+		if (length > available)
+		{
+			return Error(error::out_of_bounds, "String length exceeds the remaining size of the stream.");
+		}
+	}
+
+	// characters are read directly into the presized buffer,
+	// one byte characters don't depend on endianness
+	str = String(static_cast<size_t>(length));
+	return length != 0 ? ReadBinary(str.GetAddress(), 1, length) : Optional<Error>();
+}
+
+// Writes a string prefixed with its length.
+//    @str - reference to the string to be written
+//    @return - ut::Error if failed
+Optional<Error> Controller::WriteLengthPrefixedString(const String& str)
+{
+	const SizeType length = static_cast<SizeType>(str.Length());
+	Optional<Error> write_error = WriteBinary<SizeType>(&length, 1);
+	if (write_error)
+	{
+		return write_error;
+	}
+
+	return length != 0 ? WriteBinary(str.GetAddress(), 1, length) : Optional<Error>();
+}
+
+// Reads a null-terminated string character by character.
+//    @str - reference to the string to be read
+//    @return - ut::Error if failed
+Optional<Error> Controller::ReadNullTerminatedString(String& str)
+{
+	// clear the string
+	str.Reset();
+
+	// read symbol by symbol and exit after
+	// meeting a null-terminator
+	char c;
+	do
+	{
+		Optional<Error> read_error = ReadBinary<char>(&c, 1);
+		if (read_error)
+		{
+			return read_error;
+		}
+
+		str.Append(c);
+	} while (c != '\0');
+
+	// success
+	return Optional<Error>();
+}
+
+// Writes a string with a null-terminator.
+//    @str - reference to the string to be written
+//    @return - ut::Error if failed
+Optional<Error> Controller::WriteNullTerminatedString(const String& str)
+{
+	return WriteBinary(str.GetAddress(), 1, str.Length() + 1);
+}
+
 //----------------------------------------------------------------------------//
 END_NAMESPACE(meta)
 END_NAMESPACE(ut)
@@ -41,20 +41,43 @@ namespace serialization_flags
 	// enumeration in this case.
 	const Info::Flag kTextValueEncapsulation = 0x40;
 
+	// If this bit is on, binary strings are prefixed with their length and
+	// can be read at once. Otherwise strings are null-terminated and must be
+	// read character by character (data saved by the older versions of the
+	// library has this bit off, it's still readable).
+	const Info::Flag kLengthPrefixedStrings = 0x80;
+
+	// If this bit is on, every type name is written only once per binary
+	// archive - to the dictionary that follows all serialized entities, and
+	// entities refer to the type by its index in this dictionary. This makes
+	// archives with many objects of the same (polymorphic) type much smaller
+	// and faster to load. Text mode ignores this bit.
+	const Info::Flag kTypeDictionary = 0x100;
+
+	// If this bit is on, arrays of arithmetic values (see
+	// ut::meta::IsBulkSerializable) are written as a single value instead of
+	// a separate node per element. This bit is always set when saving, data
+	// saved by the older versions of the library has this bit off and is read
+	// element by element.
+	const Info::Flag kBulkArrays = 0x200;
+
 	// Set of flags with maximum information about the serialized entity.
 	const Info::Flag kComplete = kLittleEndian | kTypeInfo | kLinkageInfo |
 	                             kBinaryNames | kSizeInfo |
-	                             kTextValueEncapsulation;
+	                             kTextValueEncapsulation | kLengthPrefixedStrings |
+	                             kTypeDictionary | kBulkArrays;
 
 	// Set of flags with minimum information sufficient for serializing
 	// any entity. No serialization error can be handled in this case.
-	const Info::Flag kMinimal = kLittleEndian | kLinkageInfo | kTextValueEncapsulation;
+	const Info::Flag kMinimal = kLittleEndian | kLinkageInfo |
+	                            kTextValueEncapsulation | kLengthPrefixedStrings |
+	                            kTypeDictionary | kBulkArrays;
 
 	// Set of flags with minimum information about the serialized entity.
 	// References can't be serialized.
 	// This is suitable only for very primitive structures (plain values,
 	// arrays, etc.) without pointers.
-	const Info::Flag kPure = kLittleEndian;
+	const Info::Flag kPure = kLittleEndian | kLengthPrefixedStrings | kBulkArrays;
 }
 
 //----------------------------------------------------------------------------//
@@ -254,6 +277,79 @@ void Info::EnableValueEncapsulation(bool status)
 	VerifyFlags();
 }
 
+//----------------------------------------------------------------------------->
+// Returns 'true' if binary strings are prefixed with their length.
+// See ut::meta::serialization_flags::kLengthPrefixedStrings for details.
+bool Info::HasLengthPrefixedStrings() const
+{
+	return (flags & serialization_flags::kLengthPrefixedStrings) ? true : false;
+}
+
+// Turns on/off length prefixes of the binary strings, turn it off
+// to produce data readable by the older versions of the library.
+// See ut::meta::serialization_flags::kLengthPrefixedStrings for details.
+//    @param status - boolean that turns on/off length prefixes.
+void Info::EnableLengthPrefixedStrings(bool status)
+{
+	if (status)
+	{
+		flags |= serialization_flags::kLengthPrefixedStrings;
+	}
+	else
+	{
+		flags &= ~serialization_flags::kLengthPrefixedStrings;
+	}
+}
+
+//----------------------------------------------------------------------------->
+// Returns 'true' if type names are written once per binary archive.
+// See ut::meta::serialization_flags::kTypeDictionary for details.
+bool Info::HasTypeDictionary() const
+{
+	return (flags & serialization_flags::kTypeDictionary) ? true : false;
+}
+
+// Turns on/off the type dictionary, turn it off to produce
+// data readable by the older versions of the library.
+// See ut::meta::serialization_flags::kTypeDictionary for details.
+//    @param status - boolean that turns on/off the type dictionary.
+void Info::EnableTypeDictionary(bool status)
+{
+	if (status)
+	{
+		flags |= serialization_flags::kTypeDictionary;
+	}
+	else
+	{
+		flags &= ~serialization_flags::kTypeDictionary;
+	}
+}
+
+//----------------------------------------------------------------------------->
+// Returns 'true' if arithmetic arrays are serialized as a single value.
+// See ut::meta::serialization_flags::kBulkArrays for details.
+bool Info::HasBulkArrays() const
+{
+	return (flags & serialization_flags::kBulkArrays) ? true : false;
+}
+
+// Turns on/off the bulk layout of arithmetic arrays, the flag is set
+// automatically by ut::meta::Controller, because arrays are always saved
+// in bulk, so there is no need to call this function manually.
+// See ut::meta::serialization_flags::kBulkArrays for details.
+//    @param status - boolean that turns on/off the bulk layout.
+void Info::EnableBulkArrays(bool status)
+{
+	if (status)
+	{
+		flags |= serialization_flags::kBulkArrays;
+	}
+	else
+	{
+		flags &= ~serialization_flags::kBulkArrays;
+	}
+}
+
 //----------------------------------------------------------------------------->
 // Returns current set of binary flags.
 Info::Flag Info::GetFlags() const
@@ -8,6 +8,8 @@ START_NAMESPACE(meta)
 //----------------------------------------------------------------------------//
 // Default constructor
 Node::Node() : id(0)
+             , fixed(false)
+             , transient(false)
 {}
 
 // Constructor
@@ -20,6 +22,8 @@ Node::Node(const SharedPtr<BaseParameter>& in_parameter,
            uint32 in_id) : parameter(in_parameter)
                          , name(Move(in_name))
                          , id(in_id)
+                         , fixed(false)
+                         , transient(false)
 {}
 
 //----------------------------------------------------------------------------//
@@ -0,0 +1,457 @@
+//----------------------------------------------------------------------------//
+//---------------------------------|  U  T  |---------------------------------//
+//----------------------------------------------------------------------------//
+#include "meta/ut_meta_schema.h"
+//----------------------------------------------------------------------------//
+START_NAMESPACE(ut)
+START_NAMESPACE(meta)
+//----------------------------------------------------------------------------//
+// Constructor, is called only by ut::meta::Schema.
+//    @param owner - schema the snapshot belongs to, or nullptr
+//                   if the snapshot must not be cached.
+//    @param snapshot_ptr - unique pointer to the snapshot.
+//    @param in_anchors - pointer to the array of anchors.
+//    @param in_anchor_count - number of anchors.
+Schema::Lease::Lease(Schema* owner,
+                     UniquePtr<Snapshot> snapshot_ptr,
+                     const Anchor* in_anchors,
+                     size_t in_anchor_count) : schema(owner)
+                                             , snapshot(Move(snapshot_ptr))
+                                             , anchor_count(in_anchor_count)
+{
+	UT_ASSERT(anchor_count <= skMaxAnchors);
+	for (size_t i = 0; i < anchor_count; i++)
+	{
+		anchors[i] = in_anchors[i];
+	}
+}
+
+//----------------------------------------------------------------------------->
+// Move constructor
+Schema::Lease::Lease(Lease&& other) noexcept : schema(other.schema)
+                                             , snapshot(Move(other.snapshot))
+                                             , anchor_count(other.anchor_count)
+{
+	for (size_t i = 0; i < anchor_count; i++)
+	{
+		anchors[i] = other.anchors[i];
+	}
+	other.schema = nullptr;
+}
+
+//----------------------------------------------------------------------------->
+// Move operator
+Schema::Lease& Schema::Lease::operator = (Lease&& other) noexcept
+{
+	if (schema != nullptr && snapshot)
+	{
+		schema->Release(Move(snapshot), anchors);
+	}
+
+	schema = other.schema;
+	snapshot = Move(other.snapshot);
+	anchor_count = other.anchor_count;
+	for (size_t i = 0; i < anchor_count; i++)
+	{
+		anchors[i] = other.anchors[i];
+	}
+	other.schema = nullptr;
+
+	return *this;
+}
+
+//----------------------------------------------------------------------------->
+// Destructor, returns the snapshot to the cache.
+Schema::Lease::~Lease()
+{
+	if (schema != nullptr && snapshot)
+	{
+		schema->Release(Move(snapshot), anchors);
+	}
+}
+
+//----------------------------------------------------------------------------->
+// Returns a reference to the snapshot bound to the object.
+Snapshot& Schema::Lease::Get()
+{
+	return snapshot.GetRef();
+}
+
+//----------------------------------------------------------------------------->
+// Dereference operator
+Snapshot& Schema::Lease::operator *()
+{
+	return snapshot.GetRef();
+}
+
+//----------------------------------------------------------------------------->
+// Dereference operator
+Snapshot* Schema::Lease::operator ->()
+{
+	return snapshot.Get();
+}
+
+//----------------------------------------------------------------------------//
+// Constructor, use Schema::Get() to access the schema of the desired type.
+Schema::Schema() : state(State::empty)
+                 , dynamic_type(nullptr)
+{}
+
+//----------------------------------------------------------------------------->
+// Returns 'true' if cached snapshots can be reused,
+// 'false' if the type violates the rules (see class description).
+bool Schema::IsCacheable() const
+{
+	ScopeLock lock(mutex);
+	return state != State::not_cacheable;
+}
+
+//----------------------------------------------------------------------------->
+// Returns a cached snapshot bound to the anchors, or captures a new one.
+//    @param anchors - pointer to the array of anchors.
+//    @param anchor_count - number of anchors.
+//    @param name - name of the snapshot.
+//    @param info - serialization info.
+//    @param capture - function capturing a new snapshot.
+//    @return - lease of the snapshot or ut::Error if failed.
+Result<Schema::Lease, Error> Schema::AcquireSnapshot(const Anchor* anchors,
+                                                     size_t anchor_count,
+                                                     String name,
+                                                     Info info,
+                                                     const Function<Snapshot()>& capture)
+{
+	// try to pick a cached snapshot
+	UniquePtr<Snapshot> snapshot;
+	bool cacheable = false;
+	{
+		ScopeLock lock(mutex);
+		if (state == State::cacheable && anchor_count == anchor_sizes.Count())
+		{
+			cacheable = true;
+			for (size_t i = 0; i < anchor_count; i++)
+			{
+				cacheable = cacheable && anchors[i].size == anchor_sizes[i];
+			}
+
+			if (cacheable && cache.Count() != 0)
+			{
+				snapshot = Move(cache.GetLast());
+				cache.Remove(cache.Count() - 1);
+			}
+		}
+	}
+
+	if (snapshot)
+	{
+		// entries are never changed after the schema became cacheable
+		size_t entry_id = 0;
+		Bind(snapshot.GetRef(), anchors, entry_id);
+	}
+	else
+	{
+		snapshot = MakeUnique<Snapshot>(capture());
+
+		// describe the new snapshot and compare it with the cached description
+		ScopeLock lock(mutex);
+		if (state != State::not_cacheable)
+		{
+			Array<Entry> description;
+			const bool valid = Describe(snapshot.GetRef(), anchors, anchor_count, description);
+			if (valid && state == State::empty)
+			{
+				entries = Move(description);
+				anchor_sizes.Reset();
+				for (size_t i = 0; i < anchor_count; i++)
+				{
+					anchor_sizes.Add(anchors[i].size);
+				}
+				state = State::cacheable;
+			}
+			else if (!valid || !cacheable || !MatchEntries(description))
+			{
+				// reflection depends on the instance
+				state = State::not_cacheable;
+				cache.Reset();
+			}
+
+			cacheable = state == State::cacheable;
+		}
+
+		if (cacheable)
+		{
+			size_t entry_id = 0;
+			Mark(snapshot.GetRef(), entry_id);
+		}
+	}
+
+	// apply desired name and serialization info
+	snapshot->data.name = Move(name);
+	snapshot->info.GetRef() = Move(info);
+
+	return Lease(cacheable ? this : nullptr, Move(snapshot), anchors, anchor_count);
+}
+
+//----------------------------------------------------------------------------->
+// Returns the snapshot to the cache if it's still bound to the anchors,
+// loading can replace objects managed by pointers.
+//    @param snapshot - unique pointer to the snapshot.
+//    @param anchors - pointer to the array of anchors.
+void Schema::Release(UniquePtr<Snapshot> snapshot, const Anchor* anchors)
+{
+	// callbacks could be assigned by the user of the lease
+	snapshot->presave = Function<void()>();
+	snapshot->postsave = Function<void()>();
+	snapshot->preload = Function<void()>();
+	snapshot->postload = Function<void()>();
+
+	size_t entry_id = 0;
+	if (!Strip(snapshot.GetRef(), anchors, entry_id))
+	{
+		return;
+	}
+
+	ScopeLock lock(mutex);
+	if (state == State::cacheable && cache.Count() < skMaxCachedSnapshots)
+	{
+		cache.Add(Move(snapshot));
+	}
+}
+
+//----------------------------------------------------------------------------->
+// Describes every node of the newly captured snapshot.
+//    @param node - reference to the current node.
+//    @param anchors - pointer to the array of anchors.
+//    @param anchor_count - number of anchors.
+//    @param out - array to receive node descriptions.
+//    @return - 'true' if the snapshot can be cached.
+bool Schema::Describe(Snapshot& node,
+                      const Anchor* anchors,
+                      size_t anchor_count,
+                      Array<Entry>& out)
+{
+	// managed object must be inside one of the anchors
+	const void* address = node.data.parameter->GetAddress();
+	Optional<uint32> anchor = FindAnchor(address, anchors, anchor_count);
+	if (!anchor)
+	{
+		return false;
+	}
+
+	Entry entry;
+	entry.anchor = anchor.Get();
+	entry.offset = static_cast<size_t>(static_cast<const byte*>(address) - anchors[entry.anchor].address);
+	entry.fixed = !node.data.parameter->GetTraits().container;
+	entry.child_count = node.CountChildren();
+
+	// children of the containers are reflected on every use, except for
+	// the case when every child is an anchor itself (see Schema::Acquire())
+	entry.reflect = false;
+	if (!entry.fixed)
+	{
+		entry.reflect = entry.child_count == 0;
+		for (size_t i = 0; i < entry.child_count; i++)
+		{
+			const byte* child_address = static_cast<const byte*>(node[i].data.parameter->GetAddress());
+			Optional<uint32> child_anchor = FindAnchor(child_address, anchors, anchor_count);
+			if (!child_anchor || child_anchor.Get() == 0 ||
+			    anchors[child_anchor.Get()].address != child_address)
+			{
+				entry.reflect = true;
+				break;
+			}
+		}
+	}
+	else if (node.presave.IsValid() || node.postsave.IsValid() ||
+	         node.preload.IsValid() || node.postload.IsValid())
+	{
+		// callbacks can be bound to the reflected object
+		return false;
+	}
+
+	if (entry.reflect)
+	{
+		entry.child_count = 0;
+	}
+
+	if (!out.Add(entry))
+	{
+		return false;
+	}
+
+	// describe children
+	if (!entry.reflect)
+	{
+		for (size_t i = 0; i < entry.child_count; i++)
+		{
+			if (!Describe(node[i], anchors, anchor_count, out))
+			{
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+//----------------------------------------------------------------------------->
+// Rebinds every node of the cached snapshot to the new anchors.
+//    @param node - reference to the current node.
+//    @param anchors - pointer to the array of anchors.
+//    @param entry_id - reference to the id of the current entry.
+void Schema::Bind(Snapshot& node, const Anchor* anchors, size_t& entry_id) const
+{
+	const Entry& entry = entries[entry_id++];
+	node.data.parameter->ptr = anchors[entry.anchor].address + entry.offset;
+	node.data.fixed = entry.fixed;
+
+	if (entry.reflect)
+	{
+		node.Reset();
+		node.data.parameter->Reflect(node);
+		return;
+	}
+
+	for (size_t i = 0; i < entry.child_count; i++)
+	{
+		Bind(node[i], anchors, entry_id);
+	}
+}
+
+//----------------------------------------------------------------------------->
+// Checks that the snapshot is still bound to the anchors and removes
+// children of the nodes that are reflected on every use.
+//    @param node - reference to the current node.
+//    @param anchors - pointer to the array of anchors.
+//    @param entry_id - reference to the id of the current entry.
+//    @return - 'true' if the snapshot can be cached.
+bool Schema::Strip(Snapshot& node, const Anchor* anchors, size_t& entry_id) const
+{
+	if (entry_id >= entries.Count())
+	{
+		return false;
+	}
+
+	const Entry& entry = entries[entry_id++];
+	const byte* expected_address = anchors[entry.anchor].address + entry.offset;
+	if (node.data.parameter->GetAddress() != expected_address)
+	{
+		return false;
+	}
+
+	if (entry.reflect)
+	{
+		node.Reset();
+		return true;
+	}
+
+	if (node.CountChildren() != entry.child_count)
+	{
+		return false;
+	}
+
+	for (size_t i = 0; i < entry.child_count; i++)
+	{
+		if (!Strip(node[i], anchors, entry_id))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+//----------------------------------------------------------------------------->
+// Marks nodes of the newly captured snapshot as fixed.
+//    @param node - reference to the current node.
+//    @param entry_id - reference to the id of the current entry.
+void Schema::Mark(Snapshot& node, size_t& entry_id) const
+{
+	const Entry& entry = entries[entry_id++];
+	node.data.fixed = entry.fixed;
+
+	if (entry.reflect)
+	{
+		return;
+	}
+
+	for (size_t i = 0; i < entry.child_count; i++)
+	{
+		Mark(node[i], entry_id);
+	}
+}
+
+//----------------------------------------------------------------------------->
+// Compares provided description with the cached one.
+//    @param description - description of the snapshot.
+//    @return - 'true' if descriptions are equal.
+bool Schema::MatchEntries(const Array<Entry>& description) const
+{
+	const size_t count = entries.Count();
+	if (description.Count() != count)
+	{
+		return false;
+	}
+
+	for (size_t i = 0; i < count; i++)
+	{
+		const Entry& a = entries[i];
+		const Entry& b = description[i];
+		if (a.anchor != b.anchor || a.offset != b.offset || a.fixed != b.fixed ||
+		    a.reflect != b.reflect || a.child_count != b.child_count)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+//----------------------------------------------------------------------------->
+// Checks that all objects bound to this schema have the same dynamic type.
+//    @param type - dynamic type of the object, or nullptr if
+//                  the type is not polymorphic.
+//    @return - ut::Error if types don't match.
+Optional<Error> Schema::CheckDynamicType(const DynamicType* type)
+{
+	ScopeLock lock(mutex);
+	if (dynamic_type == nullptr)
+	{
+		dynamic_type = type;
+	}
+	else if (dynamic_type != type)
+	{
+		return Error(error::types_not_match, "Schema is bound to another dynamic type.");
+	}
+
+	return Optional<Error>();
+}
+
+//----------------------------------------------------------------------------->
+// Returns the id of the anchor containing provided address.
+//    @param address - address of the object.
+//    @param anchors - pointer to the array of anchors.
+//    @param anchor_count - number of anchors.
+//    @return - id of the anchor or nothing if not found.
+Optional<uint32> Schema::FindAnchor(const void* address,
+                                    const Anchor* anchors,
+                                    size_t anchor_count)
+{
+	const uptr value = reinterpret_cast<uptr>(address);
+	for (size_t i = 0; i < anchor_count; i++)
+	{
+		const uptr start = reinterpret_cast<uptr>(anchors[i].address);
+		if (value >= start && value < start + anchors[i].size)
+		{
+			return static_cast<uint32>(i);
+		}
+	}
+
+	return Optional<uint32>();
+}
+
+//----------------------------------------------------------------------------//
+END_NAMESPACE(meta)
+END_NAMESPACE(ut)
+//----------------------------------------------------------------------------//
+//----------------------------------------------------------------------------//
+//----------------------------------------------------------------------------//
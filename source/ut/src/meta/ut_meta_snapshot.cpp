@@ -3,6 +3,8 @@
 //----------------------------------------------------------------------------//
 #include "meta/ut_meta_snapshot.h"
 #include "meta/ut_meta_controller.h"
+#include "streams/ut_buffered_stream.h"
+#include "hash/ut_murmur2.h"
 //----------------------------------------------------------------------------//
 START_NAMESPACE(ut)
 START_NAMESPACE(meta)
@@ -11,11 +13,39 @@ START_NAMESPACE(meta)
 // serialization events must be logged to the global log (ut::log).
 static const bool skLogSerializationEvents = true;
 
+//----------------------------------------------------------------------------//
+// ut::meta::DeltaArchive is the serialized form of the delta,
+// see Snapshot::SaveDelta().
+class DeltaArchive : public Reflective
+{
+public:
+	DeltaArchive() : version(0), flags(0)
+	{}
+
+	void Reflect(Snapshot& snapshot)
+	{
+		snapshot.Add(version, "version");
+		snapshot.Add(flags, "flags");
+		snapshot.Add(paths, "paths");
+		snapshot.Add(nodes, "nodes");
+	}
+
+	// format of the serialized nodes
+	Info::Version version;
+	Info::Flag flags;
+
+	// paths of the changed nodes and their binary form
+	Array<String> paths;
+	Array< Array<byte> > nodes;
+};
+
 //----------------------------------------------------------------------------//
 // Constructor
 //    @param info_copy - copy of the serialization info, that will be
 //                       used during serialization and deserialization
-Snapshot::Snapshot(Info info_copy) : Base(), info(MakeUnsafeShared<Info>(Move(info_copy)))
+Snapshot::Snapshot(Info info_copy) : Base()
+                                    , info(MakeUnsafeShared<Info>(Move(info_copy)))
+                                    , deferred_offset(0)
 { }
 
 //----------------------------------------------------------------------------->
@@ -23,6 +53,21 @@ Snapshot::Snapshot(Info info_copy) : Base(), info(MakeUnsafeShared<Info>(Move(in
 void Snapshot::Rename(String new_name)
 {
 	data.name = Move(new_name);
+
+	// name index of the parent is not valid anymore
+	Optional<Snapshot&> parent = GetParent();
+	if (parent)
+	{
+		parent->child_index.Reset();
+	}
+}
+
+//----------------------------------------------------------------------------->
+// Removes child nodes of the snapshot.
+void Snapshot::Reset()
+{
+	Base::Reset();
+	child_index.Reset();
 }
 
 //----------------------------------------------------------------------------->
@@ -31,6 +76,246 @@ void Snapshot::Rename(String new_name)
 //    @return - optionally ut::Error if failed
 Optional<Error> Snapshot::Save(OutputStream& stream)
 {
+	return SaveBinary(stream, nullptr);
+}
+
+//----------------------------------------------------------------------------->
+// Saves full tree to a binary stream, sibling subtrees are serialized
+// simultaneously in the provided thread pool.
+//    @param stream - reference to the output stream to serialize a tree to
+//    @param pool - thread pool to serialize subtrees in
+//    @return - optionally ut::Error if failed
+Optional<Error> Snapshot::Save(OutputStream& stream, ThreadPool<void>& pool)
+{
+	return SaveBinary(stream, &pool);
+}
+
+//----------------------------------------------------------------------------->
+// Loads full tree from a stream.
+//    @param stream - reference to the input stream to deserialize from
+//    @return - optionally ut::Error if failed
+Optional<Error> Snapshot::Load(InputStream& stream)
+{
+	return LoadBinary(stream, nullptr, false);
+}
+
+//----------------------------------------------------------------------------->
+// Loads full tree from a binary stream, sibling subtrees are deserialized
+// simultaneously in the provided thread pool.
+//    @param stream - reference to the input stream to deserialize from
+//    @param pool - thread pool to deserialize subtrees in
+//    @return - optionally ut::Error if failed
+Optional<Error> Snapshot::Load(InputStream& stream, ThreadPool<void>& pool)
+{
+	return LoadBinary(stream, &pool, false);
+}
+
+//----------------------------------------------------------------------------->
+// Loads the tree from a binary stream lazily, leaves of the root node are
+// loaded on the first access via Snapshot::FindChildByName().
+//    @param stream - reference to the input stream supporting positioning
+//    @return - optionally ut::Error if failed
+Optional<Error> Snapshot::LoadLazy(InputStream& stream)
+{
+	// leaves are read later at remembered positions
+	if (!stream.GetCursor())
+	{
+		return Error(error::not_supported, "Lazy loading requires a stream that supports positioning.");
+	}
+
+	return LoadBinary(stream, nullptr, true);
+}
+
+//----------------------------------------------------------------------------->
+// Returns a view of the serialized data of the binary leaf that is
+// waiting to be loaded lazily.
+//    @param child_name - name of the leaf.
+//    @return - view of the data or ut::Error if failed.
+Result<Controller::BinaryView, Error> Snapshot::MapBinary(const String& child_name)
+{
+	const Optional<size_t> find_result = child_index.Find(*this, child_name);
+	if (!find_result)
+	{
+		return MakeError(error::not_found);
+	}
+
+	const Snapshot& leaf = Base::child_nodes[find_result.Get()];
+	if (!leaf.deferred_source)
+	{
+		return MakeError(error::fail, "Node isn't waiting to be loaded lazily.");
+	}
+
+	Controller controller(leaf.deferred_source.GetRef());
+	Optional<Error> cursor_error = controller.SetCursor(leaf.deferred_offset, true);
+	if (cursor_error)
+	{
+		return MakeError(cursor_error.Move());
+	}
+
+	return controller.MapBinaryValue();
+}
+
+//----------------------------------------------------------------------------->
+// Saves only the nodes that changed since the previous delta was saved
+// against the same @baseline, the first delta contains the whole tree.
+//    @param stream - reference to the output stream to write the delta to
+//    @param baseline - reference to the digests of the previous state
+//    @return - optionally ut::Error if failed
+Optional<Error> Snapshot::SaveDelta(OutputStream& stream, Baseline& baseline)
+{
+	// linkage ids and type dictionary refer to the whole archive,
+	// so they can't be used in separate nodes
+	Info delta_info(info.GetRef());
+	delta_info.EnableLinkageInformation(false);
+	delta_info.EnableTypeDictionary(false);
+
+	// write the whole tree to memory remembering positions of the nodes
+	BinaryStream buffer;
+	Controller::NodeRecorder records;
+	Controller controller(delta_info);
+	Optional<Error> mode_error = controller.SetBinaryOutputStream(buffer);
+	if (mode_error)
+	{
+		return mode_error;
+	}
+	controller.SetNodeRecorder(&records);
+
+	// call pre-save callback functions
+	InvokeCallback(&Snapshot::presave);
+
+	meta::Controller::SerializationOptions default_options;
+	Optional<Error> write_error = controller.WriteNode(*this, default_options);
+	if (write_error)
+	{
+		return write_error;
+	}
+
+	// digests of the other format can't be compared
+	if (baseline.version != delta_info.GetVersion() || baseline.flags != delta_info.GetFlags())
+	{
+		baseline.Reset();
+		baseline.version = delta_info.GetVersion();
+		baseline.flags = delta_info.GetFlags();
+	}
+
+	// compare the tree with the baseline
+	const Array<byte>& data = buffer.GetBuffer();
+	Baseline::Digests digests;
+	Result<Baseline::Digest, Error> digest = CalculateDigests(String(), records, data, digests);
+	if (!digest)
+	{
+		return digest.MoveAlt();
+	}
+
+	DeltaArchive delta;
+	delta.version = delta_info.GetVersion();
+	delta.flags = delta_info.GetFlags();
+	Optional<Error> collect_error = CollectDelta(String(), records, data,
+	                                             baseline.digests, digests,
+	                                             delta.paths, delta.nodes);
+	if (collect_error)
+	{
+		return collect_error;
+	}
+
+	// write changed nodes
+	Info archive_info = Info::CreateComplete();
+	archive_info.EnableLinkageInformation(false);
+	Optional<Error> save_error = Snapshot::Capture(delta, "delta", archive_info).Save(stream);
+	if (save_error)
+	{
+		return save_error;
+	}
+
+	// the saved state becomes a new baseline
+	baseline.digests = Move(digests);
+
+	// call post-save callback functions
+	InvokeCallback(&Snapshot::postsave);
+
+	// success
+	return Optional<Error>();
+}
+
+//----------------------------------------------------------------------------->
+// Applies the delta saved with Snapshot::SaveDelta().
+//    @param stream - reference to the input stream to read the delta from
+//    @return - optionally ut::Error if failed
+Optional<Error> Snapshot::LoadDelta(InputStream& stream)
+{
+	DeltaArchive delta;
+	Info archive_info = Info::CreateComplete();
+	archive_info.EnableLinkageInformation(false);
+	Optional<Error> load_error = Snapshot::Capture(delta, "delta", archive_info).Load(stream);
+	if (load_error)
+	{
+		return load_error;
+	}
+
+	if (delta.paths.Count() != delta.nodes.Count())
+	{
+		return Error(error::fail, "Delta is corrupted.");
+	}
+
+	// call pre-load callback functions
+	InvokeCallback(&Snapshot::preload);
+
+	// every node is read from a separate buffer
+	const Info delta_info(delta.version, delta.flags);
+	for (size_t i = 0; i < delta.paths.Count(); i++)
+	{
+		const String& path = delta.paths[i];
+		Optional<Snapshot&> node = path.Length() == 0 ? Optional<Snapshot&>(*this) : FindChildByName(path);
+		if (!node)
+		{
+			return Error(error::not_found, String("Node \"") + path + "\" of the delta wasn't found.");
+		}
+
+		BinaryStream buffer;
+		buffer.SetBuffer(Move(delta.nodes[i]));
+		Controller controller(delta_info);
+		Optional<Error> mode_error = controller.SetBinaryInputStream(buffer);
+		if (mode_error)
+		{
+			return mode_error;
+		}
+
+		meta::Controller::SerializationOptions options;
+		options.initialize = false;
+		Result<Controller::Uniform, Error> read_result = controller.ReadNode(node.Get(), options);
+		if (!read_result)
+		{
+			return read_result.MoveAlt();
+		}
+	}
+
+	// call post-load callback functions
+	InvokeCallback(&Snapshot::postload);
+
+	// success
+	return Optional<Error>();
+}
+
+//----------------------------------------------------------------------------->
+// Saves full tree to a binary stream.
+//    @param stream - reference to the output stream to serialize a tree to
+//    @param pool - thread pool to serialize subtrees in, or nullptr
+//    @return - optionally ut::Error if failed
+Optional<Error> Snapshot::SaveBinary(OutputStream& stream, ThreadPool<void>* pool)
+{
+	// sizes and links are back-patched, so the stream must support positioning
+	if (!stream.GetCursor())
+	{
+		BufferedOutputStream buffered_stream(stream);
+		Optional<Error> save_error = SaveBinary(buffered_stream, pool);
+		if (save_error)
+		{
+			return save_error;
+		}
+
+		return buffered_stream.Flush();
+	}
+
 	// create a new controller using current information object
 	Controller controller(info.GetRef());
 
@@ -40,6 +325,7 @@ Optional<Error> Snapshot::Save(OutputStream& stream)
 	{
 		return mode_error;
 	}
+	controller.SetThreadPool(pool);
 
 	// call pre-save callback functions
 	InvokeCallback(&Snapshot::presave);
@@ -60,11 +346,21 @@ Optional<Error> Snapshot::Save(OutputStream& stream)
 }
 
 //----------------------------------------------------------------------------->
-// Loads full tree from a stream.
+// Loads full tree from a binary stream.
 //    @param stream - reference to the input stream to deserialize from
+//    @param pool - thread pool to deserialize subtrees in, or nullptr
+//    @param lazy - 'true' to load leaves on demand, see Snapshot::LoadLazy()
 //    @return - optionally ut::Error if failed
-Optional<Error> Snapshot::Load(InputStream& stream)
+Optional<Error> Snapshot::LoadBinary(InputStream& stream, ThreadPool<void>* pool, bool lazy)
 {
+	// skipped parameters are read once again, so the
+	// stream must support positioning
+	if (!stream.GetCursor())
+	{
+		BufferedInputStream buffered_stream(stream);
+		return LoadBinary(buffered_stream, pool, lazy);
+	}
+
 	// create a new controller using current information object
 	Controller controller(info.GetRef());
 
@@ -74,6 +370,8 @@ Optional<Error> Snapshot::Load(InputStream& stream)
 	{
 		return mode_error;
 	}
+	controller.SetThreadPool(pool);
+	controller.SetLazyLoading(lazy);
 	
 	// call pre-load callback functions
 	InvokeCallback(&Snapshot::preload);
@@ -184,17 +482,196 @@ Optional<Snapshot&> Snapshot::FindChildByName(const String& node_name)
 
 	// search a leaf node by name
 	const bool is_final_node = *pstr == '\0';
-	for (size_t i = 0; i < Base::CountChildren(); i++)
+	const Optional<size_t> find_result = child_index.Find(*this, leaf_name);
+	if (!find_result)
+	{
+		return Optional<Snapshot&>(); // not found
+	}
+
+	Snapshot& leaf = Base::child_nodes[find_result.Get()];
+
+	// load the leaf on the first access, see Snapshot::LoadLazy()
+	if (leaf.deferred_source)
+	{
+		Optional<Error> load_error = leaf.LoadDeferred();
+		if (load_error)
+		{
+			String error_desc = "Serialization error: Lazy loading of the parameter \"";
+			error_desc += leaf_name + "\" failed: " + load_error.Get().GetDesc();
+			info->LogMessage(error_desc);
+			return Optional<Snapshot&>();
+		}
+	}
+
+	return is_final_node ? leaf : leaf.FindChildByName(++pstr);
+}
+
+//----------------------------------------------------------------------------->
+// Calculates digests of the serialized subtree, see Snapshot::SaveDelta().
+//    @param path - path to this node.
+//    @param records - positions of the serialized nodes.
+//    @param data - serialized tree.
+//    @param digests - reference to the container to add digests to.
+//    @return - digest of this node or ut::Error if failed
+Result<Baseline::Digest, Error> Snapshot::CalculateDigests(const String& path,
+                                                           const Controller::NodeRecorder& records,
+                                                           const Array<byte>& data,
+                                                           Baseline::Digests& digests) const
+{
+	Optional<const Controller::NodeRecord&> find_result = records.Find(this);
+	if (!find_result)
+	{
+		return MakeError(error::not_found, "Node wasn't serialized.");
+	}
+	const Controller::NodeRecord& record = find_result.Get();
+	const byte* bytes = data.GetAddress();
+
+	// body digest includes the number of leaves, so it's enough to check
+	// body digest to find out if the set of leaves has changed
+	const uint64 child_count = child_nodes.Count();
+	Baseline::Digest digest;
+	digest.body = MurmurHash64A(bytes + record.body,
+	                            record.leaves - record.body,
+	                            Baseline::skSeed);
+	digest.body = MurmurHash64A(&child_count, sizeof(uint64), digest.body);
+
+	// subtree digest is combined from the uniforms,
+	// the body and the digests of all leaves
+	digest.subtree = MurmurHash64A(bytes + record.start,
+	                               record.body - record.start,
+	                               digest.body);
+	for (size_t i = 0; i < child_count; i++)
+	{
+		const Snapshot& child = child_nodes[i];
+		Result<Baseline::Digest, Error> child_digest = child.CalculateDigests(MakeChildPath(path, child.data.name),
+		                                                                      records, data, digests);
+		if (!child_digest)
+		{
+			return MakeError(child_digest.MoveAlt());
+		}
+
+		digest.subtree = MurmurHash64A(&child_digest.Get().subtree, sizeof(uint64), digest.subtree);
+	}
+
+	// paths of the leaves with the same name are the same,
+	// the first one is used (see Snapshot::FindChildByName())
+	digests.Insert(path, digest);
+
+	return digest;
+}
+
+//----------------------------------------------------------------------------->
+// Adds serialized nodes that differ from the baseline to the delta.
+//    @param path - path to this node.
+//    @param records - positions of the serialized nodes.
+//    @param data - serialized tree.
+//    @param previous - digests of the baseline.
+//    @param current - digests of the serialized tree.
+//    @param paths - reference to the array of paths of the changed nodes.
+//    @param nodes - reference to the array of the changed nodes.
+//    @return - optionally ut::Error if failed
+Optional<Error> Snapshot::CollectDelta(const String& path,
+                                       const Controller::NodeRecorder& records,
+                                       const Array<byte>& data,
+                                       const Baseline::Digests& previous,
+                                       const Baseline::Digests& current,
+                                       Array<String>& paths,
+                                       Array< Array<byte> >& nodes) const
+{
+	Optional<const Baseline::Digest&> digest = current.Find(path);
+	Optional<const Controller::NodeRecord&> record = records.Find(this);
+	if (!digest || !record)
+	{
+		return Error(error::not_found, "Node wasn't serialized.");
+	}
+
+	// unchanged subtree is skipped
+	Optional<const Baseline::Digest&> previous_digest = previous.Find(path);
+	if (previous_digest && previous_digest->subtree == digest->subtree)
+	{
+		return Optional<Error>();
+	}
+
+	// leaves are compared separately only if the node itself didn't change
+	// and every leaf can be found by path unambiguously
+	const size_t child_count = child_nodes.Count();
+	bool compare_leaves = previous_digest && previous_digest->body == digest->body && child_count != 0;
+	for (size_t i = 0; compare_leaves && i < child_count; i++)
 	{
-		Snapshot& leaf = Base::child_nodes[i];
-		if (leaf_name == leaf.data.name)
+		const String& name = child_nodes[i].data.name;
+		const Optional<size_t> leaf_id = child_index.Find(*this, name);
+		compare_leaves = leaf_id && leaf_id.Get() == i && previous.Find(MakeChildPath(path, name));
+	}
+
+	if (compare_leaves)
+	{
+		for (size_t i = 0; i < child_count; i++)
 		{
-			return is_final_node ? Base::child_nodes[i] : leaf.FindChildByName(++pstr);
+			const Snapshot& child = child_nodes[i];
+			Optional<Error> collect_error = child.CollectDelta(MakeChildPath(path, child.data.name),
+			                                                   records, data, previous, current,
+			                                                   paths, nodes);
+			if (collect_error)
+			{
+				return collect_error;
+			}
 		}
+
+		return Optional<Error>();
+	}
+
+	// the whole node is written
+	const size_t node_size = record->end - record->start;
+	Array<byte> node_data(node_size);
+	if (node_data.GetSize() != node_size)
+	{
+		return Error(error::out_of_memory);
 	}
+	memory::Copy(node_data.GetAddress(), data.GetAddress() + record->start, node_size);
 
-	// not found
-	return Optional<Snapshot&>();
+	if (!paths.Add(path) || !nodes.Add(Move(node_data)))
+	{
+		return Error(error::out_of_memory);
+	}
+
+	// success
+	return Optional<Error>();
+}
+
+//----------------------------------------------------------------------------->
+// Returns the path of the leaf with provided name.
+//    @param path - path to this node.
+//    @param name - name of the leaf.
+String Snapshot::MakeChildPath(const String& path, const String& name)
+{
+	return path.Length() == 0 ? name : path + "/" + name;
+}
+
+//----------------------------------------------------------------------------->
+// Loads the node that was waiting to be loaded lazily.
+//    @return - optionally ut::Error if failed
+Optional<Error> Snapshot::LoadDeferred()
+{
+	// the node is considered loaded even if loading fails
+	Controller controller(deferred_source.GetRef());
+	deferred_source = SharedPtr<Controller>();
+
+	Optional<Error> cursor_error = controller.SetCursor(deferred_offset, true);
+	if (cursor_error)
+	{
+		return cursor_error;
+	}
+
+	meta::Controller::SerializationOptions options;
+	options.initialize = false;
+	Result<Controller::Uniform, Error> read_result = controller.ReadNode(*this, options);
+	if (!read_result)
+	{
+		return read_result.MoveAlt();
+	}
+
+	// success
+	return Optional<Error>();
 }
 
 //----------------------------------------------------------------------------->
@@ -276,9 +753,26 @@ bool Snapshot::ValidateParameterName(const String& name)
 // the same serialization info structure
 //    @param info_ptr - reference to the shared pointer with the serialization
 //                      info structure, that is shared among all tree branches
-Snapshot::Snapshot(const InfoSharedPtr& info_ptr) : Base(), info(info_ptr)
+Snapshot::Snapshot(const InfoSharedPtr& info_ptr) : Base()
+                                                   , info(info_ptr)
+                                                   , deferred_offset(0)
 { }
 
+//----------------------------------------------------------------------------->
+// Makes the whole subtree share provided serialization info.
+//    @param info_ptr - reference to the shared pointer with the
+//                      serialization info structure.
+void Snapshot::ShareInfo(const InfoSharedPtr& info_ptr)
+{
+	info = info_ptr;
+
+	const size_t child_count = child_nodes.Count();
+	for (size_t i = 0; i < child_count; i++)
+	{
+		child_nodes[i].ShareInfo(info_ptr);
+	}
+}
+
 //----------------------------------------------------------------------------->
 // Recursively calls desired callback.
 //    @param callback_ptr - pointer to the member representing
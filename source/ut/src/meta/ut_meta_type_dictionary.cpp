@@ -0,0 +1,155 @@
+//----------------------------------------------------------------------------//
+//---------------------------------|  U  T  |---------------------------------//
+//----------------------------------------------------------------------------//
+#include "meta/ut_meta_type_dictionary.h"
+//----------------------------------------------------------------------------//
+START_NAMESPACE(ut)
+START_NAMESPACE(meta)
+//----------------------------------------------------------------------------//
+// Constructor
+//    @param in_track_references - 'true' to remember positions of the
+//                                 serialized indices, see AddReference().
+TypeDictionary::TypeDictionary(bool in_track_references) : anchor(0)
+                                                          , track_references(in_track_references)
+{}
+
+//----------------------------------------------------------------------------->
+// Returns the index of the entry with provided type name, a new entry
+// is created if this name wasn't registered yet.
+//    @param name - name of the type.
+//    @return - index of the entry or ut::Error if failed.
+Result<TypeDictionary::Id, Error> TypeDictionary::Register(const String& name)
+{
+	Optional<Id&> find_result = ids.Find(name);
+	if (find_result)
+	{
+		return find_result.Get();
+	}
+
+	const Id id = static_cast<Id>(entries.Count());
+	Optional<Error> add_error = Add(name);
+	if (add_error)
+	{
+		return MakeError(add_error.Move());
+	}
+
+	ids.Insert(name, id);
+	return id;
+}
+
+//----------------------------------------------------------------------------->
+// Adds a new entry to the end of the table, use it to fill the
+// dictionary while reading it from the archive.
+//    @param name - name of the type.
+//    @return - ut::Error if failed.
+Optional<Error> TypeDictionary::Add(String name)
+{
+	Entry entry;
+	entry.name = Move(name);
+	entry.factory = nullptr;
+	entry.type = nullptr;
+	if (!entries.Add(Move(entry)))
+	{
+		return Error(error::out_of_memory);
+	}
+
+	// success
+	return Optional<Error>();
+}
+
+//----------------------------------------------------------------------------->
+// Returns the name of the type by index.
+//    @param id - index of the entry.
+//    @return - reference to the name or ut::Error if failed.
+Result<const String&, Error> TypeDictionary::GetName(Id id) const
+{
+	if (id >= entries.Count())
+	{
+		return MakeError(error::out_of_bounds, "Invalid type dictionary index.");
+	}
+
+	return entries[id].name;
+}
+
+//----------------------------------------------------------------------------->
+// Returns the dynamic type of the entry, the result is cached so that
+// subsequent calls with the same factory don't search for the type again.
+//    @param id - index of the entry.
+//    @param factory - factory of the base type.
+//    @return - reference to the dynamic type or ut::Error if failed.
+Result<const DynamicType&, Error> TypeDictionary::Resolve(Id id, const FactoryView& factory)
+{
+	if (id >= entries.Count())
+	{
+		return MakeError(error::out_of_bounds, "Invalid type dictionary index.");
+	}
+
+	// the same name can be resolved differently by different factories
+	ScopeLock lock(mutex);
+	Entry& entry = entries[id];
+	if (entry.factory != &factory)
+	{
+		Result<const DynamicType&, Error> type_result = factory.GetType(entry.name);
+		if (!type_result)
+		{
+			return MakeError(type_result.MoveAlt());
+		}
+
+		entry.factory = &factory;
+		entry.type = &type_result.Get();
+	}
+
+	return *entry.type;
+}
+
+//----------------------------------------------------------------------------->
+// Returns the number of entries.
+size_t TypeDictionary::Count() const
+{
+	return entries.Count();
+}
+
+//----------------------------------------------------------------------------->
+// Remembers the position of the serialized index if the dictionary
+// tracks references, does nothing otherwise.
+//    @param position - position of the index in the stream.
+//    @param id - index of the entry.
+//    @return - ut::Error if failed.
+Optional<Error> TypeDictionary::AddReference(stream::Cursor position, Id id)
+{
+	if (!track_references)
+	{
+		return Optional<Error>();
+	}
+
+	Reference reference;
+	reference.position = position;
+	reference.id = id;
+	if (!references.Add(reference))
+	{
+		return Error(error::out_of_memory);
+	}
+
+	return Optional<Error>();
+}
+
+//----------------------------------------------------------------------------->
+// Checks if the dictionary remembers positions of the serialized indices.
+bool TypeDictionary::TracksReferences() const
+{
+	return track_references;
+}
+
+//----------------------------------------------------------------------------->
+// Returns all references in order of serialization.
+const Array<TypeDictionary::Reference>& TypeDictionary::GetReferences() const
+{
+	return references;
+}
+
+//----------------------------------------------------------------------------//
+END_NAMESPACE(meta)
+END_NAMESPACE(ut)
+//----------------------------------------------------------------------------//
+//----------------------------------------------------------------------------//
+//----------------------------------------------------------------------------//
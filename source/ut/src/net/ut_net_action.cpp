@@ -4,9 +4,34 @@
 #include "net/ut_net_action.h"
 #include "net/ut_connection.h"
 #include "streams/ut_binary_stream.h"
+#include "meta/ut_meta_schema.h"
 //----------------------------------------------------------------------------//
 START_NAMESPACE(ut)
 START_NAMESPACE(net)
+//----------------------------------------------------------------------------//
+// Serializes the command, reflection tree of the command type is cached
+// if the command allows it (see Command::HasFixedReflection()), so it's
+// not built again for every sent message.
+//    @param cmd - reference to the unique pointer to the command.
+//    @param stream - reference to the output stream.
+//    @return - error if failed.
+static Optional<Error> SaveCommand(UniquePtr<Command>& cmd, OutputStream& stream)
+{
+	if (!cmd || !cmd->HasFixedReflection())
+	{
+		return meta::Snapshot::Capture(cmd).Save(stream);
+	}
+
+	meta::Schema& schema = meta::Schema::Get<Command>(cmd->Identify());
+	Result<meta::Schema::Lease, Error> lease = schema.Acquire(cmd);
+	if (!lease)
+	{
+		return lease.MoveAlt();
+	}
+
+	return lease.Get()->Save(stream);
+}
+
 //----------------------------------------------------------------------------//
 // Constructor
 //    @param command_name - name of the registered command class name,
@@ -76,7 +101,7 @@ Optional<Error> SendCommand::Execute(Connection& connection)
 {
 	// serialize command
 	BinaryStream stream;
-	Optional<Error> serialization_error = meta::Snapshot::Capture(cmd).Save(stream);
+	Optional<Error> serialization_error = SaveCommand(cmd, stream);
 
 	// validate serialization result
 	if (serialization_error)
@@ -131,7 +156,7 @@ Optional<Error> SendCommandFromStack::Execute(Connection& connection)
 	// serialize command
 	BinaryStream stream;
 	UniquePtr<Command>& cmd = pick_result ? picked_cmd : idle_cmd;
-	Optional<Error> serialization_error = meta::Snapshot::Capture(cmd).Save(stream);
+	Optional<Error> serialization_error = SaveCommand(cmd, stream);
 
 	// validate serialization result
 	if (serialization_error)
@@ -18,6 +18,15 @@ Optional<Error> CmdSignalCombiner::operator()(const Optional<Error>& err)
 }
 
 //----------------------------------------------------------------------------//
+// Returns 'true' if every instance of the command registers the same
+// members in Reflect() and all of them lie inside the command object,
+// so the reflection tree can be cached (see ut::meta::Schema). Commands
+// are reflected on every send by default.
+bool Command::HasFixedReflection() const
+{
+	return false;
+}
+
 // Executes command if received by client.
 //    @param connection - connection owning the command.
 //    @return - error if failed.
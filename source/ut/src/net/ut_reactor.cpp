@@ -0,0 +1,302 @@
+//----------------------------------------------------------------------------//
+//---------------------------------|  U  T  |---------------------------------//
+//----------------------------------------------------------------------------//
+#include "net/ut_reactor.h"
+//----------------------------------------------------------------------------//
+START_NAMESPACE(ut)
+START_NAMESPACE(net)
+//----------------------------------------------------------------------------//
+const SocketSystem& Reactor::skSystem = socket_system;
+//----------------------------------------------------------------------------//
+// Platform-specific descriptor of the polled socket.
+#if UT_WINDOWS
+typedef WSAPOLLFD PollDescriptor;
+#elif UT_UNIX
+typedef pollfd PollDescriptor;
+#else
+#error ut::net::PollDescriptor is not implemented
+#endif
+
+//----------------------------------------------------------------------------//
+// Constructor, starts the reactor thread. Throws ut::Error
+// if failed to create the socket used to wake up the thread.
+Reactor::Reactor() : stop(false)
+                   , wake_socket(UT_INVALID_SOCKET)
+{
+	Optional<Error> creation_error = CreateWakeSocket();
+	if (creation_error)
+	{
+		CloseWakeSocket();
+		throw creation_error.Move();
+	}
+
+	clock.Start();
+	thread = MakeUnique<Thread>([this] { this->Run(); });
+}
+
+//----------------------------------------------------------------------------->
+// Destructor, stops the reactor thread and calls callbacks
+// of the pending operations with an error.
+Reactor::~Reactor()
+{
+	{ // inform the thread before waking it up
+		ScopeLock lock(mutex);
+		stop = true;
+	}
+	Wake();
+	thread->Join();
+	CloseWakeSocket();
+
+	// nobody can add an operation to the destroyed reactor,
+	// so there is no need to lock the mutex
+	for (size_t i = 0; i < timers.Count(); i++)
+	{
+		timers[i].callback(Error(error::fail, "Reactor was destroyed."));
+	}
+
+	for (size_t i = 0; i < waiters.Count(); i++)
+	{
+		waiters[i].callback(Error(error::fail, "Reactor was destroyed."));
+	}
+}
+
+//----------------------------------------------------------------------------->
+// Registers a timer.
+//    @param timeout_ms - timeout in milliseconds.
+//    @param callback - function to be called when the timer expires.
+void Reactor::AddTimer(uint32 timeout_ms, Callback callback)
+{
+	Timer timer;
+	timer.deadline = GetTime() + timeout_ms;
+	timer.callback = Move(callback);
+
+	{
+		ScopeLock lock(mutex);
+		timers.Add(Move(timer));
+	}
+	Wake();
+}
+
+//----------------------------------------------------------------------------->
+// Registers a socket operation.
+//    @param socket - socket to wait for, must outlive the operation.
+//    @param event - type of the event to wait for.
+//    @param callback - function to be called when the socket is ready.
+void Reactor::AddSocket(const Socket& socket, Event event, Callback callback)
+{
+	Waiter waiter;
+	waiter.socket = socket.GetPlatformSocket();
+	waiter.event = event;
+	waiter.callback = Move(callback);
+
+	{
+		ScopeLock lock(mutex);
+		waiters.Add(Move(waiter));
+	}
+	Wake();
+}
+
+//----------------------------------------------------------------------------->
+// Procedure of the reactor thread.
+void Reactor::Run()
+{
+	Array<PollDescriptor> descriptors;
+	Array<Completion> completions;
+	while (true)
+	{
+		int timeout_ms = -1;
+		size_t descriptor_count;
+
+		{ // collect expired timers and sockets to wait for
+			ScopeLock lock(mutex);
+			if (stop)
+			{
+				return;
+			}
+
+			const uint64 now = GetTime();
+			for (size_t i = timers.Count(); i-- > 0;)
+			{
+				if (timers[i].deadline <= now)
+				{
+					Completion completion;
+					completion.callback = Move(timers[i].callback);
+					completions.Add(Move(completion));
+					timers.Remove(i);
+				}
+				else
+				{
+					// poll() accepts the timeout as 'int', distant deadlines are clamped
+					const int remaining = static_cast<int>(Min<uint64>(timers[i].deadline - now, 0x7FFFFFFF));
+					timeout_ms = timeout_ms < 0 || remaining < timeout_ms ? remaining : timeout_ms;
+				}
+			}
+
+			// the first descriptor is always the wake up socket
+			descriptor_count = waiters.Count() + 1;
+			descriptors.Resize(descriptor_count);
+			descriptors[0].fd = wake_socket;
+			descriptors[0].events = POLLIN;
+			descriptors[0].revents = 0;
+			for (size_t i = 1; i < descriptor_count; i++)
+			{
+				const Waiter& waiter = waiters[i - 1];
+				descriptors[i].fd = waiter.socket;
+				descriptors[i].events = waiter.event == Event::read ? POLLIN : POLLOUT;
+				descriptors[i].revents = 0;
+			}
+		}
+
+		// expired timers
+		for (size_t i = 0; i < completions.Count(); i++)
+		{
+			completions[i].callback(Move(completions[i].error));
+		}
+		completions.Reset();
+
+		// wait for events, callbacks could add new operations but they
+		// wake up the thread, so poll() returns immediately in this case
+#if UT_WINDOWS
+		const int result = WSAPoll(descriptors.GetAddress(), static_cast<ULONG>(descriptor_count), timeout_ms);
+#elif UT_UNIX
+		const int result = poll(descriptors.GetAddress(), static_cast<nfds_t>(descriptor_count), timeout_ms);
+#else
+	#error ut::net::Reactor::Run() is not implemented
+#endif
+		if (result <= 0)
+		{
+			continue;
+		}
+
+		if (descriptors[0].revents != 0)
+		{
+			Drain();
+		}
+
+		{ // collect ready sockets, new waiters could be added to the end
+			// of the array, so indices of the polled ones are still valid
+			ScopeLock lock(mutex);
+			for (size_t i = descriptor_count - 1; i > 0; i--)
+			{
+				const short revents = descriptors[i].revents;
+				if (revents == 0)
+				{
+					continue;
+				}
+
+				Completion completion;
+				completion.callback = Move(waiters[i - 1].callback);
+				if ((revents & descriptors[i].events) == 0)
+				{
+					completion.error = Error(error::connection_closed);
+				}
+				completions.Add(Move(completion));
+				waiters.Remove(i - 1);
+			}
+		}
+
+		// ready sockets
+		for (size_t i = 0; i < completions.Count(); i++)
+		{
+			completions[i].callback(Move(completions[i].error));
+		}
+		completions.Reset();
+	}
+}
+
+//----------------------------------------------------------------------------->
+// Wakes up the reactor thread if it waits in poll().
+void Reactor::Wake()
+{
+	const char signal = 0;
+	send(wake_socket, &signal, 1, 0);
+}
+
+//----------------------------------------------------------------------------->
+// Reads all pending bytes from the wake up socket.
+void Reactor::Drain()
+{
+	char buffer[64];
+	while (recv(wake_socket, buffer, sizeof(buffer), 0) > 0);
+}
+
+//----------------------------------------------------------------------------->
+// Returns the time passed since the reactor was created in milliseconds.
+uint64 Reactor::GetTime() const
+{
+	return clock.GetTime<time::Unit::millisecond, uint64>();
+}
+
+//----------------------------------------------------------------------------->
+// Creates the wake up socket connected to itself.
+//    @return - ut::Error if failed.
+Optional<Error> Reactor::CreateWakeSocket()
+{
+	sockaddr_in address;
+	memset(&address, 0, sizeof(address));
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	address.sin_port = 0;
+
+#if UT_WINDOWS
+	wake_socket = ::socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	if (wake_socket == UT_INVALID_SOCKET)
+	{
+		return Error(error::fail);
+	}
+
+	int address_size = sizeof(address);
+	u_long non_blocking = 1;
+	if (bind(wake_socket, (sockaddr*)&address, sizeof(address)) != 0 ||
+	    getsockname(wake_socket, (sockaddr*)&address, &address_size) != 0 ||
+	    connect(wake_socket, (sockaddr*)&address, sizeof(address)) != 0 ||
+	    ioctlsocket(wake_socket, FIONBIO, &non_blocking) != 0)
+	{
+		return Error(error::fail);
+	}
+#elif UT_UNIX
+	wake_socket = ::socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	if (wake_socket == UT_INVALID_SOCKET)
+	{
+		return Error(ConvertErrno(errno));
+	}
+
+	socklen_t address_size = sizeof(address);
+	if (bind(wake_socket, (sockaddr*)&address, sizeof(address)) != 0 ||
+	    getsockname(wake_socket, (sockaddr*)&address, &address_size) != 0 ||
+	    connect(wake_socket, (sockaddr*)&address, sizeof(address)) != 0 ||
+	    fcntl(wake_socket, F_SETFL, fcntl(wake_socket, F_GETFL, 0) | O_NONBLOCK) != 0)
+	{
+		return Error(ConvertErrno(errno));
+	}
+#else
+	#error ut::net::Reactor::CreateWakeSocket() is not implemented
+#endif
+	return Optional<Error>();
+}
+
+//----------------------------------------------------------------------------->
+// Closes the wake up socket.
+void Reactor::CloseWakeSocket()
+{
+	if (wake_socket == UT_INVALID_SOCKET)
+	{
+		return;
+	}
+
+#if UT_WINDOWS
+	closesocket(wake_socket);
+#elif UT_UNIX
+	close(wake_socket);
+#else
+	#error ut::net::Reactor::CloseWakeSocket() is not implemented
+#endif
+	wake_socket = UT_INVALID_SOCKET;
+}
+
+//----------------------------------------------------------------------------//
+END_NAMESPACE(net)
+END_NAMESPACE(ut)
+//----------------------------------------------------------------------------//
+//----------------------------------------------------------------------------//
+//----------------------------------------------------------------------------//
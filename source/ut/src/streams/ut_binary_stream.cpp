@@ -154,7 +154,7 @@ void BinaryStream::SetBuffer(const Array<byte>& copy)
 // Moves provided array and replaces current buffer with it
 void BinaryStream::SetBuffer(Array<byte>&& rval)
 {
-	data = rval;
+	data = Move(rval);
 }
 
 //----------------------------------------------------------------------------//
@@ -0,0 +1,308 @@
+//----------------------------------------------------------------------------//
+//---------------------------------|  U  T  |---------------------------------//
+//----------------------------------------------------------------------------//
+#include "streams/ut_buffered_stream.h"
+#include "system/ut_memory.h"
+//----------------------------------------------------------------------------//
+START_NAMESPACE(ut)
+//----------------------------------------------------------------------------//
+// Constructor, cursor is set to the current position of the target
+// stream, or to zero if the target stream doesn't support positioning.
+//    @param target_stream - reference to the stream to flush data to.
+BufferedOutputStream::BufferedOutputStream(OutputStream& target_stream) : target(target_stream)
+                                                                        , start(0)
+                                                                        , cursor(0)
+{
+	Result<stream::Cursor, Error> target_cursor = target.GetCursor();
+	if (target_cursor)
+	{
+		start = target_cursor.Get();
+	}
+}
+
+//----------------------------------------------------------------------------->
+// Writes an array of @count elements, each one with a size of @size bytes,
+// from the block of memory pointed by @ptr to the current position
+//    @param ptr - pointer to the array of elements to be written
+//    @param size - size in bytes of each element to be written
+//    @param count - number of elements, each one with a size of @size bytes
+//    @return - ut::Error if encountered an error
+Optional<Error> BufferedOutputStream::Write(const void* ptr,
+                                            size_t size,
+                                            size_t count)
+{
+	// calculate full array size
+	const size_t arr_size = size * count;
+
+	// allocate enough memory
+	const size_t min_size = cursor + arr_size;
+	if (buffer.GetSize() < min_size)
+	{
+		if (!buffer.Resize(min_size))
+		{
+			return Error(error::out_of_memory);
+		}
+	}
+
+	// write data
+	memory::Copy(buffer.GetAddress() + cursor, ptr, arr_size);
+
+	// move cursor
+	cursor += arr_size;
+
+	// success
+	return Optional<Error>();
+}
+
+//----------------------------------------------------------------------------->
+// Writes all buffered data to the target stream and flushes it,
+// cursor is moved to the end of the written data.
+//    @return - error code if failed
+Optional<Error> BufferedOutputStream::Flush()
+{
+	const size_t size = buffer.GetSize();
+	if (size != 0)
+	{
+		Optional<Error> write_error = target.Write(buffer.GetAddress(), 1, size);
+		if (write_error)
+		{
+			return write_error;
+		}
+
+		start += size;
+		cursor = 0;
+		buffer.Reset();
+	}
+
+	// flushing is optional for the target stream
+	Optional<Error> flush_error = target.Flush();
+	if (flush_error && flush_error->GetCode() != error::not_supported)
+	{
+		return flush_error;
+	}
+
+	// success
+	return Optional<Error>();
+}
+
+//----------------------------------------------------------------------------->
+// Returns stream offset to the current cursor position (in bytes)
+//    @return - cursor position
+Result<stream::Cursor, Error> BufferedOutputStream::GetCursor() const
+{
+	return start + cursor;
+}
+
+//----------------------------------------------------------------------------->
+// Sets stream offset to the current cursor position (in bytes),
+// cursor can be moved only inside the data that is not flushed yet.
+//    @param offset - offset in bytes from @origin
+//    @param origin - offset from the beginning of the stream
+//                    @offset will be added to this parameter
+//    @return - error code if failed
+Optional<Error> BufferedOutputStream::MoveCursor(stream::Cursor offset, stream::Position origin)
+{
+	// calculate start position
+	stream::Cursor base;
+	switch (origin)
+	{
+		case stream::Position::cursor: base = start + cursor; break;
+		case stream::Position::start: base = 0; break;
+		case stream::Position::end: base = start + buffer.GetSize(); break;
+		default: return Error(error::invalid_arg);
+	}
+
+	// flushed data can't be modified
+	const stream::Cursor position = base + offset;
+	if (position < start || position > start + buffer.GetSize())
+	{
+		return Error(error::out_of_bounds, "Cursor can't leave the buffered data.");
+	}
+
+	// set new cursor value
+	cursor = position - start;
+
+	// success
+	return Optional<Error>();
+}
+
+//----------------------------------------------------------------------------->
+// Returns size of the stream including flushed data
+Result<size_t, Error> BufferedOutputStream::GetSize()
+{
+	return start + buffer.GetSize();
+}
+
+//----------------------------------------------------------------------------//
+// Constructor, cursor is set to the current position of the source
+// stream, or to zero if the source stream doesn't support positioning.
+//    @param source_stream - reference to the stream to read data from.
+BufferedInputStream::BufferedInputStream(InputStream& source_stream) : source(source_stream)
+                                                                     , start(0)
+                                                                     , cursor(0)
+{
+	Result<stream::Cursor, Error> source_cursor = source.GetCursor();
+	if (source_cursor)
+	{
+		start = source_cursor.Get();
+	}
+
+	// data can be read in blocks only if the source size is known
+	Result<size_t, Error> source_size = source.GetSize();
+	if (source_cursor && source_size && source_size.Get() >= start)
+	{
+		remaining = source_size.Get() - start;
+	}
+}
+
+//----------------------------------------------------------------------------->
+// Reads an array of @count elements, each one with a size of @size bytes,
+// from the stream and stores them in the block of memory specified by @ptr.
+//    @param ptr - pointer to a block of memory with a size of
+//                 at least (@size*@count) bytes
+//    @param size - Size, in bytes, of each element to be read
+//    @param count - Number of elements, each one with a size of @size bytes
+//    @return - ut::Error if encountered an error
+Optional<Error> BufferedInputStream::Read(void* ptr, size_t size, size_t count)
+{
+	// calculate full array size
+	const size_t arr_size = size * count;
+
+	// read missing data from the source stream
+	const size_t min_size = cursor + arr_size;
+	if (buffer.GetSize() < min_size)
+	{
+		Optional<Error> fetch_error = Fetch(min_size);
+		if (fetch_error)
+		{
+			return fetch_error;
+		}
+	}
+
+	// read data
+	memory::Copy(ptr, buffer.GetAddress() + cursor, arr_size);
+
+	// move cursor
+	cursor += arr_size;
+
+	// success
+	return Optional<Error>();
+}
+
+//----------------------------------------------------------------------------->
+// Returns stream offset to the current cursor position (in bytes)
+//    @return - cursor position
+Result<stream::Cursor, Error> BufferedInputStream::GetCursor() const
+{
+	return start + cursor;
+}
+
+//----------------------------------------------------------------------------->
+// Sets stream offset to the current cursor position (in bytes),
+// cursor can't be moved before the initial position.
+//    @param offset - offset in bytes from @origin
+//    @param origin - offset from the beginning of the stream
+//                    @offset will be added to this parameter
+//    @return - error code if failed
+Optional<Error> BufferedInputStream::MoveCursor(stream::Cursor offset, stream::Position origin)
+{
+	// calculate start position
+	stream::Cursor base;
+	switch (origin)
+	{
+		case stream::Position::cursor: base = start + cursor; break;
+		case stream::Position::start: base = 0; break;
+		case stream::Position::end:
+		{
+			if (!remaining)
+			{
+				return Error(error::not_supported, "Size of the source stream is unknown.");
+			}
+			base = start + buffer.GetSize() + remaining.Get();
+		} break;
+		default: return Error(error::invalid_arg);
+	}
+
+	// data before the initial position was never read
+	const stream::Cursor position = base + offset;
+	if (position < start)
+	{
+		return Error(error::out_of_bounds);
+	}
+
+	// skipped data must be read anyway
+	const size_t min_size = position - start;
+	if (buffer.GetSize() < min_size)
+	{
+		Optional<Error> fetch_error = Fetch(min_size);
+		if (fetch_error)
+		{
+			return fetch_error;
+		}
+	}
+
+	// set new cursor value
+	cursor = min_size;
+
+	// success
+	return Optional<Error>();
+}
+
+//----------------------------------------------------------------------------->
+// Returns size of the source stream, or error if it's unknown
+Result<size_t, Error> BufferedInputStream::GetSize()
+{
+	if (!remaining)
+	{
+		return MakeError(error::not_supported);
+	}
+
+	return start + buffer.GetSize() + remaining.Get();
+}
+
+//----------------------------------------------------------------------------->
+// Reads data from the source stream until the buffer
+// contains at least @size bytes.
+//    @param size - desired size of the buffer.
+//    @return - error code if failed
+Optional<Error> BufferedInputStream::Fetch(size_t size)
+{
+	const size_t buffered_size = buffer.GetSize();
+	size_t fetch_size = size - buffered_size;
+
+	// read a whole block if possible
+	if (remaining)
+	{
+		if (fetch_size > remaining.Get())
+		{
+			return Error(error::out_of_bounds);
+		}
+
+		fetch_size = Min<size_t>(Max<size_t>(fetch_size, skBlockSize), remaining.Get());
+	}
+
+	if (!buffer.Resize(buffered_size + fetch_size))
+	{
+		return Error(error::out_of_memory);
+	}
+
+	Optional<Error> read_error = source.Read(buffer.GetAddress() + buffered_size, 1, fetch_size);
+	if (read_error)
+	{
+		buffer.Resize(buffered_size);
+		return read_error;
+	}
+
+	if (remaining)
+	{
+		remaining.Get() -= fetch_size;
+	}
+
+	return Optional<Error>();
+}
+
+//----------------------------------------------------------------------------//
+END_NAMESPACE(ut)
+//----------------------------------------------------------------------------//
+//----------------------------------------------------------------------------//
+//----------------------------------------------------------------------------//
@@ -741,6 +741,29 @@ Optional<Error> File::Read(void* ptr, size_t size, size_t count)
 	return Optional<Error>();
 }
 
+// Reads at most @size bytes, fewer bytes are read only if the end of the
+// file is reached.
+//    @param ptr - pointer to a block of memory with a size of
+//                 at least @size bytes
+//    @param size - maximum number of bytes to read
+//    @return - number of bytes that were read, 0 if the file has
+//              no more data, or ut::Error if failed
+Result<size_t, Error> File::ReadSome(void* ptr, size_t size)
+{
+	if (f == nullptr)
+	{
+		return MakeError(error::invalid_arg);
+	}
+
+	const size_t result = fread(ptr, 1, size, f);
+	if (result != size && ferror(f))
+	{
+		return MakeError(error::fail);
+	}
+
+	return result;
+}
+
 // Synchronizes the associated stream buffer with file.
 //    @return - error code if failed
 Optional<Error> File::Flush()
@@ -5,6 +5,53 @@
 //----------------------------------------------------------------------------//
 START_NAMESPACE(ut)
 //----------------------------------------------------------------------------//
+// Reads at most @size bytes, fewer bytes are read only if the end of the
+// stream is reached.
+//    @param ptr - pointer to a block of memory with a size of
+//                 at least @size bytes
+//    @param size - maximum number of bytes to read
+//    @return - number of bytes that were read, 0 if the stream has
+//              no more data, or ut::Error if failed
+Result<size_t, Error> InputStream::ReadSome(void* ptr, size_t size)
+{
+	// read the whole block at once if the stream knows its size
+	Result<stream::Cursor, Error> cursor = GetCursor();
+	Result<size_t, Error> stream_size = cursor ? GetSize() : Result<size_t, Error>(MakeError(error::not_supported));
+	if (stream_size)
+	{
+		const size_t available = stream_size.Get() > cursor.Get() ? stream_size.Get() - cursor.Get() : 0;
+		const size_t read_size = Min(size, available);
+		if (read_size != 0)
+		{
+			Optional<Error> read_error = Read(ptr, 1, read_size);
+			if (read_error)
+			{
+				return MakeError(read_error.Move());
+			}
+		}
+		return read_size;
+	}
+
+	// otherwise read byte by byte to never request more data than the
+	// stream has, an error after some data was read will be reported
+	// by the next call
+	byte* data = static_cast<byte*>(ptr);
+	for (size_t i = 0; i < size; i++)
+	{
+		Optional<Error> read_error = Read(data + i, 1, 1);
+		if (read_error)
+		{
+			if (i == 0 && read_error->GetCode() != error::out_of_bounds)
+			{
+				return MakeError(read_error.Move());
+			}
+			return i;
+		}
+	}
+
+	return size;
+}
+
 // Synchronizes the associated stream buffer with its controlled output sequence.
 //    @return - error code if failed
 Optional<Error> InputStream::Sync()
@@ -37,6 +84,16 @@ Result<size_t, Error> InputStream::GetSize()
 	return MakeError(error::not_implemented);
 }
 
+// Returns a pointer to the data at the provided offset if the stream is
+// backed by contiguous memory, returns "not_supported" error if not
+// overridden by child class.
+//    @param offset - offset in bytes from the beginning of the stream
+//    @return - pointer to the data or error if failed
+Result<const void*, Error> InputStream::GetData(stream::Cursor) const
+{
+	return MakeError(error::not_supported);
+}
+
 // Operator '>>' applied to an input stream is known as extraction operator.
 // Use it for formatted human-readable text data input.
 InputStream& InputStream::operator >> (InputStream& stream)
@@ -0,0 +1,326 @@
+//----------------------------------------------------------------------------//
+//---------------------------------|  U  T  |---------------------------------//
+//----------------------------------------------------------------------------//
+#include "streams/ut_mapped_file.h"
+#include "system/ut_memory.h"
+//----------------------------------------------------------------------------//
+START_NAMESPACE(ut)
+//----------------------------------------------------------------------------//
+// Default constructor
+MappedFile::MappedFile() : data(nullptr)
+                         , size(0)
+                         , cursor(0)
+                         , opened(false)
+{}
+
+//----------------------------------------------------------------------------->
+// Constructor, maps file @filename
+//    @param filename - path to the file
+MappedFile::MappedFile(const String& filename) : data(nullptr)
+                                               , size(0)
+                                               , cursor(0)
+                                               , opened(false)
+{
+	Optional<Error> open_error = Open(filename);
+	if (open_error)
+	{
+		throw open_error.Move();
+	}
+}
+
+//----------------------------------------------------------------------------->
+// Move constructor.
+MappedFile::MappedFile(MappedFile&& other) noexcept : data(other.data)
+                                                    , size(other.size)
+                                                    , cursor(other.cursor)
+                                                    , opened(other.opened)
+{
+	other.data = nullptr;
+	other.size = 0;
+	other.cursor = 0;
+	other.opened = false;
+}
+
+//----------------------------------------------------------------------------->
+// Move operator.
+MappedFile& MappedFile::operator = (MappedFile&& other) noexcept
+{
+	Close();
+	data = other.data;
+	size = other.size;
+	cursor = other.cursor;
+	opened = other.opened;
+	other.data = nullptr;
+	other.size = 0;
+	other.cursor = 0;
+	other.opened = false;
+	return *this;
+}
+
+//----------------------------------------------------------------------------->
+// Destructor, unmaps the file (if it was previously mapped)
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+//----------------------------------------------------------------------------->
+// Maps file @filename into memory, previously mapped file is closed
+//    @param filename - path to the file
+//    @return - ut::Error if encountered an error
+Optional<Error> MappedFile::Open(const String& filename)
+{
+	Optional<Error> close_error = Close();
+	if (close_error)
+	{
+		return close_error;
+	}
+
+	// file handles are closed right after mapping,
+	// the mapping itself keeps the file alive
+#if UT_WINDOWS
+	WString wfilename = StrConvert<char, wchar, CodePage::utf8>(filename);
+	HANDLE file_handle = ::CreateFileW(wfilename.GetAddress(),
+	                                   GENERIC_READ,
+	                                   FILE_SHARE_READ,
+	                                   NULL,
+	                                   OPEN_EXISTING,
+	                                   FILE_ATTRIBUTE_NORMAL,
+	                                   NULL);
+	if (file_handle == INVALID_HANDLE_VALUE)
+	{
+		return Error(ConvertWinSysErr(GetLastError()));
+	}
+
+	LARGE_INTEGER file_size;
+	if (::GetFileSizeEx(file_handle, &file_size) == FALSE)
+	{
+		const DWORD size_error = GetLastError();
+		::CloseHandle(file_handle);
+		return Error(ConvertWinSysErr(size_error));
+	}
+
+	// empty files can't be mapped
+	if (file_size.QuadPart != 0)
+	{
+		HANDLE mapping_handle = ::CreateFileMappingW(file_handle, NULL, PAGE_READONLY, 0, 0, NULL);
+		if (mapping_handle == NULL)
+		{
+			const DWORD mapping_error = GetLastError();
+			::CloseHandle(file_handle);
+			return Error(ConvertWinSysErr(mapping_error));
+		}
+
+		void* view = ::MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0);
+		const DWORD view_error = GetLastError();
+		::CloseHandle(mapping_handle);
+		::CloseHandle(file_handle);
+		if (view == NULL)
+		{
+			return Error(ConvertWinSysErr(view_error));
+		}
+
+		data = static_cast<const byte*>(view);
+	}
+	else
+	{
+		::CloseHandle(file_handle);
+	}
+
+	size = static_cast<size_t>(file_size.QuadPart);
+#elif UT_UNIX
+	int fd = open(filename.GetAddress(), O_RDONLY);
+	if (fd == -1)
+	{
+		return Error(ConvertErrno(errno));
+	}
+
+	struct stat file_stat;
+	if (fstat(fd, &file_stat) != 0)
+	{
+		const int stat_error = errno;
+		close(fd);
+		return Error(ConvertErrno(stat_error));
+	}
+
+	// empty files can't be mapped
+	if (file_stat.st_size != 0)
+	{
+		void* view = mmap(nullptr, static_cast<size_t>(file_stat.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+		const int map_error = errno;
+		close(fd);
+		if (view == MAP_FAILED)
+		{
+			return Error(ConvertErrno(map_error));
+		}
+
+		data = static_cast<const byte*>(view);
+	}
+	else
+	{
+		close(fd);
+	}
+
+	size = static_cast<size_t>(file_stat.st_size);
+#else
+	#error ut::MappedFile::Open() is not implemented
+#endif
+
+	cursor = 0;
+	opened = true;
+	return Optional<Error>();
+}
+
+//----------------------------------------------------------------------------->
+// Unmaps and closes the file (if it was previously mapped), pointers
+// returned by GetData() become invalid.
+//    @return - ut::Error if encountered an error
+Optional<Error> MappedFile::Close()
+{
+	if (data != nullptr)
+	{
+#if UT_WINDOWS
+		if (::UnmapViewOfFile(data) == FALSE)
+		{
+			return Error(ConvertWinSysErr(GetLastError()));
+		}
+#elif UT_UNIX
+		if (munmap(const_cast<byte*>(data), size) != 0)
+		{
+			return Error(ConvertErrno(errno));
+		}
+#else
+	#error ut::MappedFile::Close() is not implemented
+#endif
+	}
+
+	data = nullptr;
+	size = 0;
+	cursor = 0;
+	opened = false;
+	return Optional<Error>();
+}
+
+//----------------------------------------------------------------------------->
+// Returns 'true' if a file was opened, and hasn't been closed yet
+bool MappedFile::IsOpened() const
+{
+	return opened;
+}
+
+//----------------------------------------------------------------------------->
+// Reads an array of @count elements, each one with a size of @size bytes,
+// from the file and stores them in the block of memory specified by @ptr.
+//    @param ptr - pointer to a block of memory with a size of
+//                 at least (@size*@count) bytes
+//    @param element_size - Size, in bytes, of each element to be read
+//    @param count - Number of elements, each one with a size of @size bytes
+//    @return - ut::Error if encountered an error
+Optional<Error> MappedFile::Read(void* ptr, size_t element_size, size_t count)
+{
+	if (!opened)
+	{
+		return Error(error::empty);
+	}
+
+	// check boundaries
+	const size_t arr_size = element_size * count;
+	if (cursor + arr_size > size)
+	{
+		return Error(error::out_of_bounds);
+	}
+
+	// read data
+	if (arr_size != 0)
+	{
+		memory::Copy(ptr, data + cursor, arr_size);
+		cursor += arr_size;
+	}
+
+	// success
+	return Optional<Error>();
+}
+
+//----------------------------------------------------------------------------->
+// Returns file offset to the current cursor position (in bytes)
+//    @return - cursor position if file is mapped, or error otherwise
+Result<stream::Cursor, Error> MappedFile::GetCursor() const
+{
+	if (!opened)
+	{
+		return MakeError(error::empty);
+	}
+
+	return cursor;
+}
+
+//----------------------------------------------------------------------------->
+// Sets file offset to the current cursor position (in bytes)
+//    @param offset - offset in bytes from @origin
+//    @param origin - offset from the beginning of the file
+//                    @offset will be added to this parameter
+//    @return - error code if failed
+Optional<Error> MappedFile::MoveCursor(stream::Cursor offset, stream::Position origin)
+{
+	if (!opened)
+	{
+		return Error(error::empty);
+	}
+
+	// calculate start position
+	stream::Cursor start;
+	switch (origin)
+	{
+		case stream::Position::cursor: start = cursor; break;
+		case stream::Position::start: start = 0; break;
+		case stream::Position::end: start = size; break;
+		default: return Error(error::invalid_arg);
+	}
+
+	// validate new cursor value
+	stream::Cursor new_cursor = start + offset;
+	if (new_cursor > size)
+	{
+		return Error(error::invalid_arg);
+	}
+
+	cursor = new_cursor;
+	return Optional<Error>();
+}
+
+//----------------------------------------------------------------------------->
+// Returns size of the file or error if failed
+Result<size_t, Error> MappedFile::GetSize()
+{
+	if (!opened)
+	{
+		return MakeError(error::empty);
+	}
+
+	return size;
+}
+
+//----------------------------------------------------------------------------->
+// Returns a pointer to the mapped data, it's valid until the file is closed
+//    @param offset - offset in bytes from the beginning of the file
+//    @return - pointer to the data or error if failed
+Result<const void*, Error> MappedFile::GetData(stream::Cursor offset) const
+{
+	if (data == nullptr)
+	{
+		return MakeError(error::empty);
+	}
+
+	if (offset > size)
+	{
+		return MakeError(error::out_of_bounds);
+	}
+
+	return static_cast<const void*>(data + offset);
+}
+
+//----------------------------------------------------------------------------//
+END_NAMESPACE(ut)
+//----------------------------------------------------------------------------//
+//----------------------------------------------------------------------------//
+//----------------------------------------------------------------------------//
@@ -2,6 +2,11 @@
 //---------------------------------|  U  T  |---------------------------------//
 //----------------------------------------------------------------------------//
 #include "system/ut_endianness.h"
+#include "system/ut_memory.h"
+//----------------------------------------------------------------------------//
+#if UT_WINDOWS
+#include <stdlib.h> // _byteswap_* functions
+#endif
 //----------------------------------------------------------------------------//
 START_NAMESPACE(ut)
 START_NAMESPACE(endianness)
@@ -22,6 +27,118 @@ Order GetNative()
 	return endianness_order;
 }
 
+//----------------------------------------------------------------------------//
+// Reverses byte order of every element of the array using provided swap
+// function, memory::Copy() is used because elements can be unaligned.
+//    @param T - unsigned integer type of the element size.
+//    @param data - address of the first element.
+//    @param count - number of elements.
+//    @param swap - function reversing byte order of one element.
+template<typename T, typename SwapFunction>
+static void SwapElements(byte* data, size_t count, SwapFunction swap)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		T element;
+		memory::Copy(&element, data, sizeof(T));
+		element = swap(element);
+		memory::Copy(data, &element, sizeof(T));
+		data += sizeof(T);
+	}
+}
+
+// Reverses byte order of every element of the array in place. Elements of
+// 2, 4 and 8 bytes are swapped using byte-swap intrinsics.
+//    @param data - address of the first element.
+//    @param granularity - size of one element.
+//    @param count - number of elements.
+void Swap(void* data, size_t granularity, size_t count)
+{
+	byte* start = static_cast<byte*>(data);
+	switch (granularity)
+	{
+		case 1:
+			return;
+#if UT_WINDOWS
+		case 2: SwapElements<uint16>(start, count, [](uint16 e) { return _byteswap_ushort(e); }); return;
+		case 4: SwapElements<uint32>(start, count, [](uint32 e) { return static_cast<uint32>(_byteswap_ulong(e)); }); return;
+		case 8: SwapElements<uint64>(start, count, [](uint64 e) { return _byteswap_uint64(e); }); return;
+#elif UT_UNIX
+		case 2: SwapElements<uint16>(start, count, [](uint16 e) { return __builtin_bswap16(e); }); return;
+		case 4: SwapElements<uint32>(start, count, [](uint32 e) { return __builtin_bswap32(e); }); return;
+		case 8: SwapElements<uint64>(start, count, [](uint64 e) { return __builtin_bswap64(e); }); return;
+#endif
+	}
+
+	// generic variant for other sizes
+	for (size_t i = 0; i < count; i++)
+	{
+		for (size_t b = 0; b < granularity / 2; b++)
+		{
+			const byte tmp = start[b];
+			start[b] = start[granularity - b - 1];
+			start[granularity - b - 1] = tmp;
+		}
+		start += granularity;
+	}
+}
+
+// Writes elements to the stream in reverse byte order. Elements are swapped
+// in a small intermediate buffer, so that stream is written in large blocks.
+//    @param stream - reference to the output stream.
+//    @param data - address of the data to be written.
+//    @param granularity - size of one element.
+//    @param count - number of elements.
+//    @return - ut::Error if failed.
+Optional<Error> WriteSwapped(OutputStream& stream,
+                             const void* data,
+                             size_t granularity,
+                             size_t count)
+{
+	static constexpr size_t skBufferSize = 4096;
+	byte buffer[skBufferSize];
+
+	// huge elements are copied one by one
+	const size_t chunk_count = granularity < skBufferSize ? skBufferSize / granularity : 0;
+	if (chunk_count == 0)
+	{
+		Array<byte> element(granularity);
+		const byte* src = static_cast<const byte*>(data);
+		for (size_t i = 0; i < count; i++)
+		{
+			memory::Copy(element.GetAddress(), src, granularity);
+			Swap(element.GetAddress(), granularity, 1);
+			Optional<Error> write_error = stream.Write(element.GetAddress(), granularity, 1);
+			if (write_error)
+			{
+				return write_error;
+			}
+			src += granularity;
+		}
+
+		return Optional<Error>();
+	}
+
+	// swap and write every chunk
+	const byte* src = static_cast<const byte*>(data);
+	for (size_t i = 0; i < count; i += chunk_count)
+	{
+		const size_t element_count = Min<size_t>(chunk_count, count - i);
+		const size_t chunk_size = element_count * granularity;
+		memory::Copy(buffer, src, chunk_size);
+		Swap(buffer, granularity, element_count);
+		Optional<Error> write_error = stream.Write(buffer, 1, chunk_size);
+		if (write_error)
+		{
+			return write_error;
+		}
+		src += chunk_size;
+	}
+
+	// success
+	return Optional<Error>();
+}
+
 //----------------------------------------------------------------------------//
 END_NAMESPACE(endian)
 END_NAMESPACE(ut)
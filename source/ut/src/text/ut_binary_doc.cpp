@@ -0,0 +1,456 @@
+//----------------------------------------------------------------------------//
+//---------------------------------|  U  T  |---------------------------------//
+//----------------------------------------------------------------------------//
+#include "text/ut_binary_doc.h"
+#include "system/ut_memory.h"
+//----------------------------------------------------------------------------//
+START_NAMESPACE(ut)
+//----------------------------------------------------------------------------//
+// signature of the document
+const char* BinaryDoc::skSignature = "UTBD";
+
+// current version of the format
+const byte BinaryDoc::skVersion = 1;
+
+//----------------------------------------------------------------------------->
+// Parses binary data
+//    @param doc - string with the binary data to be parsed
+//    @return - ut::Error if encountered an error
+Optional<Error> BinaryDoc::Parse(const String& doc)
+{
+	// remove current contents
+	nodes.Reset();
+
+	// check if document is empty
+	const size_t size = doc.Length();
+	if (size == 0)
+	{
+		return Error(error::empty);
+	}
+
+	// check signature and version
+	const size_t signature_length = StrLen(skSignature);
+	if (size < signature_length + 1 ||
+	    String(doc.GetAddress(), signature_length) != skSignature)
+	{
+		return Error(error::fail, "Binary document has invalid signature.");
+	}
+
+	Reader reader;
+	reader.cursor = reinterpret_cast<const byte*>(doc.GetAddress()) + signature_length;
+	reader.end = reinterpret_cast<const byte*>(doc.GetAddress()) + size;
+	if (*reader.cursor++ > skVersion)
+	{
+		return Error(error::not_supported, "Binary document version is not supported.");
+	}
+
+	// read number of nodes
+	Result<uint64, Error> count_result = ReadVarint(reader);
+	if (!count_result)
+	{
+		return count_result.MoveAlt();
+	}
+
+	// read nodes
+	const uint64 node_count = count_result.Get();
+	for (uint64 i = 0; i < node_count; i++)
+	{
+		Tree<text::Node> node;
+		Optional<Error> read_error = ReadNode(reader, node);
+		if (read_error)
+		{
+			nodes.Reset();
+			return read_error;
+		}
+
+		if (!nodes.Add(Move(node)))
+		{
+			return Error(error::out_of_memory);
+		}
+	}
+
+	// success
+	return Optional<Error>();
+}
+
+//----------------------------------------------------------------------------->
+// Writes contents to the output stream
+//    @param stream - output stream
+//    @return - ut::Error if encountered an error
+Optional<Error> BinaryDoc::Write(OutputStream& stream) const
+{
+	Writer writer;
+
+	// signature and version
+	const size_t signature_length = StrLen(skSignature);
+	if (!writer.data.Resize(signature_length))
+	{
+		return Error(error::out_of_memory);
+	}
+	memory::Copy(writer.data.GetAddress(), skSignature, signature_length);
+	if (!writer.data.Add(skVersion))
+	{
+		return Error(error::out_of_memory);
+	}
+
+	// all nodes
+	const size_t node_count = nodes.Count();
+	Optional<Error> write_error = WriteVarint(writer, node_count);
+	for (size_t i = 0; !write_error && i < node_count; i++)
+	{
+		write_error = WriteNode(writer, nodes[i]);
+	}
+
+	if (write_error)
+	{
+		return write_error;
+	}
+
+	// write encoded data at once
+	return stream.Write(writer.data.GetAddress(), 1, writer.data.Count());
+}
+
+//----------------------------------------------------------------------------->
+// Encodes a node with all its children.
+//    @param writer - reference to the writer to encode node to
+//    @param node - node to be encoded
+//    @return - ut::Error if encountered an error
+Optional<Error> BinaryDoc::WriteNode(Writer& writer, const Tree<text::Node>& node)
+{
+	// flags
+	byte flags = static_cast<byte>(static_cast<byte>(node.data.GetType()) << type_shift);
+	flags |= node.data.value ? has_value : 0;
+	flags |= node.data.value_type ? has_value_type : 0;
+	flags |= node.data.encapsulation_name ? has_encapsulation_name : 0;
+	flags |= node.data.is_attribute ? is_attribute : 0;
+	flags |= node.data.is_array ? is_array : 0;
+	if (!writer.data.Add(flags))
+	{
+		return Error(error::out_of_memory);
+	}
+
+	// name
+	Optional<Error> write_error = WriteTableString(writer, node.data.name);
+	if (write_error)
+	{
+		return write_error;
+	}
+
+	// value
+	if (node.data.value)
+	{
+		write_error = WriteString(writer, node.data.value.Get());
+		if (write_error)
+		{
+			return write_error;
+		}
+	}
+
+	// value type
+	if (node.data.value_type)
+	{
+		write_error = WriteTableString(writer, node.data.value_type.Get());
+		if (write_error)
+		{
+			return write_error;
+		}
+	}
+
+	// encapsulation name
+	if (node.data.encapsulation_name)
+	{
+		write_error = WriteTableString(writer, node.data.encapsulation_name.Get());
+		if (write_error)
+		{
+			return write_error;
+		}
+	}
+
+	// child nodes
+	const size_t child_count = node.CountChildren();
+	write_error = WriteVarint(writer, child_count);
+	for (size_t i = 0; !write_error && i < child_count; i++)
+	{
+		write_error = WriteNode(writer, node[i]);
+	}
+
+	return write_error;
+}
+
+//----------------------------------------------------------------------------->
+// Encodes a string that is likely to be repeated.
+//    @param writer - reference to the writer to encode string to
+//    @param str - string to be encoded
+//    @return - ut::Error if encountered an error
+Optional<Error> BinaryDoc::WriteTableString(Writer& writer, const String& str)
+{
+	// reference to the string that was already written
+	Optional<uint32&> find_result = writer.table.Find(str);
+	if (find_result)
+	{
+		return WriteVarint(writer, static_cast<uint64>(find_result.Get()) * 2 + 1);
+	}
+
+	// new string
+	const uint32 id = static_cast<uint32>(writer.table.Count());
+	writer.table.Insert(str, id);
+
+	const size_t length = str.Length();
+	Optional<Error> write_error = WriteVarint(writer, static_cast<uint64>(length) * 2);
+	if (write_error)
+	{
+		return write_error;
+	}
+
+	const size_t offset = writer.data.Count();
+	if (!writer.data.Resize(offset + length))
+	{
+		return Error(error::out_of_memory);
+	}
+	memory::Copy(writer.data.GetAddress() + offset, str.GetAddress(), length);
+
+	// success
+	return Optional<Error>();
+}
+
+//----------------------------------------------------------------------------->
+// Encodes a string with a length prefix.
+//    @param writer - reference to the writer to encode string to
+//    @param str - string to be encoded
+//    @return - ut::Error if encountered an error
+Optional<Error> BinaryDoc::WriteString(Writer& writer, const String& str)
+{
+	const size_t length = str.Length();
+	Optional<Error> write_error = WriteVarint(writer, length);
+	if (write_error)
+	{
+		return write_error;
+	}
+
+	const size_t offset = writer.data.Count();
+	if (!writer.data.Resize(offset + length))
+	{
+		return Error(error::out_of_memory);
+	}
+	memory::Copy(writer.data.GetAddress() + offset, str.GetAddress(), length);
+
+	// success
+	return Optional<Error>();
+}
+
+//----------------------------------------------------------------------------->
+// Encodes an unsigned integer as a LEB128 varint.
+//    @param writer - reference to the writer to encode number to
+//    @param value - number to be encoded
+//    @return - ut::Error if encountered an error
+Optional<Error> BinaryDoc::WriteVarint(Writer& writer, uint64 value)
+{
+	do
+	{
+		byte b = static_cast<byte>(value & 0x7F);
+		value >>= 7;
+		if (value != 0)
+		{
+			b |= 0x80;
+		}
+
+		if (!writer.data.Add(b))
+		{
+			return Error(error::out_of_memory);
+		}
+	} while (value != 0);
+
+	// success
+	return Optional<Error>();
+}
+
+//----------------------------------------------------------------------------->
+// Decodes a node with all its children.
+//    @param reader - reference to the reader to decode node from
+//    @param node - node to be filled
+//    @return - ut::Error if encountered an error
+Optional<Error> BinaryDoc::ReadNode(Reader& reader, Tree<text::Node>& node)
+{
+	// flags
+	if (reader.cursor >= reader.end)
+	{
+		return Error(error::out_of_bounds, "Binary document is truncated.");
+	}
+	const byte flags = *reader.cursor++;
+	const byte type = flags >> type_shift;
+	if (type > static_cast<byte>(text::node::Type::xml_cdata))
+	{
+		return Error(error::fail, "Binary document has invalid node type.");
+	}
+	node.data = text::Node(static_cast<text::node::Type>(type));
+	node.data.is_attribute = (flags & is_attribute) != 0;
+	node.data.is_array = (flags & is_array) != 0;
+
+	// name
+	Result<String, Error> name_result = ReadTableString(reader);
+	if (!name_result)
+	{
+		return name_result.MoveAlt();
+	}
+	node.data.name = name_result.Move();
+
+	// value
+	if (flags & has_value)
+	{
+		Result<String, Error> value_result = ReadString(reader);
+		if (!value_result)
+		{
+			return value_result.MoveAlt();
+		}
+		node.data.value = value_result.Move();
+	}
+
+	// value type
+	if (flags & has_value_type)
+	{
+		Result<String, Error> value_type_result = ReadTableString(reader);
+		if (!value_type_result)
+		{
+			return value_type_result.MoveAlt();
+		}
+		node.data.value_type = value_type_result.Move();
+	}
+
+	// encapsulation name
+	if (flags & has_encapsulation_name)
+	{
+		Result<String, Error> encapsulation_result = ReadTableString(reader);
+		if (!encapsulation_result)
+		{
+			return encapsulation_result.MoveAlt();
+		}
+		node.data.encapsulation_name = encapsulation_result.Move();
+	}
+
+	// child nodes, every child takes at least 3 bytes
+	// (flags, name, number of children)
+	Result<uint64, Error> count_result = ReadVarint(reader);
+	if (!count_result)
+	{
+		return count_result.MoveAlt();
+	}
+
+	const uint64 child_count = count_result.Get();
+	if (child_count > static_cast<uint64>(reader.end - reader.cursor) / 3)
+	{
+		return Error(error::out_of_bounds, "Binary document is truncated.");
+	}
+
+	for (uint64 i = 0; i < child_count; i++)
+	{
+		Tree<text::Node> child;
+		Optional<Error> read_error = ReadNode(reader, child);
+		if (read_error)
+		{
+			return read_error;
+		}
+
+		if (!node.Add(Move(child)))
+		{
+			return Error(error::out_of_memory);
+		}
+	}
+
+	// success
+	return Optional<Error>();
+}
+
+//----------------------------------------------------------------------------->
+// Decodes a string that was encoded with BinaryDoc::WriteTableString().
+//    @param reader - reference to the reader to decode string from
+//    @return - decoded string or ut::Error if encountered an error
+Result<String, Error> BinaryDoc::ReadTableString(Reader& reader)
+{
+	Result<uint64, Error> prefix_result = ReadVarint(reader);
+	if (!prefix_result)
+	{
+		return MakeError(prefix_result.MoveAlt());
+	}
+
+	// reference to the string that was already read
+	const uint64 prefix = prefix_result.Get();
+	if (prefix & 1)
+	{
+		const uint64 id = prefix >> 1;
+		if (id >= reader.table.Count())
+		{
+			return MakeError(error::out_of_bounds, "Binary document has invalid string reference.");
+		}
+		return reader.table[static_cast<size_t>(id)];
+	}
+
+	// new string
+	const uint64 length = prefix >> 1;
+	if (length > static_cast<uint64>(reader.end - reader.cursor))
+	{
+		return MakeError(error::out_of_bounds, "Binary document is truncated.");
+	}
+
+	String str(reinterpret_cast<const char*>(reader.cursor), static_cast<size_t>(length));
+	reader.cursor += length;
+	if (!reader.table.Add(str))
+	{
+		return MakeError(Error(error::out_of_memory));
+	}
+
+	return str;
+}
+
+//----------------------------------------------------------------------------->
+// Decodes a string with a length prefix.
+//    @param reader - reference to the reader to decode string from
+//    @return - decoded string or ut::Error if encountered an error
+Result<String, Error> BinaryDoc::ReadString(Reader& reader)
+{
+	Result<uint64, Error> length_result = ReadVarint(reader);
+	if (!length_result)
+	{
+		return MakeError(length_result.MoveAlt());
+	}
+
+	const uint64 length = length_result.Get();
+	if (length > static_cast<uint64>(reader.end - reader.cursor))
+	{
+		return MakeError(error::out_of_bounds, "Binary document is truncated.");
+	}
+
+	String str(reinterpret_cast<const char*>(reader.cursor), static_cast<size_t>(length));
+	reader.cursor += length;
+	return str;
+}
+
+//----------------------------------------------------------------------------->
+// Decodes a LEB128 varint.
+//    @param reader - reference to the reader to decode number from
+//    @return - decoded number or ut::Error if encountered an error
+Result<uint64, Error> BinaryDoc::ReadVarint(Reader& reader)
+{
+	uint64 value = 0;
+	for (uint32 shift = 0; shift < 64; shift += 7)
+	{
+		if (reader.cursor >= reader.end)
+		{
+			return MakeError(error::out_of_bounds, "Binary document is truncated.");
+		}
+
+		const byte b = *reader.cursor++;
+		value |= static_cast<uint64>(b & 0x7F) << shift;
+		if ((b & 0x80) == 0)
+		{
+			return value;
+		}
+	}
+
+	return MakeError(error::fail, "Binary document has invalid varint.");
+}
+
+//----------------------------------------------------------------------------//
+END_NAMESPACE(ut)
+//----------------------------------------------------------------------------//
+//----------------------------------------------------------------------------//
+//----------------------------------------------------------------------------//
@@ -5,10 +5,35 @@
 //----------------------------------------------------------------------------//
 START_NAMESPACE(ut)
 //----------------------------------------------------------------------------//
+// Arrays having less elements are always parsed sequentially.
+const size_t JsonDoc::skMinParallelArraySize = 64;
+
+//----------------------------------------------------------------------------->
 // Parses raw text
 //    @param text - string with a text to be parsed
 //    @return - ut::Error if encountered an error
 Optional<Error> JsonDoc::Parse(const String& doc)
+{
+	return ParseDocument(doc, nullptr);
+}
+
+//----------------------------------------------------------------------------->
+// Parses raw text, elements of the large arrays are parsed simultaneously
+// in the provided thread pool.
+//    @param text - string with a text to be parsed
+//    @param pool - thread pool to parse array elements in
+//    @return - ut::Error if encountered an error
+Optional<Error> JsonDoc::Parse(const String& doc, ThreadPool<void>& pool)
+{
+	return ParseDocument(doc, &pool);
+}
+
+//----------------------------------------------------------------------------->
+// Parses raw text
+//    @param text - string with a text to be parsed
+//    @param pool - thread pool to parse large arrays in, or nullptr
+//    @return - ut::Error if encountered an error
+Optional<Error> JsonDoc::ParseDocument(const String& doc, ThreadPool<void>* pool)
 {
 	// create input object with the address of the provided string
 	text::Reader cursor(doc.GetAddress());
@@ -28,7 +53,7 @@ Optional<Error> JsonDoc::Parse(const String& doc)
 	JSON.data.name = "JSON";
 
 	// parse value node
-	Optional<Error> parse_error = ParseValue(cursor, JSON);
+	Optional<Error> parse_error = ParseValue(cursor, JSON, pool);
 	if (parse_error)
 	{
 		return parse_error;
@@ -88,8 +113,11 @@ Optional<Error> JsonDoc::Write(OutputStream& stream) const
 // Parses the value of the node
 //    @param cursor - reference to the current parsing position
 //    @param node - reference to the parent node
+//    @param pool - thread pool to parse large arrays in, or nullptr
 //    @return - ut::Error if encountered an error
-Optional<Error> JsonDoc::ParseValue(text::Reader& cursor, Tree<text::Node>& node)
+Optional<Error> JsonDoc::ParseValue(text::Reader& cursor,
+                                    Tree<text::Node>& node,
+                                    ThreadPool<void>* pool)
 {
 	// Is it a string?
 	if (cursor == '"')
@@ -133,7 +161,7 @@ Optional<Error> JsonDoc::ParseValue(text::Reader& cursor, Tree<text::Node>& node
 	}
 	else if (cursor == '{') // object?
 	{
-		Optional<Error> object_error = ParseObject(cursor, node);
+		Optional<Error> object_error = ParseObject(cursor, node, pool);
 		if (object_error)
 		{
 			return object_error;
@@ -141,7 +169,7 @@ Optional<Error> JsonDoc::ParseValue(text::Reader& cursor, Tree<text::Node>& node
 	}
 	else if (cursor == '[') // array?
 	{
-		Optional<Error> array_error = ParseArray(cursor, node);
+		Optional<Error> array_error = ParseArray(cursor, node, pool);
 		if (array_error)
 		{
 			return array_error;
@@ -161,8 +189,11 @@ Optional<Error> JsonDoc::ParseValue(text::Reader& cursor, Tree<text::Node>& node
 // Parses '{}' object node
 //    @param cursor - reference to the current parsing position
 //    @param node - reference to the parent node
+//    @param pool - thread pool to parse large arrays in, or nullptr
 //    @return - ut::Error if encountered an error
-Optional<Error> JsonDoc::ParseObject(text::Reader& cursor, Tree<text::Node>& node)
+Optional<Error> JsonDoc::ParseObject(text::Reader& cursor,
+                                     Tree<text::Node>& node,
+                                     ThreadPool<void>* pool)
 {
 	// every json object must start with '{' character
 	UT_ASSERT(cursor == '{');
@@ -229,7 +260,7 @@ Optional<Error> JsonDoc::ParseObject(text::Reader& cursor, Tree<text::Node>& nod
 		}
 
 		// The value is here
-		Optional<Error> parse_value_error = ParseValue(cursor, child_node);
+		Optional<Error> parse_value_error = ParseValue(cursor, child_node, pool);
 		if (parse_value_error)
 		{
 			return parse_value_error;
@@ -280,12 +311,21 @@ Optional<Error> JsonDoc::ParseObject(text::Reader& cursor, Tree<text::Node>& nod
 // Parses '[]' array node
 //    @param cursor - reference to the current parsing position
 //    @param node - reference to the parent node
+//    @param pool - thread pool to parse large arrays in, or nullptr
 //    @return - ut::Error if encountered an error
-Optional<Error> JsonDoc::ParseArray(text::Reader& cursor, Tree<text::Node>& node)
+Optional<Error> JsonDoc::ParseArray(text::Reader& cursor,
+                                    Tree<text::Node>& node,
+                                    ThreadPool<void>* pool)
 {
 	// every json object must start with '[' character
 	UT_ASSERT(cursor == '[');
 
+	// large arrays are parsed simultaneously
+	if (pool != nullptr && ParseArrayParallel(cursor, node, *pool))
+	{
+		return Optional<Error>();
+	}
+
 	// skip '['
 	cursor++;
 
@@ -311,8 +351,8 @@ Optional<Error> JsonDoc::ParseArray(text::Reader& cursor, Tree<text::Node>& node
 			return Optional<Error>();
 		}
 
-		// Get the value
-		Optional<Error> parse_value_error = ParseValue(cursor, element_node);
+		// Get the value, nested arrays are parsed sequentially
+		Optional<Error> parse_value_error = ParseValue(cursor, element_node, nullptr);
 		if (parse_value_error)
 		{
 			return parse_value_error;
@@ -352,6 +392,183 @@ Optional<Error> JsonDoc::ParseArray(text::Reader& cursor, Tree<text::Node>& node
 	return Optional<Error>();
 }
 
+//----------------------------------------------------------------------------->
+// Parses elements of the '[]' array node simultaneously.
+//    @param cursor - reference to the current parsing position
+//    @param node - reference to the parent node
+//    @param pool - thread pool to parse elements in
+//    @return - 'true' if array was parsed, 'false' if the array is too
+//              small or malformed and must be parsed sequentially
+bool JsonDoc::ParseArrayParallel(text::Reader& cursor,
+                                 Tree<text::Node>& node,
+                                 ThreadPool<void>& pool)
+{
+	// find element boundaries
+	Array<const char*> separators;
+	if (!ScanArray(cursor.Get(), separators) || separators.Count() <= skMinParallelArraySize)
+	{
+		return false;
+	}
+
+	// every element is parsed into a separate node
+	const size_t element_count = separators.Count() - 1;
+	Array< Tree<text::Node> > elements(element_count);
+	if (elements.Count() != element_count)
+	{
+		return false;
+	}
+
+	// split elements into batches, a few batches per thread
+	// to balance the load if elements differ in size
+	const size_t batch_count = Min<size_t>(element_count, pool.GetThreadCount() * 4);
+	const size_t batch_size = element_count / batch_count;
+	const size_t remainder = element_count % batch_count;
+	Array<bool> batch_failed(batch_count);
+	for (size_t i = 0; i < batch_count; i++)
+	{
+		batch_failed[i] = false;
+	}
+
+	// parse batches
+	Scheduler<void> scheduler = pool.CreateScheduler();
+	size_t first = 0;
+	for (size_t i = 0; i < batch_count; i++)
+	{
+		const size_t count = batch_size + (i < remainder ? 1 : 0);
+		bool& failed = batch_failed[i];
+		Function<void()> function([&separators, &elements, first, count, &failed]
+		                          {
+		                              ParseArrayElements(separators, elements, first, count, failed);
+		                          });
+		scheduler.Enqueue(MakeUnique< Task<void()> >(Move(function)));
+		first += count;
+	}
+	scheduler.WaitForCompletion();
+
+	// the first failed element is reported by the sequential parser
+	for (size_t i = 0; i < batch_count; i++)
+	{
+		if (batch_failed[i])
+		{
+			return false;
+		}
+	}
+
+	// merge elements in the original order
+	node.data.is_array = true;
+	for (size_t i = 0; i < element_count; i++)
+	{
+		if (!node.Add(Move(elements[i])))
+		{
+			node.Reset();
+			return false;
+		}
+	}
+
+	// skip ']'
+	cursor = separators.GetLast() + 1;
+
+	// success
+	return true;
+}
+
+//----------------------------------------------------------------------------->
+// Parses a range of the array elements found by JsonDoc::ScanArray().
+//    @param separators - positions of the '[', ',' and ']' characters
+//    @param elements - array of element nodes to be filled
+//    @param first - id of the first element to be parsed
+//    @param count - number of elements to be parsed
+//    @param failed - is set to 'true' if any element failed
+void JsonDoc::ParseArrayElements(const Array<const char*>& separators,
+                                 Array< Tree<text::Node> >& elements,
+                                 size_t first,
+                                 size_t count,
+                                 bool& failed)
+{
+	for (size_t i = first; i < first + count; i++)
+	{
+		// element is located between two separators
+		const char* element_end = separators[i + 1];
+		text::Reader element_cursor(separators[i] + 1);
+		Skip(element_cursor, Lookup::skWhitespace);
+		if (element_cursor.Get() >= element_end)
+		{
+			failed = true; // empty element
+			return;
+		}
+
+		// parse the value
+		Optional<Error> parse_value_error = ParseValue(element_cursor, elements[i], nullptr);
+		if (parse_value_error)
+		{
+			failed = true;
+			return;
+		}
+
+		// only whitespace can follow the value
+		Skip(element_cursor, Lookup::skWhitespace);
+		if (element_cursor.Get() != element_end)
+		{
+			failed = true;
+			return;
+		}
+	}
+}
+
+//----------------------------------------------------------------------------->
+// Finds boundaries of the array elements without parsing them.
+//    @param start - pointer to the '[' character
+//    @param separators - array to receive positions of the opening '[',
+//                        top-level ',' characters and the closing ']'
+//    @return - 'false' if the array is malformed
+bool JsonDoc::ScanArray(const char* start, Array<const char*>& separators)
+{
+	UT_ASSERT(*start == '[');
+	if (!separators.Add(start))
+	{
+		return false;
+	}
+
+	size_t depth = 0;
+	for (const char* c = start + 1; *c != '\0'; c++)
+	{
+		switch (*c)
+		{
+		case '"':
+			// skip the whole string, escaped characters included
+			for (c++; *c != '"'; c++)
+			{
+				if (*c == '\0' || (*c == '\\' && *++c == '\0'))
+				{
+					return false;
+				}
+			}
+			break;
+		case '[':
+		case '{':
+			depth++;
+			break;
+		case ']':
+		case '}':
+			if (depth == 0)
+			{
+				return *c == ']' && separators.Add(c);
+			}
+			depth--;
+			break;
+		case ',':
+			if (depth == 0 && !separators.Add(c))
+			{
+				return false;
+			}
+			break;
+		}
+	}
+
+	// unexpected end of text
+	return false;
+}
+
 //----------------------------------------------------------------------------->
 // Extracts a JSON String as defined by the spec - "<some chars>"
 // Any escaped characters are swapped out for their unescaped values
@@ -0,0 +1,522 @@
+//----------------------------------------------------------------------------//
+//---------------------------------|  U  T  |---------------------------------//
+//----------------------------------------------------------------------------//
+#include "text/ut_json_path.h"
+//----------------------------------------------------------------------------//
+START_NAMESPACE(ut)
+//----------------------------------------------------------------------------//
+// wildcard segment
+const char* JsonPath::skWildcard = "*";
+
+//----------------------------------------------------------------------------->
+// Creates a query from the JSON Pointer string.
+//    @param pointer - JSON Pointer, empty string refers to the whole
+//                     document, otherwise it must start with '/'
+//    @return - compiled query, or ut::Error if @pointer is invalid
+Result<JsonPath, Error> JsonPath::Create(const String& pointer)
+{
+	JsonPath path;
+
+	// empty pointer refers to the whole document
+	const char* c = pointer.GetAddress();
+	if (*c == '\0')
+	{
+		return path;
+	}
+
+	if (*c != '/')
+	{
+		return MakeError(error::invalid_arg, "JSON Pointer must start with '/'.");
+	}
+
+	while (*c == '/')
+	{
+		Segment segment;
+		segment.wildcard = false;
+
+		// unescape the reference token
+		for (c++; *c != '\0' && *c != '/'; c++)
+		{
+			if (*c != '~')
+			{
+				segment.key.Append(*c);
+				continue;
+			}
+
+			c++;
+			if (*c == '0')
+			{
+				segment.key.Append('~');
+			}
+			else if (*c == '1')
+			{
+				segment.key.Append('/');
+			}
+			else
+			{
+				return MakeError(error::invalid_arg, "JSON Pointer has invalid escape sequence.");
+			}
+		}
+
+		// check if the token is a wildcard or an array index, leading
+		// zeros are not allowed for indices, numbers that don't fit
+		// size_t are treated as keys
+		const size_t length = segment.key.Length();
+		segment.wildcard = segment.key == skWildcard;
+		if (length != 0 && (length == 1 || segment.key[0] != '0'))
+		{
+			const size_t max_index = static_cast<size_t>(-1);
+			size_t index = 0;
+			bool is_number = true;
+			for (size_t i = 0; is_number && i < length; i++)
+			{
+				const char digit = segment.key[i];
+				const size_t value = static_cast<size_t>(digit - '0');
+				is_number = digit >= '0' && digit <= '9' && index <= (max_index - value) / 10;
+				if (is_number)
+				{
+					index = index * 10 + value;
+				}
+			}
+
+			if (is_number)
+			{
+				segment.index = index;
+			}
+		}
+
+		if (!path.segments.Add(Move(segment)))
+		{
+			return MakeError(Error(error::out_of_memory));
+		}
+	}
+
+	// success
+	return path;
+}
+
+//----------------------------------------------------------------------------->
+// Evaluates the query against the child nodes of the provided tree.
+//    @param root - reference to the root node
+//    @return - array of references to the matched nodes
+Array< ConstRef< Tree<text::Node> > > JsonPath::Select(const Tree<text::Node>& root) const
+{
+	Array< ConstRef< Tree<text::Node> > > out;
+	SelectNode(root, 0, out);
+	return out;
+}
+
+//----------------------------------------------------------------------------->
+// Evaluates the query against the nodes of the provided document. Document
+// has no root node, so the first segment is matched against the names of the
+// nodes, and if there is no such name - against positions of the nodes (the
+// root of the JSON document can be an array).
+//    @param doc - reference to the parsed document
+//    @return - array of references to the matched nodes
+Array< ConstRef< Tree<text::Node> > > JsonPath::Select(const text::Document& doc) const
+{
+	Array< ConstRef< Tree<text::Node> > > out;
+	const size_t node_count = doc.nodes.Count();
+
+	// empty path - the whole document
+	if (segments.Count() == 0)
+	{
+		for (size_t i = 0; i < node_count; i++)
+		{
+			out.Add(ConstRef< Tree<text::Node> >(doc.nodes[i]));
+		}
+		return out;
+	}
+
+	// wildcard - every node
+	const Segment& segment = segments[0];
+	if (segment.wildcard)
+	{
+		for (size_t i = 0; i < node_count; i++)
+		{
+			if (SelectNode(doc.nodes[i], 1, out))
+			{
+				break;
+			}
+		}
+		return out;
+	}
+
+	// search by name
+	for (size_t i = 0; i < node_count; i++)
+	{
+		if (doc.nodes[i].data.name == segment.key)
+		{
+			SelectNode(doc.nodes[i], 1, out);
+			return out;
+		}
+	}
+
+	// search by index
+	if (segment.index && segment.index.Get() < node_count)
+	{
+		SelectNode(doc.nodes[segment.index.Get()], 1, out);
+	}
+
+	return out;
+}
+
+//----------------------------------------------------------------------------->
+// Evaluates the query against the raw JSON text.
+//    @param json - string with a JSON text
+//    @return - array of matched nodes, or ut::Error if encountered an error
+Result<Array< Tree<text::Node> >, Error> JsonPath::Scan(const String& json) const
+{
+	text::Reader cursor(json.GetAddress());
+
+	// check if document is empty
+	JsonDoc::Skip(cursor, JsonDoc::Lookup::skWhitespace);
+	if (cursor == '\0')
+	{
+		return MakeError(Error(error::empty));
+	}
+
+	Array< Tree<text::Node> > out;
+	Result<bool, Error> scan_result = ScanValue(cursor, String(), 0, out);
+	if (!scan_result)
+	{
+		return MakeError(scan_result.MoveAlt());
+	}
+
+	return out;
+}
+
+//----------------------------------------------------------------------------->
+// Returns 'true' if the query has at least one wildcard segment.
+bool JsonPath::HasWildcards() const
+{
+	const size_t segment_count = segments.Count();
+	for (size_t i = 0; i < segment_count; i++)
+	{
+		if (segments[i].wildcard)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+//----------------------------------------------------------------------------->
+// Recursively evaluates the query against the tree.
+//    @param node - reference to the current node
+//    @param segment_id - id of the segment to match children of @node
+//    @param out - array to receive matched nodes
+//    @return - 'true' if search must be stopped
+bool JsonPath::SelectChildren(const Tree<text::Node>& node,
+                              size_t segment_id,
+                              Array< ConstRef< Tree<text::Node> > >& out) const
+{
+	const Segment& segment = segments[segment_id];
+
+	// every child node
+	if (segment.wildcard)
+	{
+		const size_t child_count = node.CountChildren();
+		for (size_t i = 0; i < child_count; i++)
+		{
+			if (SelectNode(node[i], segment_id + 1, out))
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// array element
+	if (node.data.is_array)
+	{
+		if (!segment.index || segment.index.Get() >= node.CountChildren())
+		{
+			return false;
+		}
+		return SelectNode(node[segment.index.Get()], segment_id + 1, out);
+	}
+
+	// object member
+	Optional<const Tree<text::Node>&> child = text::FindChild(node, segment.key);
+	if (!child)
+	{
+		return false;
+	}
+	return SelectNode(child.Get(), segment_id + 1, out);
+}
+
+//----------------------------------------------------------------------------->
+// Checks if the node matches the segment and continues the search.
+//    @param node - reference to the node to be checked
+//    @param segment_id - id of the segment to match @node
+//    @param out - array to receive matched nodes
+//    @return - 'true' if search must be stopped
+bool JsonPath::SelectNode(const Tree<text::Node>& node,
+                          size_t segment_id,
+                          Array< ConstRef< Tree<text::Node> > >& out) const
+{
+	if (segment_id == segments.Count())
+	{
+		out.Add(ConstRef< Tree<text::Node> >(node));
+		return !HasWildcards();
+	}
+
+	return SelectChildren(node, segment_id, out);
+}
+
+//----------------------------------------------------------------------------->
+// Recursively evaluates the query against the raw text.
+//    @param cursor - reference to the current position, the beginning of
+//                    the value, cursor is moved to the end of this value
+//    @param name - name of the current value
+//    @param segment_id - id of the segment to match children of the value
+//    @param out - array to receive matched nodes
+//    @return - 'true' if search must be stopped, or ut::Error if failed
+Result<bool, Error> JsonPath::ScanValue(text::Reader& cursor,
+                                        const String& name,
+                                        size_t segment_id,
+                                        Array< Tree<text::Node> >& out) const
+{
+	JsonDoc::Skip(cursor, JsonDoc::Lookup::skWhitespace);
+
+	// the value matches the whole path - parse it
+	if (segment_id == segments.Count())
+	{
+		Tree<text::Node> node;
+		node.data.name = name;
+		Optional<Error> parse_error = JsonDoc::ParseValue(cursor, node, nullptr);
+		if (parse_error)
+		{
+			return MakeError(parse_error.Move());
+		}
+
+		if (!out.Add(Move(node)))
+		{
+			return MakeError(Error(error::out_of_memory));
+		}
+
+		return !HasWildcards();
+	}
+
+	const Segment& segment = segments[segment_id];
+	if (cursor == '{') // object
+	{
+		cursor++;
+		JsonDoc::Skip(cursor, JsonDoc::Lookup::skWhitespace);
+		if (cursor == '}')
+		{
+			cursor++;
+			return false;
+		}
+
+		while (true)
+		{
+			// name of the member
+			JsonDoc::Skip(cursor, JsonDoc::Lookup::skWhitespace);
+			if (cursor != '"')
+			{
+				return MakeError(error::fail, "JSON object has no name.");
+			}
+			cursor++;
+
+			Result<String, Error> name_result = JsonDoc::ExtractString(cursor);
+			if (!name_result)
+			{
+				return MakeError(name_result.MoveAlt());
+			}
+
+			JsonDoc::Skip(cursor, JsonDoc::Lookup::skWhitespace);
+			if (cursor != ':')
+			{
+				return MakeError(error::fail, "JSON object - expected \":\" character.");
+			}
+			cursor++;
+			JsonDoc::Skip(cursor, JsonDoc::Lookup::skWhitespace);
+
+			// visit matched member, skip others
+			if (segment.wildcard || name_result.Get() == segment.key)
+			{
+				Result<bool, Error> scan_result = ScanValue(cursor, name_result.Get(), segment_id + 1, out);
+				if (!scan_result || scan_result.Get())
+				{
+					return scan_result;
+				}
+			}
+			else
+			{
+				Optional<Error> skip_error = SkipValue(cursor);
+				if (skip_error)
+				{
+					return MakeError(skip_error.Move());
+				}
+			}
+
+			// end of the object or the next member
+			JsonDoc::Skip(cursor, JsonDoc::Lookup::skWhitespace);
+			if (cursor == '}')
+			{
+				cursor++;
+				return false;
+			}
+
+			if (cursor != ',')
+			{
+				return MakeError(error::fail, "JSON object - expected \",\" character.");
+			}
+			cursor++;
+		}
+	}
+	else if (cursor == '[') // array
+	{
+		cursor++;
+		JsonDoc::Skip(cursor, JsonDoc::Lookup::skWhitespace);
+		if (cursor == ']')
+		{
+			cursor++;
+			return false;
+		}
+
+		for (size_t i = 0; ; i++)
+		{
+			// visit matched element, skip others
+			JsonDoc::Skip(cursor, JsonDoc::Lookup::skWhitespace);
+			if (segment.wildcard || (segment.index && segment.index.Get() == i))
+			{
+				Result<bool, Error> scan_result = ScanValue(cursor, String(), segment_id + 1, out);
+				if (!scan_result || scan_result.Get())
+				{
+					return scan_result;
+				}
+			}
+			else
+			{
+				Optional<Error> skip_error = SkipValue(cursor);
+				if (skip_error)
+				{
+					return MakeError(skip_error.Move());
+				}
+			}
+
+			// end of the array or the next element
+			JsonDoc::Skip(cursor, JsonDoc::Lookup::skWhitespace);
+			if (cursor == ']')
+			{
+				cursor++;
+				return false;
+			}
+
+			if (cursor != ',')
+			{
+				return MakeError(error::fail, "JSON array - expected \",\" character.");
+			}
+			cursor++;
+		}
+	}
+
+	// scalar value has no children
+	Optional<Error> skip_error = SkipValue(cursor);
+	if (skip_error)
+	{
+		return MakeError(skip_error.Move());
+	}
+
+	return false;
+}
+
+//----------------------------------------------------------------------------->
+// Skips the value without parsing it.
+//    @param cursor - reference to the current position, the beginning of
+//                    the value, cursor is moved to the end of this value
+//    @return - ut::Error if the value is malformed
+Optional<Error> JsonPath::SkipValue(text::Reader& cursor)
+{
+	// string
+	if (cursor == '"')
+	{
+		return SkipString(cursor);
+	}
+
+	// object or array
+	if (cursor == '{' || cursor == '[')
+	{
+		size_t depth = 0;
+		do
+		{
+			const char c = cursor[0];
+			if (c == '\0')
+			{
+				return Error(error::fail, "Unexpected end of file.");
+			}
+			else if (c == '"')
+			{
+				Optional<Error> skip_error = SkipString(cursor);
+				if (skip_error)
+				{
+					return skip_error;
+				}
+				continue;
+			}
+			else if (c == '{' || c == '[')
+			{
+				depth++;
+			}
+			else if (c == '}' || c == ']')
+			{
+				depth--;
+			}
+			cursor++;
+		} while (depth != 0);
+
+		return Optional<Error>();
+	}
+
+	// number or literal
+	const char* start = cursor.Get();
+	while (cursor != '\0' && cursor != ',' && cursor != '}' && cursor != ']' &&
+	       cursor != ' ' && cursor != '\t' && cursor != '\n' && cursor != '\r')
+	{
+		cursor++;
+	}
+
+	if (cursor.Get() == start)
+	{
+		return Error(error::fail, "Unknown value type.");
+	}
+
+	return Optional<Error>();
+}
+
+//----------------------------------------------------------------------------->
+// Skips the string without unescaping it.
+//    @param cursor - reference to the current position, the opening
+//                    quote, cursor is moved past the closing quote
+//    @return - ut::Error if the string is not terminated
+Optional<Error> JsonPath::SkipString(text::Reader& cursor)
+{
+	UT_ASSERT(cursor == '"');
+
+	for (cursor++; cursor != '"'; cursor++)
+	{
+		// skip escaped character
+		if (cursor == '\\')
+		{
+			cursor++;
+		}
+
+		if (cursor == '\0')
+		{
+			return Error(error::fail, "Unexpected end of file.");
+		}
+	}
+
+	// skip closing quote
+	cursor++;
+	return Optional<Error>();
+}
+
+//----------------------------------------------------------------------------//
+END_NAMESPACE(ut)
+//----------------------------------------------------------------------------//
+//----------------------------------------------------------------------------//
+//----------------------------------------------------------------------------//
@@ -20,6 +20,40 @@ node::Type Node::GetType() const
 	return type;
 }
 
+//----------------------------------------------------------------------------//
+// Searches for a child node with the desired name using the index.
+//    @param parent - reference to the parent node to search in.
+//    @param name - name of the child node to search for.
+//    @return - reference to the child node, or nothing if not found.
+Optional<const Tree<Node>&> FindChild(const Tree<Node>& parent, const String& name)
+{
+	const Optional<size_t> find_result = parent.data.child_index.Find(parent, name);
+	if (!find_result)
+	{
+		return Optional<const Tree<Node>&>();
+	}
+
+	return parent[find_result.Get()];
+}
+
+// Searches for a child node with the desired name linearly.
+//    @param parent - reference to the parent node to search in.
+//    @param name - name of the child node to search for.
+//    @return - reference to the child node, or nothing if not found.
+Optional<Tree<Node>&> FindChild(Tree<Node>& parent, const String& name)
+{
+	const size_t child_count = parent.CountChildren();
+	for (size_t i = 0; i < child_count; i++)
+	{
+		if (parent[i].data.name == name)
+		{
+			return parent[i];
+		}
+	}
+
+	return Optional<Tree<Node>&>();
+}
+
 //----------------------------------------------------------------------------//
 END_NAMESPACE(text)
 END_NAMESPACE(ut)
@@ -75,7 +75,7 @@ Optional<Error> XmlDoc::Write(OutputStream& stream) const
 //----------------------------------------------------------------------------->
 // Parses BOM, if any
 //    @param cursor - reference to the current char pointer
-void XmlDoc::ParseBOM(text::Reader& cursor) const
+void XmlDoc::ParseBOM(text::Reader& cursor)
 {
 	if (cursor[0] != 0 && cursor[1] != 0 && cursor[2] != 0)
 	{
@@ -803,8 +803,8 @@ Result<String, Error> XmlDoc::SkipAndExpandCharacterRefs(text::Reader& cursor,
 		}
 
 		// No replacement, only copy character
-		cursor++;
 		out.Append(cursor[0]);
+		cursor++;
 	}
 
 	// Return the value
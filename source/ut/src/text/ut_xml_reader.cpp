@@ -0,0 +1,578 @@
+//----------------------------------------------------------------------------//
+//---------------------------------|  U  T  |---------------------------------//
+//----------------------------------------------------------------------------//
+#include "text/ut_xml_reader.h"
+#include "system/ut_memory.h"
+#include "math/ut_cmp.h"
+//----------------------------------------------------------------------------//
+START_NAMESPACE(ut)
+//----------------------------------------------------------------------------//
+// default number of bytes requested from the stream at once
+const size_t XmlReader::skDefaultChunkSize = 4096;
+
+// default maximum size of the internal buffer
+const size_t XmlReader::skDefaultBufferCapacity = 1024 * 1024;
+
+//----------------------------------------------------------------------------//
+// Constructor
+XmlReader::Event::Event(Type event_type) : type(event_type)
+{ }
+
+//----------------------------------------------------------------------------//
+// Constructor, creates a reader pulling data from the provided stream.
+//    @param input - stream to read data from, reader doesn't own it
+//    @param chunk_size - number of bytes to request from the stream at once
+//    @param buffer_capacity - maximum size of the internal buffer in bytes,
+//                             this is also the maximum size of one token
+XmlReader::XmlReader(InputStream& input,
+                     size_t reader_chunk_size,
+                     size_t buffer_capacity) : stream(&input)
+                                             , chunk_size(reader_chunk_size == 0 ? 1 : reader_chunk_size)
+                                             , buffer(buffer_capacity + 1)
+                                             , begin(0)
+                                             , end(0)
+                                             , finished(false)
+                                             , bom_checked(false)
+                                             , pending_end(false)
+{ }
+
+// Constructor, creates a reader for the push mode, use XmlReader::Feed()
+// to supply data and XmlReader::Finish() to signal the end of the data.
+//    @param buffer_capacity - maximum size of the internal buffer in bytes,
+//                             this is also the maximum size of one token
+XmlReader::XmlReader(size_t buffer_capacity) : stream(nullptr)
+                                             , chunk_size(0)
+                                             , buffer(buffer_capacity + 1)
+                                             , begin(0)
+                                             , end(0)
+                                             , finished(false)
+                                             , bom_checked(false)
+                                             , pending_end(false)
+{ }
+
+//----------------------------------------------------------------------------->
+// Appends a chunk of data to the internal buffer (push mode).
+//    @param data - pointer to the data
+//    @param size - size of the data in bytes
+//    @return - ut::Error if buffer capacity is exceeded
+Optional<Error> XmlReader::Feed(const void* data, size_t size)
+{
+	// feeding is not allowed if reader is bound to the stream
+	if (stream != nullptr || finished)
+	{
+		return Error(error::fail, "XmlReader doesn't accept data.");
+	}
+
+	// free some space
+	Compact();
+
+	// check capacity
+	const size_t capacity = buffer.Count() - 1;
+	if (size > capacity - end)
+	{
+		return Error(error::out_of_bounds, "XmlReader buffer overflow.");
+	}
+
+	// copy data
+	memory::Copy(buffer.GetAddress() + end, data, size);
+	end += size;
+
+	// success
+	return Optional<Error>();
+}
+
+//----------------------------------------------------------------------------->
+// Signals that no more data will be fed (push mode).
+void XmlReader::Finish()
+{
+	finished = true;
+}
+
+//----------------------------------------------------------------------------->
+// Parses the next token and returns it as an event.
+//    @return - event, or ut::Error if encountered an error. In push mode
+//              error::empty means that more data must be fed to complete
+//              the current token, calling Next() again after feeding is safe.
+Result<XmlReader::Event, Error> XmlReader::Next()
+{
+	// self-closing element is closed right after it was opened
+	if (pending_end)
+	{
+		pending_end = false;
+		Event event(Event::Type::end_element);
+		event.node.data.name = Move(open_elements.GetLast());
+		open_elements.PopBack();
+		return event;
+	}
+
+	const size_t capacity = buffer.Count() - 1;
+	while (true)
+	{
+		const char* data = buffer.GetAddress();
+
+		// skip BOM, at least 3 characters are needed to check it
+		if (!bom_checked)
+		{
+			if (end - begin >= 3 || IsEndOfData())
+			{
+				buffer[end] = 0;
+				text::Reader cursor(data + begin);
+				XmlDoc::ParseBOM(cursor);
+				begin = cursor.Get() - data;
+				bom_checked = true;
+			}
+		}
+		else
+		{
+			// skip whitespace between tokens
+			while (begin < end && XmlDoc::Lookup::skWhitespace[static_cast<byte>(data[begin])])
+			{
+				begin++;
+			}
+
+			// try to parse the next token if there is any data
+			if (begin < end)
+			{
+				Optional<size_t> token_end = FindTokenEnd(begin);
+				if (!token_end && IsEndOfData())
+				{
+					if (data[begin] == '<')
+					{
+						return MakeError(error::fail, "unexpected end of data");
+					}
+					token_end = end; // trailing text
+				}
+
+				if (token_end)
+				{
+					return ParseToken(begin, token_end.Get());
+				}
+
+				// incomplete token must fit the buffer
+				if (begin == 0 && end == capacity)
+				{
+					return MakeError(error::out_of_bounds, "XML token exceeds XmlReader buffer capacity.");
+				}
+			}
+			else if (IsEndOfData())
+			{
+				if (open_elements.Count() != 0)
+				{
+					return MakeError(error::fail, "unexpected end of data");
+				}
+				return Event(Event::Type::end_document);
+			}
+		}
+
+		// receive more data
+		if (stream == nullptr)
+		{
+			return MakeError(error::empty);
+		}
+
+		Optional<Error> fill_error = Fill();
+		if (fill_error)
+		{
+			return MakeError(fill_error.Move());
+		}
+	}
+}
+
+//----------------------------------------------------------------------------->
+// Returns current depth of the element hierarchy.
+size_t XmlReader::GetDepth() const
+{
+	return open_elements.Count();
+}
+
+//----------------------------------------------------------------------------->
+// Scans the buffer for the end of the token starting at @start.
+//    @param start - offset of the first character of the token ('<' or text)
+//    @return - offset of the character following the token, or
+//              nothing if the token is incomplete
+Optional<size_t> XmlReader::FindTokenEnd(size_t start) const
+{
+	const char* data = buffer.GetAddress();
+	const char* cursor = data + start;
+	const char* last = data + end;
+	const size_t length = end - start;
+
+	// text lasts until the next tag
+	if (cursor[0] != '<')
+	{
+		const void* tag = memchr(cursor, '<', length);
+		if (tag == nullptr)
+		{
+			return Optional<size_t>();
+		}
+		return static_cast<const char*>(tag) - data;
+	}
+
+	// at least 2 characters are needed to determine the type of the tag
+	if (length < 2)
+	{
+		return Optional<size_t>();
+	}
+
+	// terminating sequence of the token
+	const char* terminator = ">";
+	size_t terminator_length = 1;
+	const char* search_from = cursor + 1;
+
+	if (cursor[1] == '?')
+	{
+		// <?...?>
+		terminator = "?>";
+		terminator_length = 2;
+		search_from = cursor + 2;
+	}
+	else if (cursor[1] == '!')
+	{
+		// 9 characters are enough to distinguish between <!-- <![CDATA[ and <!DOCTYPE
+		const size_t skPrefixLength = 9;
+		if (length < skPrefixLength && !IsEndOfData())
+		{
+			return Optional<size_t>();
+		}
+
+		if (length >= 4 && cursor[2] == '-' && cursor[3] == '-')
+		{
+			// <!-- ... -->
+			terminator = "-->";
+			terminator_length = 3;
+			search_from = cursor + 4;
+		}
+		else if (length >= 9 && memcmp(cursor + 2, "[CDATA[", 7) == 0)
+		{
+			// <![CDATA[ ... ]]>
+			terminator = "]]>";
+			terminator_length = 3;
+			search_from = cursor + 9;
+		}
+		else if (length >= 10 && memcmp(cursor + 2, "DOCTYPE", 7) == 0)
+		{
+			// <!DOCTYPE ... [ ... ] ... >, brackets can be nested
+			int depth = 0;
+			for (const char* c = cursor + 9; c < last; c++)
+			{
+				if (*c == '[')
+				{
+					depth++;
+				}
+				else if (*c == ']' && depth > 0)
+				{
+					depth--;
+				}
+				else if (*c == '>' && depth == 0)
+				{
+					return c + 1 - data;
+				}
+			}
+			return Optional<size_t>();
+		}
+	}
+	else if (cursor[1] != '/')
+	{
+		// element start tag, '>' can be a part of the attribute value
+		char quote = 0;
+		for (const char* c = cursor + 1; c < last; c++)
+		{
+			if (quote != 0)
+			{
+				if (*c == quote)
+				{
+					quote = 0;
+				}
+			}
+			else if (*c == '"' || *c == '\'')
+			{
+				quote = *c;
+			}
+			else if (*c == '>')
+			{
+				return c + 1 - data;
+			}
+		}
+		return Optional<size_t>();
+	}
+
+	// search for the terminating sequence
+	for (const char* c = search_from; c + terminator_length <= last; c++)
+	{
+		if (memcmp(c, terminator, terminator_length) == 0)
+		{
+			return c + terminator_length - data;
+		}
+	}
+
+	// token is incomplete
+	return Optional<size_t>();
+}
+
+//----------------------------------------------------------------------------->
+// Parses a complete token that is located in the buffer.
+//    @param start - offset of the first character of the token
+//    @param end - offset of the character following the token
+//    @return - event, or ut::Error if encountered an error
+Result<XmlReader::Event, Error> XmlReader::ParseToken(size_t start, size_t token_end)
+{
+	// XmlDoc routines expect null-terminated text
+	char* data = buffer.GetAddress();
+	const char terminated_char = data[token_end];
+	data[token_end] = 0;
+
+	// token is consumed regardless of the result
+	begin = token_end;
+
+	text::Reader cursor(data + start);
+	Result<Event, Error> result = MakeError(error::fail);
+	if (cursor != '<')
+	{
+		// character data
+		if (open_elements.Count() == 0)
+		{
+			result = MakeError(error::fail, "expected <");
+		}
+		else
+		{
+			Event event(Event::Type::text);
+			Result<char, Error> data_result = XmlDoc::ParseAndAppendData(event.node,
+			                                                             cursor,
+			                                                             cursor.Get(),
+			                                                             true,
+			                                                             true);
+			if (data_result)
+			{
+				result = Move(event);
+			}
+			else
+			{
+				result = MakeError(data_result.MoveAlt());
+			}
+		}
+	}
+	else if (cursor[1] == '/')
+	{
+		result = ParseEndTag(cursor);
+	}
+	else if (cursor[1] == '?')
+	{
+		cursor += 2; // skip '<?'
+		const bool is_declaration = (cursor[0] == 'x' || cursor[0] == 'X') &&
+		                            (cursor[1] == 'm' || cursor[1] == 'M') &&
+		                            (cursor[2] == 'l' || cursor[2] == 'L') &&
+		                            XmlDoc::Lookup::skWhitespace[static_cast<byte>(cursor[3])];
+		Event event(is_declaration ? Event::Type::declaration : Event::Type::pi);
+		Result<Tree<text::Node>, Error> node_result = MakeError(error::fail);
+		if (is_declaration)
+		{
+			cursor += 4; // skip 'xml '
+			node_result = XmlDoc::ParseXmlDeclaration(cursor);
+		}
+		else
+		{
+			node_result = XmlDoc::ParsePi(cursor);
+		}
+
+		if (node_result)
+		{
+			event.node = node_result.Move();
+			result = Move(event);
+		}
+		else
+		{
+			result = MakeError(node_result.MoveAlt());
+		}
+	}
+	else if (cursor[1] == '!')
+	{
+		Event event;
+		Result<Tree<text::Node>, Error> node_result = MakeError(error::fail, "No node recognized");
+		if (cursor[2] == '-' && cursor[3] == '-')
+		{
+			cursor += 4; // skip '<!--'
+			event.type = Event::Type::comment;
+			node_result = XmlDoc::ParseComment(cursor);
+		}
+		else if (cursor.Compare("<![CDATA["))
+		{
+			cursor += 9; // skip '<![CDATA['
+			event.type = Event::Type::cdata;
+			node_result = XmlDoc::ParseCData(cursor);
+		}
+		else if (cursor.Compare("<!DOCTYPE") &&
+		         XmlDoc::Lookup::skWhitespace[static_cast<byte>(cursor[9])])
+		{
+			cursor += 10; // skip '<!DOCTYPE '
+			event.type = Event::Type::doctype;
+			node_result = XmlDoc::ParseDoctype(cursor);
+		}
+
+		if (node_result)
+		{
+			event.node = node_result.Move();
+			result = Move(event);
+		}
+		else
+		{
+			result = MakeError(node_result.MoveAlt());
+		}
+	}
+	else
+	{
+		result = ParseStartTag(cursor);
+	}
+
+	// restore the character that was replaced by the null terminator
+	data[token_end] = terminated_char;
+
+	return result;
+}
+
+//----------------------------------------------------------------------------->
+// Parses start tag of the element (<name attr="...">).
+//    @param cursor - reference to the current reader position
+//    @return - event, or ut::Error if encountered an error
+Result<XmlReader::Event, Error> XmlReader::ParseStartTag(text::Reader& cursor)
+{
+	Event event(Event::Type::start_element);
+
+	// skip '<'
+	++cursor;
+
+	// extract element name
+	const char* name = cursor.Get();
+	XmlDoc::Skip(cursor, XmlDoc::Lookup::skNodeName);
+	if (cursor.Get() == name)
+	{
+		return MakeError(error::fail, "expected element name");
+	}
+	event.node.data.name = String(name, cursor.Get() - name);
+
+	// skip whitespace between element name and attributes or >
+	XmlDoc::Skip(cursor, XmlDoc::Lookup::skWhitespace);
+
+	// parse attributes, if any
+	Optional<Error> parse_attributes_error = XmlDoc::ParseNodeAttributes(cursor, event.node);
+	if (parse_attributes_error)
+	{
+		return MakeError(parse_attributes_error.Move());
+	}
+
+	// determine ending type
+	if (cursor == '/')
+	{
+		++cursor;
+		pending_end = true;
+	}
+
+	if (cursor != '>')
+	{
+		return MakeError(error::fail, "expected >");
+	}
+
+	// remember opened element to validate closing tag
+	if (!open_elements.Add(event.node.data.name))
+	{
+		return MakeError(error::out_of_memory);
+	}
+
+	return event;
+}
+
+//----------------------------------------------------------------------------->
+// Parses closing tag of the element (</name>).
+//    @param cursor - reference to the current reader position
+//    @return - event, or ut::Error if encountered an error
+Result<XmlReader::Event, Error> XmlReader::ParseEndTag(text::Reader& cursor)
+{
+	Event event(Event::Type::end_element);
+
+	// skip '</'
+	cursor += 2;
+
+	// skip and validate closing tag name
+	const char* name = cursor.Get();
+	XmlDoc::Skip(cursor, XmlDoc::Lookup::skNodeName);
+	event.node.data.name = String(name, cursor.Get() - name);
+	if (open_elements.Count() == 0 || event.node.data.name != open_elements.GetLast())
+	{
+		return MakeError(error::fail, "invalid closing tag name");
+	}
+
+	// skip remaining whitespace after node name
+	XmlDoc::Skip(cursor, XmlDoc::Lookup::skWhitespace);
+	if (cursor != '>')
+	{
+		return MakeError(error::fail, "expected >");
+	}
+
+	// element is closed
+	open_elements.PopBack();
+
+	return event;
+}
+
+//----------------------------------------------------------------------------->
+// Moves unprocessed data to the beginning of the buffer.
+void XmlReader::Compact()
+{
+	if (begin == 0)
+	{
+		return;
+	}
+
+	char* data = buffer.GetAddress();
+	memory::Move(data, data + begin, end - begin);
+	end -= begin;
+	begin = 0;
+}
+
+//----------------------------------------------------------------------------->
+// Reads the next chunk from the stream into the buffer.
+//    @return - ut::Error if encountered an error
+Optional<Error> XmlReader::Fill()
+{
+	UT_ASSERT(stream != nullptr);
+
+	// free some space
+	Compact();
+
+	// calculate the size of the chunk
+	const size_t capacity = buffer.Count() - 1;
+	const size_t read_size = Min(chunk_size, capacity - end);
+	if (read_size == 0)
+	{
+		return Optional<Error>();
+	}
+
+	// streams of unknown size can return fewer bytes than requested,
+	// empty result means the end of the stream
+	Result<size_t, Error> read_result = stream->ReadSome(buffer.GetAddress() + end, read_size);
+	if (!read_result)
+	{
+		return read_result.MoveAlt();
+	}
+
+	if (read_result.Get() == 0)
+	{
+		finished = true;
+	}
+	end += read_result.Get();
+
+	// success
+	return Optional<Error>();
+}
+
+//----------------------------------------------------------------------------->
+// Returns 'true' if there is no more data to receive.
+bool XmlReader::IsEndOfData() const
+{
+	return finished;
+}
+
+//----------------------------------------------------------------------------//
+END_NAMESPACE(ut)
+//----------------------------------------------------------------------------//
+//----------------------------------------------------------------------------//
+//----------------------------------------------------------------------------//
@@ -0,0 +1,65 @@
+//----------------------------------------------------------------------------//
+//---------------------------------|  U  T  |---------------------------------//
+//----------------------------------------------------------------------------//
+#include "thread/ut_backoff.h"
+#include "thread/ut_thread.h"
+//----------------------------------------------------------------------------//
+START_NAMESPACE(ut)
+//----------------------------------------------------------------------------//
+// Constructor.
+//    @param spin_count - number of spinning iterations.
+//    @param yield_count - number of yielding iterations.
+Backoff::Thresholds::Thresholds(uint32 spin_count,
+                                uint32 yield_count) : spin(spin_count)
+                                                    , yield(yield_count)
+{}
+
+//----------------------------------------------------------------------------->
+// Constructor.
+//    @param thresholds - number of iterations of every stage.
+Backoff::Backoff(Thresholds in_thresholds) : thresholds(in_thresholds)
+                                           , iteration(0)
+{}
+
+//----------------------------------------------------------------------------->
+// Performs one waiting iteration according to the current stage.
+//    @return - 'true' if the caller must check the condition and call
+//              Wait() again, or 'false' if all iterations were spent
+//              and the thread must be parked.
+bool Backoff::Wait()
+{
+	if (iteration < thresholds.spin)
+	{
+		// number of pauses doubles every iteration up to the limit
+		const uint32 pause_count = iteration < 5 ? 1u << iteration : skMaxPauseCount;
+		for (uint32 i = 0; i < pause_count; i++)
+		{
+			this_thread::Pause();
+		}
+	}
+	else if (iteration - thresholds.spin < thresholds.yield)
+	{
+		this_thread::Yield();
+	}
+	else
+	{
+		return false;
+	}
+
+	iteration++;
+	return true;
+}
+
+//----------------------------------------------------------------------------->
+// Starts from the spinning stage again, must be called
+// when the condition became true.
+void Backoff::Reset()
+{
+	iteration = 0;
+}
+
+//----------------------------------------------------------------------------//
+END_NAMESPACE(ut)
+//----------------------------------------------------------------------------//
+//----------------------------------------------------------------------------//
+//----------------------------------------------------------------------------//
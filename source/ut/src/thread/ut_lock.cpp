@@ -2,6 +2,8 @@
 //---------------------------------|  U  T  |---------------------------------//
 //----------------------------------------------------------------------------//
 #include "thread/ut_lock.h"
+#include "thread/ut_interlocked.h"
+#include "thread/ut_thread.h"
 #include "error/ut_error.h"
 //----------------------------------------------------------------------------//
 START_NAMESPACE(ut)
@@ -318,6 +320,110 @@ void ScopeRWLock::Reset(void)
 	}
 }
 
+//----------------------------------------------------------------------------//
+// class ut::ShardedRWLock                                                    //
+//----------------------------------------------------------------------------//
+// Constructor
+ShardedRWLock::ShardedRWLock() : writer(0)
+{
+	for (size_t i = 0; i < skShardCount; i++)
+	{
+		shards[i].readers = 0;
+	}
+}
+
+//----------------------------------------------------------------------------->
+// Locks section with 'RWLock::Access::write' access
+void ShardedRWLock::Lock()
+{
+	Lock(Access::write);
+}
+
+//----------------------------------------------------------------------------->
+// Unlocks section with 'RWLock::Access::write' access
+void ShardedRWLock::Unlock()
+{
+	Unlock(Access::write);
+}
+
+//----------------------------------------------------------------------------->
+// Locks section with desired access
+void ShardedRWLock::Lock(Access access)
+{
+	if (access == Access::read)
+	{
+		Shard& shard = GetShard();
+		Backoff backoff;
+		while (true)
+		{
+			// both operations are sequentially consistent, so either the
+			// writer sees this reader, or the reader sees the writer flag
+			atomics::interlocked::Increment(&shard.readers);
+			if (atomics::interlocked::Read(&writer) == 0)
+			{
+				return;
+			}
+			atomics::interlocked::Decrement(&shard.readers);
+
+			// writer holds the mutex for the whole write section,
+			// so the reader is parked here if waiting takes too long
+			while (atomics::interlocked::Read(&writer) != 0)
+			{
+				if (!backoff.Wait())
+				{
+					ScopeLock lock(writer_mutex);
+					backoff.Reset();
+				}
+			}
+		}
+	}
+	else
+	{
+		writer_mutex.Lock();
+		atomics::interlocked::Store(&writer, 1);
+
+		// readers hold the lock for a short time and don't
+		// signal the writer, so it can only spin and yield
+		for (size_t i = 0; i < skShardCount; i++)
+		{
+			Backoff backoff;
+			while (atomics::interlocked::Read(&shards[i].readers) != 0)
+			{
+				if (!backoff.Wait())
+				{
+					this_thread::Yield();
+				}
+			}
+		}
+	}
+}
+
+//----------------------------------------------------------------------------->
+// Unlocks section with desired access
+void ShardedRWLock::Unlock(Access access)
+{
+	if (access == Access::read)
+	{
+		atomics::interlocked::Decrement(&GetShard().readers);
+	}
+	else
+	{
+		atomics::interlocked::Store(&writer, 0);
+		writer_mutex.Unlock();
+	}
+}
+
+//----------------------------------------------------------------------------->
+// Returns the shard of the current thread. Threads get shards in the
+// round-robin order on the first call, so concurrently running threads
+// use different shards until there are more threads than shards.
+ShardedRWLock::Shard& ShardedRWLock::GetShard()
+{
+	static int32 thread_counter = 0;
+	static thread_local const uint32 thread_index = static_cast<uint32>(atomics::interlocked::Increment(&thread_counter));
+	return shards[thread_index % skShardCount];
+}
+
 //----------------------------------------------------------------------------//
 END_NAMESPACE(ut)
 //----------------------------------------------------------------------------//
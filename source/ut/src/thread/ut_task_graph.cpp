@@ -0,0 +1,136 @@
+//----------------------------------------------------------------------------//
+//---------------------------------|  U  T  |---------------------------------//
+//----------------------------------------------------------------------------//
+#include "thread/ut_task_graph.h"
+//----------------------------------------------------------------------------//
+START_NAMESPACE(ut)
+//----------------------------------------------------------------------------//
+// Constructor.
+TaskGraph::TaskGraph() : built(false)
+{}
+
+//----------------------------------------------------------------------------->
+// Adds a new node to the graph, invalidates the result of Build().
+//    @param task - unique pointer to the task of the node.
+//    @return - identifier of the new node or ut::Error if failed.
+Result<size_t, Error> TaskGraph::AddNode(UniqueTaskPtr task)
+{
+	if (!task)
+	{
+		return MakeError(error::invalid_arg, "Task of the node can't be null.");
+	}
+
+	Node node;
+	node.task = Move(task);
+	node.predecessor_count = 0;
+	node.remaining = 0;
+	if (!nodes.Add(Move(node)))
+	{
+		return MakeError(error::out_of_memory);
+	}
+
+	built = false;
+	return nodes.Count() - 1;
+}
+
+//----------------------------------------------------------------------------->
+// Adds a dependency between two nodes, invalidates the result of Build().
+//    @param predecessor - identifier of the node that must finish first.
+//    @param successor - identifier of the node that must start after
+//                       @predecessor is finished.
+//    @return - ut::Error if identifiers are invalid or failed
+//              to allocate memory.
+Optional<Error> TaskGraph::AddDependency(size_t predecessor, size_t successor)
+{
+	const size_t count = nodes.Count();
+	if (predecessor >= count || successor >= count)
+	{
+		return Error(error::out_of_bounds);
+	}
+
+	if (predecessor == successor)
+	{
+		return Error(error::invalid_arg, "Node can't depend on itself.");
+	}
+
+	if (!nodes[predecessor].successors.Add(successor))
+	{
+		return Error(error::out_of_memory);
+	}
+
+	nodes[successor].predecessor_count++;
+	built = false;
+	return Optional<Error>();
+}
+
+//----------------------------------------------------------------------------->
+// Validates the graph and prepares it for execution, must be called
+// after the last modification and before the first execution.
+//    @return - ut::Error if the graph has a cycle or failed
+//              to allocate memory.
+Optional<Error> TaskGraph::Build()
+{
+	const size_t count = nodes.Count();
+	roots.Reset();
+
+	// topological sort (Kahn's algorithm): @order is used as a queue of nodes
+	// whose predecessors were all visited, every node gets to the queue
+	// exactly once if there are no cycles
+	Array<size_t> order;
+	Array<int32> in_degree;
+	if (!order.Resize(count) || !in_degree.Resize(count))
+	{
+		return Error(error::out_of_memory);
+	}
+
+	size_t tail = 0;
+	for (size_t i = 0; i < count; i++)
+	{
+		in_degree[i] = nodes[i].predecessor_count;
+		if (in_degree[i] != 0)
+		{
+			continue;
+		}
+
+		if (!roots.Add(i))
+		{
+			return Error(error::out_of_memory);
+		}
+		order[tail++] = i;
+	}
+
+	for (size_t head = 0; head < tail; head++)
+	{
+		const Array<size_t>& successors = nodes[order[head]].successors;
+		const size_t successor_count = successors.Count();
+		for (size_t i = 0; i < successor_count; i++)
+		{
+			if (--in_degree[successors[i]] == 0)
+			{
+				order[tail++] = successors[i];
+			}
+		}
+	}
+
+	if (tail != count)
+	{
+		roots.Reset();
+		return Error(error::invalid_arg, "Task graph has a cycle.");
+	}
+
+	built = true;
+	return Optional<Error>();
+}
+
+//----------------------------------------------------------------------------->
+// Returns the number of nodes in the graph.
+size_t TaskGraph::GetNodeCount() const
+{
+	return nodes.Count();
+}
+
+//----------------------------------------------------------------------------//
+END_NAMESPACE(ut)
+//----------------------------------------------------------------------------//
+//----------------------------------------------------------------------------//
+//----------------------------------------------------------------------------//
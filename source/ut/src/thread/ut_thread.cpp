@@ -5,8 +5,369 @@
 #include "system/ut_memory.h"
 #include "error/ut_error.h"
 #include "dbg/ut_exception.h"
+#include "streams/ut_file.h"
 //----------------------------------------------------------------------------//
 START_NAMESPACE(ut)
+//----------------------------------------------------------------------------//
+// Restricts the thread to the provided processors.
+//    @param thread - platform-specific handle of the thread.
+//    @param cpu_set - set of processors.
+//    @return - ut::Error if failed.
+static Optional<Error> SetPlatformAffinity(ThreadHandle thread, const CpuSet& cpu_set)
+{
+	if (cpu_set.Count() == 0)
+	{
+		return Error(error::invalid_arg, "Set of processors is empty.");
+	}
+
+#if UT_WINDOWS
+	// only the first processor group is supported
+	const uint32 mask_size = static_cast<uint32>(sizeof(DWORD_PTR) * 8);
+	DWORD_PTR mask = 0;
+	for (uint32 i = 0; i < CpuSet::skMaxCpuCount; i++)
+	{
+		if (!cpu_set.Has(i))
+		{
+			continue;
+		}
+
+		if (i >= mask_size)
+		{
+			return Error(error::not_supported, "Processor index is out of the first processor group.");
+		}
+
+		mask |= static_cast<DWORD_PTR>(1) << i;
+	}
+
+	if (SetThreadAffinityMask(thread, mask) == 0)
+	{
+		return Error(error::fail);
+	}
+#elif UT_UNIX
+	cpu_set_t native_set;
+	CPU_ZERO(&native_set);
+	for (uint32 i = 0; i < CpuSet::skMaxCpuCount && i < CPU_SETSIZE; i++)
+	{
+		if (cpu_set.Has(i))
+		{
+			CPU_SET(i, &native_set);
+		}
+	}
+
+	const int result = pthread_setaffinity_np(thread, sizeof(native_set), &native_set);
+	if (result != 0)
+	{
+		return Error(ConvertErrno(result));
+	}
+#else
+	#error ut::SetPlatformAffinity() is not implemented
+#endif
+	return Optional<Error>();
+}
+
+//----------------------------------------------------------------------------->
+// Sets the name of the thread.
+//    @param thread - platform-specific handle of the thread.
+//    @param name - name of the thread.
+//    @return - ut::Error if failed.
+static Optional<Error> SetPlatformName(ThreadHandle thread, const String& name)
+{
+#if UT_WINDOWS
+	WString wide_name = StrConvert<char, wchar, CodePage::utf8>(name.GetAddress());
+	if (FAILED(SetThreadDescription(thread, wide_name.GetAddress())))
+	{
+		return Error(error::fail);
+	}
+#elif UT_UNIX
+	// linux limits the name by 16 bytes including null terminator
+	char short_name[16];
+	const size_t length = name.Length() < sizeof(short_name) - 1 ? name.Length() : sizeof(short_name) - 1;
+	memory::Copy(short_name, name.GetAddress(), length);
+	short_name[length] = 0;
+
+	const int result = pthread_setname_np(thread, short_name);
+	if (result != 0)
+	{
+		return Error(ConvertErrno(result));
+	}
+#else
+	#error ut::SetPlatformName() is not implemented
+#endif
+	return Optional<Error>();
+}
+
+//----------------------------------------------------------------------------->
+// Sets the scheduling priority of the thread.
+//    @param thread - platform-specific handle of the thread.
+//    @param native_id - kernel id of the thread, used only in unix.
+//    @param priority - priority level.
+//    @return - ut::Error if failed.
+#if UT_WINDOWS
+static Optional<Error> SetPlatformPriority(ThreadHandle thread, thread_priority::Level priority)
+#elif UT_UNIX
+static Optional<Error> SetPlatformPriority(ThreadHandle thread, pid_t native_id, thread_priority::Level priority)
+#endif
+{
+#if UT_WINDOWS
+	int native_priority = THREAD_PRIORITY_NORMAL;
+	switch (priority)
+	{
+		case thread_priority::Level::lowest:  native_priority = THREAD_PRIORITY_IDLE; break;
+		case thread_priority::Level::low:     native_priority = THREAD_PRIORITY_BELOW_NORMAL; break;
+		case thread_priority::Level::normal:  native_priority = THREAD_PRIORITY_NORMAL; break;
+		case thread_priority::Level::high:    native_priority = THREAD_PRIORITY_ABOVE_NORMAL; break;
+		case thread_priority::Level::highest: native_priority = THREAD_PRIORITY_HIGHEST; break;
+		case thread_priority::Level::realtime: native_priority = THREAD_PRIORITY_TIME_CRITICAL; break;
+	}
+
+	if (!SetThreadPriority(thread, native_priority))
+	{
+		return Error(error::fail);
+	}
+#elif UT_UNIX
+	// time-sharing threads differ only in the nice value, linux sets it per
+	// thread using the kernel id, real-time policy can starve the rest of
+	// the system, so it's used only on explicit request; negative nice
+	// values and real-time policy usually require CAP_SYS_NICE capability
+	int policy = SCHED_OTHER;
+	int nice = 0;
+	sched_param param;
+	memory::Set(&param, 0, sizeof(param));
+	switch (priority)
+	{
+		case thread_priority::Level::lowest:   nice = 19; break;
+		case thread_priority::Level::low:      nice = 10; break;
+		case thread_priority::Level::normal:   nice = 0; break;
+		case thread_priority::Level::high:     nice = -5; break;
+		case thread_priority::Level::highest:  nice = -10; break;
+		case thread_priority::Level::realtime:
+			policy = SCHED_RR;
+			param.sched_priority = sched_get_priority_min(SCHED_RR);
+			break;
+	}
+
+	const int result = pthread_setschedparam(thread, policy, &param);
+	if (result != 0)
+	{
+		return Error(ConvertErrno(result));
+	}
+
+	if (policy == SCHED_OTHER && setpriority(PRIO_PROCESS, static_cast<id_t>(native_id), nice) != 0)
+	{
+		return Error(ConvertErrno(errno));
+	}
+#else
+	#error ut::SetPlatformPriority() is not implemented
+#endif
+	return Optional<Error>();
+}
+
+//----------------------------------------------------------------------------->
+// Parses the list of indices in linux sysfs format, for example: "0-3,8,10-11".
+//    @param text - text of the list.
+//    @param cpu_set - set to add indices to.
+//    @return - 'true' if the list was parsed successfully.
+#if UT_UNIX
+static bool ParseIndexList(const Array<byte>& text, CpuSet& cpu_set)
+{
+	const size_t size = text.Count();
+	size_t position = 0;
+	while (position < size && text[position] >= '0' && text[position] <= '9')
+	{
+		uint32 first = 0;
+		for (; position < size && text[position] >= '0' && text[position] <= '9'; position++)
+		{
+			first = first * 10 + static_cast<uint32>(text[position] - '0');
+		}
+
+		uint32 last = first;
+		if (position < size && text[position] == '-')
+		{
+			last = 0;
+			for (position++; position < size && text[position] >= '0' && text[position] <= '9'; position++)
+			{
+				last = last * 10 + static_cast<uint32>(text[position] - '0');
+			}
+		}
+
+		if (last < first || last >= CpuSet::skMaxCpuCount)
+		{
+			return false;
+		}
+
+		for (uint32 i = first; i <= last; i++)
+		{
+			cpu_set.Add(i);
+		}
+
+		if (position < size && text[position] == ',')
+		{
+			position++;
+		}
+	}
+	return true;
+}
+#endif
+
+//----------------------------------------------------------------------------//
+// class ut::CpuSet                                                           //
+//----------------------------------------------------------------------------//
+// Constructor, creates an empty set.
+CpuSet::CpuSet()
+{
+	memory::Set(mask, 0, sizeof(mask));
+}
+
+//----------------------------------------------------------------------------->
+// Returns the set of all processors the current process is allowed to run on.
+CpuSet CpuSet::All()
+{
+	CpuSet cpu_set;
+#if UT_WINDOWS
+	// only the first processor group is supported
+	DWORD_PTR process_mask = 0;
+	DWORD_PTR system_mask = 0;
+	if (GetProcessAffinityMask(GetCurrentProcess(), &process_mask, &system_mask))
+	{
+		const uint32 mask_size = static_cast<uint32>(sizeof(DWORD_PTR) * 8);
+		for (uint32 i = 0; i < mask_size; i++)
+		{
+			if (process_mask & (static_cast<DWORD_PTR>(1) << i))
+			{
+				cpu_set.Add(i);
+			}
+		}
+	}
+#elif UT_UNIX
+	cpu_set_t native_set;
+	CPU_ZERO(&native_set);
+	if (sched_getaffinity(0, sizeof(native_set), &native_set) == 0)
+	{
+		for (uint32 i = 0; i < skMaxCpuCount && i < CPU_SETSIZE; i++)
+		{
+			if (CPU_ISSET(i, &native_set))
+			{
+				cpu_set.Add(i);
+			}
+		}
+	}
+#else
+	#error ut::CpuSet::All() is not implemented
+#endif
+
+	// affinity mask is unavailable, assume that processors are numbered
+	// without gaps
+	if (cpu_set.Count() == 0)
+	{
+		const uint32 count = GetNumberOfProcessors();
+		for (uint32 i = 0; i < count && i < skMaxCpuCount; i++)
+		{
+			cpu_set.Add(i);
+		}
+	}
+
+	return cpu_set;
+}
+
+//----------------------------------------------------------------------------->
+// Returns the set of processors belonging to the NUMA node.
+//    @param node - index of the NUMA node.
+//    @return - set of processors or ut::Error if failed.
+Result<CpuSet, Error> CpuSet::FromNumaNode(uint32 node)
+{
+	CpuSet cpu_set;
+#if UT_WINDOWS
+	ULONGLONG node_mask = 0;
+	if (node > 0xFF || !GetNumaNodeProcessorMask(static_cast<UCHAR>(node), &node_mask))
+	{
+		return MakeError(error::not_found);
+	}
+
+	for (uint32 i = 0; i < 64; i++)
+	{
+		if (node_mask & (static_cast<ULONGLONG>(1) << i))
+		{
+			cpu_set.Add(i);
+		}
+	}
+#elif UT_UNIX
+	String path;
+	path.Print("/sys/devices/system/node/node%u/cpulist", node);
+	Result<Array<byte>, Error> cpu_list = ReadFile(path);
+	if (!cpu_list)
+	{
+		// non-NUMA kernels have no node directories, node 0 has all processors
+		return node == 0 ? All() : Result<CpuSet, Error>(MakeError(error::not_found));
+	}
+
+	if (!ParseIndexList(cpu_list.Get(), cpu_set))
+	{
+		return MakeError(error::invalid_arg, "Invalid format of the processor list.");
+	}
+#else
+	#error ut::CpuSet::FromNumaNode() is not implemented
+#endif
+	return cpu_set;
+}
+
+//----------------------------------------------------------------------------->
+// Adds a processor to the set.
+//    @param cpu - index of the processor.
+void CpuSet::Add(uint32 cpu)
+{
+	UT_ASSERT(cpu < skMaxCpuCount);
+	mask[cpu / 64] |= static_cast<uint64>(1) << (cpu % 64);
+}
+
+//----------------------------------------------------------------------------->
+// Removes a processor from the set.
+//    @param cpu - index of the processor.
+void CpuSet::Remove(uint32 cpu)
+{
+	UT_ASSERT(cpu < skMaxCpuCount);
+	mask[cpu / 64] &= ~(static_cast<uint64>(1) << (cpu % 64));
+}
+
+//----------------------------------------------------------------------------->
+// Checks if the processor belongs to the set.
+//    @param cpu - index of the processor.
+bool CpuSet::Has(uint32 cpu) const
+{
+	return cpu < skMaxCpuCount && (mask[cpu / 64] & (static_cast<uint64>(1) << (cpu % 64))) != 0;
+}
+
+//----------------------------------------------------------------------------->
+// Returns the number of processors in the set.
+uint32 CpuSet::Count() const
+{
+	uint32 count = 0;
+	for (uint32 i = 0; i < skWordCount; i++)
+	{
+		for (uint64 word = mask[i]; word != 0; word &= word - 1)
+		{
+			count++;
+		}
+	}
+	return count;
+}
+
+//----------------------------------------------------------------------------->
+// Returns the processor with the provided ordinal number in the set,
+// processors are sorted by index.
+//    @param n - ordinal number of the processor, starting from 0.
+//    @return - index of the processor or nothing if @n >= Count().
+Optional<uint32> CpuSet::GetNth(uint32 n) const
+{
+	for (uint32 i = 0; i < skMaxCpuCount; i++)
+	{
+		if (Has(i) && n-- == 0)
+		{
+			return i;
+		}
+	}
+	return Optional<uint32>();
+}
+
 //----------------------------------------------------------------------------//
 // ut::this_thread namespace groups a set of functions that access the
 // current thread.
@@ -25,6 +386,26 @@ namespace this_thread
 #endif
 	}
 
+	// Hints the processor that the calling thread is in a spin-wait loop,
+	// reduces power consumption and frees resources for the sibling
+	// hyper-thread. Doesn't give up the time slice, see Yield() for that.
+	void Pause()
+	{
+#if UT_WINDOWS
+		YieldProcessor();
+#elif UT_UNIX
+	#if defined(__i386__) || defined(__x86_64__)
+		__builtin_ia32_pause();
+	#elif defined(__aarch64__) || defined(__arm__)
+		__asm__ __volatile__("yield" ::: "memory");
+	#else
+		__asm__ __volatile__("" ::: "memory");
+	#endif
+#else
+#error ut::this_thread::Pause() is not implemented
+#endif
+	}
+
 	// Returns the id of the current thread
 	//    @return - id of the current thread
 	ThreadId GetId()
@@ -35,6 +416,49 @@ namespace this_thread
 		return pthread_self();
 #else
 #error ut::this_thread::GetId() is not implemented
+#endif
+	}
+
+	// Restricts the current thread to the provided processors.
+	//    @param cpu_set - set of processors, must not be empty.
+	//    @return - ut::Error if failed.
+	Optional<Error> SetAffinity(const CpuSet& cpu_set)
+	{
+#if UT_WINDOWS
+		return SetPlatformAffinity(GetCurrentThread(), cpu_set);
+#elif UT_UNIX
+		return SetPlatformAffinity(pthread_self(), cpu_set);
+#else
+#error ut::this_thread::SetAffinity() is not implemented
+#endif
+	}
+
+	// Sets the name of the current thread visible in debuggers
+	// and profilers, long names are truncated on Linux (15 characters).
+	//    @param name - name of the thread.
+	//    @return - ut::Error if failed.
+	Optional<Error> SetName(const String& name)
+	{
+#if UT_WINDOWS
+		return SetPlatformName(GetCurrentThread(), name);
+#elif UT_UNIX
+		return SetPlatformName(pthread_self(), name);
+#else
+#error ut::this_thread::SetName() is not implemented
+#endif
+	}
+
+	// Sets the scheduling priority of the current thread.
+	//    @param priority - priority level.
+	//    @return - ut::Error if failed.
+	Optional<Error> SetPriority(thread_priority::Level priority)
+	{
+#if UT_WINDOWS
+		return SetPlatformPriority(GetCurrentThread(), priority);
+#elif UT_UNIX
+		return SetPlatformPriority(pthread_self(), static_cast<pid_t>(syscall(SYS_gettid)), priority);
+#else
+#error ut::this_thread::SetPriority() is not implemented
 #endif
 	}
 }
@@ -55,6 +479,32 @@ uint32 GetNumberOfProcessors()
 #endif
 }
 
+//----------------------------------------------------------------------------->
+// Returns the number of NUMA nodes, 1 if the system isn't NUMA.
+//    @return - number of NUMA nodes
+uint32 GetNumberOfNumaNodes()
+{
+#if UT_WINDOWS
+	ULONG highest_node = 0;
+	if (!GetNumaHighestNodeNumber(&highest_node))
+	{
+		return 1;
+	}
+	return static_cast<uint32>(highest_node) + 1;
+#elif UT_UNIX
+	// node indices have the same format as processor indices
+	Result<Array<byte>, Error> node_list = ReadFile("/sys/devices/system/node/online");
+	CpuSet nodes;
+	if (!node_list || !ParseIndexList(node_list.Get(), nodes) || nodes.Count() == 0)
+	{
+		return 1;
+	}
+	return nodes.Count();
+#else
+	#error ut::GetNumberOfNumaNodes() is not implemented
+#endif
+}
+
 //----------------------------------------------------------------------------//
 // class ut::Job                                                              //
 //----------------------------------------------------------------------------//
@@ -76,6 +526,7 @@ void Job::Exit()
 //    @param proc - function to be called from a new thread.
 Thread::Thread(Function<void()> proc) : handle(0)
                                       , id(0)
+                                      , native_id(0)
                                       , active(false)
 {
 	UT_ASSERT(proc.IsValid());
@@ -94,6 +545,7 @@ Thread::Thread(Function<void()> proc) : handle(0)
 Thread::Thread(UniquePtr<Job> job_ptr) : job(Move(job_ptr))
                                        , handle(0)
                                        , id(0)
+                                       , native_id(0)
                                        , active(false)
 {
 	UT_ASSERT(job);
@@ -111,6 +563,7 @@ Thread::Thread(UniquePtr<Job> job_ptr) : job(Move(job_ptr))
 Thread::Thread(UniquePtr< BaseTask<void> > proc) : task(Move(proc))
                                                  , handle(0)
                                                  , id(0)
+                                                 , native_id(0)
                                                  , active(false)
 {
 	Optional<Error> launch_error = Start();
@@ -212,6 +665,62 @@ void Thread::Kill(void)
 	active = false;
 }
 
+//----------------------------------------------------------------------------->
+// Restricts the thread to the provided processors.
+//    @param cpu_set - set of processors, must not be empty.
+//    @return - ut::Error if failed.
+Optional<Error> Thread::SetAffinity(const CpuSet& cpu_set)
+{
+	UT_ASSERT(active);
+#if UT_WINDOWS
+	return SetPlatformAffinity(handle, cpu_set);
+#elif UT_UNIX
+	return SetPlatformAffinity(id, cpu_set);
+#else
+	#error ut::Thread::SetAffinity() is not implemented
+#endif
+}
+
+//----------------------------------------------------------------------------->
+// Sets the name of the thread visible in debuggers and
+// profilers, long names are truncated on Linux (15 characters).
+//    @param name - name of the thread.
+//    @return - ut::Error if failed.
+Optional<Error> Thread::SetName(const String& name)
+{
+	UT_ASSERT(active);
+#if UT_WINDOWS
+	return SetPlatformName(handle, name);
+#elif UT_UNIX
+	return SetPlatformName(id, name);
+#else
+	#error ut::Thread::SetName() is not implemented
+#endif
+}
+
+//----------------------------------------------------------------------------->
+// Sets the scheduling priority of the thread.
+//    @param priority - priority level.
+//    @return - ut::Error if failed.
+Optional<Error> Thread::SetPriority(thread_priority::Level priority)
+{
+	UT_ASSERT(active);
+#if UT_WINDOWS
+	return SetPlatformPriority(handle, priority);
+#elif UT_UNIX
+	// kernel id is published by the thread right after the start
+	int32 tid = native_id.Read();
+	while (tid == 0)
+	{
+		this_thread::Yield();
+		tid = native_id.Read();
+	}
+	return SetPlatformPriority(id, static_cast<pid_t>(tid), priority);
+#else
+	#error ut::Thread::SetPriority() is not implemented
+#endif
+}
+
 //----------------------------------------------------------------------------->
 // Starts a new thread using @task member, windows variant uses
 // _beginthreadex() to run a thread, Linux variant uses pthread_create().
@@ -222,7 +731,7 @@ inline Optional<Error> Thread::Start()
 			_beginthreadex(NULL, // security
 			               0, // stack size
 			               reinterpret_cast<unsigned int(__stdcall*)(void*)>(Entry),
-			               task.Get(), // thread argument
+			               this, // thread argument
 			               0, // initialization flags
 			               (unsigned int*)&id)); // thread id (address)
 
@@ -234,7 +743,7 @@ inline Optional<Error> Thread::Start()
 	int result = pthread_create(&id,
 	                            NULL,
 	                            reinterpret_cast<void* (*)(void*)>(Entry),
-	                            task.Get());
+	                            this);
 	if (result != 0)
 	{
 		return Error(ConvertErrno(result));
@@ -248,8 +757,16 @@ inline Optional<Error> Thread::Start()
 
 //----------------------------------------------------------------------------->
 // Entry function for the new thread, calls @task->Execute() internally.
-THREAD_PROCEDURE Thread::Entry(BaseTask<void>* proc)
+THREAD_PROCEDURE Thread::Entry(Thread* thread)
 {
+	UT_ASSERT(thread != nullptr);
+#if UT_UNIX
+	thread->native_id.Store(static_cast<int32>(syscall(SYS_gettid)));
+#endif
+
+	// thread object can be destroyed by the task itself,
+	// so it's not accessed after the start of the task
+	BaseTask<void>* proc = thread->task.Get();
 	UT_ASSERT(proc != nullptr);
 	if (CatchExceptions([=]() { proc->Execute(); }))
 	{